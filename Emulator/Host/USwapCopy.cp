@@ -0,0 +1,275 @@
+// ==============================
+// File:			USwapCopy.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "USwapCopy.h"
+
+// Vector units
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define kSwapCopyX86 1
+	#include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__arm64__))
+	#define kSwapCopyNEON 1
+	#include <arm_neon.h>
+#endif
+
+// -------------------------------------------------------------------------- //
+// Kernels
+// -------------------------------------------------------------------------- //
+typedef void (*SwapWordsProc)( KUInt8*, const KUInt8*, KUInt32 );
+
+// -------------------------------------------------------------------------- //
+//  * SwapWordsScalar( KUInt8*, const KUInt8*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+SwapWordsScalar( KUInt8* outDest, const KUInt8* inSrc, KUInt32 inSize )
+{
+	KUInt32 nbWords = inSize / 4;
+	while (nbWords-- > 0)
+	{
+		// Read the whole word first, the buffers may be identical.
+		KUInt8 theByte0 = inSrc[0];
+		KUInt8 theByte1 = inSrc[1];
+		KUInt8 theByte2 = inSrc[2];
+		KUInt8 theByte3 = inSrc[3];
+		outDest[0] = theByte3;
+		outDest[1] = theByte2;
+		outDest[2] = theByte1;
+		outDest[3] = theByte0;
+		inSrc += 4;
+		outDest += 4;
+	}
+}
+
+#if kSwapCopyX86
+// -------------------------------------------------------------------------- //
+//  * SwapWordsSSSE3( KUInt8*, const KUInt8*, KUInt32 )
+// -------------------------------------------------------------------------- //
+__attribute__((target("ssse3")))
+static void
+SwapWordsSSSE3( KUInt8* outDest, const KUInt8* inSrc, KUInt32 inSize )
+{
+	const __m128i theMask = _mm_setr_epi8(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+	while (inSize >= 16)
+	{
+		__m128i theVector = _mm_loadu_si128( (const __m128i*) inSrc );
+		_mm_storeu_si128(
+			(__m128i*) outDest, _mm_shuffle_epi8( theVector, theMask ) );
+		inSrc += 16;
+		outDest += 16;
+		inSize -= 16;
+	}
+	SwapWordsScalar( outDest, inSrc, inSize );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwapWordsAVX2( KUInt8*, const KUInt8*, KUInt32 )
+// -------------------------------------------------------------------------- //
+__attribute__((target("avx2")))
+static void
+SwapWordsAVX2( KUInt8* outDest, const KUInt8* inSrc, KUInt32 inSize )
+{
+	// vpshufb shuffles within each 128 bits lane.
+	const __m256i theMask = _mm256_setr_epi8(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+	while (inSize >= 64)
+	{
+		__m256i theVector0 = _mm256_loadu_si256( (const __m256i*) inSrc );
+		__m256i theVector1 = _mm256_loadu_si256( (const __m256i*) (inSrc + 32) );
+		_mm256_storeu_si256(
+			(__m256i*) outDest, _mm256_shuffle_epi8( theVector0, theMask ) );
+		_mm256_storeu_si256(
+			(__m256i*) (outDest + 32), _mm256_shuffle_epi8( theVector1, theMask ) );
+		inSrc += 64;
+		outDest += 64;
+		inSize -= 64;
+	}
+	if (inSize >= 32)
+	{
+		__m256i theVector = _mm256_loadu_si256( (const __m256i*) inSrc );
+		_mm256_storeu_si256(
+			(__m256i*) outDest, _mm256_shuffle_epi8( theVector, theMask ) );
+		inSrc += 32;
+		outDest += 32;
+		inSize -= 32;
+	}
+	SwapWordsSSSE3( outDest, inSrc, inSize );
+}
+#endif
+
+#if kSwapCopyNEON
+// -------------------------------------------------------------------------- //
+//  * SwapWordsNEON( KUInt8*, const KUInt8*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+SwapWordsNEON( KUInt8* outDest, const KUInt8* inSrc, KUInt32 inSize )
+{
+	while (inSize >= 16)
+	{
+		vst1q_u8( outDest, vrev32q_u8( vld1q_u8( inSrc ) ) );
+		inSrc += 16;
+		outDest += 16;
+		inSize -= 16;
+	}
+	SwapWordsScalar( outDest, inSrc, inSize );
+}
+#endif
+
+// -------------------------------------------------------------------------- //
+//  * SwapWordsSelect( KUInt8*, const KUInt8*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void SwapWordsSelect( KUInt8* outDest, const KUInt8* inSrc, KUInt32 inSize );
+
+static SwapWordsProc gSwapWordsProc = SwapWordsSelect;
+static USwapCopy::EKernel gKernel = USwapCopy::kScalar;
+
+static void
+SwapWordsSelect( KUInt8* outDest, const KUInt8* inSrc, KUInt32 inSize )
+{
+	// Select the best kernel at the first call.
+	(void) USwapCopy::GetKernel();
+	(*gSwapWordsProc)( outDest, inSrc, inSize );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwapWords( KUInt8*, const KUInt8*, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+USwapCopy::SwapWords( KUInt8* outDest, const KUInt8* inSrc, KUInt32 inSize )
+{
+	(*gSwapWordsProc)( outDest, inSrc, inSize );
+}
+
+// -------------------------------------------------------------------------- //
+//  * IsKernelAvailable( EKernel )
+// -------------------------------------------------------------------------- //
+Boolean
+USwapCopy::IsKernelAvailable( EKernel inKernel )
+{
+	Boolean theResult = false;
+	switch (inKernel)
+	{
+		case kScalar:
+			theResult = true;
+			break;
+
+#if kSwapCopyX86
+		case kSSSE3:
+			theResult = __builtin_cpu_supports( "ssse3" );
+			break;
+
+		case kAVX2:
+			theResult = __builtin_cpu_supports( "avx2" );
+			break;
+#endif
+
+#if kSwapCopyNEON
+		case kNEON:
+			theResult = true;
+			break;
+#endif
+
+		default:
+			break;
+	}
+	
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetKernel( EKernel )
+// -------------------------------------------------------------------------- //
+Boolean
+USwapCopy::SetKernel( EKernel inKernel )
+{
+	if (!IsKernelAvailable( inKernel ))
+	{
+		return true;
+	}
+	
+	switch (inKernel)
+	{
+#if kSwapCopyX86
+		case kSSSE3:
+			gSwapWordsProc = SwapWordsSSSE3;
+			break;
+
+		case kAVX2:
+			gSwapWordsProc = SwapWordsAVX2;
+			break;
+#endif
+
+#if kSwapCopyNEON
+		case kNEON:
+			gSwapWordsProc = SwapWordsNEON;
+			break;
+#endif
+
+		default:
+			gSwapWordsProc = SwapWordsScalar;
+			break;
+	}
+	gKernel = inKernel;
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetKernel( void )
+// -------------------------------------------------------------------------- //
+USwapCopy::EKernel
+USwapCopy::GetKernel( void )
+{
+	if (gSwapWordsProc == SwapWordsSelect)
+	{
+		// Best first.
+		if (SetKernel( kAVX2 ) && SetKernel( kSSSE3 ) && SetKernel( kNEON ))
+		{
+			(void) SetKernel( kScalar );
+		}
+	}
+	
+	return gKernel;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetKernelName( EKernel )
+// -------------------------------------------------------------------------- //
+const char*
+USwapCopy::GetKernelName( EKernel inKernel )
+{
+	static const char* const kNames[kKernelCount] = {
+		"scalar", "ssse3", "avx2", "neon"
+	};
+	
+	return (inKernel < kKernelCount) ? kNames[inKernel] : "unknown";
+}
+
+// ====================================================================== //
+// The first 90% of the code accounts for the first 90% of the           //
+// development time.  The remaining 10% of the code accounts for the     //
+// other 90% of the development time.                                     //
+//                 -- Tom Cargill                                         //
+// ====================================================================== //
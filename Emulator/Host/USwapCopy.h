@@ -0,0 +1,102 @@
+// ==============================
+// File:			USwapCopy.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _USWAPCOPY_H
+#define _USWAPCOPY_H
+
+#include <K/Defines/KDefinitions.h>
+
+///
+/// Copy of buffers of 32 bits words with their bytes swapped, to move big
+/// endian guest data to and from a little endian host.
+///
+/// The copy is done by a kernel selected at the first call from what the
+/// host processor supports (AVX2 or SSSE3 on x86, NEON on ARM64), with a
+/// portable fallback.
+///
+/// \test	UMemoryTests::SwapCopyTest
+///
+class USwapCopy
+{
+public:
+	/// Kernels.
+	enum EKernel {
+		kScalar		= 0,	///< Portable code.
+		kSSSE3		= 1,	///< 16 bytes at a time with pshufb.
+		kAVX2		= 2,	///< 32 bytes at a time with vpshufb.
+		kNEON		= 3,	///< 16 bytes at a time with vrev32.
+		kKernelCount
+	};
+
+	///
+	/// Copy words, swapping the bytes of every word.
+	/// Buffers may be unaligned and may be identical, but must not
+	/// overlap otherwise.
+	///
+	/// \param outDest	destination buffer.
+	/// \param inSrc	source buffer.
+	/// \param inSize	number of bytes to copy (multiple of 4).
+	///
+	static void		SwapWords(
+						KUInt8* outDest,
+						const KUInt8* inSrc,
+						KUInt32 inSize );
+
+	///
+	/// Determine if a kernel can run on this host.
+	///
+	/// \param inKernel	kernel to test.
+	/// \return true if the kernel is compiled in and supported.
+	///
+	static Boolean	IsKernelAvailable( EKernel inKernel );
+
+	///
+	/// Select the kernel used by SwapWords (for tests and benchmarks).
+	///
+	/// \param inKernel	kernel to use.
+	/// \return true if the kernel is not available.
+	///
+	static Boolean	SetKernel( EKernel inKernel );
+
+	///
+	/// Accessor on the kernel SwapWords uses.
+	///
+	/// \return the current kernel.
+	///
+	static EKernel	GetKernel( void );
+
+	///
+	/// Accessor on the name of a kernel.
+	///
+	/// \param inKernel	kernel.
+	/// \return a constant string.
+	///
+	static const char*	GetKernelName( EKernel inKernel );
+};
+
+#endif
+		// _USWAPCOPY_H
+
+// ====================================================================== //
+// Byte swapping: the art of making two wrongs make a right.              //
+// ====================================================================== //
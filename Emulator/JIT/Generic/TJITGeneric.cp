@@ -30,6 +30,7 @@
 #include "TMemory.h"
 #include "TJITGeneric.h"
 #include "TJITGenericPage.h"
+#include "TJITGenericPageFile.h"
 #include "TARMProcessor.h"
 #include "TEmulator.h"
 #include "TMemoryConsts.h"
@@ -128,6 +129,11 @@ test()
 // Constantes
 // -------------------------------------------------------------------------- //
 
+static Boolean gBranchCacheEnabled = true;
+
+/// Whether translated ROM pages are kept in a file next to the ROM image.
+static Boolean gUsePageFile = false;
+
 // -------------------------------------------------------------------------- //
 //  * TJITGeneric( void )
 // -------------------------------------------------------------------------- //
@@ -135,7 +141,9 @@ TJITGeneric::TJITGeneric(
 		TMemory* inMemoryIntf,
 		TMMU* inMMUIntf )
 	:
-		TJIT<TJITGeneric, TJITGenericPage>( inMemoryIntf, inMMUIntf )
+		TJIT<TJITGeneric, TJITGenericPage>( inMemoryIntf, inMMUIntf ),
+		mPageFile( NULL ),
+		mBranchCacheMisses( 0 )
 {
 }
 
@@ -144,6 +152,51 @@ TJITGeneric::TJITGeneric(
 // -------------------------------------------------------------------------- //
 TJITGeneric::~TJITGeneric( void )
 {
+	if (mPageFile)
+	{
+		delete mPageFile;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * OpenPageFile( const char*, const KUInt32[10] )
+// -------------------------------------------------------------------------- //
+void
+TJITGeneric::OpenPageFile(
+				const char* inImagePath,
+				const KUInt32 inChecksums[10] )
+{
+	if (mPageFile)
+	{
+		delete mPageFile;
+		mPageFile = NULL;
+	}
+	if (!gUsePageFile)
+	{
+		return;
+	}
+	
+	size_t theLength = ::strlen( inImagePath );
+	char* thePath = (char*) ::malloc( theLength + 5 );
+	(void) ::memcpy( thePath, inImagePath, theLength );
+	(void) ::memcpy( &thePath[theLength], ".jit", 5 );
+	mPageFile = new TJITGenericPageFile( thePath, inChecksums );
+	::free( thePath );
+	
+	if (!mPageFile->IsOpen())
+	{
+		delete mPageFile;
+		mPageFile = NULL;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetUsePageFile( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITGeneric::SetUsePageFile( Boolean inUsePageFile )
+{
+	gUsePageFile = inUsePageFile;
 }
 
 // -------------------------------------------------------------------------- //
@@ -266,6 +319,104 @@ TJITGeneric::GetJITUnitForPC(
 	return thePage->GetJITUnitForOffset(indexInPage);
 }
 
+// -------------------------------------------------------------------------- //
+//  * GetLinkedJITUnitForPC( TARMProcessor*, TMemory*, KUInt32, JITUnit* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGeneric::GetLinkedJITUnitForPC(
+					TARMProcessor* ioCPU,
+					TMemory* inMemoryInterface,
+					KUInt32 inPC,
+					JITUnit* ioLink )
+{
+	TJITGenericPage* theSourcePage = (TJITGenericPage*) ioLink[0].fPtr;
+	KUInt32 theSourceGeneration = theSourcePage->GetLinkGeneration();
+
+	// Get the page from the cache.
+	KUInt32 pc = inPC - 4;
+	TJITGenericPage* thePage = GetPage(pc);
+
+	if (thePage == NULL)
+	{
+		// Let's manage the exception
+		ioCPU->PrefetchAbort();
+
+		// Redo the translation.
+		pc = ioCPU->mCurrentRegisters[TARMProcessor::kR15];
+		return GetJITUnitForPC( ioCPU, inMemoryInterface, pc );
+	}
+
+	KUInt32 indexInPage = GetOffsetInPage(pc) / sizeof( KUInt32 );
+	JITUnit* theUnit = thePage->GetJITUnitForOffset(indexInPage);
+
+	// The page we come from may have been recycled by GetPage, in which case
+	// the link record no longer exists.
+	if (theSourcePage->GetLinkGeneration() == theSourceGeneration)
+	{
+		ioLink[1].fPtr = (KUIntPtr) thePage;
+		ioLink[2].fValue = thePage->GetLinkGeneration();
+		ioLink[3].fValue = GetPageGeneration(thePage);
+		ioLink[4].fPtr = (KUIntPtr) theUnit;
+	}
+
+	return theUnit;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetCachedJITUnitForPC( TARMProcessor*, TMemory*, KUInt32, JITUnit* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGeneric::GetCachedJITUnitForPC(
+					TARMProcessor* ioCPU,
+					TMemory* inMemoryInterface,
+					KUInt32 inPC,
+					JITUnit* ioCache )
+{
+	mBranchCacheMisses++;
+
+	TJITGenericPage* theSourcePage = (TJITGenericPage*) ioCache[0].fPtr;
+	KUInt32 theSourceGeneration = theSourcePage->GetLinkGeneration();
+
+	// Get the page from the cache.
+	KUInt32 pc = inPC - 4;
+	TJITGenericPage* thePage = GetPage(pc);
+
+	if (thePage == NULL)
+	{
+		// Let's manage the exception
+		ioCPU->PrefetchAbort();
+
+		// Redo the translation.
+		pc = ioCPU->mCurrentRegisters[TARMProcessor::kR15];
+		return GetJITUnitForPC( ioCPU, inMemoryInterface, pc );
+	}
+
+	KUInt32 indexInPage = GetOffsetInPage(pc) / sizeof( KUInt32 );
+	JITUnit* theUnit = thePage->GetJITUnitForOffset(indexInPage);
+
+	// Remember the target, unless the record disappeared with the source
+	// page (recycled by GetPage).
+	if (gBranchCacheEnabled
+		&& (theSourcePage->GetLinkGeneration() == theSourceGeneration))
+	{
+		ioCache[1].fValue = inPC;
+		ioCache[2].fPtr = (KUIntPtr) thePage;
+		ioCache[3].fValue = thePage->GetLinkGeneration();
+		ioCache[4].fValue = GetPageGeneration(thePage);
+		ioCache[5].fPtr = (KUIntPtr) theUnit;
+	}
+
+	return theUnit;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetBranchCacheEnabled( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITGeneric::SetBranchCacheEnabled( Boolean inEnabled )
+{
+	gBranchCacheEnabled = inEnabled;
+}
 
 KSInt32
 TJITGeneric::GetJITUnitDelta(
@@ -294,14 +445,17 @@ TJITGeneric::GetJITUnitDelta(
 }
 
 // -------------------------------------------------------------------------- //
-//  * DoPatchROM(KUInt32* romPtr, const std::string& inMachineName)
+//  * DoPatchROM(KUInt32*, const std::string&, const STable*)
 // -------------------------------------------------------------------------- //
 void
-TJITGeneric::DoPatchROM(KUInt32* romPtr, const std::string& inMachineName) {
+TJITGeneric::DoPatchROM(
+				KUInt32* romPtr,
+				const std::string& inMachineName,
+				const TROMPatchDatabase::STable* inTable) {
 	fprintf(stderr, "PATCHING THE ROM\n");
 
-	TJITGenericROMPatch::DoPatchROM(romPtr, inMachineName);
-	TVirtualizedCallsPatches::DoPatchROM(romPtr, inMachineName);
+	TJITGenericROMPatch::DoPatchROM(romPtr, inMachineName, inTable);
+	TVirtualizedCallsPatches::DoPatchROM(romPtr, inMachineName, inTable);
 }
 
 
@@ -33,6 +33,7 @@
 
 class TMemory;
 class TARMProcessor;
+class TJITGenericPageFile;
 union JITUnit;
 
 
@@ -92,6 +93,65 @@ public:
 					TMemory* inMemoryInterface,
 					KUInt32 inPC );
 
+	///
+	/// Get a JIT unit for a given PC and store it in a link record so that
+	/// the next jump through this record doesn't need a lookup.
+	///
+	/// \param ioCPU				ARM CPU.
+	/// \param inMemoryInterface	interface to memory.
+	/// \param inPC				new PC.
+	/// \param ioLink			link record (see TJITGenericPage::PushLink).
+	/// \return the unit for the new PC.
+	///
+	JITUnit* GetLinkedJITUnitForPC(
+					TARMProcessor* ioCPU,
+					TMemory* inMemoryInterface,
+					KUInt32 inPC,
+					JITUnit* ioLink );
+
+	///
+	/// Get a JIT unit for a PC computed at run time and store it in the
+	/// branch cache record of the call site.
+	///
+	/// \param ioCPU				ARM CPU.
+	/// \param inMemoryInterface	interface to memory.
+	/// \param inPC				new PC.
+	/// \param ioCache			record (see TJITGenericPage::PushBranchCache).
+	/// \return the unit for the new PC.
+	///
+	JITUnit* GetCachedJITUnitForPC(
+					TARMProcessor* ioCPU,
+					TMemory* inMemoryInterface,
+					KUInt32 inPC,
+					JITUnit* ioCache );
+
+	///
+	/// Enable or disable filling the branch cache records (for benchmarks).
+	/// When disabled, every indirect branch is a miss.
+	///
+	/// \param inEnabled		whether records are filled.
+	///
+	static void SetBranchCacheEnabled( Boolean inEnabled );
+
+	///
+	/// Accessor on the number of indirect branches that missed their
+	/// branch cache record.
+	///
+	/// \return the number of misses since the last reset.
+	///
+	KUInt32	GetBranchCacheMisses( void ) const
+		{
+			return mBranchCacheMisses;
+		}
+
+	///
+	/// Reset the number of branch cache misses.
+	///
+	void	ResetBranchCacheMisses( void )
+		{
+			mBranchCacheMisses = 0;
+		}
+
 	///
 	/// Get the offset between the current JIT unit and the JIT unit for the new PC
 	/// \return kNotTheSamePage if the units are not on the same page
@@ -114,7 +174,46 @@ public:
 	/// This function is called to modify the ROM before it is saved on disk.
 	/// It is only called when the image is created.
 	///
-	static void DoPatchROM(KUInt32* romPtr, const std::string& inMachineName);
+	/// \param inTable	table of the patch database for this ROM or NULL
+	///					for the patches of the 717006 ROM.
+	///
+	static void DoPatchROM(
+					KUInt32* romPtr,
+					const std::string& inMachineName,
+					const TROMPatchDatabase::STable* inTable);
+
+	///
+	/// Attach the file with the translated ROM pages of a previous run,
+	/// next to the ROM image (the file is created if required).
+	/// Does nothing unless the file was enabled with SetUsePageFile.
+	/// Should be called before any ROM page is translated.
+	///
+	/// \param inImagePath		path to the ROM image.
+	/// \param inChecksums		checksums of the ROM image.
+	///
+	void	OpenPageFile(
+					const char* inImagePath,
+					const KUInt32 inChecksums[10] );
+
+	///
+	/// Accessor on the file with the translated ROM pages.
+	///
+	/// \return the file or NULL if there is none.
+	///
+	TJITGenericPageFile*	GetPageFile( void )
+		{
+			return mPageFile;
+		}
+
+	///
+	/// Enable or disable the file with the translated ROM pages (disabled
+	/// by default). ROM pages are then translated at once, to be stored,
+	/// instead of one run at a time. Emulators created afterwards are
+	/// affected.
+	///
+	/// \param inUsePageFile	whether OpenPageFile attaches the file.
+	///
+	static void	SetUsePageFile( Boolean inUsePageFile );
 	
 private:
 	///
@@ -138,6 +237,8 @@ private:
 	/// \name Variables
 	
 	TJITGenericPage*	mPagesPool;	///< Array with all the pages.
+	TJITGenericPageFile*	mPageFile;	///< Translated ROM pages (or NULL).
+	KUInt32				mBranchCacheMisses;	///< Indirect branches resolved.
 };
 
 #endif
@@ -29,6 +29,8 @@
 // Einstein
 #include "TARMProcessor.h"
 #include "TJITGenericPage.h"
+#include "TJITGenericPageFile.h"
+#include "TMemory.h"
 
 #include "TJITGeneric_Macros.h"
 
@@ -55,13 +57,41 @@
 static KUInt16 gMaxUnitsCount = 0;
 #endif
 
+/// Whether flag setting instructions whose flags are dead compute them.
+static Boolean gEliminateDeadFlags = true;
+
+/// Whether loops that poll memory wait for the next interrupt.
+static Boolean gDetectIdleLoops = true;
+
+/// Flags read by every condition.
+static const KUInt8 kConditionFlags[16] = {
+	0x4, 0x4,	// EQ, NE: Z
+	0x2, 0x2,	// CS, CC: C
+	0x8, 0x8,	// MI, PL: N
+	0x1, 0x1,	// VS, VC: V
+	0x6, 0x6,	// HI, LS: C, Z
+	0x9, 0x9,	// GE, LT: N, V
+	0xD, 0xD,	// GT, LE: N, Z, V
+	0x0, 0x0	// AL, NV
+};
+
 // -------------------------------------------------------------------------- //
 //  * TJITGenericPage( void )
 // -------------------------------------------------------------------------- //
 TJITGenericPage::TJITGenericPage( void )
+	:
+		mLinkGeneration( 0 ),
+		mBlocks( NULL ),
+		mBlockCapacity( 0 ),
+		mBlockCount( 0 ),
+		mBlockIndex( 0 ),
+		mUnitCrsr( 0 ),
+		mUnitsMayMove( true ),
+		mUnitOverflow( false ),
+		mMemoryIntf( NULL )
 {
-	mUnits = (JITUnit*) ::malloc(sizeof(JITUnit) * kDefaultUnitCount);
-	mUnitCount = kDefaultUnitCount;
+	(void) ::memset(mInstructionUnits, 0, sizeof(mInstructionUnits));
+	SelectBlock(0);
 }
 
 // -------------------------------------------------------------------------- //
@@ -69,7 +99,13 @@ TJITGenericPage::TJITGenericPage( void )
 // -------------------------------------------------------------------------- //
 TJITGenericPage::~TJITGenericPage( void )
 {
-	::free(mUnits);
+	KUInt32 indexBlock;
+	for (indexBlock = 0; indexBlock < mBlockCount; indexBlock++)
+	{
+		::free(mBlocks[indexBlock].fUnits);
+		::free(mBlocks[indexBlock].fUnitKinds);
+	}
+	::free(mBlocks);
 }
 
 // -------------------------------------------------------------------------- //
@@ -83,50 +119,291 @@ TJITGenericPage::Init(
 {
 	TJITPage<TJITGeneric, TJITGenericPage>::Init( inMemoryIntf, inVAddr, inPAddr );
 	KUInt32* thePointer = GetPointer();
+	mMemoryIntf = inMemoryIntf;
 
-	// Translate the page.
-	KUInt32 indexInstr;
-	KUInt32 theOffsetInPage = 0;
-	KUInt16 unitCrsr = 0;
-	for (indexInstr = 0; indexInstr < kInstructionCount; indexInstr++)
+	// Links from other pages point to the previous translation.
+	InvalidateLinks();
+
+	// Forget about the previous translation.
+	(void) ::memset(mInstructionUnits, 0, sizeof(mInstructionUnits));
+	SelectBlock(0);
+	mUnitCrsr = 0;
+#ifdef JITTARGET_X86_64
+	mNativeCode.Reset();
+#endif
+
+	// ROM pages mapped at their physical address may have been translated
+	// by a previous run.
+	TJITGenericPageFile* thePageFile = NULL;
+	if ((inVAddr == inPAddr) && TMemory::IsPageInROM(inPAddr))
 	{
-		mUnitsTable[indexInstr] = unitCrsr;
-		Translate(
-		    inMemoryIntf,
-			&unitCrsr,
-			thePointer[indexInstr],
-			inVAddr + theOffsetInPage );
-		theOffsetInPage += 4;
+		thePageFile = inMemoryIntf->GetJITObject()->GetPageFile();
 	}
 
-	PushUnit(&unitCrsr, TJITGenericPage::EndOfPage);
-	PushUnit(&unitCrsr, inVAddr + theOffsetInPage + 4);	// PC + 8
+	// Other pages are translated by runs, when they are reached. Pages that
+	// are stored (only with the page file, which is disabled by default) are
+	// translated at once.
+	mUnitsMayMove = (thePageFile != NULL);
+	mUnitOverflow = false;
+	if (!mUnitsMayMove)
+	{
+		return;
+	}
+
+	KUInt32 indexInstr;
+	KUInt16 theEndOfPageUnit;
+	if ((thePageFile == NULL)
+		|| thePageFile->LoadPage(this, inPAddr, thePointer, &theEndOfPageUnit))
+	{
+		// Translate the page.
+		KUInt32 theOffsetInPage = 0;
+		KUInt16 unitCrsr = 0;
+		for (indexInstr = 0; indexInstr < kInstructionCount; indexInstr++)
+		{
+			mUnitsTable[indexInstr] = unitCrsr;
+			Translate(
+				inMemoryIntf,
+				&unitCrsr,
+				thePointer[indexInstr],
+				inVAddr + theOffsetInPage );
+			theOffsetInPage += 4;
+		}
+
+		theEndOfPageUnit = unitCrsr;
+		PushUnit(&unitCrsr, TJITGenericPage::EndOfPage);
+		PushUnit(&unitCrsr, inVAddr + theOffsetInPage + 4);	// PC + 8
+		PushLink(&unitCrsr);
+
+		if (thePageFile)
+		{
+			thePageFile->StorePage(
+				this, inPAddr, thePointer, unitCrsr, theEndOfPageUnit);
+		}
 
 #ifdef COLLECT_STATS_ON_PAGES
-	if (unitCrsr > gMaxUnitsCount) {
-		gMaxUnitsCount = unitCrsr;
-		fprintf(stderr, "Max units count = %i\n", unitCrsr);
+		if (unitCrsr > gMaxUnitsCount) {
+			gMaxUnitsCount = unitCrsr;
+			fprintf(stderr, "Max units count = %i\n", unitCrsr);
+		}
+#endif
+	}
+
+	for (indexInstr = 0; indexInstr < kInstructionCount; indexInstr++)
+	{
+		mInstructionUnits[indexInstr] = &mUnits[mUnitsTable[indexInstr]];
 	}
+
+#if defined(JITTARGET_X86_64) && !defined(JIT_PERFORMANCE)
+	// Units won't move anymore: compile what we can to native code.
+	mNativeCode.EmitRun(
+		mInstructionUnits, thePointer, inVAddr, kInstructionCount,
+		&mUnits[theEndOfPageUnit] );
 #endif
 }
 
 // -------------------------------------------------------------------------- //
-//  * PushUnit( KUInt16*, KUIntPtr )
+//  * PushUnit( KUInt16*, KUIntPtr, KUInt8 )
 // -------------------------------------------------------------------------- //
 void
-TJITGenericPage::PushUnit(KUInt16* ioUnitCrsr, KUIntPtr inUnit)
+TJITGenericPage::PushUnit(KUInt16* ioUnitCrsr, KUIntPtr inUnit, KUInt8 inKind)
 {
 	// Can we push it?
 	KUInt16 theCrsr = *ioUnitCrsr;
 	if (theCrsr == mUnitCount) {
+		if (!mUnitsMayMove) {
+			// Units of the block may already be running: TranslateRun
+			// translates the instruction again in another block.
+			mUnitOverflow = true;
+			return;
+		}
 		// We need to resize the table.
-		mUnitCount += kUnitIncrement;
-		mUnits = (JITUnit*) ::realloc(mUnits, mUnitCount * sizeof(JITUnit));
+		ResizeUnits(mUnitCount + kUnitIncrement);
 	}
+	mUnitKinds[theCrsr] = inKind;
 	mUnits[theCrsr++].fPtr = inUnit;
 	*ioUnitCrsr = theCrsr;
 }
 
+// -------------------------------------------------------------------------- //
+//  * ResizeUnits( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::ResizeUnits( KUInt32 inUnitCount )
+{
+	mUnitCount = inUnitCount;
+	mUnits = (JITUnit*) ::realloc(mUnits, mUnitCount * sizeof(JITUnit));
+	mUnitKinds = (KUInt8*) ::realloc(mUnitKinds, mUnitCount * sizeof(KUInt8));
+	SUnitBlock* theBlock = &mBlocks[mBlockIndex];
+	theBlock->fUnits = mUnits;
+	theBlock->fUnitKinds = mUnitKinds;
+	theBlock->fUnitCount = mUnitCount;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SelectBlock( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::SelectBlock( KUInt32 inIndex )
+{
+	if (inIndex == mBlockCount) {
+		if (mBlockCount == mBlockCapacity) {
+			// Only the descriptions of the blocks move, not their units.
+			mBlockCapacity += kBlockIncrement;
+			mBlocks = (SUnitBlock*) ::realloc(
+				mBlocks, mBlockCapacity * sizeof(SUnitBlock));
+		}
+		SUnitBlock* theNewBlock = &mBlocks[mBlockCount++];
+		theNewBlock->fUnits =
+			(JITUnit*) ::malloc(sizeof(JITUnit) * kDefaultUnitCount);
+		theNewBlock->fUnitKinds =
+			(KUInt8*) ::malloc(sizeof(KUInt8) * kDefaultUnitCount);
+		theNewBlock->fUnitCount = kDefaultUnitCount;
+	}
+	SUnitBlock* theBlock = &mBlocks[inIndex];
+	mBlockIndex = inIndex;
+	mUnits = theBlock->fUnits;
+	mUnitKinds = theBlock->fUnitKinds;
+	mUnitCount = theBlock->fUnitCount;
+}
+
+// -------------------------------------------------------------------------- //
+//  * TranslateRun( KUInt32 )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::TranslateRun( KUInt32 inIndex )
+{
+	KUInt32* thePointer = GetPointer();
+	KUInt32 theVAddr = GetVAddr();
+
+	// Make sure the first instruction fits in the block.
+	KUInt16 unitCrsr = mUnitCrsr;
+	if (mUnitCount - unitCrsr < kMaxUnitsPerInstruction + kMaxRunEndUnits)
+	{
+		SelectBlock(mBlockIndex + 1);
+		unitCrsr = 0;
+	}
+	
+	KUInt32 indexInstr = inIndex;
+	JITUnit* theNextUnit = NULL;
+	do {
+		KUInt16 theInstructionCrsr = unitCrsr;
+		mInstructionUnits[indexInstr] = &mUnits[unitCrsr];
+		KUInt32 theInstruction = thePointer[indexInstr];
+		Translate(
+			mMemoryIntf,
+			&unitCrsr,
+			theInstruction,
+			theVAddr + (indexInstr * 4) );
+		if (mUnitOverflow || (mUnitCount - unitCrsr < kMaxRunEndUnits))
+		{
+			// Translate the instruction again at the beginning of the next
+			// block, which nothing runs yet, and jump there instead. The
+			// block grows to leave room for the end of the run.
+			KUInt32 theBlockIndex = mBlockIndex;
+			SelectBlock(theBlockIndex + 1);
+			unitCrsr = 0;
+			mUnitOverflow = false;
+			mUnitsMayMove = true;
+			Translate(
+				mMemoryIntf,
+				&unitCrsr,
+				theInstruction,
+				theVAddr + (indexInstr * 4) );
+			if (mUnitCount - unitCrsr < kMaxUnitsPerInstruction + kMaxRunEndUnits)
+			{
+				ResizeUnits(unitCrsr + kMaxUnitsPerInstruction + kMaxRunEndUnits);
+			}
+			mUnitsMayMove = false;
+			JITUnit* theUnits = mUnits;
+			SelectBlock(theBlockIndex);
+			PushUnit(&theInstructionCrsr, TJITGenericPage::JumpToUnit);
+			PushUnit(&theInstructionCrsr, (KUIntPtr) theUnits);
+			SelectBlock(theBlockIndex + 1);
+			mInstructionUnits[indexInstr] = theUnits;
+		}
+		indexInstr++;
+		
+		if (indexInstr == kInstructionCount)
+		{
+			theNextUnit = &mUnits[unitCrsr];
+			PushUnit(&unitCrsr, TJITGenericPage::EndOfPage);
+			PushUnit(&unitCrsr, theVAddr + kPageSize + 4);	// PC + 8
+			PushLink(&unitCrsr);
+		} else if (mInstructionUnits[indexInstr]) {
+			// Continue with the run that starts there.
+			theNextUnit = mInstructionUnits[indexInstr];
+			PushUnit(&unitCrsr, TJITGenericPage::JumpToUnit);
+			PushUnit(&unitCrsr, (KUIntPtr) mInstructionUnits[indexInstr]);
+			break;
+		} else if (EndsRun(theInstruction)
+			|| (mUnitCount - unitCrsr < kMaxUnitsPerInstruction + kMaxRunEndUnits))
+		{
+			// The next instruction is translated when it is reached, if ever.
+			theNextUnit = &mUnits[unitCrsr];
+			PushUnit(&unitCrsr, TJITGenericPage::TranslateStub);
+			PushUnit(&unitCrsr, (KUIntPtr) this, kUnitPage);
+			PushUnit(&unitCrsr, indexInstr);
+			break;
+		}
+	} while (indexInstr < kInstructionCount);
+	mUnitCrsr = unitCrsr;
+
+#if defined(JITTARGET_X86_64) && !defined(JIT_PERFORMANCE)
+	// Units of the run won't move anymore: compile what we can to native
+	// code.
+	mNativeCode.EmitRun(
+		&mInstructionUnits[inIndex], &thePointer[inIndex],
+		theVAddr + (inIndex * 4), indexInstr - inIndex, theNextUnit );
+#else
+	(void) theNextUnit;
+#endif
+
+	return mInstructionUnits[inIndex];
+}
+
+// -------------------------------------------------------------------------- //
+//  * EndsRun( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericPage::EndsRun( KUInt32 inInstruction )
+{
+	// Only unconditional instructions that always change the PC.
+	// This is a hint: the stub handles any other case.
+	if ((inInstruction >> 28) != kTestAL)
+	{
+		return false;
+	}
+	
+	// -Cond-- 1  0  1  0  ---------------------offset---------------------------- B
+	if ((inInstruction & 0x0F000000) == 0x0A000000)
+	{
+		return true;
+	}
+
+	// -Cond-- 1  0  0  P  U  S  W  1  --Rn--- 1 ---------Register List----------- LDM with PC
+	if ((inInstruction & 0x0E108000) == 0x08108000)
+	{
+		return true;
+	}
+	
+	// -Cond-- 0  1  I  P  U  B  W  1  --Rn--- 1  1  1  1  --------Offset--------- LDR PC
+	if ((inInstruction & 0x0C10F000) == 0x0410F000)
+	{
+		return true;
+	}
+	
+	// -Cond-- 0  0  I  --Opcode--- S  --Rn--- 1  1  1  1  -------Operand 2------- MOV PC...
+	// (but neither test instructions nor PSR transfers, multiplies and swaps)
+	if (((inInstruction & 0x0C00F000) == 0x0000F000)
+		&& ((inInstruction & 0x01800000) != 0x01000000)
+		&& ((inInstruction & 0x02000090) != 0x00000090))
+	{
+		return true;
+	}
+	
+	return false;
+}
+
 
 #ifdef JIT_PERFORMANCE
 JITInstructionProto(instrCount)
@@ -169,6 +446,53 @@ TJITGenericPage::Translate(
 											inVAddr);
 	}
 	
+	// Data processing instructions don't need to compute flags that the next
+	// instructions overwrite without reading them.
+	if (gEliminateDeadFlags
+		&& ((inInstruction & 0x0C100000) == 0x00100000)		// DP with S
+		&& ((inInstruction & 0x01800000) != 0x01000000)		// not a test
+		&& ((inInstruction & 0x0000F000) != 0x0000F000)		// not Rd = PC
+		&& ((inInstruction & 0x02000090) != 0x00000090))	// not a multiply
+	{
+		KUInt32 theRead;
+		KUInt32 theMayWrite;
+		KUInt32 theWritten;
+		GetFlagsUsage(
+			inInstruction, &theRead, &theMayWrite, &theWritten);
+		if (AreFlagsDead((inVAddr - GetVAddr()) / 4, theMayWrite))
+		{
+			inInstruction &= ~0x00100000;
+		}
+	}
+	
+	// A short backward branch that closes a loop polling memory tests its
+	// condition itself and waits for the next interrupt after a while.
+	if (gDetectIdleLoops
+		&& ((inInstruction & 0x0F800000) == 0x0A800000)	// B, backward
+		&& ((inInstruction >> 28) != kTestNV))
+	{
+		KUInt32 theOffset = ((inInstruction & 0x007FFFFF) << 2) | 0xFE000000;
+		KUInt32 theTarget = inVAddr + theOffset + 8;
+		KUInt32 theLength = ((inVAddr - theTarget) / 4) + 1;
+		KUInt32 theLoads[kMaxIdleLoopLoads];
+		if ((theTarget <= inVAddr)
+			&& (theTarget >= GetVAddr())
+			&& (theLength <= kMaxIdleLoopLength)
+			&& IsIdleLoop(
+					&GetPointer()[(theTarget - GetVAddr()) / 4],
+					theLength,
+					theLoads ))
+		{
+			Translate_IdleLoopBranch(
+				this,
+				ioUnitCrsr,
+				inInstruction,
+				inVAddr,
+				theLoads );
+			return;
+		}
+	}
+	
 	int theTestKind = inInstruction >> 28;
 	KUInt16 testUnitCrsr = *ioUnitCrsr;
 	if ((theTestKind != kTestAL) && (theTestKind != kTestNV))
@@ -214,14 +538,325 @@ TJITGenericPage::Translate(
 		} // switch 27 & 26
 	}
 	
-	// Finally put the test, based on the current unit crsr.
-	if ((theTestKind != kTestAL) && (theTestKind != kTestNV))
+	// Finally put the test, based on the current unit crsr (unless the
+	// instruction is translated again).
+	if ((theTestKind != kTestAL) && (theTestKind != kTestNV) && !mUnitOverflow)
 	{
 		KUInt16 nextInstrCrsr = *ioUnitCrsr;
 		PutTest(testUnitCrsr, nextInstrCrsr - testUnitCrsr, theTestKind);
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * SetEliminateDeadFlags( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::SetEliminateDeadFlags( Boolean inEliminateDeadFlags )
+{
+	gEliminateDeadFlags = inEliminateDeadFlags;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetDetectIdleLoops( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::SetDetectIdleLoops( Boolean inDetectIdleLoops )
+{
+	gDetectIdleLoops = inDetectIdleLoops;
+}
+
+// -------------------------------------------------------------------------- //
+//  * IsIdleLoop( const KUInt32*, KUInt32, KUInt32[] )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericPage::IsIdleLoop(
+				const KUInt32* inLoop,
+				KUInt32 inLength,
+				KUInt32 outLoads[kMaxIdleLoopLoads] )
+{
+	KUInt32 indexLoad;
+	for (indexLoad = 0; indexLoad < kMaxIdleLoopLoads; indexLoad++)
+	{
+		outLoads[indexLoad] = 0;
+	}
+	
+	// First pass: what the loop writes. The branch comes last.
+	KUInt32 theDestinations[kMaxIdleLoopLength];
+	KUInt32 theLoopRegisters = 0;
+	KUInt32 theLoopFlags = 0;
+	KUInt32 indexInstr;
+	for (indexInstr = 0; indexInstr + 1 < inLength; indexInstr++)
+	{
+		KUInt32 theInstruction = inLoop[indexInstr];
+		KUInt32 theDestination = 1 << ((theInstruction >> 12) & 0xF);
+		if ((theInstruction >> 28) != kTestAL)
+		{
+			// Conditional writes would make the analysis harder.
+			return false;
+		}
+		
+		if ((theInstruction & 0x0C000000) == 0x00000000)
+		{
+			// -Cond-- 0  0  I  --Opcode--- S  --Rn--- --Rd--- -------Operand 2------- Data Processing
+			if (((theInstruction & 0x02000090) == 0x00000090)
+				|| ((theInstruction & 0x0000F000) == 0x0000F000)
+				|| ((theInstruction & 0x01900000) == 0x01000000))
+			{
+				// Multiplies, swaps, halfwords, PC and PSR transfers.
+				return false;
+			}
+			if ((theInstruction & 0x01800000) == 0x01000000)
+			{
+				// Tests only write the flags.
+				theDestination = 0;
+			}
+		} else if ((theInstruction & 0x0E100000) == 0x04100000) {
+			// -Cond-- 0  1  0  P  U  B  W  1  --Rn--- --Rd--- --------Offset--------- LDR, immediate
+			if (((theInstruction & 0x01200000) != 0x01000000)
+				|| ((theInstruction & 0x0000F000) == 0x0000F000))
+			{
+				// Post-indexed or write-back loads, loads to PC.
+				return false;
+			}
+		} else {
+			// Stores, branches, coprocessors and SWIs.
+			return false;
+		}
+		theDestinations[indexInstr] = theDestination;
+		theLoopRegisters |= theDestination;
+		
+		KUInt32 theRead;
+		KUInt32 theMayWrite;
+		KUInt32 theWritten;
+		GetFlagsUsage( theInstruction, &theRead, &theMayWrite, &theWritten );
+		theLoopFlags |= theMayWrite;
+	}
+	
+	// Second pass: every iteration computes the same values from memory.
+	// What the loop writes can only be read after it is written in the same
+	// iteration.
+	KUInt32 theWrittenRegisters = 0;
+	KUInt32 theWrittenFlags = 0;
+	KUInt32 theLoadCount = 0;
+	for (indexInstr = 0; indexInstr + 1 < inLength; indexInstr++)
+	{
+		KUInt32 theInstruction = inLoop[indexInstr];
+		KUInt32 theReadRegisters = 1 << ((theInstruction >> 16) & 0xF);
+		if ((theInstruction & 0x0C000000) == 0x00000000)
+		{
+			KUInt32 theOpcode = (theInstruction >> 21) & 0xF;
+			if ((theOpcode == 0xD) || (theOpcode == 0xF))
+			{
+				// MOV and MVN have no Rn.
+				theReadRegisters = 0;
+			}
+			if (!(theInstruction & 0x02000000))
+			{
+				theReadRegisters |= 1 << (theInstruction & 0xF);
+				if (theInstruction & 0x00000010)
+				{
+					theReadRegisters |= 1 << ((theInstruction >> 8) & 0xF);
+				}
+			}
+		} else if (((theInstruction >> 16) & 0xF) != 15) {
+			// Not a literal: the address is checked before waiting, with the
+			// base register as it is at the branch.
+			if (theLoadCount == kMaxIdleLoopLoads)
+			{
+				return false;
+			}
+			KUInt32 indexNext;
+			for (indexNext = indexInstr; indexNext + 1 < inLength; indexNext++)
+			{
+				if (theDestinations[indexNext] & theReadRegisters)
+				{
+					return false;
+				}
+			}
+			outLoads[theLoadCount++] = theInstruction;
+		}
+		
+		if (theReadRegisters & theLoopRegisters & ~theWrittenRegisters)
+		{
+			// Carried from the previous iteration.
+			return false;
+		}
+		
+		KUInt32 theRead;
+		KUInt32 theMayWrite;
+		KUInt32 theWritten;
+		GetFlagsUsage( theInstruction, &theRead, &theMayWrite, &theWritten );
+		if (theRead & theLoopFlags & ~theWrittenFlags)
+		{
+			return false;
+		}
+		theWrittenRegisters |= theDestinations[indexInstr];
+		theWrittenFlags |= theWritten;
+	}
+	
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetFlagsUsage( KUInt32, KUInt32*, KUInt32*, KUInt32* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::GetFlagsUsage(
+				KUInt32 inInstruction,
+				KUInt32* outRead,
+				KUInt32* outMayWrite,
+				KUInt32* outMustWrite )
+{
+	KUInt32 theCondition = inInstruction >> 28;
+	KUInt32 theRead = kConditionFlags[theCondition];
+	KUInt32 theWritten = 0;
+	KUInt32 theMayWrite = 0;
+	Boolean isBarrier = false;
+	
+	switch ((inInstruction >> 25) & 0x7)				// 27 - 25
+	{
+		case 0x0:	// 000
+		case 0x1:	// 001
+			if ((inInstruction & 0x0E000090) == 0x00000090)
+			{
+				// -Cond-- 0  0  0  0  0  0  A  S  --Rd--- --Rn--- --Rs--- 1  0  0  1  --Rm--- Multiply
+				if (((inInstruction & 0x0FC000F0) == 0x00000090)
+					&& ((inInstruction & 0x000F0000) != 0x000F0000))
+				{
+					if (inInstruction & 0x00100000)
+					{
+						theWritten = kFlagN | kFlagZ;
+						theMayWrite = theWritten;
+					}
+				} else {
+					// Swaps and halfwords.
+					isBarrier = true;
+				}
+			} else {
+				// -Cond-- 0  0  I  --Opcode--- S  --Rn--- --Rd--- -------Operand 2------- Data Processing
+				KUInt32 theOpcode = (inInstruction >> 21) & 0xF;
+				Boolean theFlagS = (inInstruction & 0x00100000) != 0;
+				Boolean isShifted =
+					!(inInstruction & 0x02000000) && (inInstruction & 0x00000FF0);
+				if (((inInstruction & 0x0000F000) == 0x0000F000)
+					|| (!theFlagS && ((theOpcode & 0xC) == 0x8)))
+				{
+					// PC or PSR transfers.
+					isBarrier = true;
+				} else {
+					if (isShifted || (theOpcode >= 0x5 && theOpcode <= 0x7))
+					{
+						// RRX, ADC, SBC, RSC.
+						theRead |= kFlagC;
+					}
+					if (theFlagS)
+					{
+						if (((theOpcode >= 0x2) && (theOpcode <= 0x7))
+							|| (theOpcode == 0xA) || (theOpcode == 0xB))
+						{
+							theWritten = kAllFlags;
+							theMayWrite = kAllFlags;
+						} else {
+							theWritten = kFlagN | kFlagZ;
+							theMayWrite = theWritten;
+							// The shifter carry, unless the immediate isn't
+							// rotated. A shift amount in a register only
+							// changes it if the amount isn't 0.
+							if ((inInstruction & 0x02000000)
+								? (inInstruction & 0x00000F00)
+								: isShifted)
+							{
+								theMayWrite |= kFlagC;
+								if ((inInstruction & 0x02000010) != 0x00000010)
+								{
+									theWritten |= kFlagC;
+								}
+							}
+						}
+					}
+				}
+			}
+			break;
+			
+		case 0x2:	// 010
+		case 0x3:	// 011
+			// -Cond-- 0  1  I  P  U  B  W  L  --Rn--- --Rd--- --------Offset--------- Single Data Transfer
+			if (((inInstruction & 0x02000010) == 0x02000010)
+				|| ((inInstruction & 0x0010F000) == 0x0010F000))
+			{
+				// Undefined or load into PC.
+				isBarrier = true;
+			}
+			break;
+			
+		case 0x4:	// 100
+			// -Cond-- 1  0  0  P  U  S  W  L  --Rn--- -------Register List------- Block Data Transfer
+			if ((inInstruction & 0x00400000)
+				|| ((inInstruction & 0x00108000) == 0x00108000))
+			{
+				// User bank, CPSR restore or load into PC.
+				isBarrier = true;
+			}
+			break;
+			
+		default:
+			// Branches, coprocessors and SWIs.
+			isBarrier = true;
+			break;
+	}
+	
+	if (isBarrier)
+	{
+		theRead = kAllFlags;
+		theWritten = 0;
+		theMayWrite = kAllFlags;
+	} else if (theCondition == kTestNV) {
+		theRead = 0;
+		theWritten = 0;
+		theMayWrite = 0;
+	} else if (theCondition != kTestAL) {
+		// The instruction may not be executed.
+		theWritten = 0;
+	}
+	
+	*outRead = theRead;
+	*outMayWrite = theMayWrite;
+	*outMustWrite = theWritten;
+}
+
+// -------------------------------------------------------------------------- //
+//  * AreFlagsDead( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericPage::AreFlagsDead( KUInt32 inIndex, KUInt32 inFlags )
+{
+	KUInt32* thePointer = GetPointer();
+	KUInt32 thePendingFlags = inFlags;
+	KUInt32 indexInstr = inIndex + 1;
+	KUInt32 theLastIndex = inIndex + kMaxLivenessScan;
+	if (theLastIndex >= kInstructionCount)
+	{
+		// Flags are live at the end of the page.
+		theLastIndex = kInstructionCount - 1;
+	}
+	while ((thePendingFlags != 0) && (indexInstr <= theLastIndex))
+	{
+		KUInt32 theRead;
+		KUInt32 theMayWrite;
+		KUInt32 theWritten;
+		GetFlagsUsage(
+			thePointer[indexInstr], &theRead, &theMayWrite, &theWritten);
+		if (theRead & thePendingFlags)
+		{
+			return false;
+		}
+		thePendingFlags &= ~theWritten;
+		indexInstr++;
+	}
+	
+	return (thePendingFlags == 0);
+}
+
 // -------------------------------------------------------------------------- //
 //  * PutTest( KUInt16*, KUInt32 )
 // -------------------------------------------------------------------------- //
@@ -229,9 +864,11 @@ TJITGenericPage::Translate(
 #define __PutTest_line(func, delta)										\
 		case (delta):													\
 			mUnits[inUnitCrsr].fFuncPtr = _template1(func, delta);		\
+			mUnitKinds[inUnitCrsr] = kUnitFunction;						\
 			break
 
-// NOTICE: maximum number of units for an instruction is set to 6.....
+// NOTICE: maximum number of units for an instruction is set to 8
+// (a conditional mov pc, rm or ldm {..., pc} with its branch cache record).
 
 #define __PutTest_packet(func)							\
 		switch(inDelta) {								\
@@ -241,6 +878,8 @@ TJITGenericPage::Translate(
 			__PutTest_line(func, 5);					\
 			__PutTest_line(func, 6);					\
 			__PutTest_line(func, 7);					\
+			__PutTest_line(func, 8);					\
+			__PutTest_line(func, 9);					\
 			default:									\
 				fprintf(stderr, "Test overflow!\n");	\
 				abort();								\
@@ -462,7 +1101,37 @@ TJITGenericPage::EndOfPage(
 	POPPC();
 
 	// Don't execute next function.
-	MMUCALLNEXT(GETPC());
+	LINKEDCALLNEXT(GETPC());
+}
+
+// -------------------------------------------------------------------------- //
+//  * TranslateStub( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::TranslateStub(
+				JITUnit* ioUnit,
+				TARMProcessor* ioCPU )
+{
+	TJITGenericPage* thePage = (TJITGenericPage*) ioUnit[1].fPtr;
+	JITUnit* theUnit = thePage->GetJITUnitForOffset(ioUnit[2].fValue);
+
+	// Next time, go there directly.
+	ioUnit[1].fPtr = (KUIntPtr) theUnit;
+	ioUnit[0].fFuncPtr = JumpToUnit;
+	
+	return theUnit->fFuncPtr(theUnit, ioCPU);
+}
+
+// -------------------------------------------------------------------------- //
+//  * JumpToUnit( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::JumpToUnit(
+				JITUnit* ioUnit,
+				TARMProcessor* ioCPU )
+{
+	JITUnit* theUnit = (JITUnit*) ioUnit[1].fPtr;
+	return theUnit->fFuncPtr(theUnit, ioCPU);
 }
 
 // -------------------------------------------------------------------------- //
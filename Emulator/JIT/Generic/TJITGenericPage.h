@@ -31,6 +31,13 @@
 #include "TJITPerformance.h"
 #endif
 
+// Native code is opt-in: jittarget=X86_64 in the Jam build,
+// JITTARGET_DEFINES=JITTARGET_X86_64=1 in Xcode or -DJITTARGET_X86_64=ON
+// with cmake.
+#ifdef JITTARGET_X86_64
+#include "TJITX86_64Code.h"
+#endif
+
 class TARMProcessor;
 union JITUnit;
 class TJITGeneric;
@@ -62,6 +69,18 @@ public:
 	/// Access from TJITGeneric
 	///
 	friend class TJITGeneric;
+
+	///
+	/// Access from TJITGenericPageFile
+	///
+	friend class TJITGenericPageFile;
+
+	/// Kinds of units, used to relocate them in the page file.
+	enum EUnitKind {
+		kUnitValue = 0,		///< Any value.
+		kUnitFunction = 1,	///< Pointer to a JIT function.
+		kUnitPage = 2,		///< Pointer to this page.
+	};
 	
 	///
 	/// Default constructor.
@@ -85,19 +104,72 @@ public:
 	/// Push a unit in the table, resizing the table if required.
 	///
 	void PushUnit(KUInt16* ioUnitCrsr, JITFuncPtr inUnit) {
-		PushUnit(ioUnitCrsr, (KUIntPtr) inUnit);
+		PushUnit(ioUnitCrsr, (KUIntPtr) inUnit, kUnitFunction);
 	}
 
 	///
 	/// Push a unit in the table, resizing the table if required.
 	///
-	void PushUnit(KUInt16* ioUnitCrsr, KUIntPtr inUnit);
+	void PushUnit(
+				KUInt16* ioUnitCrsr,
+				KUIntPtr inUnit,
+				KUInt8 inKind = kUnitValue);
 	
 	///
-	/// Get the unit for a given (instruction) offset.
+	/// Push a link record to another page, unresolved for now.
+	/// A link record is five units: this page, the target page, the
+	/// generation of the target page, the generation of its binding and the
+	/// target unit.
+	///
+	void PushLink(KUInt16* ioUnitCrsr) {
+		PushUnit(ioUnitCrsr, (KUIntPtr) this, kUnitPage);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+	}
+
+	///
+	/// Push a branch cache record for an instruction that writes PC with a
+	/// value only known at run time (mov pc, lr, ldmfd sp!, {..., pc}).
+	/// The record is six units: this page, the last target PC, the target
+	/// page, the generation of the target page, the generation of its
+	/// binding and the target unit.
+	///
+	void PushBranchCache(KUInt16* ioUnitCrsr) {
+		PushUnit(ioUnitCrsr, (KUIntPtr) this, kUnitPage);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+		PushUnit(ioUnitCrsr, (KUIntPtr) 0);
+	}
+
+	///
+	/// Accessor on the generation of the page, used to validate links.
+	///
+	inline KUInt32 GetLinkGeneration( void ) const {
+		return mLinkGeneration;
+	}
+
+	///
+	/// Tear down all links to this page.
+	/// Called when the page is retranslated or loses its virtual binding.
+	///
+	inline void InvalidateLinks( void ) {
+		mLinkGeneration++;
+	}
+
+	///
+	/// Get the unit for a given (instruction) offset, translating a run of
+	/// instructions from there if it wasn't translated yet.
 	///
 	inline JITUnit* GetJITUnitForOffset(KUInt32 inOffset) {
-		return &mUnits[mUnitsTable[inOffset]];
+		JITUnit* theUnit = mInstructionUnits[inOffset];
+		if (theUnit == NULL) {
+			theUnit = TranslateRun(inOffset);
+		}
+		return theUnit;
 	}
 
 	///
@@ -112,6 +184,50 @@ public:
 				   KUInt16* ioUnitCrsr,
 				   KUInt32 inInstruction,
 				   KUInt32 inVAddr );
+
+	///
+	/// Enable or disable the elimination of dead flags (for comparisons).
+	/// Pages that are already translated are not affected.
+	///
+	/// \param inEliminateDeadFlags	whether flags that are overwritten
+	///								before being read are computed.
+	///
+	static void SetEliminateDeadFlags( Boolean inEliminateDeadFlags );
+
+	/// Idle loops.
+	enum {
+		kMaxIdleLoopLength = 8,	///< Instructions, including the branch.
+		kMaxIdleLoopLoads = 3,	///< Loads whose address is checked.
+		kIdleLoopSpins = 512,	///< Iterations before waiting.
+	};
+
+	///
+	/// Enable or disable the detection of idle loops.
+	/// Pages that are already translated are not affected.
+	///
+	/// \param inDetectIdleLoops	whether short loops that poll memory wait
+	///								for the next interrupt.
+	///
+	static void SetDetectIdleLoops( Boolean inDetectIdleLoops );
+
+	///
+	/// Determine if a backward branch closes a loop that only polls memory.
+	/// Every iteration of such a loop reads the same words and computes the
+	/// same values from them, so only an interrupt handler or a device can
+	/// end it. The loop may only load with an immediate offset, compute and
+	/// compare, and registers it writes may not carry from an iteration to
+	/// the next one.
+	///
+	/// \param inLoop		instructions of the loop, the branch last.
+	/// \param inLength		number of instructions.
+	/// \param outLoads		loads from a register, whose address is checked
+	///						before waiting (unused entries are 0).
+	/// \return true if the loop is idle.
+	///
+	static Boolean IsIdleLoop(
+				const KUInt32* inLoop,
+				KUInt32 inLength,
+				KUInt32 outLoads[kMaxIdleLoopLoads] );
 	
 protected:
 	/// Test bits.
@@ -152,6 +268,46 @@ protected:
 					JITUnit* ioUnit,
 					TARMProcessor* ioObject );
 
+	///
+	/// Translate the run that starts at a given instruction the first time
+	/// it is reached, then jump directly to it.
+	///
+	static JITUnit* TranslateStub(
+					JITUnit* ioUnit,
+					TARMProcessor* ioObject );
+
+	///
+	/// Continue with a unit translated in another run.
+	///
+	static JITUnit* JumpToUnit(
+					JITUnit* ioUnit,
+					TARMProcessor* ioObject );
+
+	///
+	/// Translate instructions from a given one, until the end of the page,
+	/// an instruction that was already translated or an instruction that
+	/// doesn't fall through (the rest is translated when it is reached).
+	///
+	/// \param inIndex		index of the first instruction.
+	/// \return the first unit of the instruction.
+	///
+	JITUnit* TranslateRun( KUInt32 inIndex );
+
+	///
+	/// Determine if a run ends after an instruction.
+	///
+	/// \param inInstruction	instruction that was translated.
+	/// \return true if the instruction never falls through.
+	///
+	static Boolean EndsRun( KUInt32 inInstruction );
+
+	///
+	/// Select the block runs are translated into, allocating it if required.
+	///
+	/// \param inIndex		index of the block.
+	///
+	void SelectBlock( KUInt32 inIndex );
+
 	///
 	/// Subroutine to put the test in the units table.
 	///
@@ -217,22 +373,98 @@ protected:
 					KUInt32 inInstruction,
 					KUInt32 inVAddr );
 
+	///
+	/// Grow the units (and their kinds) to the given count.
+	///
+	/// \param inUnitCount	new number of units.
+	///
+	void ResizeUnits( KUInt32 inUnitCount );
+
+	///
+	/// Determine the flags an instruction reads, the flags it may write and
+	/// the flags it always writes. Instructions that may change the PC read
+	/// all flags.
+	///
+	/// \param inInstruction	instruction to examine.
+	/// \param outRead			flags the instruction reads.
+	/// \param outMayWrite		flags the instruction may write.
+	/// \param outMustWrite		flags the instruction always writes.
+	///
+	static void GetFlagsUsage(
+				KUInt32 inInstruction,
+				KUInt32* outRead,
+				KUInt32* outMayWrite,
+				KUInt32* outMustWrite );
+
+	///
+	/// Determine if the flags written by an instruction are overwritten by
+	/// the next instructions of the page before they are read.
+	///
+	/// \param inIndex		index of the instruction in the page.
+	/// \param inFlags		flags written by the instruction.
+	/// \return true if the instruction doesn't need to compute the flags.
+	///
+	Boolean AreFlagsDead( KUInt32 inIndex, KUInt32 inFlags );
+
+	/// Flags, for liveness.
+	enum {
+		kFlagN = 0x8,
+		kFlagZ = 0x4,
+		kFlagC = 0x2,
+		kFlagV = 0x1,
+		kAllFlags = 0xF,
+		kMaxLivenessScan = 8,	///< Flags are live after that many instructions.
+	};
+
 	/// \name Constants
 	enum {
 		kInstructionCount = (TJITPage< TJITGeneric, TJITGenericPage >::kPageSize / 4),
 		kDefaultUnitCount = 3 * kInstructionCount,
 		kUnitIncrement = 32,
+		kMaxUnitsPerInstruction = 16,	///< Including a link record and a test.
+		kMaxRunEndUnits = 6,	///< End of page and its link record.
+		kBlockIncrement = 8,	///< Blocks the array grows by.
+	};
+
+	///
+	/// Block of units. A page translated at once only uses the first one,
+	/// which grows as required. Lazily translated runs use the next ones
+	/// when the current one is full, as units may not move anymore. An
+	/// instruction that doesn't fit in the rest of a block is translated
+	/// again in the next one, which may grow until the instruction is done.
+	///
+	struct SUnitBlock {
+		JITUnit*	fUnits;
+		KUInt8*		fUnitKinds;
+		KUInt32		fUnitCount;
 	};
 	
 	/// \name Variables
-	KUInt32			mUnitCount;	///< Total number of units in this page.
+	KUInt32			mLinkGeneration;	///< Incremented to tear down links.
+	KUInt32			mUnitCount;	///< Total number of units in the block.
 								///< This is initialized with a reasonable
 								///< default and increased as required.
 	KUInt16			mUnitsTable[kInstructionCount];
 								///< Array with the index of a unit for a given
-								///< address. This is used to find out the
-								///< proper unit when jumping...
-	JITUnit*		mUnits;		///< Array with all the units.
+								///< address, when the page is translated at
+								///< once (to store it or compile it).
+	JITUnit*		mUnits;		///< Array with the units of the current block.
+	KUInt8*			mUnitKinds;	///< Kind of every unit (EUnitKind).
+	JITUnit*		mInstructionUnits[kInstructionCount];
+								///< First unit of every instruction, NULL
+								///< if it wasn't translated yet.
+	SUnitBlock*		mBlocks;		///< Blocks of units.
+	KUInt32			mBlockCapacity;	///< Number of blocks in mBlocks.
+	KUInt32			mBlockCount;	///< Number of allocated blocks.
+	KUInt32			mBlockIndex;	///< Block runs are translated into.
+	KUInt16			mUnitCrsr;		///< Next unit in this block.
+	Boolean			mUnitsMayMove;	///< Whether the block may grow.
+	Boolean			mUnitOverflow;	///< Whether the current instruction
+									///< didn't fit in the block.
+	TMemory*		mMemoryIntf;	///< Interface to memory, for runs.
+#ifdef JITTARGET_X86_64
+	TJITX86_64Code	mNativeCode;	///< Native code for this page.
+#endif
 };
 
 #endif
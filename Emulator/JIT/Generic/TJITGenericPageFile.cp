@@ -0,0 +1,378 @@
+// ==============================
+// File:			TJITGenericPageFile.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#ifdef JITTARGET_GENERIC
+
+#include "TJITGenericPageFile.h"
+
+// ANSI & POSIX
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#if TARGET_OS_WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+	#include <sys/file.h>
+#endif
+
+// Einstein
+#include "TJITGenericPage.h"
+#include "TJITGeneric_Other.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+#if TARGET_OS_WIN32
+	#define kPageFileOpenFlags	(O_RDWR | O_CREAT | O_BINARY)
+#else
+	#define kPageFileOpenFlags	(O_RDWR | O_CREAT)
+#endif
+
+/// Function pointers are stored relative to this one.
+#define kPageFileBase		((KUIntPtr) TJITGenericPage::EndOfPage)
+
+/// Number of values read at once when loading a page.
+#define kPageFileChunk		64
+
+// -------------------------------------------------------------------------- //
+//  * TJITGenericPageFile( const char*, const KUInt32[10] )
+// -------------------------------------------------------------------------- //
+TJITGenericPageFile::TJITGenericPageFile(
+				const char* inPath,
+				const KUInt32 inChecksums[10] )
+	:
+		mFile( -1 ),
+		mIndex( NULL )
+{
+	SHeader theHeader;
+	FillHeader( &theHeader, inChecksums );
+	mIndex = (KUInt32*) ::calloc( kIndexSize, sizeof(KUInt32) );
+
+	mFile = ::open( inPath, kPageFileOpenFlags, 0644 );
+	if (mFile < 0)
+	{
+		// Probably a read-only directory: pages will be translated.
+		return;
+	}
+	
+	Lock( true );
+	SHeader theFileHeader;
+	const int theIndexSize = kIndexSize * sizeof(KUInt32);
+	if ((::read( mFile, &theFileHeader, sizeof(SHeader) ) != (int) sizeof(SHeader))
+		|| ::memcmp( &theFileHeader, &theHeader, sizeof(SHeader) )
+		|| (::read( mFile, mIndex, theIndexSize ) != theIndexSize))
+	{
+		// New or outdated file: start from scratch.
+		(void) ::memset( mIndex, 0, theIndexSize );
+		Lock( false );
+		(void) ::close( mFile );
+		mFile = ::open( inPath, kPageFileOpenFlags | O_TRUNC, 0644 );
+		if (mFile < 0)
+		{
+			return;
+		}
+		Lock( true );
+		if ((::write( mFile, &theHeader, sizeof(SHeader) ) != (int) sizeof(SHeader))
+			|| (::write( mFile, mIndex, theIndexSize ) != theIndexSize))
+		{
+			Lock( false );
+			(void) ::close( mFile );
+			mFile = -1;
+			return;
+		}
+	}
+	Lock( false );
+}
+
+// -------------------------------------------------------------------------- //
+//  * ~TJITGenericPageFile( void )
+// -------------------------------------------------------------------------- //
+TJITGenericPageFile::~TJITGenericPageFile( void )
+{
+	if (mFile >= 0)
+	{
+		(void) ::close( mFile );
+	}
+	::free( mIndex );
+}
+
+// -------------------------------------------------------------------------- //
+//  * FillHeader( SHeader*, const KUInt32[10] )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPageFile::FillHeader(
+				SHeader* outHeader,
+				const KUInt32 inChecksums[10] )
+{
+	(void) ::memset( outHeader, 0, sizeof(SHeader) );
+	outHeader->fMagic = kMagic;
+	outHeader->fVersion = kVersion;
+	outHeader->fJITID = JITClass::GetID();
+	outHeader->fJITVersion = JITClass::GetVersion();
+	outHeader->fTranslatorVersion = kTranslatorVersion;
+	outHeader->fPointerSize = sizeof(KUIntPtr);
+	(void) ::memcpy( outHeader->fChecksums, inChecksums, sizeof(outHeader->fChecksums) );
+	
+	// Layout of the binary: the offsets between functions of several
+	// translation units change with almost any rebuild.
+	KUIntPtr theBase = kPageFileBase;
+	outHeader->fFingerprint[0] = (KUInt32) ((KUIntPtr) TJITGenericPage::Halt - theBase);
+	outHeader->fFingerprint[1] = (KUInt32) ((KUIntPtr) UndefinedInstruction - theBase);
+	outHeader->fFingerprint[2] = (KUInt32) ((KUIntPtr) SoftwareBreakpoint - theBase);
+	outHeader->fFingerprint[3] = (KUInt32) ((KUIntPtr) SystemBootUND - theBase);
+	outHeader->fFingerprint[4] = (KUInt32) ((KUIntPtr) Translate_Branch - theBase);
+	outHeader->fFingerprint[5] = (KUInt32) ((KUIntPtr) Translate_SWIAndCoproc - theBase);
+}
+
+// -------------------------------------------------------------------------- //
+//  * Lock( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPageFile::Lock( Boolean inLock )
+{
+#if !TARGET_OS_WIN32
+	(void) ::flock( mFile, inLock ? LOCK_EX : LOCK_UN );
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+//  * LoadPage( TJITGenericPage*, KUInt32, const KUInt32*, KUInt16* )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericPageFile::LoadPage(
+				TJITGenericPage* ioPage,
+				KUInt32 inPAddr,
+				const KUInt32* inInstructions,
+				KUInt16* outEndOfPageUnit )
+{
+	KUInt32 theIndex = inPAddr / TMemoryConsts::kMMUSmallestPageSize;
+	if ((mFile < 0) || (theIndex >= kIndexSize) || (mIndex[theIndex] == 0))
+	{
+		return true;
+	}
+
+	// Records are never modified once written: no need to lock.
+	Boolean theResult = true;
+	do {
+		SRecord theRecord;
+		if ((::lseek( mFile, mIndex[theIndex], SEEK_SET ) < 0)
+			|| (::read( mFile, &theRecord, sizeof(SRecord) ) != (int) sizeof(SRecord)))
+		{
+			break;
+		}
+		KUInt32 theUnitCount = theRecord.fUnitCount;
+		if ((theRecord.fPAddr != inPAddr)
+			|| (theUnitCount == 0)
+			|| (theUnitCount > 0xFFFF)
+			|| (theRecord.fEndOfPageUnit >= theUnitCount)
+			|| ::memcmp(
+					theRecord.fInstructions,
+					inInstructions,
+					sizeof(theRecord.fInstructions) ))
+		{
+			break;
+		}
+		KUInt32 indexInstr;
+		for (indexInstr = 0; indexInstr < kInstructionCount; indexInstr++)
+		{
+			if (theRecord.fUnitsTable[indexInstr] >= theUnitCount)
+			{
+				break;
+			}
+		}
+		if (indexInstr < kInstructionCount)
+		{
+			break;
+		}
+		
+		// Kinds.
+		if (theUnitCount > ioPage->mUnitCount)
+		{
+			ioPage->ResizeUnits( theUnitCount );
+		}
+		KUInt32 thePadding = ((theUnitCount + 7) & ~7) - theUnitCount;
+		if ((::read( mFile, ioPage->mUnitKinds, theUnitCount ) != (int) theUnitCount)
+			|| (::lseek( mFile, thePadding, SEEK_CUR ) < 0))
+		{
+			break;
+		}
+		
+		// Values.
+		KUIntPtr theBase = kPageFileBase;
+		KUInt64 theValues[kPageFileChunk];
+		KUInt32 indexUnit = 0;
+		Boolean theRecordIsValid = true;
+		while (theRecordIsValid && (indexUnit < theUnitCount))
+		{
+			KUInt32 theChunk = theUnitCount - indexUnit;
+			if (theChunk > kPageFileChunk)
+			{
+				theChunk = kPageFileChunk;
+			}
+			int theChunkSize = theChunk * sizeof(KUInt64);
+			if (::read( mFile, theValues, theChunkSize ) != theChunkSize)
+			{
+				theRecordIsValid = false;
+				break;
+			}
+			KUInt32 indexValue;
+			for (indexValue = 0; indexValue < theChunk; indexValue++, indexUnit++)
+			{
+				JITUnit* theUnit = &ioPage->mUnits[indexUnit];
+				switch (ioPage->mUnitKinds[indexUnit])
+				{
+					case TJITGenericPage::kUnitValue:
+						theUnit->fPtr = (KUIntPtr) theValues[indexValue];
+						break;
+						
+					case TJITGenericPage::kUnitFunction:
+						theUnit->fPtr = theBase + (KUIntPtr) theValues[indexValue];
+						break;
+						
+					case TJITGenericPage::kUnitPage:
+						theUnit->fPtr = (KUIntPtr) ioPage;
+						break;
+						
+					default:
+						theRecordIsValid = false;
+						break;
+				}
+			}
+		}
+		if (!theRecordIsValid)
+		{
+			break;
+		}
+
+		(void) ::memcpy(
+					ioPage->mUnitsTable,
+					theRecord.fUnitsTable,
+					sizeof(theRecord.fUnitsTable) );
+		*outEndOfPageUnit = (KUInt16) theRecord.fEndOfPageUnit;
+		theResult = false;
+	} while (false);
+	
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * StorePage( const TJITGenericPage*, KUInt32, const KUInt32*, ... )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPageFile::StorePage(
+				const TJITGenericPage* inPage,
+				KUInt32 inPAddr,
+				const KUInt32* inInstructions,
+				KUInt16 inUnitCount,
+				KUInt16 inEndOfPageUnit )
+{
+	KUInt32 theIndex = inPAddr / TMemoryConsts::kMMUSmallestPageSize;
+	if ((mFile < 0) || (theIndex >= kIndexSize) || (mIndex[theIndex] != 0))
+	{
+		return;
+	}
+
+	// Build the record.
+	KUInt32 theKindsSize = (inUnitCount + 7) & ~7;
+	KUInt32 theSize =
+		sizeof(SRecord) + theKindsSize + (inUnitCount * sizeof(KUInt64));
+	KUInt8* theBuffer = (KUInt8*) ::calloc( 1, theSize );
+	SRecord* theRecord = (SRecord*) theBuffer;
+	theRecord->fPAddr = inPAddr;
+	theRecord->fUnitCount = inUnitCount;
+	theRecord->fEndOfPageUnit = inEndOfPageUnit;
+	(void) ::memcpy(
+				theRecord->fInstructions,
+				inInstructions,
+				sizeof(theRecord->fInstructions) );
+	(void) ::memcpy(
+				theRecord->fUnitsTable,
+				inPage->mUnitsTable,
+				sizeof(theRecord->fUnitsTable) );
+	KUInt8* theKinds = theBuffer + sizeof(SRecord);
+	(void) ::memcpy( theKinds, inPage->mUnitKinds, inUnitCount );
+	KUInt8* theValues = theKinds + theKindsSize;
+	KUIntPtr theBase = kPageFileBase;
+	KUInt32 indexUnit;
+	for (indexUnit = 0; indexUnit < inUnitCount; indexUnit++)
+	{
+		KUInt64 theValue;
+		switch (theKinds[indexUnit])
+		{
+			case TJITGenericPage::kUnitFunction:
+				theValue = (KUInt64) (inPage->mUnits[indexUnit].fPtr - theBase);
+				break;
+				
+			case TJITGenericPage::kUnitPage:
+				theValue = 0;
+				break;
+				
+			default:
+				theValue = (KUInt64) inPage->mUnits[indexUnit].fPtr;
+				break;
+		}
+		(void) ::memcpy(
+					&theValues[indexUnit * sizeof(KUInt64)],
+					&theValue,
+					sizeof(KUInt64) );
+	}
+	
+	// Append it, unless another instance already did.
+	off_t theIndexPosition = sizeof(SHeader) + (theIndex * sizeof(KUInt32));
+	KUInt32 theOffset = 0;
+	Lock( true );
+	if ((::lseek( mFile, theIndexPosition, SEEK_SET ) == theIndexPosition)
+		&& (::read( mFile, &theOffset, sizeof(KUInt32) ) == (int) sizeof(KUInt32))
+		&& (theOffset == 0))
+	{
+		off_t theEnd = ::lseek( mFile, 0, SEEK_END );
+		if ((theEnd > 0)
+			&& (theEnd <= (off_t) 0xFFFFFFFF)
+			&& (::write( mFile, theBuffer, theSize ) == (int) theSize)
+			&& (::lseek( mFile, theIndexPosition, SEEK_SET ) == theIndexPosition))
+		{
+			theOffset = (KUInt32) theEnd;
+			if (::write( mFile, &theOffset, sizeof(KUInt32) ) != (int) sizeof(KUInt32))
+			{
+				theOffset = 0;
+			}
+		}
+	}
+	Lock( false );
+	mIndex[theIndex] = theOffset;
+
+	::free( theBuffer );
+}
+
+#endif
+
+// =============================================================== //
+// The first rule of intelligent tinkering is to save all the      //
+// parts.                                                          //
+//                 -- Paul Erlich                                  //
+// =============================================================== //
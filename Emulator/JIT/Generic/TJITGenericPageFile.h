@@ -0,0 +1,182 @@
+// ==============================
+// File:			TJITGenericPageFile.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TJITGENERICPAGEFILE_H
+#define _TJITGENERICPAGEFILE_H
+
+#include <K/Defines/KDefinitions.h>
+
+// Einstein
+#include "TMemoryConsts.h"
+
+class TJITGenericPage;
+
+///
+/// Sidecar file with the translated ROM pages, next to the ROM image.
+///
+/// A ROM page is translated the same way from one launch to the next. So
+/// pages are stored the first time they are translated, and loaded instead
+/// of being translated the next time they are needed. Function pointers are
+/// stored relative to TJITGenericPage::EndOfPage, and the file is keyed by
+/// the ROM checksums, the JIT ID and version, the translator version and a
+/// fingerprint of the binary. A record is only used if the instructions of the page did not
+/// change since it was stored (e.g. with a breakpoint).
+///
+class TJITGenericPageFile
+{
+public:
+	///
+	/// Constructor from the path of the file and the ROM checksums.
+	/// The file is created (or reset) if it doesn't match.
+	///
+	/// \param inPath		path to the sidecar file.
+	/// \param inChecksums	checksums of the ROM image.
+	///
+	TJITGenericPageFile(
+				const char* inPath,
+				const KUInt32 inChecksums[10] );
+
+	///
+	/// Destructor.
+	///
+	~TJITGenericPageFile( void );
+
+	///
+	/// Determine if the file could be opened.
+	///
+	Boolean		IsOpen( void ) const
+		{
+			return (mFile >= 0);
+		}
+
+	///
+	/// Load the units of a page from the file.
+	///
+	/// \param ioPage			page to fill.
+	/// \param inPAddr			physical address of the page.
+	/// \param inInstructions	current instructions of the page.
+	/// \param outEndOfPageUnit	index of the end of page unit.
+	/// \return true if the page wasn't found (it should be translated).
+	///
+	Boolean		LoadPage(
+					TJITGenericPage* ioPage,
+					KUInt32 inPAddr,
+					const KUInt32* inInstructions,
+					KUInt16* outEndOfPageUnit );
+
+	///
+	/// Store the units of a freshly translated page.
+	///
+	/// \param inPage			page to store.
+	/// \param inPAddr			physical address of the page.
+	/// \param inInstructions	instructions of the page.
+	/// \param inUnitCount		number of units used by the page.
+	/// \param inEndOfPageUnit	index of the end of page unit.
+	///
+	void		StorePage(
+					const TJITGenericPage* inPage,
+					KUInt32 inPAddr,
+					const KUInt32* inInstructions,
+					KUInt16 inUnitCount,
+					KUInt16 inEndOfPageUnit );
+
+private:
+	///
+	/// Copy constructor, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TJITGenericPageFile( const TJITGenericPageFile& inCopy );
+
+	///
+	/// Assignment operator, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TJITGenericPageFile& operator = ( const TJITGenericPageFile& inCopy );
+
+	/// \name Constants
+	enum {
+		kMagic				= 0x454A5046,	///< 'EJPF'
+		kVersion			= 3,
+		kTranslatorVersion	= 3,	///< Bump when the units of an instruction change.
+		kInstructionCount	= TMemoryConsts::kMMUSmallestPageSize / 4,
+		kIndexSize			= TMemoryConsts::kROMEnd / TMemoryConsts::kMMUSmallestPageSize,
+		kFingerprintSize	= 6,
+	};
+
+	///
+	/// Header of the file, followed by the index (offset of the record of
+	/// every ROM page, 0 if it wasn't stored).
+	///
+	struct SHeader {
+		KUInt32		fMagic;
+		KUInt32		fVersion;
+		KUInt32		fJITID;
+		KUInt32		fJITVersion;
+		KUInt32		fPointerSize;
+		KUInt32		fChecksums[10];
+		KUInt32		fTranslatorVersion;
+		KUInt32		fFingerprint[kFingerprintSize];
+	};
+
+	///
+	/// Header of a page record, followed by one kind byte per unit (padded
+	/// to 8 bytes) and one 64 bits value per unit.
+	///
+	struct SRecord {
+		KUInt32		fPAddr;
+		KUInt32		fUnitCount;
+		KUInt32		fEndOfPageUnit;
+		KUInt32		fInstructions[kInstructionCount];
+		KUInt16		fUnitsTable[kInstructionCount];
+	};
+
+	///
+	/// Fill a header for this ROM and this binary.
+	///
+	/// \param outHeader	header to fill.
+	/// \param inChecksums	checksums of the ROM image.
+	///
+	static void	FillHeader(
+					SHeader* outHeader,
+					const KUInt32 inChecksums[10] );
+
+	///
+	/// Lock or unlock the file (other instances may share it).
+	///
+	void		Lock( Boolean inLock );
+
+	/// \name Variables
+	int			mFile;			///< File descriptor (or -1).
+	KUInt32*	mIndex;			///< Offsets of the records.
+};
+
+#endif
+		// _TJITGENERICPAGEFILE_H
+
+// =============================================================== //
+// The first rule of intelligent tinkering is to save all the      //
+// parts.                                                          //
+//                 -- Paul Erlich                                  //
+// =============================================================== //
@@ -164,10 +164,12 @@ KUInt32     TJITGenericROMPatch::NPatch = 0;
 TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, KUInt32 val)
 :	next_(first_),
 	address_(addr>>2),
+	appliedAddress_(addr>>2),
 	value_(val),
 	stub_(0L),
 	function_(0L),
-	method_(0L)
+	method_(0L),
+	name_(0L)
 {
     first_ = this;
 }
@@ -179,6 +181,7 @@ TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, KUInt32 val)
 TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, KUInt32 val, const char *name)
 :   next_(first_),
     address_(addr>>2),
+    appliedAddress_(addr>>2),
     value_(val),
     stub_(0L),
     function_(0L),
@@ -196,6 +199,7 @@ TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, KUInt32 val, const char *
 TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, JITFuncPtr stub, const char *name, AnyFunctionPtr function)
 :   next_(first_),
     address_(addr>>2),
+    appliedAddress_(addr>>2),
     value_(0xef800000),
     stub_(stub),
     function_(function),
@@ -214,6 +218,7 @@ TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, JITFuncPtr stub, const ch
 TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, JITFuncPtr stub, const char *name)
 :   next_(first_),
     address_(addr>>2),
+    appliedAddress_(addr>>2),
     value_(0xef800000),
     stub_(stub),
     function_(0L),
@@ -232,6 +237,7 @@ TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, JITFuncPtr stub, const ch
 TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, JITFuncPtr stub, const char *name, AnyMethodPtr method)
 :   next_(first_),
 address_(addr>>2),
+appliedAddress_(addr>>2),
 value_(0xef800000),
 stub_(stub),
 function_(0L),
@@ -250,6 +256,7 @@ method_(method)
 TJITGenericROMPatch::TJITGenericROMPatch(KUInt32 addr, JITFuncPtr stub, const char *name, JITSimPtr function)
 :   next_(first_),
 	address_(addr>>2),
+	appliedAddress_(addr>>2),
 	value_(0xef800000),
 	stub_(stub),
 	function_((AnyFunctionPtr)function),
@@ -320,7 +327,7 @@ KUInt32 TJITGenericROMPatch::GetOriginalInstructionAt(KUInt32 command, KUInt32 a
 	
 	// if the address of the pacth is known, verify that we have the correct patch
 	if (address!=0xFFFFFFFF) {
-		if (patch_[index]->address_ != (address>>2))
+		if (patch_[index]->appliedAddress_ != (address>>2))
 			return command;
 	}
 	
@@ -365,18 +372,53 @@ KUInt32 TJITGenericROMPatch::addPatch(TJITGenericROMPatch *p)
 // -------------------------------------------------------------------------- //
 //  * Apply the patch to the ROM words
 // -------------------------------------------------------------------------- //
-void TJITGenericROMPatch::apply(KUInt32 *ROM)
+void TJITGenericROMPatch::applyAt(KUInt32 *ROM, KUInt32 address)
 {
-    ROM[address()] = value();
+    appliedAddress_ = address;
+    ROM[address] = value();
 }
 
 
 // -------------------------------------------------------------------------- //
-//  * DoPatchROM(KUInt32*, const std::string&)
+//  * FindByName(const char*)
+// -------------------------------------------------------------------------- //
+TJITGenericROMPatch *TJITGenericROMPatch::FindByName(const char *name)
+{
+	TJITGenericROMPatch *p;
+	for (p=first(); p; p=p->next())
+	{
+		if (p->name_ && strcmp(p->name_, name)==0)
+			break;
+	}
+	return p;
+}
+
+
+// -------------------------------------------------------------------------- //
+//  * DoPatchROM(KUInt32*, const std::string&, const STable*)
 // -------------------------------------------------------------------------- //
 void
-TJITGenericROMPatch::DoPatchROM(KUInt32* inROMPtr, const std::string& inMachineName) {
-	if (inMachineName == "717006") {
+TJITGenericROMPatch::DoPatchROM(
+					KUInt32* inROMPtr,
+					const std::string& inMachineName,
+					const TROMPatchDatabase::STable* inTable) {
+	if (inTable) {
+		// Only the patches of the table, at its addresses.
+		for (KUInt32 i=0; i<inTable->fEntryCount; i++)
+		{
+			const TROMPatchDatabase::SEntry *e = &inTable->fEntries[i];
+			if (e->fKind==TROMPatchDatabase::kWord) {
+				inROMPtr[e->fAddress>>2] = e->fValue;
+			} else if (e->fKind==TROMPatchDatabase::kCompiled) {
+				TJITGenericROMPatch *p = FindByName(e->fName);
+				if (p) {
+					p->applyAt(inROMPtr, e->fAddress>>2);
+				} else {
+					fprintf(stderr, "Unknown compiled patch: %s\n", e->fName);
+				}
+			}
+		}
+	} else if (inMachineName == "717006") {
 		// Iterate on patches.
 		TJITGenericROMPatch *p;
 		for (p=TJITGenericROMPatch::first(); p; p=p->next())
@@ -409,20 +451,22 @@ TJITGenericROMPatch::DoPatchROM(KUInt32* inROMPtr, const std::string& inMachineN
 // -------------------------------------------------------------------------- //
 //  * Apply the injection patch to the ROM words
 // -------------------------------------------------------------------------- //
-void TJITGenericROMInjection::apply(KUInt32 *ROM)
+void TJITGenericROMInjection::applyAt(KUInt32 *ROM, KUInt32 address)
 {
-    originalInstruction_ = ROM[address()];
-    ROM[address()] = value() | 0xefc00000;
+    appliedAddress_ = address;
+    originalInstruction_ = ROM[address];
+    ROM[address] = value() | 0xefc00000;
 }
 
 
 // -------------------------------------------------------------------------- //
 //  * Apply the simulator injection patch to the ROM words
 // -------------------------------------------------------------------------- //
-void TJITGenericROMSimulatorInjection::apply(KUInt32 *ROM)
+void TJITGenericROMSimulatorInjection::applyAt(KUInt32 *ROM, KUInt32 address)
 {
-    originalInstruction_ = ROM[address()];
-    ROM[address()] = value() | 0xefa00000;
+    appliedAddress_ = address;
+    originalInstruction_ = ROM[address];
+    ROM[address] = value() | 0xefa00000;
 }
 
 
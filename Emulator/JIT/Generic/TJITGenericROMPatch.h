@@ -22,6 +22,7 @@
 
 #include <K/Defines/KDefinitions.h>
 #include "JIT.h"
+#include "Emulator/ROM/TROMPatchDatabase.h"
 
 // The three lines below are tricking the compiler into letting
 // us handle a whole range of function calls. This may not work
@@ -35,7 +36,10 @@ typedef void (TAnyClass::*AnyMethodPtr)();
 /// Patches can be created in any module by static declaration of TJITGenericROMPatch's
 /// which will then be linked into the patch database and applied to a
 /// freshly loaded ROM.
-/// Usage is currently limited to ROM v717006
+/// The addresses are those of ROM v717006. For other ROMs, patches are applied
+/// by name at the addresses given by a table of the TROMPatchDatabase. The
+/// patches declared with T_ROM_TABLE_INJECTION have no address and are only
+/// applied by such tables.
 ///
 /// These ROM patches provide the original instruction and are used when
 /// translating code.
@@ -46,6 +50,7 @@ protected:
 	static TJITGenericROMPatch *first_;
 	TJITGenericROMPatch *next_;
 	KUInt32 address_;
+	KUInt32 appliedAddress_;
 	KUInt32 value_;
 	KUInt32 originalInstruction_;
 	JITFuncPtr stub_;
@@ -58,6 +63,10 @@ protected:
 	static KUInt32 addPatch(TJITGenericROMPatch *patch);
 	
 public:
+	/// Address of the patches that have no address in ROM v717006: only
+	/// the tables of the TROMPatchDatabase apply them
+	static const KUInt32 kNoAddress = 0xFFFFFFFF;
+	
 	/// Create and add a new patch
 	TJITGenericROMPatch(KUInt32 address, KUInt32 value);
 	
@@ -90,6 +99,9 @@ public:
 	/// Return the address of this patch (must be dividable by four)
 	KUInt32 address() { return address_; }
 	
+	/// Return true unless only the tables give the address of this patch
+	bool hasAddress() { return address_ != (kNoAddress>>2); }
+	
 	/// Return the 32-bit patch value for this address
 	KUInt32 value() { return value_; }
 	
@@ -111,16 +123,28 @@ public:
 	/// Return the name for this patch
 	static const char* GetNameAt(KUInt32 index);
 	
-	/// Patch the ROM word
-	virtual void apply(KUInt32 *ROM);
+	/// Patch the ROM word at the address of ROM v717006, if the patch has one
+	void apply(KUInt32 *ROM) { if (hasAddress()) applyAt(ROM, address_); }
+	
+	/// Patch the ROM word at another address (divided by four), as given by
+	/// a table of the patch database
+	virtual void applyAt(KUInt32 *ROM, KUInt32 address);
 	
 	// Get number of patches
 	static KUInt32 GetNumPatches() { return nPatch; }
 	
+	/// Find a patch by name.
+	/// @return NULL if there is no such patch
+	static TJITGenericROMPatch *FindByName(const char *name);
+	
 	///
-	/// Loop through all patched and actually apply them.
+	/// Loop through all patched and actually apply them, at the addresses
+	/// of a table of the patch database if there is one.
 	///
-	static void DoPatchROM(KUInt32* inROMPtr, const std::string& inMachineName);
+	static void DoPatchROM(
+					KUInt32* inROMPtr,
+					const std::string& inMachineName,
+					const TROMPatchDatabase::STable* inTable = NULL);
 };
 
 
@@ -152,7 +176,7 @@ public:
 	: TJITGenericROMPatch(address, stub, name, nativeStub) { }
 	
 	/// Patch the ROM word
-	virtual void apply(KUInt32 *ROM);
+	virtual void applyAt(KUInt32 *ROM, KUInt32 address);
 };
 
 
@@ -168,6 +192,18 @@ TJITGenericROMInjection i##addr(addr, p##addr, name); \
 JITInstructionProto(p##addr)
 
 
+/**
+ Like T_ROM_INJECTION, for code that depends on more than the address: the
+ injection has no address of its own and is only applied by the tables of
+ the TROMPatchDatabase, which give its address in the ROMs it was checked
+ against. The name of the injection is the identifier.
+ */
+#define T_ROM_TABLE_INJECTION(name) \
+extern JITInstructionProto(p##name); \
+TJITGenericROMInjection i##name(TJITGenericROMPatch::kNoAddress, p##name, #name); \
+JITInstructionProto(p##name)
+
+
 /**
  (Matt: not sure anymore)
  */
@@ -189,7 +225,7 @@ public:
 	: TJITGenericROMPatch(address, (JITFuncPtr)stub, name) { }
 	
 	/// Patch the ROM word
-	virtual void apply(KUInt32 *ROM);
+	virtual void applyAt(KUInt32 *ROM, KUInt32 address);
 };
 
 #endif
@@ -50,6 +50,10 @@
 
 #ifdef JITTARGET_GENERIC
 
+// ANSI C & POSIX
+#include <stdlib.h>
+#include <string.h>
+
 // Einstein
 #include "TMemory.h"
 #include "TSymbolList.h"
@@ -121,12 +125,148 @@ static KUInt32 CountBits(KUInt16 inWord)
 	return inWord;
 }
 
+/**
+ * Names of r0 to r15 in the CPU.
+ */
+static const char *kCPURegisterNames[16] = {
+	"ioCPU->mCurrentRegisters[0]", "ioCPU->mCurrentRegisters[1]",
+	"ioCPU->mCurrentRegisters[2]", "ioCPU->mCurrentRegisters[3]",
+	"ioCPU->mCurrentRegisters[4]", "ioCPU->mCurrentRegisters[5]",
+	"ioCPU->mCurrentRegisters[6]", "ioCPU->mCurrentRegisters[7]",
+	"ioCPU->mCurrentRegisters[8]", "ioCPU->mCurrentRegisters[9]",
+	"ioCPU->mCurrentRegisters[10]", "ioCPU->mCurrentRegisters[11]",
+	"ioCPU->mCurrentRegisters[12]", "ioCPU->mCurrentRegisters[13]",
+	"ioCPU->mCurrentRegisters[14]", "ioCPU->mCurrentRegisters[15]"
+};
+
+/**
+ * Names of r0 to r15 when r0 to r14 are locals. The PC stays in the CPU.
+ */
+static const char *kLocalRegisterNames[16] = {
+	"r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+	"r8", "r9", "r10", "r11", "r12", "r13", "r14",
+	"ioCPU->mCurrentRegisters[15]"
+};
+
+/**
+ * Find the instruction that an injection replaced.
+ */
+static KUInt32 GetOriginalInstruction(KUInt32 inInstruction)
+{
+#ifndef EINSTEIN_RETARGET
+	// Make sure that injections are handled in a transparent manner
+	if ((inInstruction & 0xffe00000)==0xefc00000) {
+		inInstruction = TJITGenericROMPatch::GetOriginalInstructionAt(inInstruction);
+	} else if ((inInstruction & 0xffe00000)==0xefa00000) {
+		inInstruction = TJITGenericROMPatch::GetOriginalInstructionAt(inInstruction);
+	}
+#endif
+	return inInstruction;
+}
+
+/**
+ * Find the registers r0 to r14 that the code of an instruction uses.
+ *
+ * \param inInstruction the instruction.
+ * \param ioUsed bits of the registers that the code reads or assigns are set.
+ * \param ioWritten bits of the registers that the code assigns are set.
+ */
+static void GetRegisterUsage(KUInt32 inInstruction, KUInt32 &ioUsed, KUInt32 &ioWritten)
+{
+	const KUInt32 Rn = 1U << ((inInstruction>>16) & 15);
+	const KUInt32 Rd = 1U << ((inInstruction>>12) & 15);
+	const KUInt32 Rs = 1U << ((inInstruction>>8) & 15);
+	const KUInt32 Rm = 1U << (inInstruction & 15);
+	KUInt32 used = 0, written = 0;
+	if ((int)(inInstruction>>28)==kTestNV)
+		return;
+	switch ((inInstruction>>25) & 7) {
+		case 0: // data processing, PSR transfer, multiply, swap
+		case 1:
+			if ((inInstruction & 0x020000F0) == 0x90) {
+				if (inInstruction & 0x01000000) {
+					used = Rn | Rm;
+					written = Rd;
+				} else {
+					// Rd and Rn are swapped in multiplications
+					used = Rm | Rs;
+					if (inInstruction & 0x00200000)
+						used |= Rd;
+					written = Rn;
+				}
+			} else {
+				KUInt32 OP = (inInstruction>>21) & 15;
+				if ((inInstruction & 0x00100000)==0 && (OP==TST || OP==TEQ || OP==CMP || OP==CMN)) {
+					if (OP==TEQ || OP==CMN) { // MSR
+						if ((inInstruction & 0x02000000)==0)
+							used = Rm;
+					} else { // MRS
+						written = Rd;
+					}
+				} else {
+					if (OP!=MOV && OP!=MVN)
+						used = Rn;
+					if ((inInstruction & 0x02000000)==0) {
+						used |= Rm;
+						if (inInstruction & 0x00000010)
+							used |= Rs;
+					}
+					if (OP!=TST && OP!=TEQ && OP!=CMP && OP!=CMN)
+						written = Rd;
+				}
+			}
+			break;
+		case 2: // single data transfer, undefined
+		case 3:
+			if ((inInstruction & 0x02000010) == 0x02000010)
+				break;
+			used = Rn | Rd;
+			if (inInstruction & 0x02000000)
+				used |= Rm;
+			if (inInstruction & 0x00100000)
+				written = Rd;
+			if ((inInstruction & 0x01000000)==0 || (inInstruction & 0x00200000))
+				written |= Rn;
+			break;
+		case 4: // block data transfer
+			used = Rn | (inInstruction & 0xFFFF);
+			if (inInstruction & 0x00100000)
+				written = (inInstruction & 0xFFFF);
+			if (inInstruction & 0x00200000)
+				written |= Rn;
+			break;
+		case 5: // branch
+			if (inInstruction & 0x01000000)
+				used = written = (1U<<14);
+			break;
+		case 6: // coprocessor data transfer
+			used = Rn;
+			if (inInstruction & 0x00200000)
+				written = Rn;
+			break;
+		case 7: // coprocessor register transfer, SWI
+			if ((inInstruction & 0x01000010) == 0x00000010) {
+				used = Rd;
+				if (inInstruction & 0x00100000)
+					written = Rd;
+			}
+			break;
+	}
+	ioUsed |= (used | written) & 0x7FFF;
+	ioWritten |= written & 0x7FFF;
+}
+
 
 TJITGenericRetarget::TJITGenericRetarget(TMemory *inMemory, TSymbolList *inSymbolList) :
 	pMemory(inMemory),
 	pSymbolList(inSymbolList),
 	pCOut(stderr),
-	pHOut(stdout)
+	pHOut(stdout),
+	pParanoid(true),
+	pLocalRegisters(false),
+	pRegistersUsed(0),
+	pRegistersWritten(0),
+	pInstructionWritten(0)
 {
 #if 0
 	KUInt32 i, nSym = 0;
@@ -241,8 +381,30 @@ void TJITGenericRetarget::TranslateFunction(KUInt32 inFirst, KUInt32 inLast, con
 	if (pHOut!=stdout)
 		fprintf(pHOut, "extern void Func_0x%08X(TARMProcessor* ioCPU, KUInt32 ret); // %s\n", (unsigned int)inFirst, inName);
 	fprintf(pCOut, "void Func_0x%08X(TARMProcessor* ioCPU, KUInt32 ret)\n{\n", (unsigned int)inFirst);
+	// Generate the body in a temporary file first, to know which labels
+	// are used.
+	FILE* theCOut = pCOut;
+	FILE* theBody = tmpfile();
+	if (theBody)
+		pCOut = theBody;
 	KUInt32 instr = 0;
 	KUInt32 addr = inFirst;
+	pRegistersUsed = 0;
+	pRegistersWritten = 0;
+	if (pLocalRegisters) {
+		// Find the registers that the function uses and load them into locals
+		for ( ; addr<inLast; addr+=4) {
+			if (gJITGenericRetargetMap[addr>>2]==1) {
+				MemoryRead(addr, instr);
+				GetRegisterUsage(GetOriginalInstruction(instr), pRegistersUsed, pRegistersWritten);
+			}
+		}
+		for (int i=0; i<15; i++) {
+			if (pRegistersUsed & (1U<<i))
+				fprintf(pCOut, "\tKUInt32 r%d = ioCPU->mCurrentRegisters[%d];\n", i, i);
+		}
+		addr = inFirst;
+	}
 	for ( ; addr<inLast; addr+=4) {
 		MemoryRead(addr, instr);
 		switch (gJITGenericRetargetMap[addr>>2]) {
@@ -267,6 +429,7 @@ void TJITGenericRetarget::TranslateFunction(KUInt32 inFirst, KUInt32 inLast, con
 			}
 		}
 	}
+	PutSpillRegisters("\t", pRegistersWritten);
 	if (cont) {
 		// If the following commands are translated as well, this line will avoid
 		// falling back to the interpreter and instead generate a simple "goto"
@@ -277,6 +440,11 @@ void TJITGenericRetarget::TranslateFunction(KUInt32 inFirst, KUInt32 inLast, con
 		// If no 
 		fprintf(pCOut, "\t%s // There was no return instruction found\n", Debug);
 	}
+	if (theBody) {
+		pCOut = theCOut;
+		PutFunctionBody(theBody, inFirst, inLast);
+		fclose(theBody);
+	}
 	fprintf(pCOut, "}\n");
 	if (!dontLink) {
 		// This line creates a ROM patch that diverts the interpreter into running the code above
@@ -285,6 +453,126 @@ void TJITGenericRetarget::TranslateFunction(KUInt32 inFirst, KUInt32 inLast, con
 }
 
 
+void TJITGenericRetarget::PutFunctionBody(FILE* inBody, KUInt32 inFirst, KUInt32 inLast)
+{
+	long theSize = ftell(inBody);
+	char* theText = (char*) ::malloc(theSize + 1);
+	rewind(inBody);
+	theSize = (long) fread(theText, 1, theSize, inBody);
+	theText[theSize] = 0;
+	
+	// Mark the instructions that a goto jumps to.
+	KUInt32 theNbInstructions = (inLast - inFirst) / 4;
+	bool* theTargets = (bool*) ::calloc(theNbInstructions + 1, sizeof(bool));
+	const char* theGoto = theText;
+	while ((theGoto = strstr(theGoto, "goto L")) != NULL) {
+		theGoto += 6;
+		KUInt32 theDest = (KUInt32) strtoul(theGoto, NULL, 16);
+		if (theDest>=inFirst && theDest<inLast)
+			theTargets[(theDest - inFirst) / 4] = true;
+	}
+	
+	// Write the lines, with the labels that are not used in the comment
+	// after them: "L00001004: // 0x..." becomes "// L00001004: 0x...".
+	char* theLine = theText;
+	while (*theLine) {
+		char* theEnd = strchr(theLine, '\n');
+		theEnd = theEnd ? theEnd + 1 : theLine + strlen(theLine);
+		unsigned int theAddress;
+		int theLabelSize = 0;
+		if (sscanf(theLine, "L%08X: // %n", &theAddress, &theLabelSize) == 1
+			&& theLabelSize == 14 && theAddress>=inFirst && theAddress<inLast
+			&& !theTargets[(theAddress - inFirst) / 4])
+		{
+			fprintf(pCOut, "// L%08X: ", theAddress);
+			theLine += theLabelSize;
+		}
+		fwrite(theLine, 1, theEnd - theLine, pCOut);
+		theLine = theEnd;
+	}
+	
+	::free(theTargets);
+	::free(theText);
+}
+
+
+const char *TJITGenericRetarget::RegisterName(KUInt32 inRegister)
+{
+	if (pLocalRegisters)
+		return kLocalRegisterNames[inRegister & 15];
+	return kCPURegisterNames[inRegister & 15];
+}
+
+
+void TJITGenericRetarget::PutSpillRegisters(const char *inIndent, KUInt32 inMask)
+{
+	if (!pLocalRegisters || (inMask & 0x7FFF)==0)
+		return;
+	fprintf(pCOut, "%s", inIndent);
+	const char *theSeparator = "";
+	for (int i=0; i<15; i++) {
+		if (inMask & (1U<<i)) {
+			fprintf(pCOut, "%sioCPU->mCurrentRegisters[%d] = r%d;", theSeparator, i, i);
+			theSeparator = " ";
+		}
+	}
+	fprintf(pCOut, "\n");
+}
+
+
+void TJITGenericRetarget::PutReloadRegisters(const char *inIndent)
+{
+	if (!pLocalRegisters || pRegistersUsed==0)
+		return;
+	fprintf(pCOut, "%s", inIndent);
+	const char *theSeparator = "";
+	for (int i=0; i<15; i++) {
+		if (pRegistersUsed & (1U<<i)) {
+			fprintf(pCOut, "%sr%d = ioCPU->mCurrentRegisters[%d];", theSeparator, i, i);
+			theSeparator = " ";
+		}
+	}
+	fprintf(pCOut, "\n");
+}
+
+
+bool TJITGenericRetarget::NeedsRegistersInCPU(KUInt32 inVAddr, KUInt32 inInstruction)
+{
+	switch ((inInstruction>>25) & 7) {
+		case 0: // data processing, PSR transfer, multiply, swap
+			if ((inInstruction & 0x020000F0) == 0x90)
+				return (inInstruction & 0x01000000)!=0; // swap accesses memory
+			if (inInstruction & 0x00000FF0)
+				return true; // GetShift() reads the registers in the CPU
+			// fall through
+		case 1:
+			if ((inInstruction & 0x01B00000) == 0x01200000)
+				return true; // MSR may switch the register bank
+			return ((inInstruction & 0x0000F000) == 0x0000F000); // jumps
+		case 2: // single data transfer
+		case 3:
+			if ((inInstruction & 0x0fff0000) == 0x059F0000
+				&& ((inInstruction&0x00000fff)+inVAddr+8)<0x00800000)
+				return false; // a word of the ROM is a constant
+			return true;
+		case 5: // branch
+		{
+			if (inInstruction & 0x01000000)
+				return true;
+			KUInt32 offset = (inInstruction & 0x007FFFFF) << 2;
+			if (inInstruction & 0x00800000)
+				offset |= 0xFE000000;
+			KUInt32 dest = inVAddr + offset + 8;
+			if (dest>=0x01A00000 && dest<0x02000000)
+				return true; // jump tables read memory
+			return (dest<pFunctionBegin || dest>=pFunctionEnd);
+		}
+		default:
+			return true;
+	}
+}
+
+
 void TJITGenericRetarget::ReturnToEmulator(KUInt32 inFirst, const char *inName)
 {
 	pFunctionBegin = inFirst;
@@ -302,27 +590,35 @@ void TJITGenericRetarget::Translate(KUInt32 inVAddr, KUInt32 inInstruction)
 	pAction = 0;
 	pWarning = 0;
 	
-#ifndef EINSTEIN_RETARGET
-	// Make sure that injections are handled in a transparent manner
-	if ((inInstruction & 0xffe00000)==0xefc00000) {
-		inInstruction = TJITGenericROMPatch::GetOriginalInstructionAt(inInstruction);
-	} else if ((inInstruction & 0xffe00000)==0xefa00000) {
-		inInstruction = TJITGenericROMPatch::GetOriginalInstructionAt(inInstruction);
-	}
-#endif
+	inInstruction = GetOriginalInstruction(inInstruction);
 	
 	// Generate some crude disassmbly for comparison
 	char buf[2048];
 	UDisasm::Disasm(buf, 2047, inVAddr, inInstruction);
 	fprintf(pCOut, "L%08X: // 0x%08X  %s\n", (unsigned int)inVAddr, (unsigned int)inInstruction, buf);
 	
-	fprintf(pCOut, "\tif (ioCPU->mCurrentRegisters[15]!=0x%08X+4) %s // be paranoid about a correct PC\n", (unsigned int)inVAddr, Debug);
-	fprintf(pCOut, "\tioCPU->mCurrentRegisters[15] += 4; // update the PC\n");
+	if (pParanoid || inVAddr==pFunctionBegin) {
+		fprintf(pCOut, "\tif (ioCPU->mCurrentRegisters[15]!=0x%08X+4) %s // be paranoid about a correct PC\n", (unsigned int)inVAddr, Debug);
+		fprintf(pCOut, "\tioCPU->mCurrentRegisters[15] += 4; // update the PC\n");
+	} else {
+		// Every jump to this instruction sets the PC, so it is known here
+		fprintf(pCOut, "\tioCPU->mCurrentRegisters[15] = 0x%08X+8; // update the PC\n", (unsigned int)inVAddr);
+	}
 	
 	// Always generate code for a condition, so we can use local variables
 	int theTestKind = inInstruction >> 28;
 	PutTestBegin(theTestKind);
 	
+	// Write the locals back inside the braces of the test, so that they are
+	// in the CPU when the instruction calls out, accesses memory or leaves
+	pInstructionWritten = 0;
+	if (pLocalRegisters) {
+		KUInt32 theUsed = 0;
+		GetRegisterUsage(inInstruction, theUsed, pInstructionWritten);
+		if (NeedsRegistersInCPU(inVAddr, inInstruction))
+			PutSpillRegisters("\t\t", pRegistersWritten);
+	}
+	
 	if (pAction==0) {
 		// Translate the instructionusing the original JIT source as a guideline
 		if (theTestKind!=kTestNV)
@@ -360,7 +656,7 @@ void TJITGenericRetarget::Translate(KUInt32 inVAddr, KUInt32 inInstruction)
 void TJITGenericRetarget::TranslateSwitchCase(KUInt32 inVAddr, KUInt32 inInstruction, int inBaseReg, int inFirstCase, int inLastCase)
 {
 	fprintf(pCOut, "\t\t// switch/case statement 0..%d\n", inLastCase);
-	fprintf(pCOut, "\t\tswitch (ioCPU->mCurrentRegisters[%d]) {\n", inBaseReg);
+	fprintf(pCOut, "\t\tswitch (%s) {\n", RegisterName(inBaseReg));
 	if (inFirstCase==-1)
 		fprintf(pCOut, "\t\t\tdefault:  SETPC(0x%08X+4); goto L%08X;\n", (unsigned int)inVAddr+4, (unsigned int)inVAddr+4);
 	for (int i=0; i<=inLastCase; i++) {
@@ -495,11 +791,11 @@ void TJITGenericRetarget::Translate_Multiply( KUInt32 inVAddr, KUInt32 inInstruc
 	const KUInt32 Rm = inInstruction & 0x0000000F;
 
 	if (FLAG_A) { // multiply and add
-		fprintf(pCOut, "\t\tconst KUInt32 theResult = (ioCPU->mCurrentRegisters[%d] * ioCPU->mCurrentRegisters[%d]) + ioCPU->mCurrentRegisters[%d];\n", (int)Rm, (int)Rs, (int)Rn);
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theResult;\n", (int)Rd);
+		fprintf(pCOut, "\t\tconst KUInt32 theResult = (%s * %s) + %s;\n", RegisterName(Rm), RegisterName(Rs), RegisterName(Rn));
+		fprintf(pCOut, "\t\t%s = theResult;\n", RegisterName(Rd));
 	} else { // just multiply
-		fprintf(pCOut, "\t\tconst KUInt32 theResult = ioCPU->mCurrentRegisters[%d] * ioCPU->mCurrentRegisters[%d];\n", (int)Rm, (int)Rs);
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theResult;\n", (int)Rd);
+		fprintf(pCOut, "\t\tconst KUInt32 theResult = %s * %s;\n", RegisterName(Rm), RegisterName(Rs));
+		fprintf(pCOut, "\t\t%s = theResult;\n", RegisterName(Rd));
 	}
 	if (FLAG_S) {
 		// We track status flags
@@ -518,17 +814,17 @@ void TJITGenericRetarget::Translate_SingleDataSwap( KUInt32 inVAddr, KUInt32 inI
 	int Rm = (inInstruction>>0)&15;
 	
 	if ( (Rn!=15) || (Rd!=15) || (Rm!=15) ) {
-		fprintf(pCOut, "\t\tKUInt32 theAddress = ioCPU->mCurrentRegisters[%d];\n", Rn);
+		fprintf(pCOut, "\t\tKUInt32 theAddress = %s;\n", RegisterName(Rn));
 		if (FLAG_B) {
 			// Swap byte quantity.
 			fprintf(pCOut, "\t\tKUInt8 theData = UJITGenericRetargetSupport::ManagedMemoryReadB(ioCPU, theAddress);\n");
-			fprintf(pCOut, "\t\tUJITGenericRetargetSupport::ManagedMemoryWriteB(ioCPU, theAddress, (KUInt8)(ioCPU->mCurrentRegisters[%d] & 0xFF));\n", Rm);
-			fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theData;\n", Rd);
+			fprintf(pCOut, "\t\tUJITGenericRetargetSupport::ManagedMemoryWriteB(ioCPU, theAddress, (KUInt8)(%s & 0xFF));\n", RegisterName(Rm));
+			fprintf(pCOut, "\t\t%s = theData;\n", RegisterName(Rd));
 		} else {
 			// Swap word quantity.
 			fprintf(pCOut, "\t\tKUInt32 theData = UJITGenericRetargetSupport::ManagedMemoryRead(ioCPU, theAddress);\n");
-			fprintf(pCOut, "\t\tUJITGenericRetargetSupport::ManagedMemoryWrite(ioCPU, theAddress, ioCPU->mCurrentRegisters[%d]);\n", Rm);
-			fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theData;\n", Rd);
+			fprintf(pCOut, "\t\tUJITGenericRetargetSupport::ManagedMemoryWrite(ioCPU, theAddress, %s);\n", RegisterName(Rm));
+			fprintf(pCOut, "\t\t%s = theData;\n", RegisterName(Rd));
 		}
 	}
 }
@@ -561,13 +857,17 @@ void TJITGenericRetarget::Translate_SingleDataTransfer(
 	//L003AD74C: 0xE790F101  ldr	pc, [r0, r1, lsl #2]
 	if ( inInstruction==0xE790F101 && inVAddr==0x003AD74C) {
 		// 0x23 jump vectors at 003AD568
-		fprintf(pCOut, "\t\tswitch (ioCPU->mCurrentRegisters[1]) {\n");
+		fprintf(pCOut, "\t\tswitch (%s) {\n", RegisterName(1));
 		int i;
 		for (i=0; i<35; i++) {
 		//for (i=0; i<35; i++) {
 			KUInt32 dest = 0;
 			MemoryRead(0x003AD56C + 4*i, dest);
-			fprintf(pCOut, "\t\t\tcase %2d: SETPC(0x%08X+4); Func_0x%08X(ioCPU, 0x003AD750+4); goto L003AD750;\n", i, (unsigned int)dest, (unsigned int)dest);
+			fprintf(pCOut, "\t\t\tcase %2d:\n", i);
+			fprintf(pCOut, "\t\t\t\tSETPC(0x%08X+4);\n", (unsigned int)dest);
+			fprintf(pCOut, "\t\t\t\tFunc_0x%08X(ioCPU, 0x003AD750+4);\n", (unsigned int)dest);
+			PutReloadRegisters("\t\t\t\t");
+			fprintf(pCOut, "\t\t\t\tgoto L003AD750;\n");
 		}
 		fprintf(pCOut, "\t\t}\n");
 	}
@@ -586,18 +886,18 @@ void TJITGenericRetarget::Translate_SingleDataTransfer(
 #if 0
 			if (theValue>=0x0c100800 && theValue<=0x0F243000) {
 				// know global variables - use a symbolic expression for simulation!
-				fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = ptr_%s; // 0x%08X\n", (int)Rd, sym, (unsigned int)theValue);
+				fprintf(pCOut, "\t\t%s = ptr_%s; // 0x%08X\n", RegisterName(Rd), sym, (unsigned int)theValue);
 			} else if (theValue>=0x0F000000 && theValue<=0x0c107e14) {
 				// know hardware address range - we need to do some manual labour here!
-				fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = ptr_%s; // 0x%08X\n", (int)Rd, sym, (unsigned int)theValue);
+				fprintf(pCOut, "\t\t%s = ptr_%s; // 0x%08X\n", RegisterName(Rd), sym, (unsigned int)theValue);
 			} else {
-				fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = 0x%08X; // %s\n", (int)Rd, theValue, sym);
+				fprintf(pCOut, "\t\t%s = 0x%08X; // %s\n", RegisterName(Rd), theValue, sym);
 			}
 #else
-			fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = 0x%08X; // %s\n", (int)Rd, (unsigned int)theValue, sym);
+			fprintf(pCOut, "\t\t%s = 0x%08X; // %s\n", RegisterName(Rd), (unsigned int)theValue, sym);
 #endif
 		} else {
-			fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = 0x%08X;\n", (int)Rd, (unsigned int)theValue);
+			fprintf(pCOut, "\t\t%s = 0x%08X;\n", RegisterName(Rd), (unsigned int)theValue);
 		}
 	} else {
 		KUInt32 Rn = ((inInstruction & 0x000F0000) >> 16);
@@ -617,7 +917,7 @@ void TJITGenericRetarget::Translate_SingleDataTransfer(
 			{
 				fprintf(pCOut, "\t\tKUInt32 offset = GetShiftNoCarryNoR15( 0x%08X, ioCPU->mCurrentRegisters, ioCPU->mCPSR_C );\n", (unsigned int)inInstruction);
 			} else {
-				fprintf(pCOut, "\t\tKUInt32 offset = ioCPU->mCurrentRegisters[%d];\n", (unsigned int)(inInstruction & 0x0000000F));
+				fprintf(pCOut, "\t\tKUInt32 offset = %s;\n", RegisterName(inInstruction & 0x0000000F));
 			}
 		} else {
 			fprintf(pCOut, "\t\tKUInt32 offset = 0x%08X;\n", (unsigned int)(inInstruction & 0x00000FFF));
@@ -625,7 +925,7 @@ void TJITGenericRetarget::Translate_SingleDataTransfer(
 		if (Rn == 15) {
 			fprintf(pCOut, "\t\tKUInt32 theAddress = 0x%08X + 8", (unsigned int)(inVAddr));
 		} else {
-			fprintf(pCOut, "\t\tKUInt32 theAddress = ioCPU->mCurrentRegisters[%d]", (unsigned int)Rn);
+			fprintf(pCOut, "\t\tKUInt32 theAddress = %s", RegisterName(Rn));
 		}
 		
 		if (FLAG_P) {
@@ -657,13 +957,13 @@ void TJITGenericRetarget::Translate_SingleDataTransfer(
 					fprintf(pCOut, "\t\tSETPC(theData + 4);\n");
 				}
 			} else {
-				fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theData;\n", (int)Rd);
+				fprintf(pCOut, "\t\t%s = theData;\n", RegisterName(Rd));
 			}
 		} else {
 			if (Rd == 15) {
 				fprintf(pCOut, "\t\tKUInt32 theValue = 0x%08X + 8;\n", (unsigned int)inVAddr);
 			} else {
-				fprintf(pCOut, "\t\tKUInt32 theValue = ioCPU->mCurrentRegisters[%d];\n", (int)Rd);
+				fprintf(pCOut, "\t\tKUInt32 theValue = %s;\n", RegisterName(Rd));
 			}
 		
 			if (FLAG_B) {
@@ -679,12 +979,12 @@ void TJITGenericRetarget::Translate_SingleDataTransfer(
 			} else {
 				if (!FLAG_P) {
 					if (FLAG_U) {
-						fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theAddress + offset;\n", (int)Rn);
+						fprintf(pCOut, "\t\t%s = theAddress + offset;\n", RegisterName(Rn));
 					} else {
-						fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theAddress - offset;\n", (int)Rn);
+						fprintf(pCOut, "\t\t%s = theAddress - offset;\n", RegisterName(Rn));
 					}
 				} else {
-					fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theAddress;\n", (int)Rn);
+					fprintf(pCOut, "\t\t%s = theAddress;\n", RegisterName(Rn));
 				}
 			}
 		}
@@ -930,7 +1230,7 @@ void TJITGenericRetarget::Translate_MSR(KUInt32 inVAddr, KUInt32 inInstruction)
 			KUInt32 imm = (inInstruction&255);
 			fprintf(pCOut, "\t\tconst KUInt32 Opnd2 = 0x%08X;\n", (unsigned int) imm<<(rot*2));
 		} else {
-			fprintf(pCOut, "\t\tconst KUInt32 Opnd2 = ioCPU->mCurrentRegisters[%d];\n", (int)Rm);
+			fprintf(pCOut, "\t\tconst KUInt32 Opnd2 = %s;\n", RegisterName(Rm));
 		}
 		if (FLAG_R) {
 			fprintf(pCOut, "\t\tif (ioCPU->GetMode()==TARMProcessor::kUserMode) {\n");
@@ -953,7 +1253,7 @@ void TJITGenericRetarget::Translate_MSR(KUInt32 inVAddr, KUInt32 inInstruction)
 			KUInt32 imm = (inInstruction&255);
 			fprintf(pCOut, "\t\tconst KUInt32 Opnd2 = 0x%08X;\n", (unsigned int)imm<<(rot*2));
 		} else {
-			fprintf(pCOut, "\t\tconst KUInt32 Opnd2 = ioCPU->mCurrentRegisters[%d];\n", (int)Rm);
+			fprintf(pCOut, "\t\tconst KUInt32 Opnd2 = %s;\n", RegisterName(Rm));
 		}
 		if (FLAG_R) {
 			fprintf(pCOut, "\t\tconst KUInt32 oldValue = ioCPU->GetSPSR();\n");
@@ -963,6 +1263,8 @@ void TJITGenericRetarget::Translate_MSR(KUInt32 inVAddr, KUInt32 inInstruction)
 			fprintf(pCOut, "\t\tioCPU->SetCPSR((Opnd2 & 0xF0000000) | (oldValue & 0x0FFFFFFF));\n");
 		}
 	}
+	// A new mode has its own registers
+	PutReloadRegisters("\t\t");
 }
 
 
@@ -976,7 +1278,7 @@ void TJITGenericRetarget::Translate_MRS(KUInt32 inVAddr, KUInt32 inInstruction)
 		} else {
 			fprintf(pCOut, "\t\tconst KUInt32 theResult = ioCPU->GetCPSR();\n");
 		}
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theResult;\n", (int)Rd);
+		fprintf(pCOut, "\t\t%s = theResult;\n", RegisterName(Rd));
 	} else {
 		fprintf(pCOut, "\t\t#error Can't use R15 as a destination here!\n");
 	}
@@ -993,7 +1295,7 @@ void TJITGenericRetarget::TestOp(KUInt32 inVAddr, KUInt32 inInstruction, KUInt32
 		{
 			fprintf(pCOut, "\t\tKUInt32 Opnd2 = 0x%08X + 8; // (PC)\n", (unsigned int)inVAddr);
 		} else {
-			fprintf(pCOut, "\t\tKUInt32 Opnd2 = ioCPU->mCurrentRegisters[%d];\n", (int)Rm);
+			fprintf(pCOut, "\t\tKUInt32 Opnd2 = %s;\n", RegisterName(Rm));
 		}
 	} else if ((OP == TST) || (OP == TEQ)) {
 		fprintf(pCOut, "\t\tBoolean carry = false;\n");
@@ -1004,7 +1306,7 @@ void TJITGenericRetarget::TestOp(KUInt32 inVAddr, KUInt32 inInstruction, KUInt32
 	if (Rn == 15) {
 		fprintf(pCOut, "\t\tKUInt32 Opnd1 = 0x%08X + 8;\n", (unsigned int)inVAddr);
 	} else {
-		fprintf(pCOut, "\t\tKUInt32 Opnd1 = ioCPU->mCurrentRegisters[%d];\n", (int)Rn);
+		fprintf(pCOut, "\t\tKUInt32 Opnd1 = %s;\n", RegisterName(Rn));
 	}
 	if (OP == TST) {
 		fprintf(pCOut, "\t\tconst KUInt32 theResult = Opnd1 & Opnd2;\n");
@@ -1053,7 +1355,7 @@ void TJITGenericRetarget::LogicalOp(KUInt32 inVAddr, KUInt32 inInstruction, KUIn
 		if (Rm == 15) {
 			fprintf(pCOut, "\t\tKUInt32 Opnd2 = 0x%08X + 8; // PC\n", (unsigned int)inVAddr);
 		} else {
-			fprintf(pCOut, "\t\tKUInt32 Opnd2 = ioCPU->mCurrentRegisters[%d];\n", (unsigned int)Rm);
+			fprintf(pCOut, "\t\tKUInt32 Opnd2 = %s;\n", RegisterName(Rm));
 		}
 	} else if (FLAG_S) {
 		fprintf(pCOut, "\t\tBoolean carry = false;\n");
@@ -1064,7 +1366,7 @@ void TJITGenericRetarget::LogicalOp(KUInt32 inVAddr, KUInt32 inInstruction, KUIn
 	if (Rn == 15) {
 		fprintf(pCOut, "\t\tKUInt32 Opnd1 = 0x%08X + 8;\n", (unsigned int)inVAddr);
 	} else {
-		fprintf(pCOut, "\t\tKUInt32 Opnd1 = ioCPU->mCurrentRegisters[%d];\n", (unsigned int)Rn);
+		fprintf(pCOut, "\t\tKUInt32 Opnd1 = %s;\n", RegisterName(Rn));
 	}
 	if (OP == AND) {
 		fprintf(pCOut, "\t\tconst KUInt32 theResult = Opnd1 & Opnd2;\n");
@@ -1083,7 +1385,7 @@ void TJITGenericRetarget::LogicalOp(KUInt32 inVAddr, KUInt32 inInstruction, KUIn
 			fprintf(pCOut, "\t\tioCPU->SetCPSR( ioCPU->GetSPSR() );\n");
 		}
 	} else {
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theResult;\n", (unsigned int)Rd);
+		fprintf(pCOut, "\t\t%s = theResult;\n", RegisterName(Rd));
 		if (FLAG_S) {
 			if ((MODE == NoShift) || (MODE == Imm)) {
 				fprintf(pCOut, "\t\tioCPU->mCPSR_Z = (theResult==0);\n");
@@ -1116,7 +1418,7 @@ void TJITGenericRetarget::ArithmeticOp(KUInt32 inVAddr, KUInt32 inInstruction, K
 	// add     pc, pc, r1, lsr #24             @ 0x003ADD80 0xE08FFC21
 	if ( (inVAddr==0x003ADD80) && (inInstruction==0xE08FFC21) ) {
 		fprintf(pCOut, "\t\t// hardcoded switch/case statement\n");
-		fprintf(pCOut, "\t\tswitch (ioCPU->mCurrentRegisters[1]>>28) {\n");
+		fprintf(pCOut, "\t\tswitch (%s>>28) {\n", RegisterName(1));
 		for (int i=0; i<16; i++) {
 			fprintf(pCOut, "\t\t\tcase %3d: SETPC(0x%08X+4); goto L%08X;\n", i, (unsigned int)inVAddr+16*i+8, (unsigned int)inVAddr+16*i+8);
 		}
@@ -1144,7 +1446,7 @@ void TJITGenericRetarget::ArithmeticOp(KUInt32 inVAddr, KUInt32 inInstruction, K
 		if (Rm == 15) {
 			fprintf(pCOut, "\t\tKUInt32 Opnd2 = 0x%08X + 8; // PC\n", (unsigned int)inVAddr);
 		} else {
-			fprintf(pCOut, "\t\tKUInt32 Opnd2 = ioCPU->mCurrentRegisters[%d];\n", (unsigned int)Rm);
+			fprintf(pCOut, "\t\tKUInt32 Opnd2 = %s;\n", RegisterName(Rm));
 		}
 	} else {
 		fprintf(pCOut, "\t\tKUInt32 Opnd2 = GetShiftNoCarry( ioCPU, 0x%08X, ioCPU->mCPSR_C, 0x%08X + 8 );\n", (unsigned int)inInstruction, (unsigned int)inVAddr);
@@ -1152,7 +1454,7 @@ void TJITGenericRetarget::ArithmeticOp(KUInt32 inVAddr, KUInt32 inInstruction, K
 	if (Rn == 15) {
 		fprintf(pCOut, "\t\tKUInt32 Opnd1 = 0x%08X + 8;\n", (unsigned int)inVAddr);
 	} else {
-		fprintf(pCOut, "\t\tKUInt32 Opnd1 = ioCPU->mCurrentRegisters[%d];\n", (unsigned int)Rn);
+		fprintf(pCOut, "\t\tKUInt32 Opnd1 = %s;\n", RegisterName(Rn));
 	}
 	if (OP == SUB) {
 		fprintf(pCOut, "\t\tconst KUInt32 theResult = Opnd1 - Opnd2;\n");
@@ -1175,7 +1477,7 @@ void TJITGenericRetarget::ArithmeticOp(KUInt32 inVAddr, KUInt32 inInstruction, K
 			fprintf(pCOut, "\t\tioCPU->SetCPSR( ioCPU->GetSPSR() );\n");
 		}
 	} else {
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theResult;\n", (unsigned int)Rd);
+		fprintf(pCOut, "\t\t%s = theResult;\n", RegisterName(Rd));
 		if (FLAG_S) {
 			if ((OP == SUB) || (OP == SBC)) {
 				fprintf(pCOut, "\t\tioCPU->mCPSR_Z = (theResult==0);\n");
@@ -1216,7 +1518,7 @@ void TJITGenericRetarget::MoveOp(KUInt32 inVAddr, KUInt32 inInstruction, KUInt32
 		if (Rm == 15) {
 			fprintf(pCOut, "\t\tKUInt32 Opnd2 = 0x%08X + 8;\n", (unsigned int)inVAddr);
 		} else {
-			fprintf(pCOut, "\t\tKUInt32 Opnd2 = ioCPU->mCurrentRegisters[%d];\n", (int)Rm);
+			fprintf(pCOut, "\t\tKUInt32 Opnd2 = %s;\n", RegisterName(Rm));
 		}
 	} else if (FLAG_S) {
 		fprintf(pCOut, "\t\tBoolean carry = false;\n");
@@ -1238,7 +1540,7 @@ void TJITGenericRetarget::MoveOp(KUInt32 inVAddr, KUInt32 inInstruction, KUInt32
 			fprintf(pCOut, "\t\tioCPU->SetCPSR( ioCPU->GetSPSR() );\n");
 		}
 	} else {
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = theResult;\n", (int)Rd);
+		fprintf(pCOut, "\t\t%s = theResult;\n", RegisterName(Rd));
 		if (FLAG_S) {
 			if ((MODE == NoShift) || (MODE == Imm)) {
 				fprintf(pCOut, "\t\tioCPU->mCPSR_Z = (theResult==0);\n");
@@ -1286,6 +1588,7 @@ void TJITGenericRetarget::MoveOp(KUInt32 inVAddr, KUInt32 inInstruction, KUInt32
 void TJITGenericRetarget::GenerateReturnInstruction(bool withFlags)
 {
 	// This is typically called for 'mov pc, lr'
+	PutSpillRegisters("\t\t", pInstructionWritten);
 	// If the caller of this function was the emulator, simply return to the emulator
 	fprintf(pCOut, "\t\tif (ret==0xFFFFFFFF)\n");
 	fprintf(pCOut, "\t\t\treturn; // Return to emulator\n");
@@ -1327,9 +1630,11 @@ void TJITGenericRetarget::Translate_JumpToCalculatedAddress(KUInt32 inVAddr, KUI
 	MemoryRead(inVAddr-4, prevInstruction);
 	KUInt32 prevPrevInstruction;
 	MemoryRead(inVAddr-8, prevPrevInstruction);
+	PutSpillRegisters("\t\t", pInstructionWritten);
 	if (prevInstruction==0xE1A0E00F || prevPrevInstruction==0xE28FE004) { // mov lr,pc
 		// the previous instruct sets a return address, so this is a call
 		fprintf(pCOut, "\t\tUJITGenericRetargetSupport::JumpToCalculatedAddress(ioCPU, ioCPU->mCurrentRegisters[15], 0x%08X);\n", (unsigned int)inVAddr+8);
+		PutReloadRegisters("\t\t");
 	} else {
 		fprintf(pCOut, "\t\treturn UJITGenericRetargetSupport::JumpToCalculatedAddress(ioCPU, ioCPU->mCurrentRegisters[15], ret);\n");
 	}
@@ -1382,15 +1687,17 @@ void TJITGenericRetarget::Translate_Branch(KUInt32 inVAddr, KUInt32 inInstructio
 	if (inInstruction & 0x01000000)
 	{
 		// branch with link
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[14] = 0x%08X + 4;\n", (unsigned int)inVAddr);
+		fprintf(pCOut, "\t\t%s = 0x%08X + 4;\n", RegisterName(14), (unsigned int)inVAddr);
 		char sym[512];
 		if (pSymbolList->GetSymbolByAddress(dest, sym)) {
 			fprintf(pCOut, "\t\t// rt cjitr %s\n", sym);
 		} else {
 			fprintf(pCOut, "\t\t// rt cjitr %08X\n", (unsigned int)dest);
 		}
+		PutSpillRegisters("\t\t", pInstructionWritten);
 		fprintf(pCOut, "\t\tSETPC(0x%08X+4);\n", (unsigned int)dest);
 		fprintf(pCOut, "\t\tFunc_0x%08X(ioCPU, 0x%08X);\n", (unsigned int)dest, (unsigned int)inVAddr+8);
+		PutReloadRegisters("\t\t");
 		fprintf(pCOut, "\t\tif (ioCPU->mCurrentRegisters[15]!=0x%08X) {\n", (unsigned int)inVAddr+8);
 		fprintf(pCOut, "\t\t	RT_PANIC_UNEXPECTED_RETURN_ADDRESS\n"); // throws an exception that leaves simulation and returns to JIT
 		fprintf(pCOut, "\t\t}\n");
@@ -1465,7 +1772,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_STM1(KUInt32 inVAddr, KUIn
 	KUInt32 curRegList = theRegList & 0x7FFF;
 	KUInt32 nbRegisters = CountBits(theRegList);
 	if (Rn==15) fprintf(pCOut, "#error Rn == 15 -> UNPREDICTABLE\n");
-	fprintf(pCOut, "\t\tKUInt32 baseAddress = ioCPU->mCurrentRegisters[%d];\n", (int)Rn);
+	fprintf(pCOut, "\t\tKUInt32 baseAddress = %s;\n", RegisterName(Rn));
 	
 	if (FLAG_W) { // Write back
 		if (FLAG_U) {
@@ -1488,7 +1795,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_STM1(KUInt32 inVAddr, KUIn
 	int indexReg = 0;
 	while (curRegList) {
 		if (curRegList & 1) {
-			fprintf(pCOut, "\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[%d]);\n", indexReg);
+			fprintf(pCOut, "\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(indexReg));
 			fprintf(pCOut, "\t\tbaseAddress += 4;\n");
 		}
 		curRegList >>= 1;
@@ -1504,7 +1811,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_STM1(KUInt32 inVAddr, KUIn
 	if (FLAG_W) {
 	// Write back.
 	// Rn == 15 -> UNPREDICTABLE
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = wbAddress;\n", (int)Rn);
+		fprintf(pCOut, "\t\t%s = wbAddress;\n", RegisterName(Rn));
 	}
 }
 
@@ -1533,7 +1840,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_STM2(KUInt32 inVAddr, KUIn
 	fprintf(pCOut, "\t\t\tcurRegList = 0x%04X & 0x1FFF;\n", (unsigned int)theRegList);
 	fprintf(pCOut, "\t\t\tbankRegList = 0x%04X & 0x6000;\n", (unsigned int)theRegList);
 	fprintf(pCOut, "\t\t}\n");
-	fprintf(pCOut, "\t\tKUInt32 baseAddress = ioCPU->mCurrentRegisters[%d];\n", (unsigned int)Rn);
+	fprintf(pCOut, "\t\tKUInt32 baseAddress = %s;\n", RegisterName(Rn));
 	
 	if (FLAG_U) {
 		// Up.
@@ -1555,79 +1862,79 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_STM2(KUInt32 inVAddr, KUIn
 	fprintf(pCOut, "\t\tif (curRegList) {\n");
 	if (theRegList & 0x0001) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0001) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[0]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(0));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0002) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0002) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[1]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(1));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0004) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0004) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[2]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(2));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0008) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0008) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[3]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(3));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0010) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0010) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[4]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(4));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0020) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0020) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[5]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(5));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0040) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0040) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[6]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(6));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0080) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0080) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[7]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(7));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0100) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0100) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[8]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(8));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0200) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0200) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[9]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(9));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0400) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0400) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[10]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(10));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0800) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0800) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[11]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(11));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x1000) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x1000) {\n");
-		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[12]);\n");
+		fprintf(pCOut, "\t\t\t\tUJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, %s);\n", RegisterName(12));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
@@ -1698,7 +2005,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_LDM1(KUInt32 inVAddr, KUIn
 	KUInt32 curRegList = theRegList & 0x7FFF;
 	KUInt32 nbRegisters = CountBits(theRegList);
 	if (Rn==15) fprintf(pCOut, "#error Rn == 15 -> UNPREDICTABLE\n");
-	fprintf(pCOut, "\t\tKUInt32 baseAddress = ioCPU->mCurrentRegisters[%d];\n", (int)Rn);
+	fprintf(pCOut, "\t\tKUInt32 baseAddress = %s;\n", RegisterName(Rn));
 	if (FLAG_W) { // Write back
 		if (FLAG_U) {
 			fprintf(pCOut, "\t\tKUInt32 wbAddress = baseAddress + (%d * 4);\n", (int)nbRegisters);
@@ -1721,7 +2028,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_LDM1(KUInt32 inVAddr, KUIn
 	int indexReg = 0;
 	while (curRegList) {
 		if (curRegList & 1) {
-			fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", indexReg);
+			fprintf(pCOut, "\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(indexReg));
 			fprintf(pCOut, "\t\tbaseAddress += 4;\n");
 		}
 		curRegList >>= 1;
@@ -1738,11 +2045,12 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_LDM1(KUInt32 inVAddr, KUIn
 	if (FLAG_W) {
 	// Write back.
 	// Rn == 15 -> UNPREDICTABLE
-		fprintf(pCOut, "\t\tioCPU->mCurrentRegisters[%d] = wbAddress;\n", (int)Rn);
+		fprintf(pCOut, "\t\t%s = wbAddress;\n", RegisterName(Rn));
 	}
 	
 	if (theRegList & 0x8000)
 	{
+		PutSpillRegisters("\t\t", pInstructionWritten);
 		fprintf(pCOut, "\t\treturn; //MMUCALLNEXT_AFTERSETPC;\n");
 	} else {
 		//CALLNEXTUNIT;
@@ -1773,7 +2081,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_LDM2(KUInt32 inVAddr, KUIn
 	fprintf(pCOut, "\t\t\tcurRegList = 0x%04X & 0x1FFF;\n", (unsigned int)theRegList);
 	fprintf(pCOut, "\t\t\tbankRegList = 0x%04X & 0x6000;\n", (unsigned int)theRegList);
 	fprintf(pCOut, "\t\t}\n");
-	fprintf(pCOut, "\t\tKUInt32 baseAddress = ioCPU->mCurrentRegisters[%d];\n", (unsigned int)Rn);
+	fprintf(pCOut, "\t\tKUInt32 baseAddress = %s;\n", RegisterName(Rn));
 	
 	if (FLAG_U) {
 		// Up.
@@ -1795,79 +2103,79 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_LDM2(KUInt32 inVAddr, KUIn
 	fprintf(pCOut, "\t\tif (curRegList) {\n");
 	if (theRegList & 0x0001) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0001) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[0] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(0));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0002) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0002) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[1] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(1));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0004) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0004) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[2] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(2));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0008) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0008) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[3] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(3));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0010) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0010) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[4] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(4));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0020) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0020) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[5] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(5));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0040) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0040) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[6] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(6));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0080) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0080) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[7] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(7));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0100) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0100) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[8] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(8));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0200) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0200) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[9] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(9));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0400) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0400) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[10] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(10));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x0800) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x0800) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[11] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(11));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
 	if (theRegList & 0x1000) {
 		fprintf(pCOut, "\t\t\tif (curRegList & 0x1000) {\n");
-		fprintf(pCOut, "\t\t\t\tioCPU->mCurrentRegisters[12] = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n");
+		fprintf(pCOut, "\t\t\t\t%s = UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress);\n", RegisterName(12));
 		fprintf(pCOut, "\t\t\t\tbaseAddress += 4;\n");
 		fprintf(pCOut, "\t\t\t}\n");
 	}
@@ -1928,6 +2236,7 @@ void TJITGenericRetarget::Translate_BlockDataTransfer_LDM2(KUInt32 inVAddr, KUIn
 	
 	if (theRegList & 0x8000)
 	{
+		PutSpillRegisters("\t\t", pInstructionWritten);
 		fprintf(pCOut, "\t\treturn;\n");
 	} else {
 	}
@@ -1958,6 +2267,7 @@ void TJITGenericRetarget::DoTranslate_11(KUInt32 inVAddr, KUInt32 inInstruction)
 				// SWI.
 				fprintf(pCOut, "\t\tioCPU->DoSWI();\n");
 				fprintf(pCOut, "\t\tFunc_0x00000008(ioCPU, 0x%08X);\n", (unsigned int)inVAddr+8);
+				PutReloadRegisters("\t\t");
 				fprintf(pCOut, "\t\tif (ioCPU->mCurrentRegisters[15]!=0x%08X) {\n", (unsigned int)inVAddr+8);
 				fprintf(pCOut, "\t\t\tRT_PANIC_UNEXPECTED_RETURN_ADDRESS\n");
 				fprintf(pCOut, "\t\t}\n");
@@ -1969,6 +2279,7 @@ void TJITGenericRetarget::DoTranslate_11(KUInt32 inVAddr, KUInt32 inInstruction)
 			} else {
 				fprintf(pCOut, "\t\tioCPU->DoUndefinedInstruction(); // (1)\n");
 				fprintf(pCOut, "\t\tFunc_0x00000004(ioCPU, 0x%08X);\n", (unsigned int)inVAddr+8);
+				PutReloadRegisters("\t\t");
 				fprintf(pCOut, "\t\tif (ioCPU->mCurrentRegisters[15]!=0x%08X) {\n", (unsigned int)inVAddr+8);
 				fprintf(pCOut, "\t\t\tRT_PANIC_UNEXPECTED_RETURN_ADDRESS\n");
 				fprintf(pCOut, "\t\t}\n");
@@ -1977,6 +2288,7 @@ void TJITGenericRetarget::DoTranslate_11(KUInt32 inVAddr, KUInt32 inInstruction)
 	} else {
 		fprintf(pCOut, "\t\tioCPU->DoUndefinedInstruction(); // (2)\n");
 		fprintf(pCOut, "\t\tFunc_0x00000004(ioCPU, 0x%08X);\n", (unsigned int)inVAddr+8);
+		PutReloadRegisters("\t\t");
 		fprintf(pCOut, "\t\tif (ioCPU->mCurrentRegisters[15]!=0x%08X) {\n", (unsigned int)inVAddr+8);
 		fprintf(pCOut, "\t\t\tRT_PANIC_UNEXPECTED_RETURN_ADDRESS\n");
 		fprintf(pCOut, "\t\t}\n");
@@ -1995,12 +2307,15 @@ void TJITGenericRetarget::CoprocRegisterTransfer(KUInt32 inVAddr, KUInt32 inInst
 	KUInt32 CPNumber = (inInstruction & 0x00000F00) >> 8;
 	if (CPNumber == 0xF) {
 		fprintf(pCOut, "\t\tioCPU->SystemCoprocRegisterTransfer(0x%08X);\n", (unsigned int)inInstruction);
+		PutReloadRegisters("\t\t");
 	} else if (CPNumber == 10) {
 		// Native primitives.
 		fprintf(pCOut, "\t\tioCPU->NativeCoprocRegisterTransfer(0x%08X);\n", (unsigned int)inInstruction);
+		PutReloadRegisters("\t\t");
 	} else {
 		fprintf(pCOut, "\t\tioCPU->DoUndefinedInstruction(); // (3)\n");
 		fprintf(pCOut, "\t\tFunc_0x00000004(ioCPU, 0x%08X);\n", (unsigned int)inVAddr+8);
+		PutReloadRegisters("\t\t");
 		fprintf(pCOut, "\t\tif (ioCPU->mCurrentRegisters[15]!=0x%08X) {\n", (unsigned int)inVAddr+8);
 		fprintf(pCOut, "\t\t\tRT_PANIC_UNEXPECTED_RETURN_ADDRESS\n");
 		fprintf(pCOut, "\t\t}\n");
@@ -82,6 +82,27 @@ public:
 	 */
 	void CloseFiles();
 	
+	/**
+	 * Select whether the PC is checked before every instruction.
+	 *
+	 * Release code only checks the PC at the entry of a function, and at
+	 * returns and jump tables, where the destination is only known when
+	 * the code runs. Elsewhere the PC is set to the address of the next
+	 * instruction. Paranoid code is the default.
+	 */
+	void SetParanoid(bool inParanoid) { pParanoid = inParanoid; }
+	
+	/**
+	 * Select whether functions keep r0 to r14 in local variables.
+	 *
+	 * The registers are loaded at the entry of the function and written
+	 * back to the CPU before anything that may read them or change them:
+	 * calls, memory accesses (which may fault), mode changes and returns.
+	 * They are loaded again after calls and mode changes. The host compiler
+	 * can then keep them in its own registers.
+	 */
+	void SetLocalRegisters(bool inLocalRegisters) { pLocalRegisters = inLocalRegisters; }
+	
 	/**
 	 * Translate an entire function.
 	 */
@@ -159,6 +180,50 @@ protected:
 	void Translate_BlockDataTransfer_STM2(KUInt32 inVAddr, KUInt32 inInstruction);
 	
 	void GenerateReturnInstruction(bool withFlags);
+	
+	/**
+	 * Name of a register in the generated code.
+	 *
+	 * r0 to r14 are locals if SetLocalRegisters is on, the PC is always
+	 * in the CPU.
+	 */
+	const char *RegisterName(KUInt32 inRegister);
+	
+	/**
+	 * Write locals back to the CPU.
+	 *
+	 * \param inIndent tabs before the statements.
+	 * \param inMask bits of the registers to write.
+	 */
+	void PutSpillRegisters(const char *inIndent, KUInt32 inMask);
+	
+	/**
+	 * Read all locals of the function again from the CPU.
+	 *
+	 * \param inIndent tabs before the statements.
+	 */
+	void PutReloadRegisters(const char *inIndent);
+	
+	/**
+	 * Find out if an instruction needs the registers in the CPU.
+	 *
+	 * This is the case unless it only computes with locals, or jumps
+	 * inside the function.
+	 */
+	bool NeedsRegistersInCPU(KUInt32 inVAddr, KUInt32 inInstruction);
+
+	/**
+	 * Copy the body of a function into the C file.
+	 *
+	 * Every instruction gets a label, but only jump targets are used. The
+	 * other labels become comments, so that the code compiles without
+	 * unused label warnings.
+	 *
+	 * \param inBody temporary file holding the body.
+	 * \param inFirst address of the first instruction of the function.
+	 * \param inLast address after the last instruction.
+	 */
+	void PutFunctionBody(FILE* inBody, KUInt32 inFirst, KUInt32 inLast);
 
 	TMemory *pMemory;
 	TSymbolList *pSymbolList;
@@ -166,6 +231,11 @@ protected:
 	FILE *pHOut;
 	KUInt32 pFunctionBegin;
 	KUInt32 pFunctionEnd;
+	bool pParanoid;
+	bool pLocalRegisters;
+	KUInt32 pRegistersUsed;			///< locals of the current function
+	KUInt32 pRegistersWritten;		///< locals that the current function changes
+	KUInt32 pInstructionWritten;	///< locals that the current instruction changes
 	
 	const char *pWarning;
 	int pAction;
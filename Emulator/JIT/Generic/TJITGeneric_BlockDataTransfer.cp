@@ -117,6 +117,11 @@ Translate_BlockDataTransfer(
 	PUSHVALUE(inVAddr + 8);
 	// Push the reg list and the number of registers.
 	PUSHVALUE((nbRegs << 16) | regList);
+	// LDM1 with PC jumps through a branch cache.
+	if ((inInstruction & 0x00508000) == 0x00108000)
+	{
+		inPage->PushBranchCache(ioUnitCrsr);
+	}
 }
 
 void TJITGeneric_BlockDataTransfer_assertions( void );
@@ -451,6 +451,14 @@ Translate_DataProcessingPSRTransfer(
 	{
 		PUSHVALUE(inVAddr + 8);
 	}
+	// Writing PC without S jumps through a branch cache (test operations
+	// don't write Rd).
+	if (((inInstruction & 0x0000F000) == 0x0000F000)
+		&& !theFlagS
+		&& ((inInstruction & 0x01800000) != 0x01000000))
+	{
+		inPage->PushBranchCache(ioUnitCrsr);
+	}
 }
 
 #endif
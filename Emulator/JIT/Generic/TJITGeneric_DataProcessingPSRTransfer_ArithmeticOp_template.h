@@ -148,7 +148,7 @@ ArithmeticOp(OP, MODE, FLAG_S, Rn, Rd)
 	#if FLAG_S
 		MMUCALLNEXT_AFTERSETPC;
 	#else
-		FURTHERCALLNEXT_AFTERSETPC;
+		MMUSMARTCALLNEXT_AFTERSETPC;
 	#endif
 #else
 	CALLNEXTUNIT;
@@ -128,7 +128,7 @@ LogicalOp(OP, MODE, FLAG_S, Rn, Rd)
 	#if FLAG_S
 		MMUCALLNEXT_AFTERSETPC;
 	#else
-		FURTHERCALLNEXT_AFTERSETPC;
+		MMUSMARTCALLNEXT_AFTERSETPC;
 	#endif
 #else
 	CALLNEXTUNIT;
@@ -95,7 +95,7 @@ MoveOp(OP, MODE, FLAG_S, Rd)
 	#if FLAG_S
 		MMUCALLNEXT_AFTERSETPC;
 	#else
-		FURTHERCALLNEXT_AFTERSETPC;
+		MMUSMARTCALLNEXT_AFTERSETPC;
 	#endif
 #else
 	CALLNEXTUNIT;
@@ -68,6 +68,38 @@ LDM1_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 	#endif
 #endif
 
+	// Fast path: the whole block is in a single page of ROM or RAM, which
+	// is translated once.
+	const KUInt32* theHostWords;
+	if (!theMemoryInterface->GetBlockPointerR(
+			(TMemory::VAddr) baseAddress,
+			(theImmValue >> 16) * 4,
+			&theHostWords ))
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				ioCPU->mCurrentRegisters[indexReg] = *theHostWords++;
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+#if FLAG_W
+		// Write back.
+		// Rn == 15 -> UNPREDICTABLE
+		ioCPU->mCurrentRegisters[Rn] = wbAddress;
+#endif
+		if (theRegList & 0x8000)
+		{
+			SETPC( *theHostWords + 4 );   // Prefetch.
+			MMUSMARTCALLNEXT_AFTERSETPC;
+		}
+		CALLNEXTUNIT;
+	}
+
 	// Load.
 #if 0
 	// 5460 loops in debug mode
@@ -177,7 +209,7 @@ LDM1_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 
 	if (theRegList & 0x8000)
 	{
-		MMUCALLNEXT_AFTERSETPC;
+		MMUSMARTCALLNEXT_AFTERSETPC;
 	} else {
 		CALLNEXTUNIT;
 	}
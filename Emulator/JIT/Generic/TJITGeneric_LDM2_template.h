@@ -70,6 +70,59 @@ LDM2_Template(FLAG_P, FLAG_U, Rn)
 	#endif
 #endif
 
+	// Fast path: the whole block is in a single page of ROM or RAM, which
+	// is translated once.
+	const KUInt32* theHostWords;
+	if (!theMemoryInterface->GetBlockPointerR(
+			(TMemory::VAddr) baseAddress,
+			(theImmValue >> 16) * 4,
+			&theHostWords ))
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				ioCPU->mCurrentRegisters[indexReg] = *theHostWords++;
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+		if (bankRegList)
+		{
+			if (bankRegList & 0x0100)
+			{
+				ioCPU->mR8_Bkup = *theHostWords++;
+			}
+			if (bankRegList & 0x0200)
+			{
+				ioCPU->mR9_Bkup = *theHostWords++;
+			}
+			if (bankRegList & 0x0400)
+			{
+				ioCPU->mR10_Bkup = *theHostWords++;
+			}
+			if (bankRegList & 0x0800)
+			{
+				ioCPU->mR11_Bkup = *theHostWords++;
+			}
+			if (bankRegList & 0x1000)
+			{
+				ioCPU->mR12_Bkup = *theHostWords++;
+			}
+			if (bankRegList & 0x2000)
+			{
+				ioCPU->mR13_Bkup = *theHostWords++;
+			}
+			if (bankRegList & 0x4000)
+			{
+				ioCPU->mR14_Bkup = *theHostWords++;
+			}
+		}
+		CALLNEXTUNIT;
+	}
+
 	// Load.
 	int indexReg = 0;
 	while (curRegList)
@@ -152,7 +205,7 @@ LDM2_Template(FLAG_P, FLAG_U, Rn)
 			}
 			baseAddress += 4;
 		}
-		if (bankRegList & 0x3000)
+		if (bankRegList & 0x2000)
 		{
 			if (theMemoryInterface->ReadAligned(
 				(TMemory::VAddr) baseAddress,
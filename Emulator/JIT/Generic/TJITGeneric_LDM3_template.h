@@ -68,6 +68,35 @@ LDM3_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 	#endif
 #endif
 
+	// Fast path: the whole block is in a single page of ROM or RAM, which
+	// is translated once.
+	const KUInt32* theHostWords;
+	if (!theMemoryInterface->GetBlockPointerR(
+			(TMemory::VAddr) baseAddress,
+			(theImmValue >> 16) * 4,
+			&theHostWords ))
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				ioCPU->mCurrentRegisters[indexReg] = *theHostWords++;
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+		SETPC( *theHostWords + 4 );   // Prefetch.
+#if FLAG_W
+		// Write back should occur before the mode change.
+		// Rn == 15 -> UNPREDICTABLE
+		ioCPU->mCurrentRegisters[Rn] = wbAddress;
+#endif
+		ioCPU->SetCPSR( ioCPU->GetSPSR() );
+		MMUCALLNEXT_AFTERSETPC;
+	}
+
 	// Load.
 	int indexReg = 0;
 	while (curRegList)
@@ -95,22 +95,58 @@
 			ioCPU, theMemIntf, pc );						\
 	}
 
+// Jump to a PC computed at run time through the branch cache record that
+// follows the current unit (see TJITGenericPage::PushBranchCache). The record
+// belongs to the call site and remembers its last target, so returns and
+// indirect branches that keep going to the same place skip the lookup.
+// The target is looked up again when its page was retranslated or when its
+// binding has to be checked again (TLB or domain invalidation).
+#define MMUSMARTCALLNEXT_AFTERSETPC \
+	{														\
+		JITUnit* theCache = &ioUnit[1];						\
+		TJITGenericPage* theCachedPage =					\
+			(TJITGenericPage*) theCache[2].fPtr;			\
+		TMemory* theMemIntf = ioCPU->GetMemory();			\
+		if (theCachedPage &&								\
+			(theCache[1].fValue == THEPC) &&				\
+			(theCachedPage->GetLinkGeneration() == theCache[3].fValue) && \
+			(theMemIntf->GetJITObject()->GetPageGeneration( theCachedPage ) \
+				== theCache[4].fValue))						\
+		{													\
+			return (JITUnit*) theCache[5].fPtr;				\
+		}													\
+		return theMemIntf->GetJITObject()->GetCachedJITUnitForPC( \
+			ioCPU, theMemIntf, THEPC, theCache );			\
+	}
+
 #define MMUSMARTCALLNEXT(pc) \
 	{														\
-		static KSInt32 ioUnitOffset = kOffsetUnknown;		\
-	again:													\
-		if (ioUnitOffset<kOffsetUnknown) {					\
-			CALLUNIT(ioUnitOffset);							\
-		} else {											\
-			TMemory* theMemIntf = ioCPU->GetMemory();		\
-			if (ioUnitOffset!=kNotTheSamePage) {			\
-				ioUnitOffset = theMemIntf->GetJITObject()->GetJITUnitDelta(ioCPU, theMemIntf, ioUnit, pc ); \
-				goto again;									\
-			}												\
-			SETPC(pc);										\
-			return theMemIntf->GetJITObject()->GetJITUnitForPC( \
-				ioCPU, theMemIntf, pc );					\
+		SETPC(pc);											\
+		MMUSMARTCALLNEXT_AFTERSETPC;						\
+	}
+
+// Jump to another page through the link record that follows the current
+// unit. The link is resolved (or re-resolved) when the target page was
+// retranslated or invalidated since, or when its binding has to be checked
+// again (TLB or domain invalidation). The target page is touched as
+// GetPage would, so that the cache doesn't evict it as unused.
+#define LINKEDCALLNEXT(pc) \
+	{														\
+		SETPC(pc);											\
+		JITUnit* theLink = &ioUnit[1];						\
+		TJITGenericPage* theLinkedPage =					\
+			(TJITGenericPage*) theLink[1].fPtr;				\
+		TMemory* theMemIntf = ioCPU->GetMemory();			\
+		if (theLinkedPage &&								\
+			(theLinkedPage->GetLinkGeneration() == theLink[2].fValue) && \
+			(theMemIntf->GetJITObject()->GetPageGeneration( theLinkedPage ) \
+				== theLink[3].fValue))						\
+		{													\
+			theMemIntf->GetJITObject()->TouchPage( theLinkedPage ); \
+			return (JITUnit*) theLink[4].fPtr;				\
 		}													\
+		return theMemIntf->GetJITObject()->GetLinkedJITUnitForPC( \
+			ioCPU, theMemIntf, pc, theLink );				\
 	}
 
 #define POPPC() \
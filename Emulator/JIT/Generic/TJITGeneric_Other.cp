@@ -312,23 +312,24 @@ JITInstructionProto(Branch)
 	POPVALUE(theNewPC);
 	
 	// Branch.
-	MMUCALLNEXT(theNewPC);
+	LINKEDCALLNEXT(theNewPC);
 }
 
 // -------------------------------------------------------------------------- //
-//  * Branch within page using a know JITUnit delta.
+//  * Branch within page using a known JITUnit.
+//  Units of a page may live in several blocks when it is translated lazily,
+//  so the target is stored as a pointer rather than as a delta.
 // -------------------------------------------------------------------------- //
 JITInstructionProto(BranchWithinPage)
 {
 	KUInt32 theNewPC;
 	POPVALUE(theNewPC);
 	
-	KSInt32 theDelta;
-	POPVALUE(theDelta);
+	JITUnit* theTarget = (JITUnit*) ioUnit[1].fPtr;
 	
 	// Branch.
 	SETPC(theNewPC);
-	return ioUnit+theDelta;
+	return theTarget;
 }
 
 // -------------------------------------------------------------------------- //
@@ -339,8 +340,8 @@ JITInstructionProto(BranchWithinPageFindDelta)
 	KUInt32 theNewPC;
 	POPVALUE(theNewPC);
 	
-	KSInt32 theDelta;
-	POPVALUE(theDelta);
+	// Skip the target unit, unknown for now.
+	ioUnit++;
 	
 	// MMUCALLNEXT()
 	TMemory *theMemIntf = ioCPU->GetMemory();
@@ -349,11 +350,125 @@ JITInstructionProto(BranchWithinPageFindDelta)
 		->GetJITUnitForPC(ioCPU, theMemIntf, theNewPC);
 	
 	// now change the JIT command to the final fast branch
-	ioUnit[ 0].fValue = (KUInt32)(nextUnit - ioUnit);
+	ioUnit[ 0].fPtr = (KUIntPtr) nextUnit;
 	ioUnit[-2].fFuncPtr = BranchWithinPage;
 	return nextUnit;
 }
 
+// -------------------------------------------------------------------------- //
+//  * IsConditionTrue( TARMProcessor*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static inline Boolean
+IsConditionTrue( TARMProcessor* ioCPU, KUInt32 inCondition )
+{
+	switch (inCondition)
+	{
+		case 0x0:	return ioCPU->TestEQ();
+		case 0x1:	return ioCPU->TestNE();
+		case 0x2:	return ioCPU->TestCS();
+		case 0x3:	return ioCPU->TestCC();
+		case 0x4:	return ioCPU->TestMI();
+		case 0x5:	return ioCPU->TestPL();
+		case 0x6:	return ioCPU->TestVS();
+		case 0x7:	return ioCPU->TestVC();
+		case 0x8:	return ioCPU->TestHI();
+		case 0x9:	return ioCPU->TestLS();
+		case 0xA:	return ioCPU->TestGE();
+		case 0xB:	return ioCPU->TestLT();
+		case 0xC:	return ioCPU->TestGT();
+		case 0xD:	return ioCPU->TestLE();
+		default:	return true;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * CanIdle( TARMProcessor*, const JITUnit* )
+// -------------------------------------------------------------------------- //
+static Boolean
+CanIdle( TARMProcessor* ioCPU, const JITUnit* inLoads )
+{
+	// Only an interrupt the processor takes can end the loop.
+	if ((ioCPU->mCPSR_I && ioCPU->mCPSR_F)
+		|| ioCPU->IsThereAnyHardwareInterruptAsserted()
+		|| (ioCPU->GetEmulator() == NULL))
+	{
+		return false;
+	}
+	
+	// Unless the loop polls a device, whose registers change any time.
+	TMemory* theMemIntf = ioCPU->GetMemory();
+	KUInt32 indexLoad;
+	for (indexLoad = 0; indexLoad < JITPageClass::kMaxIdleLoopLoads; indexLoad++)
+	{
+		KUInt32 theLoad = inLoads[indexLoad].fValue;
+		if (theLoad == 0)
+		{
+			break;
+		}
+		KUInt32 theAddress = ioCPU->mCurrentRegisters[(theLoad >> 16) & 0xF];
+		if (theLoad & 0x00800000)
+		{
+			theAddress += theLoad & 0xFFF;
+		} else {
+			theAddress -= theLoad & 0xFFF;
+		}
+		const KUInt32* thePointer;
+		if (theMemIntf->GetBlockPointerR( theAddress, 4, &thePointer ))
+		{
+			// Device, flash or fault.
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * IdleLoopBranch
+//  Backward branch of a loop that only polls memory (see
+//  TJITGenericPage::IsIdleLoop). The condition is tested here rather than
+//  by a test unit, so that leaving the loop resets the iteration count.
+//  After kIdleLoopSpins iterations in a row, the emulator waits for the next
+//  interrupt.
+// -------------------------------------------------------------------------- //
+JITInstructionProto(IdleLoopBranch)
+{
+	KUInt32 theCondition;
+	POPVALUE(theCondition);
+	KUInt32 theNewPC;
+	POPVALUE(theNewPC);
+	
+	// Target unit, iterations and loads follow.
+	JITUnit* theRecord = &ioUnit[1];
+	if (!IsConditionTrue( ioCPU, theCondition ))
+	{
+		theRecord[1].fValue = 0;
+		CALLUNIT(3 + JITPageClass::kMaxIdleLoopLoads);
+	}
+	
+	JITUnit* theTarget = (JITUnit*) theRecord[0].fPtr;
+	SETPC(theNewPC);
+	if (theTarget == NULL)
+	{
+		TMemory *theMemIntf = ioCPU->GetMemory();
+		theTarget = theMemIntf->GetJITObject()
+			->GetJITUnitForPC(ioCPU, theMemIntf, theNewPC);
+		theRecord[0].fPtr = (KUIntPtr) theTarget;
+	}
+	
+	if (++theRecord[1].fValue >= JITPageClass::kIdleLoopSpins)
+	{
+		theRecord[1].fValue = 0;
+		if (CanIdle( ioCPU, &theRecord[2] ))
+		{
+			// The JIT loop returns to the emulator, which waits.
+			ioCPU->GetEmulator()->IdleSystem();
+		}
+	}
+	
+	return theTarget;
+}
+
 // -------------------------------------------------------------------------- //
 //  * BranchWithLink
 // -------------------------------------------------------------------------- //
@@ -366,11 +481,11 @@ JITInstructionProto(BranchWithLink)
 	
 	// BL
 	ioCPU->mCurrentRegisters[14] = theNewLR;
-	MMUCALLNEXT(theNewPC);
+	LINKEDCALLNEXT(theNewPC);
 }
 
 // -------------------------------------------------------------------------- //
-//  * Branch with link within page using a know JITUnit delta.
+//  * Branch with link within page using a known JITUnit.
 // -------------------------------------------------------------------------- //
 JITInstructionProto(BranchWithLinkWithinPage)
 {
@@ -378,13 +493,13 @@ JITInstructionProto(BranchWithLinkWithinPage)
 	POPVALUE(theNewLR);
 	KUInt32 theNewPC;
 	POPVALUE(theNewPC);
-	KSInt32 theDelta;
-	POPVALUE(theDelta);
+	
+	JITUnit* theTarget = (JITUnit*) ioUnit[1].fPtr;
 	
 	// BL
 	ioCPU->mCurrentRegisters[14] = theNewLR;
 	SETPC(theNewPC);
-	return ioUnit+theDelta;
+	return theTarget;
 }
 
 // -------------------------------------------------------------------------- //
@@ -396,8 +511,8 @@ JITInstructionProto(BranchWithLinkWithinPageFindDelta)
 	POPVALUE(theNewLR);
 	KUInt32 theNewPC;
 	POPVALUE(theNewPC);
-	KSInt32 theDelta;
-	POPVALUE(theDelta);
+	// Skip the target unit, unknown for now.
+	ioUnit++;
 	
 	// set the link register
 	ioCPU->mCurrentRegisters[14] = theNewLR;
@@ -409,7 +524,7 @@ JITInstructionProto(BranchWithLinkWithinPageFindDelta)
 		->GetJITUnitForPC(ioCPU, theMemIntf, theNewPC);
 	
 	// now change the JIT command to the final fast branch
-	ioUnit[ 0].fValue = (KUInt32)(nextUnit - ioUnit);
+	ioUnit[ 0].fPtr = (KUIntPtr) nextUnit;
 	ioUnit[-3].fFuncPtr = BranchWithLinkWithinPage;
 	return nextUnit;
 }
@@ -455,7 +570,7 @@ Translate_Branch(
 			PUSHVALUE(inVAddr + 4);	
 			// The new PC
 			PUSHVALUE(inVAddr + delta + 4);
-			// The branch offset in ioUnits, to be calculated later
+			// The target unit, to be found later
 			PUSHVALUE(0xffffffff);
 		} else {
 			PUSHFUNC(BranchWithLink);
@@ -463,6 +578,8 @@ Translate_Branch(
 			PUSHVALUE(inVAddr + 4);	
 			// The new PC
 			PUSHVALUE(inVAddr + delta + 4);
+			// The link to the target page, to be resolved later
+			inPage->PushLink(ioUnitCrsr);
 		}
 	} else {
 		// optimizing branches within pages gave us a 10% speed increase
@@ -471,16 +588,48 @@ Translate_Branch(
 			PUSHFUNC(BranchWithinPageFindDelta);
 			// The new PC
 			PUSHVALUE(inVAddr + delta + 4);
-			// The branch offset in ioUnits, to be calculated later
+			// The target unit, to be found later
 			PUSHVALUE(0xffffffff);
 		} else {
 			PUSHFUNC(Branch);
 			// The new PC
 			PUSHVALUE(inVAddr + delta + 4);
+			// The link to the target page, to be resolved later
+			inPage->PushLink(ioUnitCrsr);
 		}
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * Translate_IdleLoopBranch
+// -------------------------------------------------------------------------- //
+void
+Translate_IdleLoopBranch(
+				 JITPageClass* inPage,
+				 KUInt16* ioUnitCrsr,
+				 KUInt32 inInstruction,
+				 KUInt32 inVAddr,
+				 const KUInt32 inLoads[] )
+{
+	// -Cond-- 1  0  1  0  ---------------------offset---------------------------- B (backward)
+	KUInt32 offset = ((inInstruction & 0x007FFFFF) << 2) | 0xFE000000;
+	KUInt32 delta = offset + 8;
+	
+	PUSHFUNC(IdleLoopBranch);
+	PUSHVALUE(inInstruction >> 28);
+	// The new PC
+	PUSHVALUE(inVAddr + delta + 4);
+	// The target unit, to be found later
+	PUSHVALUE((KUIntPtr) 0);
+	// Iterations
+	PUSHVALUE((KUIntPtr) 0);
+	KUInt32 indexLoad;
+	for (indexLoad = 0; indexLoad < JITPageClass::kMaxIdleLoopLoads; indexLoad++)
+	{
+		PUSHVALUE(inLoads[indexLoad]);
+	}
+}
+
 // -------------------------------------------------------------------------- //
 //  * SystemBootUND
 // -------------------------------------------------------------------------- //
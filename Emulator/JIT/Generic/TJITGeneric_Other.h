@@ -60,6 +60,16 @@ Translate_Branch(
 					KUInt32 inInstruction,
 					KUInt32 inVAddr );
 
+void
+Translate_IdleLoopBranch(
+					JITPageClass* inPage,
+					KUInt16* ioUnitCrsr,
+					KUInt32 inInstruction,
+					KUInt32 inVAddr,
+					const KUInt32 inLoads[] );
+
+JITInstructionProto(IdleLoopBranch);
+
 JITInstructionProto(SystemBootUND);
 JITInstructionProto(DebuggerUND);
 JITInstructionProto(TapFileCntlUND);
@@ -68,6 +68,38 @@ STM1_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 	#endif
 #endif
 
+	// Fast path: the whole block is in a single page of RAM, which is
+	// translated once.
+	KUInt32* theHostWords;
+	if (!theMemoryInterface->GetBlockPointerW(
+			(TMemory::VAddr) baseAddress,
+			(theImmValue >> 16) * 4,
+			&theHostWords ))
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				*theHostWords++ = ioCPU->mCurrentRegisters[indexReg];
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+		if (theRegList & 0x8000)
+		{
+			// Stored value is PC + 12
+			*theHostWords = GETPC() + 4;
+		}
+#if FLAG_W
+		// Write back.
+		// Rn == 15 -> UNPREDICTABLE
+		ioCPU->mCurrentRegisters[Rn] = wbAddress;
+#endif
+		CALLNEXTUNIT;
+	}
+
 	// Store.
 #if 0
 	// 4850 loops in debug mode
@@ -72,6 +72,64 @@ STM2_Template(FLAG_P, FLAG_U, Rn)
 	#endif
 #endif
 
+	// Fast path: the whole block is in a single page of RAM, which is
+	// translated once.
+	KUInt32* theHostWords;
+	if (!theMemoryInterface->GetBlockPointerW(
+			(TMemory::VAddr) baseAddress,
+			(theImmValue >> 16) * 4,
+			&theHostWords ))
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				*theHostWords++ = ioCPU->mCurrentRegisters[indexReg];
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+		if (bankRegList)
+		{
+			if (bankRegList & 0x0100)
+			{
+				*theHostWords++ = ioCPU->mR8_Bkup;
+			}
+			if (bankRegList & 0x0200)
+			{
+				*theHostWords++ = ioCPU->mR9_Bkup;
+			}
+			if (bankRegList & 0x0400)
+			{
+				*theHostWords++ = ioCPU->mR10_Bkup;
+			}
+			if (bankRegList & 0x0800)
+			{
+				*theHostWords++ = ioCPU->mR11_Bkup;
+			}
+			if (bankRegList & 0x1000)
+			{
+				*theHostWords++ = ioCPU->mR12_Bkup;
+			}
+			if (bankRegList & 0x2000)
+			{
+				*theHostWords++ = ioCPU->mR13_Bkup;
+			}
+			if (bankRegList & 0x4000)
+			{
+				*theHostWords++ = ioCPU->mR14_Bkup;
+			}
+		}
+		if (theRegList & 0x8000)
+		{
+			// Stored value is PC + 12
+			*theHostWords = GETPC() + 4;
+		}
+		CALLNEXTUNIT;
+	}
+
 	// Store.
 	int indexReg = 0;
 	while (curRegList)
@@ -59,6 +59,14 @@
 #include "TJITGeneric_Test_template.h"
 #undef OFFSET
 
+#define OFFSET 8
+#include "TJITGeneric_Test_template.h"
+#undef OFFSET
+
+#define OFFSET 9
+#include "TJITGeneric_Test_template.h"
+#undef OFFSET
+
 #undef Test_Template
 #undef Test_TemplateName
 
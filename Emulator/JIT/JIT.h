@@ -29,6 +29,8 @@
 // Includes the proper header depending on the platform and define the JIT
 // class accordingly.
 	// Default case.
+	// With JITTARGET_X86_64, generic pages also get native code for runs of
+	// simple instructions (see TJITX86_64Code and TJITGenericPage.h).
 	#include "TJITGeneric.h"
 	#define	JITClass		TJITGeneric
 	#define	JITPageClass	TJITGenericPage
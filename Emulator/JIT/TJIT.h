@@ -28,6 +28,7 @@
 
 // Einstein
 #include "TJITCache.h"
+#include "Emulator/ROM/TROMPatchDatabase.h"
 
 // C++
 #include <string>
@@ -72,7 +73,11 @@ public:
 	void			Invalidate(
 						KUInt32 inPAddr )
 		{
-			mCache.InvalidatePage( inPAddr );
+			// Most writes are to pages that were never executed.
+			if (mCache.HasTranslation( inPAddr ))
+			{
+				mCache.InvalidatePage( inPAddr );
+			}
 		}
 
 	///
@@ -83,6 +88,16 @@ public:
 			mCache.InvalidateTLB();
 		}
 
+	///
+	/// Invalidate the V->P bindings that depend on some domains.
+	///
+	/// \param inDomains		one bit per domain whose access changed.
+	///
+	void			InvalidateDomains( KUInt32 inDomains )
+		{
+			mCache.InvalidateDomains( inDomains );
+		}
+
 	///
 	/// One or more steps with JIT.
 	///
@@ -115,6 +130,82 @@ public:
 			return mCache.GetPage( inVAddr );
 		}
 
+	///
+	/// Mark a page as the most recently used one, so that it is not
+	/// evicted while it is only entered through links.
+	///
+	/// \param inPage			page returned by GetPage.
+	///
+	void			TouchPage( TPage* inPage )
+		{
+			mCache.TouchPage( inPage );
+		}
+
+	///
+	/// Get the generation of the binding of a page, to check that a link
+	/// to it is still valid.
+	///
+	/// \param inPage			page returned by GetPage.
+	///
+	KUInt32			GetPageGeneration( TPage* inPage ) const
+		{
+			return mCache.GetPageGeneration( inPage );
+		}
+
+	///
+	/// Change the number of pages kept in the cache.
+	/// The processor must not be running.
+	///
+	/// \param inCacheSize		new number of pages.
+	/// \return true if the size is out of bounds.
+	///
+	Boolean			SetCacheSize( KUInt32 inCacheSize )
+		{
+			return mCache.SetCacheSize( inCacheSize );
+		}
+
+	///
+	/// Accessor on the number of pages kept in the cache.
+	///
+	KUInt32			GetCacheSize( void ) const
+		{
+			return mCache.GetCacheSize();
+		}
+
+	///
+	/// Pin (or unpin) ROM pages in the cache.
+	///
+	/// \param inPinROMPages	whether ROM pages should never be evicted.
+	///
+	void			SetPinROMPages( Boolean inPinROMPages )
+		{
+			mCache.SetPinROMPages( inPinROMPages );
+		}
+
+	///
+	/// Accessor on the pinning of ROM pages.
+	///
+	Boolean			GetPinROMPages( void ) const
+		{
+			return mCache.GetPinROMPages();
+		}
+
+	///
+	/// Accessor on the counters of the cache.
+	///
+	const SJITCacheStats&	GetCacheStats( void ) const
+		{
+			return mCache.GetStats();
+		}
+
+	///
+	/// Reset the counters of the cache.
+	///
+	void			ResetCacheStats( void )
+		{
+			mCache.ResetStats();
+		}
+
 	///
 	/// Get the offset in page.
 	///
@@ -128,8 +219,15 @@ public:
 	/// This function is called to modify the ROM before it is saved on disk.
 	/// It is only called when the image is created.
 	///
-	static void PatchROM(KUInt32* romPointer, const std::string& machineName) {
-	    TImplementation::DoPatchROM(romPointer, machineName);
+	/// \param romPointer	ROM words.
+	/// \param machineName	machine string of the ROM.
+	/// \param inTable		table of the patch database for this ROM or NULL.
+	///
+	static void PatchROM(
+					KUInt32* romPointer,
+					const std::string& machineName,
+					const TROMPatchDatabase::STable* inTable = NULL) {
+	    TImplementation::DoPatchROM(romPointer, machineName, inTable);
 	}
 
     ///	
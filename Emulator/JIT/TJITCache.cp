@@ -40,13 +40,6 @@ using namespace std;
 //#define kTJITCacheStats	1
 #undef kTJITCacheStats
 
-#if kTJITCacheStats
-static KUInt32 gNbHits = 0;					///< Nombre de hits.
-static KUInt32 gNbInvalidatePage = 0;		///< Nombre d'invalidations (pages)
-static KUInt32 gNbInvalidateTLB = 0;		///< Nombre d'invalidations (tlb)
-static KUInt32 gNbMiss = 0;					///< Nombre de ratés.
-#endif
-
 // -------------------------------------------------------------------------- //
 //  * InsertInPMap( KUInt32, SEntry* )
 // -------------------------------------------------------------------------- //
@@ -58,16 +51,21 @@ TJITCache<JITPageClass>::InsertInPMap( KUInt32 inPAddr, SEntry* inEntry )
 	inEntry->mNextPAEntry = *theEntryPtr;
 	*theEntryPtr = inEntry;
 	inEntry->mPhysicalAddress = inPAddr;
+	UpdateTranslatedBit( inPAddr );
 }
 
 // -------------------------------------------------------------------------- //
 //  * EraseFromPMap( SEntry* )
 // -------------------------------------------------------------------------- //
 template<>
-void
+Boolean
 TJITCache<JITPageClass>::EraseFromPMap( SEntry* inEntry )
 {
 	SEntry** theEntryPtr = GetPMapEntryPtr( inEntry->mPhysicalAddress );
+	if (theEntryPtr == NULL)
+	{
+		return false;
+	}
 	SEntry* theEntry = *theEntryPtr;
 	SEntry* thePrevEntry = NULL;
 	while (theEntry)
@@ -87,6 +85,9 @@ TJITCache<JITPageClass>::EraseFromPMap( SEntry* inEntry )
 		thePrevEntry = theEntry;
 		theEntry = theEntry->mNextPAEntry;
 	}
+	UpdateTranslatedBit( inEntry->mPhysicalAddress );
+	
+	return (theEntry != NULL);
 }
 
 // -------------------------------------------------------------------------- //
@@ -124,6 +125,7 @@ TJITCache<JITPageClass>::InitPMap( void )
 	KUInt32 ramSize = mMemoryIntf->GetRAMSize();
 	mPMapSize = (TMemoryConsts::kROMEnd + ramSize) / kPageSize;
 	mPMap = (SEntry**) ::calloc(mPMapSize, sizeof(SEntry*));
+	mTranslatedPages = (KUInt32*) ::calloc((mPMapSize + 31) / 32, sizeof(KUInt32));
 }
 
 // -------------------------------------------------------------------------- //
@@ -134,37 +136,173 @@ void
 TJITCache<JITPageClass>::DeletePMap( void )
 {
 	::free(mPMap);
+	::free(mTranslatedPages);
 }
 
 // -------------------------------------------------------------------------- //
-//  * TJITCache( TMemory*, TMMU* )
+//  * ResetStats( void )
 // -------------------------------------------------------------------------- //
 template<>
-TJITCache<JITPageClass>::TJITCache(
-		TMemory* inMemoryIntf,
-		TMMU* inMMUIntf )
-	:
-		mMemoryIntf( inMemoryIntf ),
-		mMMUIntf( inMMUIntf )
+void
+TJITCache<JITPageClass>::ResetStats( void )
+{
+	mStats.mHits = 0;
+	mStats.mMisses = 0;
+	mStats.mEvictions = 0;
+	mStats.mInvalidatedPages = 0;
+	mStats.mInvalidatedTLBs = 0;
+	mStats.mInvalidatedDomains = 0;
+	mStats.mRevalidations = 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * PinEntry( SEntry* )
+// -------------------------------------------------------------------------- //
+template<>
+void
+TJITCache<JITPageClass>::PinEntry( SEntry* inEntry )
+{
+	if (mPinROMPages
+		&& !inEntry->mPinned
+		&& TMemory::IsPageInROM( inEntry->mPhysicalAddress )
+		&& (mStats.mPinnedPages < (mVMap.GetCacheSize() / 2)))
+	{
+		inEntry->mPinned = true;
+		mStats.mPinnedPages++;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * UnpinEntry( SEntry* )
+// -------------------------------------------------------------------------- //
+template<>
+void
+TJITCache<JITPageClass>::UnpinEntry( SEntry* inEntry )
+{
+	if (inEntry->mPinned)
+	{
+		inEntry->mPinned = false;
+		mStats.mPinnedPages--;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * InitEntries( Boolean )
+// -------------------------------------------------------------------------- //
+template<>
+void
+TJITCache<JITPageClass>::InitEntries( Boolean inEnterROMPages )
 {
-	InitPMap();
-	
 	// Init the entries.
 	// We create up to one entry per ROM page.
 	SEntry* theEntries = mVMap.GetValues();
+	KUInt32 theCacheSize = mVMap.GetCacheSize();
 	KUInt32 indexEntry = 0;
-	KUInt32 theAddress = 0;
-	while (theAddress < TMemoryConsts::kROMEnd && indexEntry < THashMapCache<SEntry>::kCacheSize) {
+	KUInt32 theAddress = inEnterROMPages ? 0 : (KUInt32) TMemoryConsts::kROMEnd;
+	while (theAddress < TMemoryConsts::kROMEnd && indexEntry < theCacheSize) {
 		SEntry* theEntry = &theEntries[indexEntry];
 		theEntry->key = theAddress;
 		theEntry->mPhysicalAddress = theAddress;
-		theEntry->mPage.Init( inMemoryIntf, theAddress, theAddress);
+		theEntry->mGeneration = GetDomainGeneration( TMemoryConsts::kMMUNoDomain );
+		theEntry->mDomain = TMemoryConsts::kMMUNoDomain;
+		theEntry->mPinned = false;
+		theEntry->mPage.Init( mMemoryIntf, theAddress, theAddress);
 		
 		mVMap.Insert(theAddress, theEntry);
 		InsertInPMap(theAddress, theEntry);
+		PinEntry(theEntry);
 		theAddress += kPageSize;
 		indexEntry++;
 	}
+	
+	// Remaining entries are unused: give them unprobable values.
+	while (indexEntry < theCacheSize) {
+		SEntry* theEntry = &theEntries[indexEntry];
+		theEntry->key = 1;
+		theEntry->mPhysicalAddress = 1;
+		theEntry->mNextPAEntry = NULL;
+		theEntry->mGeneration = 0;
+		theEntry->mDomain = TMemoryConsts::kMMUNoDomain;
+		theEntry->mPinned = false;
+		indexEntry++;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * TJITCache( TMemory*, TMMU*, KUInt32 )
+// -------------------------------------------------------------------------- //
+template<>
+TJITCache<JITPageClass>::TJITCache(
+		TMemory* inMemoryIntf,
+		TMMU* inMMUIntf,
+		KUInt32 inCacheSize /* = kDefaultCacheSize */ )
+	:
+		mMemoryIntf( inMemoryIntf ),
+		mMMUIntf( inMMUIntf ),
+		mVMap( inCacheSize ),
+		mPinROMPages( false ),
+		mGeneration( 0 ),
+		mTLBGeneration( 0 )
+{
+	(void) ::memset(mDomainGenerations, 0, sizeof(mDomainGenerations));
+	InitPMap();
+	ResetStats();
+	mStats.mPinnedPages = 0;
+	
+	// The ROM can't be read yet: TMemory enters the ROM pages later.
+	InitEntries( false );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetCacheSize( KUInt32 )
+// -------------------------------------------------------------------------- //
+template<>
+Boolean
+TJITCache<JITPageClass>::SetCacheSize( KUInt32 inCacheSize )
+{
+	if ((inCacheSize < THashMapCache<SEntry>::kMinCacheSize)
+		|| (inCacheSize > THashMapCache<SEntry>::kMaxCacheSize))
+	{
+		return true;
+	}
+	
+	// Forget about all pages.
+	(void) ::memset(mPMap, 0, mPMapSize * sizeof(SEntry*));
+	(void) ::memset(mTranslatedPages, 0, ((mPMapSize + 31) / 32) * sizeof(KUInt32));
+	mStats.mPinnedPages = 0;
+
+	mVMap.Resize( inCacheSize );
+	InitEntries( true );
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetPinROMPages( Boolean )
+// -------------------------------------------------------------------------- //
+template<>
+void
+TJITCache<JITPageClass>::SetPinROMPages( Boolean inPinROMPages )
+{
+	mPinROMPages = inPinROMPages;
+	
+	SEntry* theEntries = mVMap.GetValues();
+	KUInt32 theCacheSize = mVMap.GetCacheSize();
+	KUInt32 indexEntry;
+	for (indexEntry = 0; indexEntry < theCacheSize; indexEntry++)
+	{
+		SEntry* theEntry = &theEntries[indexEntry];
+		if (inPinROMPages)
+		{
+			// Only pin pages that are still translated.
+			if (LookupInPMap( theEntry->key, theEntry->mPhysicalAddress ) == theEntry)
+			{
+				PinEntry( theEntry );
+			}
+		} else {
+			UnpinEntry( theEntry );
+		}
+	}
 }
 
 // -------------------------------------------------------------------------- //
@@ -177,15 +315,16 @@ TJITCache<JITPageClass>::~TJITCache( void )
 }
 
 // -------------------------------------------------------------------------- //
-//  * PageMiss( KUInt32, KUInt32 )
+//  * PageMiss( KUInt32, KUInt32, KUInt32 )
 // -------------------------------------------------------------------------- //
 template<>
 JITPageClass*
-TJITCache<JITPageClass>::PageMiss( KUInt32 inVAddr, KUInt32 inPAddr )
+TJITCache<JITPageClass>::PageMiss(
+			KUInt32 inVAddr,
+			KUInt32 inPAddr,
+			KUInt32 inDomain )
 {
-#if kTJITCacheStats
-	gNbMiss++;
-#endif
+	mStats.mMisses++;
 
 	SEntry** theEntryPtr = GetPMapEntryPtr( inPAddr );
 	if (theEntryPtr == NULL)
@@ -194,33 +333,32 @@ TJITCache<JITPageClass>::PageMiss( KUInt32 inVAddr, KUInt32 inPAddr )
 	}
 		
 	// Take last page.
+	// Pinned ROM pages are skipped: they are touched so they move away from
+	// the end. At most half of the entries are pinned, so this ends.
 	SEntry* theEntry = mVMap.GetLastValue();
+	while (theEntry->mPinned)
+	{
+		mVMap.MakeFirst( theEntry );
+		theEntry = mVMap.GetLastValue();
+	}
 	
 	// Remove it from tables.
 	mVMap.Erase( theEntry->key );
-	
-#if 0
-	// Do not remove entries from the ROM cache.
-	// Keeping a large cache seems to make no difference in performance, but
-	// costs us a lot of RAM. So we don't.
-	if (TMemory::IsPageInROM(theEntry->key)) {
-		SEntry *prevEntry = theEntry;
-		theEntry = (SEntry*)calloc(1, sizeof(struct SEntry));
-		theEntry->prev = prevEntry;
-	} else {
-		EraseFromPMap( theEntry );
+	if (EraseFromPMap( theEntry ))
+	{
+		mStats.mEvictions++;
 	}
-#else
-	EraseFromPMap( theEntry );
-#endif
 
 	// Modify the entry.
 	theEntry->mPage.Init( mMemoryIntf, inVAddr, inPAddr );
 	theEntry->key = inVAddr;
 	
 	// Add it into the tables.
+	theEntry->mGeneration = GetDomainGeneration( inDomain );
+	theEntry->mDomain = inDomain;
 	mVMap.Insert(inVAddr, theEntry);
 	InsertInPMap(inPAddr, theEntry);
+	PinEntry( theEntry );
 	
 	// Finally touch the entry.
 	mVMap.MakeFirst( theEntry );
@@ -236,29 +374,32 @@ JITPageClass*
 TJITCache<JITPageClass>::GetPage( KUInt32 inVAddr )
 {
 #if kTJITCacheStats
-	if ((gNbHits & 0xFF) == 0) {
+	if ((mStats.mHits & 0xFF) == 0) {
 		fprintf(
 			stderr,
-			"Hits: %i, Miss: %i, InvP: %i, InvT: %i\n",
-			gNbHits,
-			gNbMiss,
-			gNbInvalidatePage,
-			gNbInvalidateTLB);
+			"Hits: %i, Miss: %i, Evict: %i, InvP: %i, InvT: %i\n",
+			(int) mStats.mHits,
+			(int) mStats.mMisses,
+			(int) mStats.mEvictions,
+			(int) mStats.mInvalidatedPages,
+			(int) mStats.mInvalidatedTLBs);
 	}
-	gNbHits++;
 #endif
 
 	KUInt32 baseVAddr = inVAddr & kPageMask;
 	SEntry* theEntry;
 	KUInt32 thePAddr;
+	KUInt32 theDomain = TMemoryConsts::kMMUNoDomain;
 
 	// Get a page.
 	// Let's look if we already have it in the cache.
 	theEntry = mVMap.Lookup( baseVAddr );
-	if (theEntry)
+	if (theEntry
+		&& (theEntry->mGeneration == GetDomainGeneration( theEntry->mDomain )))
 	{
 		// Touch the entry.
 		mVMap.MakeFirst(theEntry);
+		mStats.mHits++;
 		return &theEntry->mPage;
 	}
 
@@ -269,6 +410,7 @@ TJITCache<JITPageClass>::GetPage( KUInt32 inVAddr )
 			// An error occurred.
 			return NULL;
 		}
+		theDomain = mMMUIntf->GetInstructionDomain( baseVAddr );
 	} else {
 		thePAddr = baseVAddr;
 	}
@@ -279,16 +421,53 @@ TJITCache<JITPageClass>::GetPage( KUInt32 inVAddr )
 		// If the VMap matches, only the mapping was altered.
 		if (theEntry->key == baseVAddr) {
 			// Re-branch the cache in the table of virtual adresses.
+			// The page may now depend on another domain.
+			KUInt32 theGeneration = GetDomainGeneration( theDomain );
+			theEntry->mDomain = theDomain;
+			if (theEntry->mGeneration != theGeneration)
+			{
+				theEntry->mGeneration = theGeneration;
+				mStats.mRevalidations++;
+			}
 			mVMap.Insert(baseVAddr, theEntry);
 
 			// Touch the entry.
 			mVMap.MakeFirst(theEntry);
+			mStats.mHits++;
 			return &theEntry->mPage;
 		}
 	}
 	
 	// The page is not in the cache.
-	return PageMiss( baseVAddr, thePAddr );
+	return PageMiss( baseVAddr, thePAddr, theDomain );
+}
+
+// -------------------------------------------------------------------------- //
+//  * NextGeneration( void )
+// -------------------------------------------------------------------------- //
+template<>
+KUInt32
+TJITCache<JITPageClass>::NextGeneration( void )
+{
+	mGeneration++;
+	if (mGeneration == 0)
+	{
+		// The counter wrapped: old generations could be mistaken for new
+		// ones. Start over with every binding and every link invalid.
+		mGeneration = 1;
+		mTLBGeneration = 1;
+		(void) ::memset(mDomainGenerations, 0, sizeof(mDomainGenerations));
+		SEntry* theEntries = mVMap.GetValues();
+		KUInt32 indexEntry;
+		KUInt32 theCacheSize = mVMap.GetCacheSize();
+		for (indexEntry = 0; indexEntry < theCacheSize; indexEntry++)
+		{
+			theEntries[indexEntry].mGeneration = 0;
+			theEntries[indexEntry].mPage.InvalidateLinks();
+		}
+	}
+	
+	return mGeneration;
 }
 
 // -------------------------------------------------------------------------- //
@@ -298,12 +477,33 @@ template<>
 void
 TJITCache<JITPageClass>::InvalidateTLB( void )
 {
-#if kTJITCacheStats
-	gNbInvalidateTLB++;
-#endif
+	mStats.mInvalidatedTLBs++;
 
-	// Erase all bindings.
-	mVMap.Clear();
+	// Bindings of an older generation are translated again when they are
+	// used, and kept if the physical page did not change. Links check the
+	// generation of their target page the same way.
+	mTLBGeneration = NextGeneration();
+}
+
+// -------------------------------------------------------------------------- //
+//  * InvalidateDomains( KUInt32 )
+// -------------------------------------------------------------------------- //
+template<>
+void
+TJITCache<JITPageClass>::InvalidateDomains( KUInt32 inDomains )
+{
+	mStats.mInvalidatedDomains++;
+
+	// Only the bindings of these domains get an older generation.
+	KUInt32 theGeneration = NextGeneration();
+	KUInt32 indexDomain;
+	for (indexDomain = 0; indexDomain < TMemoryConsts::kMMUDomainCount; indexDomain++)
+	{
+		if (inDomains & (1 << indexDomain))
+		{
+			mDomainGenerations[indexDomain] = theGeneration;
+		}
+	}
 }
 
 // -------------------------------------------------------------------------- //
@@ -318,17 +518,21 @@ TJITCache<JITPageClass>::InvalidatePage( KUInt32 inPAddr )
 	// Look for page(s).
 	// Remove it/them from the tables.
 	SEntry** theEntryPtr = GetPMapEntryPtr( basePAddr );
+	if (theEntryPtr == NULL)
+	{
+		return;
+	}
 	SEntry* theEntry = *theEntryPtr;
-#if kTJITCacheStats
 	if (theEntry)
 	{
-		gNbInvalidatePage++;
+		mStats.mInvalidatedPages++;
 	}
-#endif
 	while (theEntry)
 	{
 		// Erase the bindings.
 		mVMap.Erase( theEntry->key );
+		theEntry->mPage.InvalidateLinks();
+		UnpinEntry( theEntry );
 
 		// Move the page at the end.
 		mVMap.MakeLast(theEntry);
@@ -339,6 +543,7 @@ TJITCache<JITPageClass>::InvalidatePage( KUInt32 inPAddr )
 		theEntry = theNewEntry;
 	}
 	*theEntryPtr = NULL;
+	UpdateTranslatedBit( basePAddr );
 }
 
 // ============================================================ //
@@ -33,6 +33,20 @@
 class TMemory;
 class TMMU;
 
+///
+/// Counters of the JIT cache, to size it.
+///
+struct SJITCacheStats {
+	KUInt32			mHits;				///< Pages found in the cache.
+	KUInt32			mMisses;			///< Pages translated.
+	KUInt32			mEvictions;			///< Live pages thrown away by a miss.
+	KUInt32			mInvalidatedPages;	///< Pages invalidated by a write.
+	KUInt32			mInvalidatedTLBs;	///< Invalidations of all bindings.
+	KUInt32			mInvalidatedDomains;///< Invalidations of some domains.
+	KUInt32			mRevalidations;		///< Bindings kept after a check.
+	KUInt32			mPinnedPages;		///< ROM pages currently pinned.
+};
+
 ///
 /// Class for the JIT cache.
 ///
@@ -45,12 +59,21 @@ template< class TPage >
 class TJITCache
 {
 public:
+	enum {
+		kDefaultCacheSize	= 128,		///< Default number of pages.
+	};
+
 	///
 	/// Constructor from the memory and the MMU interfaces.
 	///
+	/// \param inMemoryIntf	interface to memory.
+	/// \param inMMUIntf		interface to the MMU.
+	/// \param inCacheSize		number of translated pages to keep.
+	///
 	TJITCache(
 		TMemory* inMemoryIntf,
-		TMMU* inMMUIntf );
+		TMMU* inMMUIntf,
+		KUInt32 inCacheSize = kDefaultCacheSize );
 
 	///
 	/// Destructor.
@@ -66,6 +89,29 @@ public:
 	///
 	TPage*		GetPage( KUInt32 inVAddr );
 	
+	///
+	/// Mark a page as the most recently used one, when it is entered
+	/// without GetPage (e.g. through a link between pages).
+	///
+	/// \param inPage	page returned by GetPage.
+	///
+	void		TouchPage( TPage* inPage )
+		{
+			// mPage is the first field of the entry.
+			mVMap.MakeFirst( (SEntry*) inPage );
+		}
+	
+	///
+	/// Get the generation of the binding of a page.
+	/// It changes when the binding has to be checked again.
+	///
+	/// \param inPage	page returned by GetPage.
+	///
+	KUInt32		GetPageGeneration( TPage* inPage ) const
+		{
+			return GetDomainGeneration( ((SEntry*) inPage)->mDomain );
+		}
+	
 	///
 	/// Get the offset of an instruction in page.
 	///
@@ -78,9 +124,18 @@ public:
 	
 	///
 	/// Invalidate all translations.
+	/// Bindings are not erased: they are checked again when they are used.
 	///
 	void		InvalidateTLB( void );
 
+	///
+	/// Invalidate the translations that depend on some domains.
+	/// Like InvalidateTLB, bindings are checked again when they are used.
+	///
+	/// \param inDomains	one bit per domain whose access changed.
+	///
+	void		InvalidateDomains( KUInt32 inDomains );
+
 	///
 	/// Invalidate a page by physical address.
 	///
@@ -88,6 +143,67 @@ public:
 	///
 	void		InvalidatePage( KUInt32 inPAddr );
 
+	///
+	/// Determine if a physical page has at least one translation.
+	/// This is cheap enough to be called on every memory write.
+	///
+	/// \param inPAddr	physical address of the modified word.
+	/// \return true if the page may have to be invalidated.
+	///
+	Boolean		HasTranslation( KUInt32 inPAddr ) const
+		{
+			KUInt32 theIndex = GetPMapIndex( inPAddr );
+			return (theIndex < mPMapSize)
+				&& ((mTranslatedPages[theIndex / 32] & (1U << (theIndex % 32))) != 0);
+		}
+
+	///
+	/// Change the number of translated pages kept in the cache.
+	/// Every translation is thrown away, so this must not be called while
+	/// the processor is running.
+	///
+	/// \param inCacheSize	new number of pages.
+	/// \return true if the size is out of bounds.
+	///
+	Boolean		SetCacheSize( KUInt32 inCacheSize );
+
+	///
+	/// Accessor on the number of translated pages kept in the cache.
+	///
+	KUInt32		GetCacheSize( void ) const
+		{
+			return mVMap.GetCacheSize();
+		}
+
+	///
+	/// Pin (or unpin) ROM pages, i.e. never evict them on a page miss.
+	/// At most half of the cache can be pinned.
+	///
+	/// \param inPinROMPages	whether ROM pages should be pinned.
+	///
+	void		SetPinROMPages( Boolean inPinROMPages );
+
+	///
+	/// Accessor on the pinning of ROM pages.
+	///
+	Boolean		GetPinROMPages( void ) const
+		{
+			return mPinROMPages;
+		}
+
+	///
+	/// Accessor on the counters.
+	///
+	const SJITCacheStats&	GetStats( void ) const
+		{
+			return mStats;
+		}
+
+	///
+	/// Reset the counters (but the number of pinned pages).
+	///
+	void		ResetStats( void );
+
 protected:
 	struct SEntry {
 		TPage			mPage;
@@ -96,6 +212,9 @@ protected:
 		SEntry*			next;
 		SEntry*			prev;
 		SEntry*			mNextPAEntry;
+		KUInt32			mGeneration;	///< Generation of the binding.
+		KUInt32			mDomain;		///< Domain of the binding.
+		Boolean			mPinned;
 	};
 
 private:
@@ -124,8 +243,52 @@ private:
 	///
 	/// \param inVAddr		new virtual address.
 	/// \param inPAddr		new physical address.
+	/// \param inDomain		domain of the binding.
 	///
-	inline TPage* PageMiss( KUInt32 inVAddr, KUInt32 inPAddr );
+	inline TPage* PageMiss( KUInt32 inVAddr, KUInt32 inPAddr, KUInt32 inDomain );
+
+	///
+	/// Get the current generation of the bindings of a domain.
+	///
+	/// \param inDomain		domain or kMMUNoDomain.
+	///
+	KUInt32		GetDomainGeneration( KUInt32 inDomain ) const
+		{
+			KUInt32 theGeneration = mDomainGenerations[inDomain];
+			if (theGeneration < mTLBGeneration)
+			{
+				theGeneration = mTLBGeneration;
+			}
+			return theGeneration;
+		}
+
+	///
+	/// Get the next generation.
+	/// When the counter wraps, every binding and every link is thrown away.
+	///
+	KUInt32		NextGeneration( void );
+
+	///
+	/// Fill the entries with the first ROM pages.
+	///
+	/// \param inEnterROMPages	false if the ROM can't be read yet, in which
+	///							case every entry is unused.
+	///
+	void	InitEntries( Boolean inEnterROMPages );
+
+	///
+	/// Pin an entry if ROM pages are pinned and there is room for it.
+	///
+	/// \param inEntry		entry that was just translated.
+	///
+	inline void	PinEntry( SEntry* inEntry );
+
+	///
+	/// Unpin an entry.
+	///
+	/// \param inEntry		entry.
+	///
+	inline void	UnpinEntry( SEntry* inEntry );
 
 	///
 	/// Insert into PMap.
@@ -139,8 +302,9 @@ private:
 	/// Erase from PMap.
 	///
 	/// \param inEntry		entry.
+	/// \return true if the entry was in the PMap.
 	///
-	inline void	EraseFromPMap( SEntry* inEntry );
+	inline Boolean	EraseFromPMap( SEntry* inEntry );
 
 	///
 	/// Lookup in PMap.
@@ -162,9 +326,9 @@ private:
 	void	DeletePMap( void );
 
 	///
-	/// Get an index in PMap table.
+	/// Get an index in PMap table (mPMapSize if the address is out of it).
 	///
-	SEntry**	GetPMapEntryPtr( KUInt32 inPAddr ) const
+	KUInt32		GetPMapIndex( KUInt32 inPAddr ) const
 		{
 			if (inPAddr & TMemoryConsts::kROMEndMask) {
 				KUInt32 theOffset = (inPAddr
@@ -172,12 +336,44 @@ private:
 					- TMemoryConsts::kRAMStart) / kPageSize;
 				if (theOffset < mPMapSize)
 				{
-					return &mPMap[theOffset];
+					return theOffset;
 				} else {
-					return NULL;
+					return mPMapSize;
 				}
 			} else {
-				return &mPMap[inPAddr / kPageSize];
+				return inPAddr / kPageSize;
+			}
+		}
+
+	///
+	/// Get an entry pointer in PMap table.
+	///
+	SEntry**	GetPMapEntryPtr( KUInt32 inPAddr ) const
+		{
+			KUInt32 theIndex = GetPMapIndex( inPAddr );
+			if (theIndex < mPMapSize)
+			{
+				return &mPMap[theIndex];
+			} else {
+				return NULL;
+			}
+		}
+
+	///
+	/// Update the translation bit of a page after its PMap entry changed.
+	///
+	void		UpdateTranslatedBit( KUInt32 inPAddr )
+		{
+			KUInt32 theIndex = GetPMapIndex( inPAddr );
+			if (theIndex < mPMapSize)
+			{
+				KUInt32 theBit = (1U << (theIndex % 32));
+				if (mPMap[theIndex])
+				{
+					mTranslatedPages[theIndex / 32] |= theBit;
+				} else {
+					mTranslatedPages[theIndex / 32] &= ~theBit;
+				}
 			}
 		}
 
@@ -188,6 +384,20 @@ private:
 	SEntry**				mPMap;					///< Association by
 													///< physical address.
 	KUInt32					mPMapSize;				///< Size of the PMap.
+	KUInt32*				mTranslatedPages;		///< One bit per PMap
+													///< entry, set if the
+													///< page is translated.
+	Boolean					mPinROMPages;			///< Whether ROM pages
+													///< are pinned.
+	SJITCacheStats			mStats;					///< Counters.
+	KUInt32					mGeneration;			///< Incremented by
+													///< invalidations.
+	KUInt32					mTLBGeneration;			///< Generation of the
+													///< last InvalidateTLB.
+	KUInt32					mDomainGenerations[TMemoryConsts::kMMUDomainCount + 1];
+													///< Generation of the
+													///< last change of each
+													///< domain.
 };
 
 #endif
@@ -0,0 +1,1042 @@
+// ==============================
+// File:			TJITX86_64Code.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#ifdef JITTARGET_X86_64
+
+#include "TJITX86_64Code.h"
+
+// ANSI & POSIX
+#include <stddef.h>
+#include <sys/mman.h>
+
+// Einstein
+#include "TARMProcessor.h"
+#include "TJITGenericPage.h"
+#include "TMemory.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+
+// The emitted code relies on the System V calling convention (ioUnit in rdi,
+// ioCPU in rsi).
+#if defined(__x86_64__) && !defined(_WIN32)
+	#define kX86_64CodeEnabled	1
+#else
+	#define kX86_64CodeEnabled	0
+#endif
+
+#if !defined(MAP_ANON) && defined(MAP_ANONYMOUS)
+	#define MAP_ANON MAP_ANONYMOUS
+#endif
+
+#ifdef MAP_JIT
+	#define kX86_64MapFlags		(MAP_PRIVATE | MAP_ANON | MAP_JIT)
+#else
+	#define kX86_64MapFlags		(MAP_PRIVATE | MAP_ANON)
+#endif
+
+/// Offsets of R0 and of the flags in the processor object (rsi).
+#define kRegistersOffset	offsetof(TARMProcessor, mCurrentRegisters)
+#define kFlagNOffset		offsetof(TARMProcessor, mCPSR_N)
+#define kFlagZOffset		offsetof(TARMProcessor, mCPSR_Z)
+#define kFlagCOffset		offsetof(TARMProcessor, mCPSR_C)
+#define kFlagVOffset		offsetof(TARMProcessor, mCPSR_V)
+
+/// x86 opcodes, prefixes, registers and condition codes we need.
+enum {
+	kX86_REX_W			= 0x48,		///< 64 bits operand size
+	kX86_MovLoad		= 0x8B,		///< mov r32, r/m32
+	kX86_MovStore		= 0x89,		///< mov r/m32, r32
+	kX86_MovImm			= 0xB8,		///< mov r32, imm32 (+ register)
+	kX86_CmpImm8		= 0x80,		///< cmp r/m8, imm8 (with /7)
+	kX86_ModRM_RSI		= 0x86,		///< [rsi + disp32] (+ register << 3)
+	kX86_EAX			= 0,
+	kX86_ECX			= 1,
+	kX86_EDX			= 2,
+	kX86_CondO			= 0x0,		///< overflow
+	kX86_CondC			= 0x2,		///< carry
+	kX86_CondNC			= 0x3,		///< no carry
+	kX86_CondE			= 0x4,		///< equal (zero)
+	kX86_CondNE			= 0x5,		///< not equal (not zero)
+	kX86_CondS			= 0x8,		///< sign
+};
+
+// -------------------------------------------------------------------------- //
+// Variables
+// -------------------------------------------------------------------------- //
+static Boolean gX86_64CodeEnabled = true;
+static KUInt32 gX86_64TotalNativeCount = 0;
+
+// -------------------------------------------------------------------------- //
+//  * TJITX86_64Code( void )
+// -------------------------------------------------------------------------- //
+TJITX86_64Code::TJITX86_64Code( void )
+	:
+		mCode( NULL ),
+		mCursor( NULL ),
+		mNativeCount( 0 )
+{
+}
+
+// -------------------------------------------------------------------------- //
+//  * ~TJITX86_64Code( void )
+// -------------------------------------------------------------------------- //
+TJITX86_64Code::~TJITX86_64Code( void )
+{
+	if (mCode)
+	{
+		(void) ::munmap( mCode, kCodeSize );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * CanCompile( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::CanCompile( KUInt32 inInstruction )
+{
+	KUInt32 theCondition = inInstruction >> 28;
+	if (theCondition == 0xF)
+	{
+		// NV: never executed.
+		return false;
+	}
+
+	switch ((inInstruction >> 26) & 0x3)
+	{
+		case 0x0:
+			return CanCompileDataProcessing( inInstruction );
+
+		case 0x1:
+			return CanCompileSingleDataTransfer( inInstruction );
+
+		case 0x2:
+			// -Cond-- 1  0  1  L  ---------------------offset----------------------------
+			// Only the condition of branches is compiled, their threaded
+			// unit follows the test unit. Short backward branches may be
+			// translated as idle loops, which test the condition themselves.
+			return ((inInstruction & 0x0E000000) == 0x0A000000)
+				&& (theCondition != 0xE)
+				&& ((inInstruction & 0x0F800000) != 0x0A800000);
+
+		default:
+			return false;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * CanCompileDataProcessing( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::CanCompileDataProcessing( KUInt32 inInstruction )
+{
+	// -Cond-- 0  0  I  --Opcode-- S  --Rn--- --Rd--- -------Operand 2-------
+	KUInt32 theOpcode = (inInstruction >> 21) & 0xF;
+	if ((theOpcode >= 0x8) && (theOpcode <= 0xB)
+		&& !(inInstruction & 0x00100000))
+	{
+		// Test operations without S are PSR transfers.
+		return false;
+	}
+
+	// Writing R15 is left to the threaded code (branches, mode changes).
+	if (((inInstruction >> 12) & 0xF) == 15)
+	{
+		return false;
+	}
+
+	if (!(inInstruction & 0x02000000))
+	{
+		// Shifts by register (and multiply & swap) are not compiled.
+		if (inInstruction & 0x00000010)
+		{
+			return false;
+		}
+		return CanCompileShift( inInstruction );
+	}
+
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * CanCompileSingleDataTransfer( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::CanCompileSingleDataTransfer( KUInt32 inInstruction )
+{
+	// -Cond-- 0  1  I  P  U  B  W  L  --Rn--- --Rd--- -----------offset----------
+	KUInt32 Rn = (inInstruction >> 16) & 0xF;
+	KUInt32 Rd = (inInstruction >> 12) & 0xF;
+
+	// PC relative loads from the ROM are constants in the threaded code and
+	// loading R15 is a branch.
+	if ((Rn == 15) || (Rd == 15))
+	{
+		return false;
+	}
+
+	Boolean isPreIndexed = (inInstruction & 0x01000000) != 0;
+	Boolean isWriteBack = (inInstruction & 0x00200000) != 0;
+	if (!isPreIndexed && isWriteBack)
+	{
+		// Unprivileged accesses are not compiled.
+		return false;
+	}
+	isWriteBack = isWriteBack || !isPreIndexed;
+	if (isWriteBack && (Rn == Rd))
+	{
+		return false;
+	}
+
+	if (inInstruction & 0x02000000)
+	{
+		// Register offset (bit 4 is an undefined instruction).
+		KUInt32 Rm = inInstruction & 0xF;
+		if ((inInstruction & 0x00000010) || (Rm == 15))
+		{
+			return false;
+		}
+		if (isWriteBack && (Rm == Rn))
+		{
+			return false;
+		}
+		return CanCompileShift( inInstruction );
+	}
+
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * CanCompileShift( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::CanCompileShift( KUInt32 inInstruction )
+{
+	// LSR #32, ASR #32 and RRX are not compiled.
+	KUInt32 theShiftType = (inInstruction >> 5) & 0x3;
+	KUInt32 theAmount = (inInstruction >> 7) & 0x1F;
+	return (theShiftType == 0) || (theAmount != 0);
+}
+
+// -------------------------------------------------------------------------- //
+//  * IsAvailable( void )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::IsAvailable( void )
+{
+	return kX86_64CodeEnabled;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetEnabled( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::SetEnabled( Boolean inEnabled )
+{
+	gX86_64CodeEnabled = inEnabled;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetTotalNativeCount( void )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Code::GetTotalNativeCount( void )
+{
+	return gX86_64TotalNativeCount;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Reset( void )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::Reset( void )
+{
+	// The buffer is kept, pages are recycled by the cache. The units of a
+	// recycled page are translated again and don't point to the old code.
+	mCursor = mCode;
+	mNativeCount = 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitRun( JITUnit* const*, const KUInt32*, KUInt32, KUInt32, JITUnit* )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::EmitRun(
+				JITUnit* const* inInstructionUnits,
+				const KUInt32* inInstructions,
+				KUInt32 inVAddr,
+				KUInt32 inCount,
+				JITUnit* inNextUnit )
+{
+#if kX86_64CodeEnabled
+	if ((!gX86_64CodeEnabled) || (inCount == 0))
+	{
+		return;
+	}
+
+	// Every instruction of the page is emitted at most once between two
+	// resets, so the buffer is allocated once with room for all of them.
+	if (mCode == NULL)
+	{
+		void* theCode = ::mmap(
+						NULL, kCodeSize,
+						PROT_READ | PROT_WRITE,
+						kX86_64MapFlags, -1, 0 );
+		if (theCode == MAP_FAILED)
+		{
+			return;
+		}
+		mCode = (KUInt8*) theCode;
+		mCursor = mCode;
+	} else if (::mprotect( mCode, kCodeSize, PROT_READ | PROT_WRITE ) != 0) {
+		return;
+	}
+	if ((KUInt32) (mCode + kCodeSize - mCursor)
+		< inCount * kMaxBytesPerInstruction)
+	{
+		(void) ::mprotect( mCode, kCodeSize, PROT_READ | PROT_EXEC );
+		return;
+	}
+
+	KUInt8* theEntries[kMaxInstructionCount];
+	KUInt32 theRunCount = 0;
+
+	KUInt32 indexInstr;
+	Boolean isNative = CanCompile( inInstructions[0] );
+	for (indexInstr = 0; indexInstr < inCount; indexInstr++)
+	{
+		KUInt32 indexNext = indexInstr + 1;
+		Boolean nextIsNative =
+			(indexNext < inCount) && CanCompile( inInstructions[indexNext] );
+		if (isNative)
+		{
+			JITUnit* theNextUnit;
+			if (indexNext < inCount)
+			{
+				theNextUnit = inInstructionUnits[indexNext];
+			} else {
+				theNextUnit = inNextUnit;
+			}
+			theEntries[indexInstr] = EmitInstruction(
+				inInstructions[indexInstr],
+				inVAddr + (indexInstr * 4),
+				inInstructionUnits[indexInstr],
+				theNextUnit,
+				nextIsNative );
+			theRunCount++;
+		} else {
+			theEntries[indexInstr] = NULL;
+		}
+		isNative = nextIsNative;
+	}
+
+	// Patch the units once all the code is there and executable.
+	if (::mprotect( mCode, kCodeSize, PROT_READ | PROT_EXEC ) != 0)
+	{
+		return;
+	}
+	mNativeCount += theRunCount;
+	gX86_64TotalNativeCount += theRunCount;
+	for (indexInstr = 0; indexInstr < inCount; indexInstr++)
+	{
+		if (theEntries[indexInstr])
+		{
+			inInstructionUnits[indexInstr]->fFuncPtr =
+				(JITFuncPtr) theEntries[indexInstr];
+		}
+	}
+#else
+	(void) inInstructionUnits;
+	(void) inInstructions;
+	(void) inVAddr;
+	(void) inCount;
+	(void) inNextUnit;
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitInstruction( KUInt32, KUInt32, JITUnit*, JITUnit*, Boolean )
+// -------------------------------------------------------------------------- //
+KUInt8*
+TJITX86_64Code::EmitInstruction(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				JITUnit* inUnit,
+				JITUnit* inNextUnit,
+				Boolean inNextIsNative )
+{
+	KUInt8* theEntry = mCursor;
+
+	KUInt8* theSkips[kMaxConditionJumps];
+	KUInt32 theSkipCount = EmitCondition( inInstruction >> 28, theSkips );
+
+	KUInt8* theDataAbort = NULL;
+	switch ((inInstruction >> 26) & 0x3)
+	{
+		case 0x0:
+			EmitDataProcessing( inInstruction, inVAddr );
+			break;
+
+		case 0x1:
+			theDataAbort = EmitSingleDataTransfer( inInstruction );
+			break;
+
+		case 0x2:
+			// The threaded branch follows the test unit.
+			Emit8( 0x48 ); Emit8( 0xBF );				// mov rdi, imm64
+			Emit64( (KUIntPtr) &inUnit[1] );
+			Emit8( 0xFF ); Emit8( 0x27 );				// jmp [rdi]
+			break;
+	}
+
+	// If the condition fails, continue with the next instruction.
+	KUInt32 indexSkip;
+	for (indexSkip = 0; indexSkip < theSkipCount; indexSkip++)
+	{
+		PatchJump( theSkips[indexSkip] );
+	}
+	KUInt8* theNextCode = EmitContinue( inNextUnit, inNextIsNative );
+
+	if (theDataAbort)
+	{
+		PatchJump( theDataAbort );
+		EmitDataAbort( inVAddr );
+	}
+
+	if (theNextCode)
+	{
+		PatchContinue( theNextCode );
+	}
+
+	return theEntry;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitCondition( KUInt32, KUInt8*[] )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Code::EmitCondition(
+				KUInt32 inCondition,
+				KUInt8* outJumps[kMaxConditionJumps] )
+{
+	// Flags are Booleans: 0 or 1.
+	KUInt32 theCount = 0;
+	KUInt8* thePass = NULL;
+	switch (inCondition)
+	{
+		case 0x0:	// EQ: Z set
+			EmitFlagAccess( kX86_CmpImm8, kFlagZOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondE );
+			break;
+
+		case 0x1:	// NE: Z clear
+			EmitFlagAccess( kX86_CmpImm8, kFlagZOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondNE );
+			break;
+
+		case 0x2:	// CS: C set
+			EmitFlagAccess( kX86_CmpImm8, kFlagCOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondE );
+			break;
+
+		case 0x3:	// CC: C clear
+			EmitFlagAccess( kX86_CmpImm8, kFlagCOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondNE );
+			break;
+
+		case 0x4:	// MI: N set
+			EmitFlagAccess( kX86_CmpImm8, kFlagNOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondE );
+			break;
+
+		case 0x5:	// PL: N clear
+			EmitFlagAccess( kX86_CmpImm8, kFlagNOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondNE );
+			break;
+
+		case 0x6:	// VS: V set
+			EmitFlagAccess( kX86_CmpImm8, kFlagVOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondE );
+			break;
+
+		case 0x7:	// VC: V clear
+			EmitFlagAccess( kX86_CmpImm8, kFlagVOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondNE );
+			break;
+
+		case 0x8:	// HI: C set and Z clear
+			EmitFlagAccess( kX86_CmpImm8, kFlagCOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondE );
+			EmitFlagAccess( kX86_CmpImm8, kFlagZOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondNE );
+			break;
+
+		case 0x9:	// LS: C clear or Z set
+			EmitFlagAccess( kX86_CmpImm8, kFlagCOffset ); Emit8( 0 );
+			thePass = EmitJump( kX86_CondE );
+			EmitFlagAccess( kX86_CmpImm8, kFlagZOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondE );
+			break;
+
+		case 0xA:	// GE: N equals V
+		case 0xB:	// LT: N differs from V
+			Emit8( 0x8A ); Emit8( kX86_ModRM_RSI );		// mov al, [N]
+			Emit32( (KUInt32) kFlagNOffset );
+			Emit8( 0x3A ); Emit8( kX86_ModRM_RSI );		// cmp al, [V]
+			Emit32( (KUInt32) kFlagVOffset );
+			outJumps[theCount++] =
+				EmitJump( (inCondition == 0xA) ? kX86_CondNE : kX86_CondE );
+			break;
+
+		case 0xC:	// GT: Z clear and N equals V
+			EmitFlagAccess( kX86_CmpImm8, kFlagZOffset ); Emit8( 0 );
+			outJumps[theCount++] = EmitJump( kX86_CondNE );
+			Emit8( 0x8A ); Emit8( kX86_ModRM_RSI );		// mov al, [N]
+			Emit32( (KUInt32) kFlagNOffset );
+			Emit8( 0x3A ); Emit8( kX86_ModRM_RSI );		// cmp al, [V]
+			Emit32( (KUInt32) kFlagVOffset );
+			outJumps[theCount++] = EmitJump( kX86_CondNE );
+			break;
+
+		case 0xD:	// LE: Z set or N differs from V
+			EmitFlagAccess( kX86_CmpImm8, kFlagZOffset ); Emit8( 0 );
+			thePass = EmitJump( kX86_CondNE );
+			Emit8( 0x8A ); Emit8( kX86_ModRM_RSI );		// mov al, [N]
+			Emit32( (KUInt32) kFlagNOffset );
+			Emit8( 0x3A ); Emit8( kX86_ModRM_RSI );		// cmp al, [V]
+			Emit32( (KUInt32) kFlagVOffset );
+			outJumps[theCount++] = EmitJump( kX86_CondE );
+			break;
+
+		default:	// AL
+			break;
+	}
+
+	if (thePass)
+	{
+		PatchJump( thePass );
+	}
+
+	return theCount;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitDataProcessing( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::EmitDataProcessing( KUInt32 inInstruction, KUInt32 inVAddr )
+{
+	KUInt32 theOpcode = (inInstruction >> 21) & 0xF;
+	KUInt32 Rn = (inInstruction >> 16) & 0xF;
+	KUInt32 Rd = (inInstruction >> 12) & 0xF;
+	Boolean setFlags = (inInstruction & 0x00100000) != 0;
+	Boolean isMove = (theOpcode == 0xD) || (theOpcode == 0xF);
+	Boolean isTest = (theOpcode >= 0x8) && (theOpcode <= 0xB);
+
+	// AND, EOR, TST, TEQ, ORR, MOV, BIC and MVN set C from the shifter.
+	Boolean isLogical;
+	switch (theOpcode)
+	{
+		case 0x0: case 0x1: case 0x8: case 0x9:
+		case 0xC: case 0xD: case 0xE: case 0xF:
+			isLogical = true;
+			break;
+
+		default:
+			isLogical = false;
+	}
+
+	// Operand 2 goes in ecx.
+	EmitOperand2( inInstruction, inVAddr, setFlags && isLogical );
+
+	// Result goes in eax.
+	if (!isMove)
+	{
+		EmitLoadRegister( kX86_EAX, Rn, inVAddr );
+	}
+
+	// The condition code to get C from the x86 carry (ARM C is the
+	// opposite of the borrow of subtractions).
+	KUInt8 theCarry = kX86_CondC;
+	switch (theOpcode)
+	{
+		case 0x0:	// AND
+		case 0x8:	// TST
+			Emit8( 0x21 ); Emit8( 0xC8 );		// and eax, ecx
+			break;
+
+		case 0x1:	// EOR
+		case 0x9:	// TEQ
+			Emit8( 0x31 ); Emit8( 0xC8 );		// xor eax, ecx
+			break;
+
+		case 0x2:	// SUB
+		case 0xA:	// CMP
+			Emit8( 0x29 ); Emit8( 0xC8 );		// sub eax, ecx
+			theCarry = kX86_CondNC;
+			break;
+
+		case 0x3:	// RSB
+			Emit8( 0x29 ); Emit8( 0xC1 );		// sub ecx, eax
+			Emit8( 0x89 ); Emit8( 0xC8 );		// mov eax, ecx
+			theCarry = kX86_CondNC;
+			break;
+
+		case 0x4:	// ADD
+		case 0xB:	// CMN
+			Emit8( 0x01 ); Emit8( 0xC8 );		// add eax, ecx
+			break;
+
+		case 0x5:	// ADC
+			Emit8( 0x8A );						// mov dl, [C]
+			Emit8( kX86_ModRM_RSI | (kX86_EDX << 3) );
+			Emit32( (KUInt32) kFlagCOffset );
+			Emit8( 0x80 ); Emit8( 0xC2 );		// add dl, 0xFF (x86 carry = C)
+			Emit8( 0xFF );
+			Emit8( 0x11 ); Emit8( 0xC8 );		// adc eax, ecx
+			break;
+
+		case 0x6:	// SBC
+			EmitFlagAccess( kX86_CmpImm8, kFlagCOffset );	// cmp [C], 1
+			Emit8( 1 );							// (x86 carry = !C)
+			Emit8( 0x19 ); Emit8( 0xC8 );		// sbb eax, ecx
+			theCarry = kX86_CondNC;
+			break;
+
+		case 0x7:	// RSC
+			EmitFlagAccess( kX86_CmpImm8, kFlagCOffset );	// cmp [C], 1
+			Emit8( 1 );							// (x86 carry = !C)
+			Emit8( 0x19 ); Emit8( 0xC1 );		// sbb ecx, eax
+			Emit8( 0x89 ); Emit8( 0xC8 );		// mov eax, ecx
+			theCarry = kX86_CondNC;
+			break;
+
+		case 0xC:	// ORR
+			Emit8( 0x09 ); Emit8( 0xC8 );		// or eax, ecx
+			break;
+
+		case 0xD:	// MOV
+			Emit8( 0x89 ); Emit8( 0xC8 );		// mov eax, ecx
+			break;
+
+		case 0xE:	// BIC
+			Emit8( 0xF7 ); Emit8( 0xD1 );		// not ecx
+			Emit8( 0x21 ); Emit8( 0xC8 );		// and eax, ecx
+			break;
+
+		case 0xF:	// MVN
+			Emit8( 0xF7 ); Emit8( 0xD1 );		// not ecx
+			Emit8( 0x89 ); Emit8( 0xC8 );		// mov eax, ecx
+			break;
+	}
+
+	if (setFlags)
+	{
+		if (isMove)
+		{
+			Emit8( 0x85 ); Emit8( 0xC0 );		// test eax, eax
+		}
+		EmitFlagAccess( 0x90 | kX86_CondS, kFlagNOffset );	// sets [N]
+		EmitFlagAccess( 0x90 | kX86_CondE, kFlagZOffset );	// sete [Z]
+		if (!isLogical)
+		{
+			EmitFlagAccess( 0x90 | theCarry, kFlagCOffset );	// setc/setnc [C]
+			EmitFlagAccess( 0x90 | kX86_CondO, kFlagVOffset );	// seto [V]
+		}
+	}
+
+	if (!isTest)
+	{
+		EmitStoreRegister( kX86_EAX, Rd );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitSingleDataTransfer( KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt8*
+TJITX86_64Code::EmitSingleDataTransfer( KUInt32 inInstruction )
+{
+	KUInt32 Rn = (inInstruction >> 16) & 0xF;
+	KUInt32 Rd = (inInstruction >> 12) & 0xF;
+	Boolean isPreIndexed = (inInstruction & 0x01000000) != 0;
+	Boolean isUp = (inInstruction & 0x00800000) != 0;
+	Boolean isByte = (inInstruction & 0x00400000) != 0;
+	Boolean isWriteBack = (!isPreIndexed) || (inInstruction & 0x00200000);
+	Boolean isLoad = (inInstruction & 0x00100000) != 0;
+
+	// The offset goes in ecx (R15 is neither Rn nor Rm).
+	if (inInstruction & 0x02000000)
+	{
+		EmitOperand2( inInstruction & ~0x02000000, 0, false );
+	} else {
+		Emit8( kX86_MovImm | kX86_ECX );		// mov ecx, imm32
+		Emit32( inInstruction & 0x00000FFF );
+	}
+
+	// The address goes in eax, the written back base in ecx.
+	EmitLoadRegister( kX86_EAX, Rn, 0 );
+	KUInt8 theOperation = isUp ? 0x01 : 0x29;	// add or sub
+	if (isPreIndexed)
+	{
+		Emit8( theOperation ); Emit8( 0xC8 );	// add/sub eax, ecx
+		if (isWriteBack)
+		{
+			Emit8( 0x89 ); Emit8( 0xC1 );		// mov ecx, eax
+		}
+	} else {
+		Emit8( 0x89 ); Emit8( 0xC2 );			// mov edx, eax
+		Emit8( theOperation ); Emit8( 0xCA );	// add/sub edx, ecx
+		Emit8( 0x89 ); Emit8( 0xD1 );			// mov ecx, edx
+	}
+
+	// The register to load or the value to store goes in edx.
+	if (isLoad)
+	{
+		Emit8( kX86_MovImm | kX86_EDX );		// mov edx, imm32
+		Emit32( Rd );
+	} else {
+		EmitLoadRegister( kX86_EDX, Rd, 0 );
+	}
+
+	KUIntPtr theFunction;
+	if (isLoad)
+	{
+		theFunction = isByte ? (KUIntPtr) LoadByte : (KUIntPtr) Load;
+	} else {
+		theFunction = isByte ? (KUIntPtr) StoreByte : (KUIntPtr) Store;
+	}
+
+	// Units are tail called, rsp is 8 bytes off a 16 bytes boundary as
+	// after a call: two pushes and 8 bytes align it again.
+	Emit8( 0x56 );								// push rsi
+	Emit8( 0x51 );								// push rcx
+	Emit8( 0x48 ); Emit8( 0x83 ); Emit8( 0xEC );	// sub rsp, 8
+	Emit8( 0x08 );
+	Emit8( 0x48 ); Emit8( 0x89 ); Emit8( 0xF7 );	// mov rdi, rsi
+	Emit8( 0x89 ); Emit8( 0xC6 );				// mov esi, eax
+	Emit8( 0x48 ); Emit8( 0xB8 );				// mov rax, imm64
+	Emit64( theFunction );
+	Emit8( 0xFF ); Emit8( 0xD0 );				// call rax
+	Emit8( 0x48 ); Emit8( 0x83 ); Emit8( 0xC4 );	// add rsp, 8
+	Emit8( 0x08 );
+	Emit8( 0x59 );								// pop rcx
+	Emit8( 0x5E );								// pop rsi
+	Emit8( 0x84 ); Emit8( 0xC0 );				// test al, al
+	KUInt8* theDataAbort = EmitJump( kX86_CondNE );
+
+	if (isWriteBack)
+	{
+		EmitStoreRegister( kX86_ECX, Rn );
+	}
+
+	return theDataAbort;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitOperand2( KUInt32, KUInt32, Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::EmitOperand2(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				Boolean inSetCarry )
+{
+	if (inInstruction & 0x02000000)
+	{
+		KUInt32 theImmValue = inInstruction & 0xFF;
+		KUInt32 theRotateAmount = ((inInstruction >> 8) & 0xF) * 2;
+		if (theRotateAmount != 0)
+		{
+			theImmValue =
+				(theImmValue >> theRotateAmount)
+				| (theImmValue << (32 - theRotateAmount));
+			if (inSetCarry)
+			{
+				// C is bit 31 of the rotated value.
+				Emit8( 0xC6 ); Emit8( kX86_ModRM_RSI );		// mov [C], imm8
+				Emit32( (KUInt32) kFlagCOffset );
+				Emit8( (KUInt8) (theImmValue >> 31) );
+			}
+		}
+		Emit8( kX86_MovImm | kX86_ECX );		// mov ecx, imm32
+		Emit32( theImmValue );
+	} else {
+		EmitLoadRegister( kX86_ECX, inInstruction & 0xF, inVAddr );
+		KUInt32 theAmount = (inInstruction >> 7) & 0x1F;
+		if (theAmount)
+		{
+			// The x86 carry is the last bit shifted out, like ARM's.
+			static const KUInt8 kShiftModRM[4] = {
+				0xE1,	// shl ecx, imm8
+				0xE9,	// shr ecx, imm8
+				0xF9,	// sar ecx, imm8
+				0xC9	// ror ecx, imm8
+			};
+			Emit8( 0xC1 );
+			Emit8( kShiftModRM[(inInstruction >> 5) & 0x3] );
+			Emit8( (KUInt8) theAmount );
+			if (inSetCarry)
+			{
+				EmitFlagAccess( 0x90 | kX86_CondC, kFlagCOffset );	// setc [C]
+			}
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitContinue( JITUnit*, Boolean )
+// -------------------------------------------------------------------------- //
+KUInt8*
+TJITX86_64Code::EmitContinue( JITUnit* inNextUnit, Boolean inNextIsNative )
+{
+	KUInt8* theNextCode = NULL;
+	Emit8( 0x48 ); Emit8( 0xBF );				// mov rdi, imm64
+	Emit64( (KUIntPtr) inNextUnit );
+	if (inNextIsNative)
+	{
+		// The code of the next instruction follows this one. Fall thru
+		// unless the unit was changed (e.g. Halt when stepping).
+		Emit8( 0x48 ); Emit8( 0xB8 );			// mov rax, imm64
+		theNextCode = mCursor;
+		Emit64( 0 );							// (patched)
+		Emit8( 0x48 ); Emit8( 0x39 ); Emit8( 0x07 );	// cmp [rdi], rax
+		Emit8( 0x74 ); Emit8( 0x02 );			// je rel8 (patched)
+	}
+	Emit8( 0xFF ); Emit8( 0x27 );				// jmp [rdi]
+
+	return theNextCode;
+}
+
+// -------------------------------------------------------------------------- //
+//  * PatchContinue( KUInt8* )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::PatchContinue( KUInt8* inNextCode )
+{
+	KUInt8* theCursor = mCursor;
+	mCursor = inNextCode;
+	Emit64( (KUIntPtr) theCursor );
+	mCursor += 4;								// cmp [rdi], rax & je
+	Emit8( (KUInt8) (theCursor - (mCursor + 1)) );
+	mCursor = theCursor;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitDataAbort( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::EmitDataAbort( KUInt32 inVAddr )
+{
+	EmitLoadRegister( kX86_EAX, 15, inVAddr );	// PC + 8
+	EmitStoreRegister( kX86_EAX, 15 );
+	Emit8( 0x48 ); Emit8( 0xB8 );				// mov rax, imm64
+	Emit64( (KUIntPtr) DataAbort );
+	Emit8( 0xFF ); Emit8( 0xE0 );				// jmp rax
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitLoadRegister( KUInt8, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::EmitLoadRegister(
+				KUInt8 inX86Register,
+				KUInt32 inRegister,
+				KUInt32 inVAddr )
+{
+	if (inRegister == 15)
+	{
+		Emit8( kX86_MovImm | inX86Register );	// mov r32, imm32
+		Emit32( inVAddr + 8 );
+	} else {
+		Emit8( kX86_MovLoad );					// mov r32, [rsi + disp32]
+		Emit8( kX86_ModRM_RSI | (inX86Register << 3) );
+		Emit32( (KUInt32) (kRegistersOffset + (inRegister * sizeof(KUInt32))) );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitStoreRegister( KUInt8, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::EmitStoreRegister( KUInt8 inX86Register, KUInt32 inRegister )
+{
+	if (sizeof(KUInt32) == 8)
+	{
+		// The 32 bits operations cleared the upper half of the register.
+		Emit8( kX86_REX_W );
+	}
+	Emit8( kX86_MovStore );						// mov [rsi + disp32], r32
+	Emit8( kX86_ModRM_RSI | (inX86Register << 3) );
+	Emit32( (KUInt32) (kRegistersOffset + (inRegister * sizeof(KUInt32))) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitFlagAccess( KUInt8, KUIntPtr )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::EmitFlagAccess( KUInt8 inOpcode, KUIntPtr inFlag )
+{
+	if (inOpcode == kX86_CmpImm8)
+	{
+		Emit8( kX86_CmpImm8 );					// cmp byte [rsi + disp32], imm8
+		Emit8( kX86_ModRM_RSI | (7 << 3) );
+	} else {
+		Emit8( 0x0F );							// setcc byte [rsi + disp32]
+		Emit8( inOpcode );
+		Emit8( kX86_ModRM_RSI );
+	}
+	Emit32( (KUInt32) inFlag );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitJump( KUInt8 )
+// -------------------------------------------------------------------------- //
+KUInt8*
+TJITX86_64Code::EmitJump( KUInt8 inCondition )
+{
+	Emit8( 0x0F ); Emit8( 0x80 | inCondition );	// jcc rel32
+	KUInt8* theJump = mCursor;
+	Emit32( 0 );								// (patched)
+	return theJump;
+}
+
+// -------------------------------------------------------------------------- //
+//  * PatchJump( KUInt8* )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::PatchJump( KUInt8* inJump )
+{
+	KUInt8* theCursor = mCursor;
+	mCursor = inJump;
+	Emit32( (KUInt32) (theCursor - (inJump + 4)) );
+	mCursor = theCursor;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Emit32( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::Emit32( KUInt32 inWord )
+{
+	// x86 is little endian.
+	Emit8( (KUInt8) (inWord & 0xFF) );
+	Emit8( (KUInt8) ((inWord >> 8) & 0xFF) );
+	Emit8( (KUInt8) ((inWord >> 16) & 0xFF) );
+	Emit8( (KUInt8) ((inWord >> 24) & 0xFF) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Emit64( KUIntPtr )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Code::Emit64( KUIntPtr inWord )
+{
+	Emit32( (KUInt32) (inWord & 0xFFFFFFFF) );
+	Emit32( (KUInt32) ((((KUInt64) inWord) >> 32) & 0xFFFFFFFF) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Load( TARMProcessor*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::Load(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inRegister )
+{
+	KUInt32 theData;
+	if (ioCPU->GetMemory()->Read( inAddress, theData ))
+	{
+		return true;
+	}
+	ioCPU->mCurrentRegisters[inRegister] = theData;
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * LoadByte( TARMProcessor*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::LoadByte(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inRegister )
+{
+	KUInt8 theData;
+	if (ioCPU->GetMemory()->ReadB( inAddress, theData ))
+	{
+		return true;
+	}
+	ioCPU->mCurrentRegisters[inRegister] = theData;
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Store( TARMProcessor*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::Store(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inValue )
+{
+	return ioCPU->GetMemory()->Write( inAddress, inValue );
+}
+
+// -------------------------------------------------------------------------- //
+//  * StoreByte( TARMProcessor*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Code::StoreByte(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inValue )
+{
+	return ioCPU->GetMemory()->WriteB( inAddress, (KUInt8) (inValue & 0xFF) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * DataAbort( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITX86_64Code::DataAbort( JITUnit* ioUnit, TARMProcessor* ioCPU )
+{
+	(void) ioUnit;
+	ioCPU->DataAbort();
+
+	TMemory* theMemIntf = ioCPU->GetMemory();
+	return theMemIntf->GetJITObject()->GetJITUnitForPC(
+		ioCPU, theMemIntf, ioCPU->mCurrentRegisters[TARMProcessor::kR15] );
+}
+
+#endif
+
+// ====================================================================== //
+// Real programmers don't comment their code.  It was hard to write, it  //
+// should be hard to understand.                                         //
+// ====================================================================== //
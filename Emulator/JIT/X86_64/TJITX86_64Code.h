@@ -0,0 +1,340 @@
+// ==============================
+// File:			TJITX86_64Code.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TJITX86_64CODE_H
+#define _TJITX86_64CODE_H
+
+#include <K/Defines/KDefinitions.h>
+
+// Einstein
+#include "TMemoryConsts.h"
+
+class TARMProcessor;
+union JITUnit;
+
+///
+/// Native x86-64 code for a JIT page.
+///
+/// Runs of instructions are first translated into threaded code by the
+/// generic JIT. Once the units of a run are final, every instruction of the
+/// run we know how to compile is emitted as x86-64 code, and the first unit
+/// of the instruction is patched to point to this code. We compile:
+/// - data processing instructions with an immediate shift, including the
+///   ones that set or read the flags and the ones that read R15;
+/// - word and byte loads and stores, which call the memory interface;
+/// - conditional branches, whose threaded unit is called if the condition
+///   passes.
+/// Any of them may be conditional, the condition is tested natively.
+/// Consecutive native instructions fall through into each other as long as
+/// the next unit was not patched (e.g. with a Halt when stepping). Any other
+/// instruction is reached with a tail jump to its threaded unit, with the
+/// usual (JITUnit*, TARMProcessor*) calling convention.
+///
+/// The code is only emitted on x86-64 System V hosts (KUInt32 may be 32 or
+/// 64 bits wide). The buffer is writable while a run is emitted, and
+/// executable otherwise, never both. Native code only tail jumps to the
+/// units and only calls the memory interface, so none of it is running when
+/// the next run of the page is emitted.
+///
+/// \test	UProcessorTests::RunCodeCompareNative
+///
+class TJITX86_64Code
+{
+public:
+	///
+	/// Default constructor.
+	///
+	TJITX86_64Code( void );
+
+	///
+	/// Destructor.
+	///
+	~TJITX86_64Code( void );
+
+	///
+	/// Forget the code of the previous translation of the page.
+	///
+	void	Reset( void );
+
+	///
+	/// Emit native code for a freshly translated run and patch its units.
+	/// The units of the run must not move anymore.
+	///
+	/// \param inInstructionUnits	first unit of every instruction of the run.
+	/// \param inInstructions		instructions of the run.
+	/// \param inVAddr				virtual address of the first instruction.
+	/// \param inCount				number of instructions in the run.
+	/// \param inNextUnit			unit executed after the run.
+	///
+	void	EmitRun(
+				JITUnit* const* inInstructionUnits,
+				const KUInt32* inInstructions,
+				KUInt32 inVAddr,
+				KUInt32 inCount,
+				JITUnit* inNextUnit );
+
+	///
+	/// Determine if an instruction can be compiled to native code.
+	///
+	/// \param inInstruction	ARM instruction.
+	/// \return true if the instruction can be compiled.
+	///
+	static Boolean	CanCompile( KUInt32 inInstruction );
+
+	///
+	/// Determine if native code can be emitted on this host.
+	///
+	/// \return true on x86-64 System V hosts.
+	///
+	static Boolean	IsAvailable( void );
+
+	///
+	/// Select whether pages translated from now on get native code.
+	/// Without it, they only run the threaded units of the generic JIT.
+	///
+	/// \param inEnabled	\c false to only use threaded code.
+	///
+	static void		SetEnabled( Boolean inEnabled );
+
+	///
+	/// Accessor on the number of instructions compiled in all pages.
+	///
+	/// \return the number of native instructions since the start.
+	///
+	static KUInt32	GetTotalNativeCount( void );
+
+	///
+	/// Accessor on the number of instructions compiled in the page.
+	///
+	/// \return the number of native instructions.
+	///
+	KUInt32	GetNativeCount( void ) const
+		{
+			return mNativeCount;
+		}
+
+private:
+	///
+	/// Copy constructor, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TJITX86_64Code( const TJITX86_64Code& inCopy );
+
+	///
+	/// Assignment operator, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TJITX86_64Code& operator = ( const TJITX86_64Code& inCopy );
+
+	/// \name Constants
+	enum {
+		kMaxBytesPerInstruction = 192,	///< Worst case for one instruction.
+		kMaxInstructionCount = TMemoryConsts::kMMUSmallestPageSize / 4,
+		kCodeSize = kMaxInstructionCount * kMaxBytesPerInstruction,
+		kMaxConditionJumps = 2,			///< Jumps that skip an instruction.
+	};
+
+	/// \name Compilation tests
+	static Boolean	CanCompileDataProcessing( KUInt32 inInstruction );
+	static Boolean	CanCompileSingleDataTransfer( KUInt32 inInstruction );
+	static Boolean	CanCompileShift( KUInt32 inInstruction );
+
+	/// \name Memory accesses, called by the native code
+	/// They return true on a data abort, like TMemory.
+	static Boolean	Load(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inRegister );
+	static Boolean	LoadByte(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inRegister );
+	static Boolean	Store(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inValue );
+	static Boolean	StoreByte(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inValue );
+
+	///
+	/// Raise a data abort, with PC set to the instruction + 8. The native
+	/// code jumps to this unit function like to any other.
+	///
+	/// \param ioUnit		ignored.
+	/// \param ioCPU		processor.
+	/// \return the first unit of the exception handler.
+	///
+	static JITUnit*	DataAbort( JITUnit* ioUnit, TARMProcessor* ioCPU );
+
+	///
+	/// Emit the code of an instruction.
+	///
+	/// \param inInstruction	instruction (CanCompile returned true).
+	/// \param inVAddr			virtual address of the instruction.
+	/// \param inUnit			first unit of the instruction.
+	/// \param inNextUnit		first unit of the next instruction.
+	/// \param inNextIsNative	whether the next instruction is native.
+	/// \return the entry point of the code.
+	///
+	KUInt8*	EmitInstruction(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				JITUnit* inUnit,
+				JITUnit* inNextUnit,
+				Boolean inNextIsNative );
+
+	///
+	/// Emit the test of a condition.
+	///
+	/// \param inCondition		condition field of the instruction.
+	/// \param outJumps			jumps to patch to skip the instruction.
+	/// \return the number of jumps.
+	///
+	KUInt32	EmitCondition(
+				KUInt32 inCondition,
+				KUInt8* outJumps[kMaxConditionJumps] );
+
+	///
+	/// Emit the code of a data processing instruction.
+	///
+	/// \param inInstruction	instruction (CanCompile returned true).
+	/// \param inVAddr			virtual address of the instruction.
+	///
+	void	EmitDataProcessing( KUInt32 inInstruction, KUInt32 inVAddr );
+
+	///
+	/// Emit the code of a single data transfer.
+	///
+	/// \param inInstruction	instruction (CanCompile returned true).
+	/// \return the jump to patch to handle a data abort.
+	///
+	KUInt8*	EmitSingleDataTransfer( KUInt32 inInstruction );
+
+	///
+	/// Emit operand 2 of a data processing instruction in ecx, or the
+	/// register offset of a single data transfer.
+	///
+	/// \param inInstruction	instruction.
+	/// \param inVAddr			virtual address of the instruction.
+	/// \param inSetCarry		whether the carry out of the shifter is
+	///							stored into the C flag.
+	///
+	void	EmitOperand2(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				Boolean inSetCarry );
+
+	///
+	/// Emit the code that continues with the next instruction.
+	///
+	/// \param inNextUnit		first unit of the next instruction.
+	/// \param inNextIsNative	whether the next instruction is native.
+	/// \return where to patch the address of the next code (or NULL).
+	///
+	KUInt8*	EmitContinue( JITUnit* inNextUnit, Boolean inNextIsNative );
+
+	///
+	/// Emit the code that raises a data abort.
+	///
+	/// \param inVAddr			virtual address of the instruction.
+	///
+	void	EmitDataAbort( KUInt32 inVAddr );
+
+	///
+	/// Patch the fall thru of EmitContinue with the current position.
+	///
+	/// \param inNextCode		value returned by EmitContinue.
+	///
+	void	PatchContinue( KUInt8* inNextCode );
+
+	///
+	/// Emit a load of an ARM register (R15 is read as PC + 8).
+	///
+	/// \param inX86Register	x86 register (kX86_EAX, kX86_ECX or kX86_EDX).
+	/// \param inRegister		ARM register.
+	/// \param inVAddr			virtual address of the instruction.
+	///
+	void	EmitLoadRegister(
+				KUInt8 inX86Register,
+				KUInt32 inRegister,
+				KUInt32 inVAddr );
+
+	///
+	/// Emit a store to an ARM register. It writes the whole KUInt32, with
+	/// the upper half cleared if it is 64 bits wide.
+	///
+	/// \param inX86Register	x86 register (kX86_EAX or kX86_ECX).
+	/// \param inRegister		ARM register (but R15).
+	///
+	void	EmitStoreRegister( KUInt8 inX86Register, KUInt32 inRegister );
+
+	///
+	/// Emit an instruction accessing a flag as [rsi + disp32].
+	///
+	/// \param inOpcode		x86 opcode (second byte of setcc, or 0x80 for cmp
+	///						with an immediate).
+	/// \param inFlag			offset of the flag in the processor.
+	///
+	void	EmitFlagAccess( KUInt8 inOpcode, KUIntPtr inFlag );
+
+	///
+	/// Emit a conditional jump with a 32 bits displacement.
+	///
+	/// \param inCondition		x86 condition (low nibble of jcc).
+	/// \return the displacement to patch with PatchJump.
+	///
+	KUInt8*	EmitJump( KUInt8 inCondition );
+
+	///
+	/// Make a jump emitted with EmitJump go to the current position.
+	///
+	/// \param inJump			displacement returned by EmitJump.
+	///
+	void	PatchJump( KUInt8* inJump );
+
+	/// \name Emission primitives
+	void	Emit8( KUInt8 inByte )
+		{
+			*mCursor++ = inByte;
+		}
+	void	Emit32( KUInt32 inWord );
+	void	Emit64( KUIntPtr inWord );
+
+	/// \name Variables
+	KUInt8*		mCode;			///< Executable buffer (or NULL).
+	KUInt8*		mCursor;		///< Current emission pointer.
+	KUInt32		mNativeCount;	///< Number of native instructions.
+};
+
+#endif
+		// _TJITX86_64CODE_H
+
+// ====================================================================== //
+// The nice thing about standards is that there are so many of them to   //
+// choose from.                                                           //
+//                 -- Andrew S. Tanenbaum                                 //
+// ====================================================================== //
@@ -0,0 +1,1010 @@
+// ==============================
+// File:			TNativeKernel.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "TNativeKernel.h"
+
+// ANSI C & POSIX
+#include <string.h>
+
+// Einstein
+#include "TARMProcessor.h"
+#include "TEmulator.h"
+#include "TMemory.h"
+#include "Log/TLog.h"
+#include "Emulator/JIT/Generic/TJITGenericROMPatch.h"
+#include "Emulator/JIT/Generic/TJITGeneric_Macros.h"
+
+// -------------------------------------------------------------------------- //
+// Injections
+// -------------------------------------------------------------------------- //
+
+// They rely on the layout of the kernel objects of the 717006 ROM, so they
+// have no address here: only the table of this ROM in _Data_/Einstein.patches
+// applies them, when it matches the machine string of the ROM.
+
+// swi 0x0B; mov pc, lr
+T_ROM_TABLE_INJECTION(SemaphoreOpGlue) {
+	TNativeKernel* theKernel = ioCPU->GetEmulator()->GetNativeKernel();
+	if (theKernel->SemaphoreOp(ioCPU)) {
+		return ioUnit;
+	}
+	return 0L;
+}
+
+T_ROM_TABLE_INJECTION(SemOp__15TSemaphoreGroupFP16TSemaphoreOpList8SemFlagsP5TTask) {
+	ioCPU->GetEmulator()->GetNativeKernel()->RememberSemaphoreOp(
+		ioCPU->GetRegister(0),
+		ioCPU->GetRegister(1));
+	return ioUnit;
+}
+
+T_ROM_TABLE_INJECTION(DeleteSemGroup__FP15TSemaphoreGroup) {
+	ioCPU->GetEmulator()->GetNativeKernel()->ForgetObject(ioCPU->GetRegister(0));
+	return ioUnit;
+}
+
+T_ROM_TABLE_INJECTION(DeleteSemList__FP16TSemaphoreOpList) {
+	ioCPU->GetEmulator()->GetNativeKernel()->ForgetObject(ioCPU->GetRegister(0));
+	return ioUnit;
+}
+
+// swi; mov pc, lr
+T_ROM_TABLE_INJECTION(DoSchedulerSWI) {
+	TNativeKernel* theKernel = ioCPU->GetEmulator()->GetNativeKernel();
+	if (theKernel->SchedulerSWI(ioCPU)) {
+		return ioUnit;
+	}
+	return 0L;
+}
+
+T_ROM_TABLE_INJECTION(Scheduler) {
+	TNativeKernel* theKernel = ioCPU->GetEmulator()->GetNativeKernel();
+	if (theKernel->SwitchTask(ioCPU)) {
+		return ioUnit;
+	}
+	return 0L;
+}
+
+T_ROM_TABLE_INJECTION(Add__10TSchedulerFP5TTask) {
+	TNativeKernel* theKernel = ioCPU->GetEmulator()->GetNativeKernel();
+	if (theKernel->AddTask(ioCPU, false)) {
+		return ioUnit;
+	}
+	return 0L;
+}
+
+T_ROM_TABLE_INJECTION(AddWhenNotCurrent__10TSchedulerFP5TTask) {
+	TNativeKernel* theKernel = ioCPU->GetEmulator()->GetNativeKernel();
+	if (theKernel->AddTask(ioCPU, true)) {
+		return ioUnit;
+	}
+	return 0L;
+}
+
+T_ROM_TABLE_INJECTION(Remove__10TSchedulerFP5TTask) {
+	TNativeKernel* theKernel = ioCPU->GetEmulator()->GetNativeKernel();
+	if (theKernel->RemoveTask(ioCPU)) {
+		return ioUnit;
+	}
+	return 0L;
+}
+
+T_ROM_TABLE_INJECTION(_AbortData) {
+	TNativeKernel* theKernel = ioCPU->GetEmulator()->GetNativeKernel();
+	if (theKernel->PageFault(ioCPU)) {
+		return ioUnit;
+	}
+	return 0L;
+}
+
+T_ROM_TABLE_INJECTION(ForgetMapping__FUlN21) {
+	ioCPU->GetEmulator()->GetNativeKernel()->RememberPendingPage();
+	return ioUnit;
+}
+
+// The routines that change the mappings, except ForgetMapping: a page
+// it forgets can be mapped again the same way.
+#define FORGET_PAGES_INJECTION(name) \
+	T_ROM_TABLE_INJECTION(name) { \
+		ioCPU->GetEmulator()->GetNativeKernel()->ForgetPages(); \
+		return ioUnit; \
+	}
+
+FORGET_PAGES_INJECTION(RemovePageTable__FUlT1)
+FORGET_PAGES_INJECTION(AddPageTable__FUlN21)
+FORGET_PAGES_INJECTION(ReleasePage__FUl)
+FORGET_PAGES_INJECTION(CopyPhysPgGlue__FUlN21)
+FORGET_PAGES_INJECTION(InvalidatePhys__FUl)
+FORGET_PAGES_INJECTION(MakePhysInaccessible__FUl)
+FORGET_PAGES_INJECTION(MakePhysAccessible__FUl)
+FORGET_PAGES_INJECTION(ChangeVirtualMapping__Fv)
+FORGET_PAGES_INJECTION(ChangeVirtualMapping__FUlN2115EPhysChangeType)
+FORGET_PAGES_INJECTION(ForgetPhysMapping__FUlN21)
+FORGET_PAGES_INJECTION(ForgetPhysMapping__Fv)
+FORGET_PAGES_INJECTION(RememberPhysMapping__FUlN21Uc)
+FORGET_PAGES_INJECTION(RememberPhysMapping__Fv)
+FORGET_PAGES_INJECTION(ForgetPermMapping__FUlN21)
+FORGET_PAGES_INJECTION(RememberPermMapping__FUlN214Perm)
+FORGET_PAGES_INJECTION(RememberMapping__FUlN31Uc)
+
+// Whether the kernel calls are done on the host when possible. Off until
+// the fast paths are validated on a real ROM.
+static Boolean gNativeKernelFastPaths = false;
+
+// Whether page faults are resolved on the host when possible. This writes
+// the page tables of the guest: off until it is validated on a real ROM.
+static Boolean gNativeKernelPageFaults = false;
+
+// Whether the host keeps the ready queues and switches tasks. The kernel
+// doesn't see its queues any more: off until it is validated on a real ROM.
+static Boolean gNativeKernelScheduler = false;
+
+// -------------------------------------------------------------------------- //
+//  * TNativeKernel( TLog*, TMemory* )
+// -------------------------------------------------------------------------- //
+TNativeKernel::TNativeKernel( TLog* inLog, TMemory* inMemoryIntf )
+	:
+		mLog( inLog ),
+		mMemoryIntf( inMemoryIntf ),
+		mPendingGroupId( 0 ),
+		mPendingListId( 0 ),
+		mPageFaultPending( false ),
+		mPendingPage( 0 ),
+		mPendingTableBase( 0 ),
+		mBlockedTask( 0 ),
+		mSchedulerStarted( false ),
+		mFastPathCount( 0 ),
+		mKernelCallCount( 0 )
+{
+	(void) ::memset( mObjects, 0, sizeof(mObjects) );
+	(void) ::memset( mPages, 0, sizeof(mPages) );
+	(void) ::memset( mTasks, 0, sizeof(mTasks) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * ~TNativeKernel( void )
+// -------------------------------------------------------------------------- //
+TNativeKernel::~TNativeKernel( void )
+{
+	KUInt32 indexTask;
+	for (indexTask = 0; indexTask < kTaskCacheSize; indexTask++)
+	{
+		if (mTasks[indexTask])
+		{
+			delete mTasks[indexTask];
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetFastPaths( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::SetFastPaths( Boolean inFastPaths )
+{
+	gNativeKernelFastPaths = inFastPaths;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetPageFaults( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::SetPageFaults( Boolean inPageFaults )
+{
+	gNativeKernelPageFaults = inPageFaults;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetNativeScheduler( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::SetNativeScheduler( Boolean inNativeScheduler )
+{
+	gNativeKernelScheduler = inNativeScheduler;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SemaphoreOp( TARMProcessor* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::SemaphoreOp( TARMProcessor* ioCPU )
+{
+	KUInt32 theGroupId = ioCPU->GetRegister(0);
+	KUInt32 theListId = ioCPU->GetRegister(1);
+	Boolean theResult = true;
+	if (gNativeKernelFastPaths)
+	{
+		KUInt32 theGroup = LookupObject( theGroupId );
+		KUInt32 theList = LookupObject( theListId );
+		if (theGroup && theList)
+		{
+			theResult = DoSemaphoreOp( theGroup, theList );
+		}
+	}
+
+	if (theResult)
+	{
+		// The kernel will tell us where the objects are.
+		mPendingGroupId = theGroupId;
+		mPendingListId = theListId;
+		mKernelCallCount++;
+	} else {
+		// Return noErr to the caller.
+		ioCPU->SetRegister( 0, 0 );
+		ioCPU->SetRegister(
+			TARMProcessor::kR15,
+			ioCPU->GetRegister( TARMProcessor::kR14 ) + 4 );
+		mFastPathCount++;
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * RememberSemaphoreOp( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::RememberSemaphoreOp( KUInt32 inGroup, KUInt32 inList )
+{
+	if (mPendingGroupId)
+	{
+		RememberObject( mPendingGroupId, inGroup );
+		RememberObject( mPendingListId, inList );
+		mPendingGroupId = 0;
+		mPendingListId = 0;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ForgetObject( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::ForgetObject( KUInt32 inAddress )
+{
+	KUInt32 indexObject;
+	for (indexObject = 0; indexObject < kObjectCacheSize; indexObject++)
+	{
+		if (mObjects[indexObject].fAddress == inAddress)
+		{
+			mObjects[indexObject].fId = 0;
+			mObjects[indexObject].fAddress = 0;
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * SchedulerSWI( TARMProcessor* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::SchedulerSWI( TARMProcessor* ioCPU )
+{
+	if (gNativeKernelScheduler)
+	{
+		return YieldTask( ioCPU );
+	}
+
+	Boolean theResult = MustSchedule();
+	if (theResult)
+	{
+		mKernelCallCount++;
+	} else {
+		// Return noErr to the caller.
+		ioCPU->SetRegister( 0, 0 );
+		ioCPU->SetRegister(
+			TARMProcessor::kR15,
+			ioCPU->GetRegister( TARMProcessor::kR14 ) + 4 );
+		mFastPathCount++;
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwitchTask( TARMProcessor* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::SwitchTask( TARMProcessor* ioCPU )
+{
+	if (gNativeKernelScheduler)
+	{
+		TTask* theTask = GetCurrentTask();
+		KUInt32 theHoldLevel;
+		if ((ReadKernel( kHoldScheduleLevelGlobal, theHoldLevel ) == false)
+			&& (theHoldLevel == 0))
+		{
+			// The kernel loads the registers of gCurrentTask at the exit
+			// of the SWI.
+			theTask = mScheduler.Schedule( false );
+			if (theTask)
+			{
+				(void) WriteKernel( kCurrentTaskGlobal, theTask->GetAddress() );
+			}
+		}
+		if (theTask == nil)
+		{
+			// No task can run: the kernel waits for one.
+			mKernelCallCount++;
+			return true;
+		}
+		ioCPU->SetRegister(
+			TARMProcessor::kR15,
+			ioCPU->GetRegister( TARMProcessor::kR14 ) + 4 );
+		mFastPathCount++;
+		return false;
+	}
+
+	Boolean theResult = MustSchedule();
+	if (theResult)
+	{
+		mKernelCallCount++;
+	} else {
+		// Back to the exit of the SWI, with the same task.
+		ioCPU->SetRegister(
+			TARMProcessor::kR15,
+			ioCPU->GetRegister( TARMProcessor::kR14 ) + 4 );
+		mFastPathCount++;
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * AddTask( TARMProcessor*, Boolean )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::AddTask( TARMProcessor* ioCPU, Boolean inWhenNotCurrent )
+{
+	KUInt32 theAddress = ioCPU->GetRegister( 1 );
+	if (!gNativeKernelScheduler)
+	{
+		RememberAddedTask( theAddress );
+		return true;
+	}
+
+	// The current task first, for AddWhenNotCurrent.
+	(void) GetCurrentTask();
+	TTask* theTask = FindTask( theAddress );
+	if (theTask == nil)
+	{
+		if (mLog)
+		{
+			mLog->FLogLine(
+				"Native scheduler: can't mirror task %.8X",
+				(unsigned int) theAddress );
+		}
+		mKernelCallCount++;
+		return true;
+	}
+	if (inWhenNotCurrent)
+	{
+		mScheduler.AddWhenNotCurrent( theTask );
+	} else {
+		mScheduler.Add( theTask );
+	}
+	ioCPU->SetRegister(
+		TARMProcessor::kR15,
+		ioCPU->GetRegister( TARMProcessor::kR14 ) + 4 );
+	mFastPathCount++;
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * RemoveTask( TARMProcessor* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::RemoveTask( TARMProcessor* ioCPU )
+{
+	KUInt32 theAddress = ioCPU->GetRegister( 1 );
+	if (!gNativeKernelScheduler)
+	{
+		RememberRemovedTask( theAddress );
+		return true;
+	}
+
+	(void) GetCurrentTask();
+	TTask* theTask = FindTask( theAddress );
+	if (theTask == nil)
+	{
+		if (mLog)
+		{
+			mLog->FLogLine(
+				"Native scheduler: can't mirror task %.8X",
+				(unsigned int) theAddress );
+		}
+		mKernelCallCount++;
+		return true;
+	}
+	mScheduler.Remove( theTask );
+	ioCPU->SetRegister(
+		TARMProcessor::kR15,
+		ioCPU->GetRegister( TARMProcessor::kR14 ) + 4 );
+	mFastPathCount++;
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * RememberRemovedTask( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::RememberRemovedTask( KUInt32 inTask )
+{
+	KUInt32 theCurrentTask;
+	if (!ReadKernel( kCurrentTaskGlobal, theCurrentTask )
+		&& (theCurrentTask == inTask))
+	{
+		mBlockedTask = inTask;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * RememberAddedTask( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::RememberAddedTask( KUInt32 inTask )
+{
+	if (mBlockedTask == inTask)
+	{
+		mBlockedTask = 0;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * PageFault( TARMProcessor* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::PageFault( TARMProcessor* ioCPU )
+{
+	// The kernel mapped the page of the previous fault by now.
+	RememberPendingPage();
+
+	KUInt32 theAddress = mMemoryIntf->GetFaultAddressRegister();
+	KUInt32 theTableBase = mMemoryIntf->GetTranslationTableBase();
+	Boolean theResult = true;
+	// Only page translation faults, and not in the abort handler.
+	if (gNativeKernelPageFaults
+		&& ((mMemoryIntf->GetFaultStatusRegister() & 0xF)
+			== TMemoryConsts::kFSR_TranslationPage)
+		&& ((ioCPU->GetSPSR() & TARMProcessor::kPSR_ModeMask)
+			!= TARMProcessor::kAbortMode))
+	{
+		theResult = MapPage( theAddress, theTableBase );
+	}
+
+	if (theResult)
+	{
+		mPageFaultPending = true;
+		mPendingPage = theAddress & TMemoryConsts::kMMUSmallPageMask;
+		mPendingTableBase = theTableBase;
+		mKernelCallCount++;
+	} else {
+		// Execute the aborted instruction again (subs pc, lr, #8).
+		KUInt32 theInstruction =
+			ioCPU->GetRegister( TARMProcessor::kR14 ) - 8;
+		ioCPU->SetCPSR( ioCPU->GetSPSR() );
+		ioCPU->SetRegister( TARMProcessor::kR15, theInstruction + 4 );
+		mFastPathCount++;
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ForgetPages( void )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::ForgetPages( void )
+{
+	(void) ::memset( mPages, 0, sizeof(mPages) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * RememberPendingPage( void )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::RememberPendingPage( void )
+{
+	if (!mPageFaultPending)
+	{
+		return;
+	}
+	mPageFaultPending = false;
+	if (mPendingTableBase != mMemoryIntf->GetTranslationTableBase())
+	{
+		return;
+	}
+
+	// Only small pages of coarse tables.
+	Boolean theFault = false;
+	KUInt32 theSectionEntry = mMemoryIntf->ReadP(
+		mPendingTableBase | ((mPendingPage >> 18) & 0xFFFFFFFC), theFault );
+	if (theFault || ((theSectionEntry & 0x3) != 0x1))
+	{
+		return;
+	}
+	KUInt32 theEntryAddress = (theSectionEntry & 0xFFFFFC00)
+		| ((mPendingPage & 0x000FF000) >> 10);
+	KUInt32 theEntry = mMemoryIntf->ReadP( theEntryAddress, theFault );
+	if (theFault || ((theEntry & 0x3) != 0x2))
+	{
+		return;
+	}
+
+	SPage* thePage = &mPages[(mPendingPage >> 12) % kPageCacheSize];
+	thePage->fPage = mPendingPage;
+	thePage->fTableBase = mPendingTableBase;
+	thePage->fSectionEntry = theSectionEntry;
+	thePage->fEntryAddress = theEntryAddress;
+	thePage->fEntry = theEntry;
+}
+
+// -------------------------------------------------------------------------- //
+//  * MapPage( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::MapPage( KUInt32 inAddress, KUInt32 inTableBase )
+{
+	SPage* thePage = &mPages[(inAddress >> 12) % kPageCacheSize];
+	if ((thePage->fEntry == 0)
+		|| (thePage->fPage != (inAddress & TMemoryConsts::kMMUSmallPageMask))
+		|| (thePage->fTableBase != inTableBase))
+	{
+		return true;
+	}
+
+	// The first level descriptor must be the same and the page still
+	// unmapped.
+	Boolean theFault = false;
+	KUInt32 theSectionEntry = mMemoryIntf->ReadP(
+		inTableBase | ((inAddress >> 18) & 0xFFFFFFFC), theFault );
+	if (theFault || (theSectionEntry != thePage->fSectionEntry))
+	{
+		return true;
+	}
+	KUInt32 theEntry = mMemoryIntf->ReadP( thePage->fEntryAddress, theFault );
+	if (theFault || (theEntry != 0))
+	{
+		return true;
+	}
+
+	// Faults are not in the TLB: there is nothing to invalidate.
+	return mMemoryIntf->WriteP( thePage->fEntryAddress, thePage->fEntry );
+}
+
+// -------------------------------------------------------------------------- //
+//  * MustSchedule( void )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::MustSchedule( void )
+{
+	if (!gNativeKernelFastPaths)
+	{
+		return true;
+	}
+
+	KUInt32 theHoldLevel;
+	KUInt32 theTask;
+	KUInt32 theScheduler;
+	KUInt32 theMask;
+	KUInt32 thePriority;
+	if (ReadKernel( kHoldScheduleLevelGlobal, theHoldLevel )
+		|| (theHoldLevel != 0)
+		|| ReadKernel( kCurrentTaskGlobal, theTask )
+		|| (theTask == 0)
+		|| (theTask == mBlockedTask)
+		|| ReadKernel( kKernelSchedulerGlobal, theScheduler )
+		|| (theScheduler == 0)
+		|| ReadKernel( theScheduler + kSchedulerMaskOffset, theMask )
+		|| ReadKernel( theTask + kTaskPriorityOffset, thePriority )
+		|| (thePriority > kMaxPriority))
+	{
+		return true;
+	}
+
+	// The kernel decides as soon as a task of the same priority is ready:
+	// it runs when the current task yields or at the end of its slice.
+	return (theMask >> thePriority) != 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * YieldTask( TARMProcessor* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::YieldTask( TARMProcessor* ioCPU )
+{
+	TTask* thePreviousTask = GetCurrentTask();
+	KUInt32 theHoldLevel;
+	// The save area holds the user registers.
+	if ((thePreviousTask == nil)
+		|| (ioCPU->GetMode() != TARMProcessor::kUserMode)
+		|| ReadKernel( kHoldScheduleLevelGlobal, theHoldLevel )
+		|| (theHoldLevel != 0))
+	{
+		mKernelCallCount++;
+		return true;
+	}
+
+	// The caller gets noErr, when it runs again.
+	KUInt32 theReturnAddress = ioCPU->GetRegister( TARMProcessor::kR14 );
+	ioCPU->SetRegister( 0, 0 );
+	TTask* theNextTask = mScheduler.Schedule( true );
+	if ((theNextTask == thePreviousTask) || (theNextTask == nil))
+	{
+		ioCPU->SetRegister( TARMProcessor::kR15, theReturnAddress + 4 );
+		mFastPathCount++;
+		return false;
+	}
+
+	thePreviousTask->SaveContext( ioCPU );
+	thePreviousTask->SetRegister( TARMProcessor::kR15, theReturnAddress );
+	if (StoreTaskContext( thePreviousTask ) || LoadTaskContext( theNextTask ))
+	{
+		// The copies of the mirror are still there.
+		if (mLog)
+		{
+			mLog->FLogLine(
+				"Native scheduler: can't switch from task %.8X to task %.8X",
+				(unsigned int) thePreviousTask->GetAddress(),
+				(unsigned int) theNextTask->GetAddress() );
+		}
+	}
+	theNextTask->RestoreContext( ioCPU );
+	ioCPU->SetRegister(
+		TARMProcessor::kR15,
+		theNextTask->GetRegister( TARMProcessor::kR15 ) + 4 );
+	(void) WriteKernel( kCurrentTaskGlobal, theNextTask->GetAddress() );
+	mFastPathCount++;
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetCurrentTask( void )
+// -------------------------------------------------------------------------- //
+TTask*
+TNativeKernel::GetCurrentTask( void )
+{
+	if (!mSchedulerStarted)
+	{
+		KUInt32 theAddress;
+		if (ReadKernel( kCurrentTaskGlobal, theAddress ) || (theAddress == 0))
+		{
+			return nil;
+		}
+		TTask* theTask = FindTask( theAddress );
+		if (theTask == nil)
+		{
+			return nil;
+		}
+		mScheduler.SetCurrentTask( theTask );
+		mSchedulerStarted = true;
+	}
+
+	return mScheduler.GetCurrentTask();
+}
+
+// -------------------------------------------------------------------------- //
+//  * FindTask( KUInt32 )
+// -------------------------------------------------------------------------- //
+TTask*
+TNativeKernel::FindTask( KUInt32 inAddress )
+{
+	KUInt32 thePriority;
+	if (ReadKernel( inAddress + kTaskPriorityOffset, thePriority ))
+	{
+		return nil;
+	}
+
+	TTask** theFreeSlot = nil;
+	KUInt32 indexTask;
+	for (indexTask = 0; indexTask < kTaskCacheSize; indexTask++)
+	{
+		TTask* theTask = mTasks[indexTask];
+		if (theTask == nil)
+		{
+			if (theFreeSlot == nil)
+			{
+				theFreeSlot = &mTasks[indexTask];
+			}
+		} else if (theTask->GetAddress() == inAddress) {
+			if (theTask->GetPriority() != thePriority)
+			{
+				mScheduler.SetPriority( theTask, thePriority );
+			}
+			return theTask;
+		}
+	}
+
+	if (theFreeSlot == nil)
+	{
+		// A blocked task is in no queue: its registers are in its TTask.
+		for (indexTask = 0; indexTask < kTaskCacheSize; indexTask++)
+		{
+			TTask* theTask = mTasks[indexTask];
+			if ((theTask->GetState() == TTask::kBlocked)
+				&& (theTask != mScheduler.GetCurrentTask()))
+			{
+				delete theTask;
+				mTasks[indexTask] = nil;
+				theFreeSlot = &mTasks[indexTask];
+				break;
+			}
+		}
+		if (theFreeSlot == nil)
+		{
+			return nil;
+		}
+	}
+
+	*theFreeSlot = new TTask( inAddress, thePriority );
+	return *theFreeSlot;
+}
+
+// -------------------------------------------------------------------------- //
+//  * StoreTaskContext( const TTask* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::StoreTaskContext( const TTask* inTask )
+{
+	KUInt32 theAddress = inTask->GetAddress();
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < TTask::kNbRegisters; indexReg++)
+	{
+		if (WriteKernel(
+				theAddress + kTaskRegistersOffset + (4 * indexReg),
+				inTask->GetRegister( indexReg ) ))
+		{
+			return true;
+		}
+	}
+	return WriteKernel( theAddress + kTaskPSROffset, inTask->GetPSR() );
+}
+
+// -------------------------------------------------------------------------- //
+//  * LoadTaskContext( TTask* )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::LoadTaskContext( TTask* ioTask )
+{
+	KUInt32 theAddress = ioTask->GetAddress();
+	KUInt32 theWord;
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < TTask::kNbRegisters; indexReg++)
+	{
+		if (ReadKernel(
+				theAddress + kTaskRegistersOffset + (4 * indexReg),
+				theWord ))
+		{
+			return true;
+		}
+		ioTask->SetRegister( indexReg, theWord );
+	}
+	if (ReadKernel( theAddress + kTaskPSROffset, theWord ))
+	{
+		return true;
+	}
+	ioTask->SetPSR( theWord );
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadKernel( KUInt32, KUInt32& )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::ReadKernel( KUInt32 inAddress, KUInt32& outWord )
+{
+	// The objects are in the kernel domain.
+	KUInt32 theAddress = inAddress;
+	if (mMemoryIntf->IsMMUEnabled()
+		&& mMemoryIntf->TranslatePrivileged( inAddress, false, theAddress ))
+	{
+		return true;
+	}
+	Boolean theFault = false;
+	outWord = mMemoryIntf->ReadP( theAddress, theFault );
+	return theFault;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteKernel( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::WriteKernel( KUInt32 inAddress, KUInt32 inWord )
+{
+	KUInt32 theAddress = inAddress;
+	if (mMemoryIntf->IsMMUEnabled()
+		&& mMemoryIntf->TranslatePrivileged( inAddress, true, theAddress ))
+	{
+		return true;
+	}
+	return mMemoryIntf->WriteP( theAddress, inWord );
+}
+
+// -------------------------------------------------------------------------- //
+//  * LookupObject( KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TNativeKernel::LookupObject( KUInt32 inId )
+{
+	SObject* theObject = &mObjects[inId % kObjectCacheSize];
+	if ((inId == 0) || (theObject->fId != inId))
+	{
+		return 0;
+	}
+
+	// The memory may have been reused.
+	KUInt32 theId;
+	if (ReadKernel( theObject->fAddress + kObjectIdOffset, theId )
+		|| (theId != inId))
+	{
+		theObject->fId = 0;
+		theObject->fAddress = 0;
+		return 0;
+	}
+
+	return theObject->fAddress;
+}
+
+// -------------------------------------------------------------------------- //
+//  * RememberObject( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TNativeKernel::RememberObject( KUInt32 inId, KUInt32 inAddress )
+{
+	// Only if this is the object of the call (this also checks that the
+	// id is where we expect it).
+	KUInt32 theId;
+	if ((inId != 0)
+		&& ((inAddress & 0x3) == 0)
+		&& !ReadKernel( inAddress + kObjectIdOffset, theId )
+		&& (theId == inId))
+	{
+		SObject* theObject = &mObjects[inId % kObjectCacheSize];
+		theObject->fId = inId;
+		theObject->fAddress = inAddress;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * DoSemaphoreOp( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TNativeKernel::DoSemaphoreOp( KUInt32 inGroup, KUInt32 inList )
+{
+	KUInt32 theOpCount;
+	KUInt32 theOps;
+	KUInt32 theSemCount;
+	KUInt32 theSems;
+	if (ReadKernel( inList + kSemListCountOffset, theOpCount )
+		|| ReadKernel( inList + kSemListOpsOffset, theOps )
+		|| ReadKernel( inGroup + kSemGroupCountOffset, theSemCount )
+		|| ReadKernel( inGroup + kSemGroupArrayOffset, theSems ))
+	{
+		return true;
+	}
+	if ((theOpCount == 0) || (theOpCount > kMaxSemOps)
+		|| (theSemCount == 0) || (theSemCount > kMaxSemaphores)
+		|| (theOps & 0x3) || (theSems & 0x3))
+	{
+		return true;
+	}
+
+	// New values of the semaphores, in the order they are first used.
+	KUInt32 theAddresses[kMaxSemOps];
+	KSInt32 theOldValues[kMaxSemOps];
+	KSInt32 theNewValues[kMaxSemOps];
+	KUInt32 theSemaphoreCount = 0;
+	KUInt32 indexOp;
+	for (indexOp = 0; indexOp < theOpCount; indexOp++)
+	{
+		// SemOp: unsigned short num, short op.
+		KUInt32 theOp;
+		if (ReadKernel( theOps + (indexOp * 4), theOp ))
+		{
+			return true;
+		}
+		KUInt32 theNum = theOp >> 16;
+		KSInt32 theDelta = (KSInt16) (theOp & 0xFFFF);
+		if (theNum >= theSemCount)
+		{
+			return true;
+		}
+		KUInt32 theSem = theSems + (theNum * kSemaphoreSize);
+		KUInt32 indexSem;
+		for (indexSem = 0; indexSem < theSemaphoreCount; indexSem++)
+		{
+			if (theAddresses[indexSem] == theSem)
+			{
+				break;
+			}
+		}
+		if (indexSem == theSemaphoreCount)
+		{
+			KUInt32 theValue;
+			if (ReadKernel( theSem + kSemValOffset, theValue ))
+			{
+				return true;
+			}
+			theAddresses[indexSem] = theSem;
+			theOldValues[indexSem] = (KSInt32) theValue;
+			theNewValues[indexSem] = (KSInt32) theValue;
+			theSemaphoreCount++;
+		}
+
+		// Operations that block or wake a task go through the kernel.
+		KSInt32 theValue = theNewValues[indexSem];
+		KUInt32 theWaitingTask;
+		if (theDelta > 0)
+		{
+			if (ReadKernel( theSem + kSemIncTasksOffset, theWaitingTask )
+				|| theWaitingTask)
+			{
+				return true;
+			}
+			theValue += theDelta;
+		} else if (theDelta < 0) {
+			if (theValue + theDelta < 0)
+			{
+				return true;
+			}
+			theValue += theDelta;
+			if ((theValue == 0)
+				&& (ReadKernel( theSem + kSemZeroTasksOffset, theWaitingTask )
+					|| theWaitingTask))
+			{
+				return true;
+			}
+		} else if (theValue != 0) {
+			return true;
+		}
+		theNewValues[indexSem] = theValue;
+	}
+
+	// Write the new values, or restore the old ones.
+	KUInt32 indexSem;
+	for (indexSem = 0; indexSem < theSemaphoreCount; indexSem++)
+	{
+		if (WriteKernel(
+				theAddresses[indexSem] + kSemValOffset,
+				(KUInt32) theNewValues[indexSem] ))
+		{
+			while (indexSem-- > 0)
+			{
+				(void) WriteKernel(
+						theAddresses[indexSem] + kSemValOffset,
+						(KUInt32) theOldValues[indexSem] );
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// ====================================================================== //
+// Simplicity does not precede complexity, but follows it.                //
+//                 -- Alan Perlis                                         //
+// ====================================================================== //
@@ -0,0 +1,453 @@
+// ==============================
+// File:			TNativeKernel.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TNATIVEKERNEL_H
+#define _TNATIVEKERNEL_H
+
+#include <K/Defines/KDefinitions.h>
+
+// Einstein
+#include "Emulator/Scheduler/TScheduler.h"
+
+class TLog;
+class TMemory;
+class TARMProcessor;
+
+///
+/// Host implementations of the common cases of NewtonOS kernel calls.
+///
+/// The calls are ROM injections (see TJITGenericROMInjection) at the entry
+/// of the user glue of the SWIs: when the host can do what the kernel
+/// would do, it updates the kernel structures and returns to the caller
+/// without the SWI. Anything else goes through the SWI and the kernel, as
+/// if there was no injection. The injections have no compiled address:
+/// only the table of the 717006 ROM in the patch database applies them
+/// (see TROMPatchDatabase), since they rely on the layout of its kernel.
+///
+/// A semaphore operation (SWI 11) is done on the host when no operation of
+/// the list would block and no task waits on a semaphore it changes. The
+/// kernel finds the objects from their ids in its object table; the host
+/// doesn't read the table but remembers the objects the kernel passes to
+/// TSemaphoreGroup::SemOp, and checks their id before each use.
+///
+/// A page translation fault is resolved on the host when the kernel
+/// already mapped the page and only forgot the mapping since: the host
+/// learns the second level descriptors the kernel writes when it handles
+/// faults and writes them again, as long as the kernel doesn't change the
+/// mappings in other ways. The data abort vector is also an injection.
+/// This has its own switch (see SetPageFaults).
+///
+/// The scheduler SWI (DoSchedulerSWI) and the task switch at the exit of
+/// the SWIs (Scheduler) return at once when the kernel would run the
+/// current task again: the schedule is not on hold, no task of the same
+/// priority or higher is ready and the current task didn't block. The host
+/// reads the ready mask of the kernel scheduler and the priority of the
+/// current task, and learns from the entries of TScheduler::Remove, Add
+/// and AddWhenNotCurrent whether the current task blocked.
+///
+/// With the native scheduler (see SetNativeScheduler), the host keeps the
+/// ready queues instead of the kernel: TScheduler::Add, AddWhenNotCurrent
+/// and Remove update a TScheduler mirror and return at once, Scheduler
+/// picks the next task from the mirror and writes gCurrentTask, and
+/// DoSchedulerSWI switches to the next task on the host. The registers of
+/// the tasks are in the save area of the kernel TTask, so the kernel can
+/// load a task the host saved and the other way around. DoSchedulerSWI
+/// gives the rest of the time slice to the tasks of the same priority.
+///
+/// The fast paths are off by default, until they are validated on a real
+/// ROM (see SetFastPaths). The offsets of the kernel objects and the
+/// addresses of the globals are not verified against a real ROM yet.
+///
+/// \test	UNativeKernelTests::Semaphores
+/// \test	UNativeKernelTests::PageFaults
+/// \test	UNativeKernelTests::Scheduler
+/// \test	UNativeKernelTests::TaskSwitch
+///
+class TNativeKernel
+{
+public:
+	/// Layout of the kernel objects (ROM 717006).
+	enum {
+		kObjectIdOffset			= 0x00,	///< TObject::fId.
+		kSemGroupCountOffset	= 0x10,	///< TSemaphoreGroup::fCount.
+		kSemGroupArrayOffset	= 0x14,	///< TSemaphoreGroup::fGroup.
+		kSemListCountOffset		= 0x10,	///< TSemaphoreOpList::fCount.
+		kSemListOpsOffset		= 0x14,	///< TSemaphoreOpList::fOpList.
+		kSemValOffset			= 0x00,	///< TSemaphore::fVal.
+		kSemZeroTasksOffset		= 0x04,	///< Head of TSemaphore::fZeroTasks.
+		kSemIncTasksOffset		= 0x0C,	///< Head of TSemaphore::fIncTasks.
+		kSemaphoreSize			= 0x14,	///< sizeof(TSemaphore).
+		kSchedulerMaskOffset	= 0x10,	///< TScheduler::fPriorityMask.
+		kTaskRegistersOffset	= 0x10,	///< TTask::fRegister (r0-r15).
+		kTaskPSROffset			= 0x50,	///< TTask::fPSR.
+		kTaskPriorityOffset		= 0x74	///< TTask::fPriority.
+	};
+
+	/// Globals of the kernel (ROM 717006).
+	enum {
+		kKernelSchedulerGlobal		= 0x0C100FD0,	///< gKernelScheduler.
+		kHoldScheduleLevelGlobal	= 0x0C100FD8,	///< gHoldScheduleLevel.
+		kCurrentTaskGlobal			= 0x0C100FF8	///< gCurrentTask.
+	};
+
+	/// Limits of the fast paths.
+	enum {
+		kMaxSemOps			= 8,	///< Longer lists go through the kernel.
+		kMaxSemaphores		= 256,	///< Larger groups are suspicious.
+		kObjectCacheSize	= 64,	///< Objects remembered.
+		kPageCacheSize		= 256,	///< Pages remembered.
+		kMaxPriority		= 31,	///< Highest priority of a task.
+		kTaskCacheSize		= 64	///< Tasks in the scheduler mirror.
+	};
+
+	///
+	/// Constructor from the log and the interface to memory.
+	///
+	/// \param inLog			interface for logging.
+	/// \param inMemoryIntf		interface to memory.
+	///
+	TNativeKernel( TLog* inLog, TMemory* inMemoryIntf );
+
+	///
+	/// Destructor.
+	///
+	~TNativeKernel( void );
+
+	///
+	/// Select whether kernel calls are done on the host when possible.
+	/// They always go through the kernel by default.
+	///
+	/// \param inFastPaths	\c false to always go through the kernel.
+	///
+	static void	SetFastPaths( Boolean inFastPaths );
+
+	///
+	/// Select whether page faults are resolved on the host when possible.
+	/// This writes the page tables of the guest, so they always go through
+	/// the kernel by default.
+	///
+	/// \param inPageFaults	\c false to always go through the kernel.
+	///
+	static void	SetPageFaults( Boolean inPageFaults );
+
+	///
+	/// Select whether the host keeps the ready queues and switches tasks
+	/// instead of the kernel. The kernel does it by default.
+	///
+	/// \param inNativeScheduler	\c false to leave the scheduler to the
+	///								kernel.
+	///
+	static void	SetNativeScheduler( Boolean inNativeScheduler );
+
+	///
+	/// Do a semaphore operation on the host, at the entry of
+	/// SemaphoreOpGlue (r0 = group id, r1 = list id, r2 = flags).
+	///
+	/// \param ioCPU	processor, returned to the caller on success.
+	/// \return true if the kernel must do the operation.
+	///
+	Boolean		SemaphoreOp( TARMProcessor* ioCPU );
+
+	///
+	/// Remember the objects of a semaphore operation of the kernel, at the
+	/// entry of TSemaphoreGroup::SemOp.
+	///
+	/// \param inGroup	address of the TSemaphoreGroup.
+	/// \param inList	address of the TSemaphoreOpList.
+	///
+	void		RememberSemaphoreOp( KUInt32 inGroup, KUInt32 inList );
+
+	///
+	/// Forget an object the kernel deletes.
+	///
+	/// \param inAddress	address of the object.
+	///
+	void		ForgetObject( KUInt32 inAddress );
+
+	///
+	/// Do the scheduler SWI on the host, at the entry of DoSchedulerSWI,
+	/// when the kernel would run the current task again, or switch to the
+	/// next task with the native scheduler.
+	///
+	/// \param ioCPU	processor, returned to the caller or switched to the
+	///					next task on success.
+	/// \return true if the kernel must schedule.
+	///
+	Boolean		SchedulerSWI( TARMProcessor* ioCPU );
+
+	///
+	/// Switch tasks on the host, at the entry of Scheduler, when the kernel
+	/// would run the current task again: there is nothing to switch. With
+	/// the native scheduler, make the next task of the mirror current.
+	///
+	/// \param ioCPU	processor, returned to the caller on success.
+	/// \return true if the kernel must schedule.
+	///
+	Boolean		SwitchTask( TARMProcessor* ioCPU );
+
+	///
+	/// Add a task to the ready queues of the mirror, at the entry of
+	/// TScheduler::Add and TScheduler::AddWhenNotCurrent (r1 = task).
+	/// Without the native scheduler, only remember that it is ready.
+	///
+	/// \param ioCPU				processor, returned to the caller on
+	///							success.
+	/// \param inWhenNotCurrent	whether the current task runs again
+	///							instead.
+	/// \return true if the kernel must add the task.
+	///
+	Boolean		AddTask( TARMProcessor* ioCPU, Boolean inWhenNotCurrent );
+
+	///
+	/// Remove a task from the ready queues of the mirror, at the entry of
+	/// TScheduler::Remove (r1 = task). Without the native scheduler, only
+	/// remember that it blocked.
+	///
+	/// \param ioCPU	processor, returned to the caller on success.
+	/// \return true if the kernel must remove the task.
+	///
+	Boolean		RemoveTask( TARMProcessor* ioCPU );
+
+	///
+	/// Remember that a task blocked if it is the current task, at the entry
+	/// of TScheduler::Remove.
+	///
+	/// \param inTask	address of the TTask.
+	///
+	void		RememberRemovedTask( KUInt32 inTask );
+
+	///
+	/// Remember that a task is ready, at the entry of TScheduler::Add and
+	/// TScheduler::AddWhenNotCurrent.
+	///
+	/// \param inTask	address of the TTask.
+	///
+	void		RememberAddedTask( KUInt32 inTask );
+
+	///
+	/// Map a page again on the host, at the data abort vector, if the
+	/// kernel mapped it before.
+	///
+	/// \param ioCPU	processor, returned to the aborted instruction on
+	///					success.
+	/// \return true if the kernel must handle the abort.
+	///
+	Boolean		PageFault( TARMProcessor* ioCPU );
+
+	///
+	/// Forget the pages the kernel mapped, when it changes the mappings
+	/// otherwise than by forgetting them.
+	///
+	void		ForgetPages( void );
+
+	///
+	/// Remember how the kernel mapped the page of the last fault it handled,
+	/// at the next fault or before ForgetMapping unmaps it.
+	///
+	void		RememberPendingPage( void );
+
+	///
+	/// Accessor on the number of calls and faults handled on the host.
+	///
+	/// \return the number of calls and faults.
+	///
+	KUInt32		GetFastPathCount( void ) const
+		{
+			return mFastPathCount;
+		}
+
+	///
+	/// Accessor on the number of calls and faults that went through the
+	/// kernel.
+	///
+	/// \return the number of calls and faults.
+	///
+	KUInt32		GetKernelCallCount( void ) const
+		{
+			return mKernelCallCount;
+		}
+
+private:
+	/// Object the kernel passed to a call.
+	struct SObject {
+		KUInt32		fId;		///< Id of the object (0 if free).
+		KUInt32		fAddress;	///< Address of the object.
+	};
+
+	/// Page the kernel mapped.
+	struct SPage {
+		KUInt32		fPage;			///< Virtual address of the page.
+		KUInt32		fTableBase;		///< Translation table base.
+		KUInt32		fSectionEntry;	///< First level descriptor.
+		KUInt32		fEntryAddress;	///< Address of the second level descriptor.
+		KUInt32		fEntry;			///< Second level descriptor (0 if free).
+	};
+
+	///
+	/// Copy constructor, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TNativeKernel( const TNativeKernel& inCopy );
+
+	///
+	/// Assignment operator, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TNativeKernel& operator = ( const TNativeKernel& inCopy );
+
+	///
+	/// Read a word with the kernel privileges, without changing the mode.
+	///
+	/// \param inAddress	virtual address.
+	/// \param outWord		word read.
+	/// \return true if the address can't be read.
+	///
+	Boolean		ReadKernel( KUInt32 inAddress, KUInt32& outWord );
+
+	///
+	/// Write a word with the kernel privileges, without changing the mode.
+	///
+	/// \param inAddress	virtual address.
+	/// \param inWord		word to write.
+	/// \return true if the address can't be written.
+	///
+	Boolean		WriteKernel( KUInt32 inAddress, KUInt32 inWord );
+
+	///
+	/// Find a remembered object and check that it still has its id.
+	///
+	/// \param inId		id of the object.
+	/// \return the address of the object or 0.
+	///
+	KUInt32		LookupObject( KUInt32 inId );
+
+	///
+	/// Remember an object if it has the id of the pending call.
+	///
+	/// \param inId			id the user passed to the pending call.
+	/// \param inAddress	address of the object.
+	///
+	void		RememberObject( KUInt32 inId, KUInt32 inAddress );
+
+	///
+	/// Do the operations of a list on the semaphores of a group, if none
+	/// would block or wake a task.
+	///
+	/// \param inGroup	address of the TSemaphoreGroup.
+	/// \param inList	address of the TSemaphoreOpList.
+	/// \return true if the kernel must do the operations.
+	///
+	Boolean		DoSemaphoreOp( KUInt32 inGroup, KUInt32 inList );
+
+	///
+	/// Write the descriptor of a remembered page again, if the tables
+	/// still lead to it and it is still a fault.
+	///
+	/// \param inAddress		address of the fault.
+	/// \param inTableBase	translation table base.
+	/// \return true if the kernel must map the page.
+	///
+	Boolean		MapPage( KUInt32 inAddress, KUInt32 inTableBase );
+
+	///
+	/// Find out if the kernel would run the current task again: the
+	/// schedule is not on hold, the task didn't block and no task of its
+	/// priority or higher is ready.
+	///
+	/// \return true if the kernel must schedule.
+	///
+	Boolean		MustSchedule( void );
+
+	///
+	/// Switch to the next task of the mirror, at the entry of
+	/// DoSchedulerSWI. The registers of the current task go to the save
+	/// area of its TTask and those of the next task come from it.
+	///
+	/// \param ioCPU	processor, in user mode.
+	/// \return true if the kernel must schedule.
+	///
+	Boolean		YieldTask( TARMProcessor* ioCPU );
+
+	///
+	/// Get the current task of the mirror. The first time, this is the
+	/// current task of the kernel.
+	///
+	/// \return the task or \c nil if the kernel must schedule.
+	///
+	TTask*		GetCurrentTask( void );
+
+	///
+	/// Find the mirror of a task, or create it with the priority of the
+	/// TTask. The mirror of a blocked task may be reused.
+	///
+	/// \param inAddress	address of the TTask.
+	/// \return the task or \c nil if the TTask can't be read or the mirror
+	///			is full.
+	///
+	TTask*		FindTask( KUInt32 inAddress );
+
+	///
+	/// Write the saved registers of a task to its TTask.
+	///
+	/// \param inTask	task.
+	/// \return true if the TTask can't be written.
+	///
+	Boolean		StoreTaskContext( const TTask* inTask );
+
+	///
+	/// Read the saved registers of a task from its TTask.
+	///
+	/// \param ioTask	task.
+	/// \return true if the TTask can't be read.
+	///
+	Boolean		LoadTaskContext( TTask* ioTask );
+
+	/// \name Variables
+	TLog*			mLog;				///< Interface for logging.
+	TMemory*		mMemoryIntf;		///< Interface to memory.
+	SObject			mObjects[kObjectCacheSize];	///< Remembered objects.
+	KUInt32			mPendingGroupId;	///< Group of the last kernel call.
+	KUInt32			mPendingListId;		///< List of the last kernel call.
+	SPage			mPages[kPageCacheSize];		///< Remembered pages.
+	Boolean			mPageFaultPending;	///< Whether the kernel handles a fault.
+	KUInt32			mPendingPage;		///< Page of the fault.
+	KUInt32			mPendingTableBase;	///< Translation table base of the fault.
+	KUInt32			mBlockedTask;		///< Current task that blocked, or 0.
+	TScheduler		mScheduler;			///< Mirror of the ready queues.
+	TTask*			mTasks[kTaskCacheSize];	///< Mirrors of the tasks.
+	Boolean			mSchedulerStarted;	///< Whether the mirror has a current task.
+	KUInt32			mFastPathCount;		///< Calls done on the host.
+	KUInt32			mKernelCallCount;	///< Calls done by the kernel.
+};
+
+#endif
+		// _TNATIVEKERNEL_H
+
+// ====================================================================== //
+// The first time, it's a KLUDGE!                                         //
+// The second, a trick.                                                   //
+// Later, it's a well-established technique!                              //
+//                 -- Mike Broido, Intermetrics                           //
+// ====================================================================== //
@@ -25,6 +25,9 @@
 #include "TVirtualizedCalls.h"
 #include "TVirtualizedCallsPatches.h"
 
+// ANSI C & POSIX
+#include <string.h>
+
 // Einstein
 #include "TARMProcessor.h"
 #include "TEmulator.h"
@@ -35,7 +38,11 @@
 // Constantes
 // -------------------------------------------------------------------------- //
 
-#define min(a,b) (a) < (b) ? (a) : (b)
+// Buffer for copies: a page.
+const KUInt32 kCopyBufferSize = TMemoryConsts::kMMUSmallestPageSize;
+
+// Strings are usually short: read them by small chunks.
+const KUInt32 kStringChunkSize = 64;
 
 // -------------------------------------------------------------------------- //
 //  * TVirtualizedCalls( void )
@@ -87,65 +94,51 @@ TVirtualizedCalls::__rt_udiv( void )
 }
 
 // -------------------------------------------------------------------------- //
-//  * memmove_slow( KUInt32, KUInt32, KUInt32 )
+//  * TranslatePages( KUInt32, KUInt32, Boolean )
 // -------------------------------------------------------------------------- //
-inline void
-TVirtualizedCalls::memmove_slow( KUInt32 inDst, KUInt32 inSrc, KUInt32 inLen )
+inline Boolean
+TVirtualizedCalls::TranslatePages(
+					KUInt32 inAddress,
+					KUInt32 inLen,
+					Boolean inWrite )
 {
-	// Slow version of memmove, typically for memmove with hardware.
-	KUInt32 len = inLen;
-	KUInt32 src = inSrc;
-	KUInt32 dst = inDst;
 	TMemory* theMemoryIntf = mMemoryIntf;
-	
-//	if ((src & 0x3) || (dst & 0x3) || (len & 0x3))
-//	{
-//		printf( "unaligned memmove( dst=%.8X, src=%.8X, len=%.8X )\n", inDst, inSrc, inLen );
-//	} else {
-//		printf( "  aligned memmove( dst=%.8X, src=%.8X, len=%.8X )\n", inDst, inSrc, inLen );
-//	}
-
-	while (len > 3)
+	if ((inLen == 0) || !theMemoryIntf->IsMMUEnabled())
 	{
-		KUInt32 word;
-		if (theMemoryIntf->Read( src, word ))
-		{
-			len = 0;
-			break;
-		}
-		if (theMemoryIntf->Write( dst, word ))
-		{
-			len = 0;
-			break;
-		}
-		
-		src += 4;
-		dst += 4;
-		len -= 4;
+		return false;
 	}
 
-	while (len)
-	{
-		KUInt8 byte;
-		if (theMemoryIntf->ReadB( src, byte ))
+	KUInt32 theAddress = inAddress;
+	KUInt32 theLastPage =
+		(inAddress + inLen - 1) & TMemoryConsts::kMMUSmallestPageMask;
+	do {
+		TMemory::PAddr thePAddr;
+		if (inWrite)
 		{
-			break;
+			if (theMemoryIntf->TranslateW( theAddress, thePAddr ))
+			{
+				return true;
+			}
+		} else if (!TMemory::IsPageInROM( theAddress )) {
+			if (theMemoryIntf->TranslateR( theAddress, thePAddr ))
+			{
+				return true;
+			}
 		}
-		if (theMemoryIntf->WriteB( dst, byte ))
+		theAddress &= TMemoryConsts::kMMUSmallestPageMask;
+		if (theAddress == theLastPage)
 		{
 			break;
 		}
-		
-		src += 1;
-		dst += 1;
-		len -= 1;
-	}
+		theAddress += TMemoryConsts::kMMUSmallestPageSize;
+	} while (true);
+	
+	return false;
 }
 
 // -------------------------------------------------------------------------- //
 //  * memmove( void )
 // -------------------------------------------------------------------------- //
-// BROKEN ON LITTLE ENDIAN
 inline void
 TVirtualizedCalls::memmove( void )
 {
@@ -153,75 +146,51 @@ TVirtualizedCalls::memmove( void )
 	KUInt32 src = mProcessor->GetRegister(1);
 	KUInt32 len = mProcessor->GetRegister(2);
 	TMemory* theMemoryIntf = mMemoryIntf;
-	
-//	memmove_slow(dst, src, len);
 
-	do {
-		if ((dst == src) || (len == 0))
+	if ((dst == src) || (len == 0))
+	{
+		return;
+	}
+
+	// Translate every page first. If one is missing, nothing was copied
+	// yet and the call is executed again once the OS handled the abort.
+	if (TranslatePages( src, len, false ) || TranslatePages( dst, len, true ))
+	{
+		mProcessor->DataAbort();
+		return;
+	}
+
+	// Copy through a buffer (which also takes care of the byte order and
+	// of alignment), backwards if the destination overlaps the end of
+	// the source.
+	KUInt8 theBuffer[kCopyBufferSize];
+	Boolean backwards = (dst > src) && ((dst - src) < len);
+	KUInt32 offset = backwards ? len : 0;
+	while (len > 0)
+	{
+		KUInt32 amount = len;
+		if (amount > kCopyBufferSize)
 		{
-			break;
+			amount = kCopyBufferSize;
 		}
-
-		// Optimization: consider page by page.
-		const KUInt8* srcPtr;
-		if (theMemoryIntf->GetDirectPointerToROMRAM(src, &srcPtr))
+		if (backwards)
 		{
-			memmove_slow(dst, src, len);
-			break;
+			offset -= amount;
 		}
-		KUInt8* dstPtr;
-		if (theMemoryIntf->GetDirectPointerToRAM(dst, &dstPtr))
+		if (theMemoryIntf->FastReadBuffer( src + offset, amount, theBuffer )
+			|| theMemoryIntf->FastWriteBuffer( dst + offset, amount, theBuffer ))
 		{
-			memmove_slow(dst, src, len);
+			// Hardware fault.
 			break;
 		}
-		
-		KUInt32 baseSrc = src & TMemoryConsts::kMMUSmallestPageMask;
-		KUInt32 baseDst = dst & TMemoryConsts::kMMUSmallestPageMask;
-		KUInt32 maxSrc = baseSrc - src + TMemoryConsts::kMMUSmallestPageSize;
-		KUInt32 maxDst = baseDst - dst + TMemoryConsts::kMMUSmallestPageSize;
-		
-		do {
-			KUInt32 amount = min(min(len, maxSrc), maxDst);
-			(void) ::memmove( dstPtr, srcPtr, amount );
-			len -= amount;
-			if (len == 0)
-			{
-				break;
-			}
-			
-			src += amount;
-			dst += amount;
-			if (amount == maxSrc)
-			{
-				if (theMemoryIntf->GetDirectPointerToROMRAM(src, &srcPtr))
-				{
-					theMemoryIntf->SetHardwareFault(src);
-					break;
-				}
-				baseSrc += TMemoryConsts::kMMUSmallestPageSize;
-				maxSrc = TMemoryConsts::kMMUSmallestPageSize;
-			} else {
-				maxSrc -= amount;
-				srcPtr += amount;
-			}
-			if (amount == maxDst)
-			{
-				if (theMemoryIntf->GetDirectPointerToRAM(dst, &dstPtr))
-				{
-					theMemoryIntf->SetHardwareFault(dst);
-					break;
-				}
-				baseDst += TMemoryConsts::kMMUSmallestPageSize;
-				maxDst = TMemoryConsts::kMMUSmallestPageSize;
-			} else {
-				maxDst -= amount;
-				dstPtr += amount;
-			}
-		} while (true);
-	} while (false);
-	
-	// mProcessor->SetRegister(0, dst);
+		if (!backwards)
+		{
+			offset += amount;
+		}
+		len -= amount;
+	}
+
+	// The result (dst) is already in r0.
 }
 
 // -------------------------------------------------------------------------- //
@@ -360,6 +329,155 @@ TVirtualizedCalls::symcmp__FPcT1( void )
 	mProcessor->SetRegister(0, result);
 }
 
+// -------------------------------------------------------------------------- //
+//  * memset( void )
+// -------------------------------------------------------------------------- //
+inline void
+TVirtualizedCalls::memset( void )
+{
+	KUInt32 dst = mProcessor->GetRegister(0);
+	KUInt8 value = (KUInt8) mProcessor->GetRegister(1);
+	KUInt32 len = mProcessor->GetRegister(2);
+	TMemory* theMemoryIntf = mMemoryIntf;
+
+	// Like memmove, fault before anything is written.
+	if (TranslatePages( dst, len, true ))
+	{
+		mProcessor->DataAbort();
+		return;
+	}
+
+	KUInt8 theBuffer[kCopyBufferSize];
+	(void) ::memset(
+				theBuffer,
+				value,
+				(len < kCopyBufferSize) ? len : kCopyBufferSize );
+	while (len > 0)
+	{
+		KUInt32 amount = len;
+		if (amount > kCopyBufferSize)
+		{
+			amount = kCopyBufferSize;
+		}
+		if (theMemoryIntf->FastWriteBuffer( dst, amount, theBuffer ))
+		{
+			// Hardware fault.
+			break;
+		}
+		dst += amount;
+		len -= amount;
+	}
+
+	// The result (dst) is already in r0.
+}
+
+// -------------------------------------------------------------------------- //
+//  * memcmp( void )
+// -------------------------------------------------------------------------- //
+inline void
+TVirtualizedCalls::memcmp( void )
+{
+	KUInt32 s1 = mProcessor->GetRegister(0);
+	KUInt32 s2 = mProcessor->GetRegister(1);
+	KUInt32 len = mProcessor->GetRegister(2);
+	TMemory* theMemoryIntf = mMemoryIntf;
+	KUInt32 result = 0;
+
+	KUInt8 theBuffer1[kCopyBufferSize];
+	KUInt8 theBuffer2[kCopyBufferSize];
+	while (len > 0)
+	{
+		// Stop at the first page boundary of either buffer, so that only
+		// the pages the ROM would read are translated.
+		KUInt32 amount = TMemoryConsts::kMMUSmallestPageSize
+			- (s1 & TMemoryConsts::kMMUSmallestPageMaskNeg);
+		KUInt32 amount2 = TMemoryConsts::kMMUSmallestPageSize
+			- (s2 & TMemoryConsts::kMMUSmallestPageMaskNeg);
+		if (amount > amount2)
+		{
+			amount = amount2;
+		}
+		if (amount > len)
+		{
+			amount = len;
+		}
+
+		// Nothing is modified: the call can be executed again from the
+		// start once the OS handled the abort.
+		if (TranslatePages( s1, amount, false )
+			|| TranslatePages( s2, amount, false ))
+		{
+			mProcessor->DataAbort();
+			return;
+		}
+		if (theMemoryIntf->FastReadBuffer( s1, amount, theBuffer1 )
+			|| theMemoryIntf->FastReadBuffer( s2, amount, theBuffer2 ))
+		{
+			// Hardware fault.
+			break;
+		}
+		if (::memcmp( theBuffer1, theBuffer2, amount ) != 0)
+		{
+			// Difference of the first different bytes.
+			KUInt32 index = 0;
+			while (theBuffer1[index] == theBuffer2[index])
+			{
+				index++;
+			}
+			result = (KUInt32) ((KSInt32) theBuffer1[index]
+				- (KSInt32) theBuffer2[index]);
+			break;
+		}
+		s1 += amount;
+		s2 += amount;
+		len -= amount;
+	}
+
+	mProcessor->SetRegister(0, result);
+}
+
+// -------------------------------------------------------------------------- //
+//  * strlen( void )
+// -------------------------------------------------------------------------- //
+inline void
+TVirtualizedCalls::strlen( void )
+{
+	KUInt32 s = mProcessor->GetRegister(0);
+	TMemory* theMemoryIntf = mMemoryIntf;
+
+	KUInt8 theBuffer[kStringChunkSize];
+	KUInt32 theAddress = s;
+	do {
+		// Never read across a page.
+		KUInt32 amount = TMemoryConsts::kMMUSmallestPageSize
+			- (theAddress & TMemoryConsts::kMMUSmallestPageMaskNeg);
+		if (amount > kStringChunkSize)
+		{
+			amount = kStringChunkSize;
+		}
+		if (TranslatePages( theAddress, amount, false ))
+		{
+			mProcessor->DataAbort();
+			return;
+		}
+		if (theMemoryIntf->FastReadBuffer( theAddress, amount, theBuffer ))
+		{
+			// Hardware fault.
+			break;
+		}
+		const KUInt8* theEnd =
+			(const KUInt8*) ::memchr( theBuffer, 0, amount );
+		if (theEnd)
+		{
+			theAddress += (KUInt32) (theEnd - theBuffer);
+			break;
+		}
+		theAddress += amount;
+	} while (true);
+
+	mProcessor->SetRegister(0, theAddress - s);
+}
+
 
 // -------------------------------------------------------------------------- //
 //  * Execute( KUInt32 )
@@ -385,6 +503,18 @@ TVirtualizedCalls::Execute( KUInt32 inInstruction )
 			symcmp__FPcT1();
 			break;
 
+		case TVirtualizedCallsPatches::kmemset:
+			memset();
+			break;
+
+		case TVirtualizedCallsPatches::kmemcmp:
+			memcmp();
+			break;
+
+		case TVirtualizedCallsPatches::kstrlen:
+			strlen();
+			break;
+
 		default:
 			break;
 	}
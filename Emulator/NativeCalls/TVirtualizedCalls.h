@@ -84,17 +84,45 @@ private:
 	///
 	inline void __rt_udiv( void );
 
+	///
+	/// Translate all the pages of a guest buffer, to raise the fault before
+	/// anything is modified.
+	///
+	/// \param inAddress	virtual address of the buffer.
+	/// \param inLen		size of the buffer.
+	/// \param inWrite		whether the buffer will be written.
+	/// \return true if a page could not be translated.
+	///
+	inline Boolean TranslatePages(
+						KUInt32 inAddress,
+						KUInt32 inLen,
+						Boolean inWrite );
+
 	///
 	/// memmove
 	///
 	inline void memmove( void );
-	inline void memmove_slow( KUInt32 inDst, KUInt32 inSrc, KUInt32 inLen );
 
 	///
 	/// symcmp__FPcT1
 	///
 	inline void symcmp__FPcT1( void );
 
+	///
+	/// memset
+	///
+	inline void memset( void );
+
+	///
+	/// memcmp
+	///
+	inline void memcmp( void );
+
+	///
+	/// strlen
+	///
+	inline void strlen( void );
+
 	/// \name Variables
 	TEmulator*		mEmulator;		///< Interface to the emulator.
 	TMemory*		mMemoryIntf;	///< Interface to memory.
@@ -22,6 +22,9 @@
 #include <K/Defines/KDefinitions.h>
 #include "TVirtualizedCallsPatches.h"
 
+// ANSI C & POSIX
+#include <string.h>
+
 // -------------------------------------------------------------------------- //
 // Constantes
 // -------------------------------------------------------------------------- //
@@ -47,44 +50,88 @@ const KUInt32 k717006VirtualizationPatches[] = {
 	// __rt_udiv
 	(0x0038C8FC + 8) / sizeof(KUInt32),	TVirtualizedCallsPatches::k__rt_udiv,
 	// memmove
-	//0x00382440 / sizeof(KUInt32),   TVirtualizedCallsPatches::kmemmove,
+	0x00382440 / sizeof(KUInt32),	TVirtualizedCallsPatches::kmemmove,
 	// symcmp__FPcT1
 	0x00358C9C / sizeof(KUInt32),	TVirtualizedCallsPatches::ksymcmp__FPcT1,
+	// memset (ClearMemory, the ROM's bzero, jumps there)
+	0x003828C8 / sizeof(KUInt32),	TVirtualizedCallsPatches::kmemset,
+	// memcmp
+	0x00358074 / sizeof(KUInt32),	TVirtualizedCallsPatches::kmemcmp,
+	// strlen
+	0x003580E4 / sizeof(KUInt32),	TVirtualizedCallsPatches::kstrlen,
 	0
 };
 
+// Names of the routines, in the order of the calls.
+static const char* const kCallNames[TVirtualizedCallsPatches::kNbCalls] = {
+	"__rt_sdiv",
+	"__rt_udiv",
+	"memmove",
+	"symcmp__FPcT1",
+	"memset",
+	"memcmp",
+	"strlen",
+};
+
 
 // -------------------------------------------------------------------------- //
-//  * DoPatchROM(KUInt32*, const std::string&)
+//  * DoPatchROM(KUInt32*, const std::string&, const STable*)
 // -------------------------------------------------------------------------- //
 void
-TVirtualizedCallsPatches::DoPatchROM(KUInt32* inROMPtr, const std::string& inMachineName) {
-	const KUInt32* patches = NULL;
-	
-	if (inMachineName == "717006") {
-		patches = k717006VirtualizationPatches;
-	}
-	
-	if (patches) {
+TVirtualizedCallsPatches::DoPatchROM(
+					KUInt32* inROMPtr,
+					const std::string& inMachineName,
+					const TROMPatchDatabase::STable* inTable) {
+	if (inTable) {
+		// Addresses from the database.
+		for (KUInt32 index = 0; index < inTable->fEntryCount; index++) {
+			const TROMPatchDatabase::SEntry* entry = &inTable->fEntries[index];
+			if (entry->fKind == TROMPatchDatabase::kVirtualized) {
+				PatchCall(inROMPtr, entry->fAddress / sizeof(KUInt32), entry->fValue);
+			}
+		}
+	} else if (inMachineName == "717006") {
 		// Iterate on patches.
+		const KUInt32* patches = k717006VirtualizationPatches;
 		while (*patches != 0) {
-			// Patch.
-			// Write all 5 words there.
-			KUInt32 address = patches[0];
-			
-			inROMPtr[address++] = kInvocation[0];
-			inROMPtr[address++] = kInvocation[1];
-			inROMPtr[address++] = kInvocation[2];
-			inROMPtr[address++] = kInvocation[3];
-			
-			// The last word in the patch is a fake instruction
-			// which will be caught in TNativePrimitives::ExecuteNative()
-			// because the high bit is set
-			
-			KUInt32 value = patches[1] | 0x80000000;
-			inROMPtr[address] = value;
-			
+			PatchCall(inROMPtr, patches[0], patches[1]);
 			patches += 2;
 		}
 	}
 }
+
+// -------------------------------------------------------------------------- //
+//  * PatchCall(KUInt32*, KUInt32, KUInt32)
+// -------------------------------------------------------------------------- //
+void
+TVirtualizedCallsPatches::PatchCall(KUInt32* inROMPtr, KUInt32 inAddress, KUInt32 inCall) {
+	// Write all 5 words there.
+	KUInt32 address = inAddress;
+	
+	inROMPtr[address++] = kInvocation[0];
+	inROMPtr[address++] = kInvocation[1];
+	inROMPtr[address++] = kInvocation[2];
+	inROMPtr[address++] = kInvocation[3];
+	
+	// The last word in the patch is a fake instruction
+	// which will be caught in TNativePrimitives::ExecuteNative()
+	// because the high bit is set
+	
+	KUInt32 value = inCall | 0x80000000;
+	inROMPtr[address] = value;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetCallByName(const char*)
+// -------------------------------------------------------------------------- //
+KUInt32
+TVirtualizedCallsPatches::GetCallByName(const char* inName) {
+	KUInt32 call;
+	for (call = 0; call < kNbCalls; call++) {
+		if (::strcmp(kCallNames[call], inName) == 0) {
+			break;
+		}
+	}
+	
+	return call;
+}
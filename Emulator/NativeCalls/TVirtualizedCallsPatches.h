@@ -27,6 +27,9 @@
 // C++
 #include <string>
 
+// Einstein
+#include "Emulator/ROM/TROMPatchDatabase.h"
+
 ///
 /// Class for virtualized calls constants.
 ///
@@ -40,9 +43,38 @@ public:
 		k__rt_udiv,
 		kmemmove,
 		ksymcmp__FPcT1,
+		kmemset,
+		kmemcmp,
+		kstrlen,
+		kNbCalls
 	};
 
-	static void DoPatchROM(KUInt32* romPtr, const std::string& inMachineName);
+	///
+	/// Patch the ROM with the calls of a table of the patch database, or
+	/// with the calls of the 717006 ROM if there is no table.
+	///
+	static void DoPatchROM(
+					KUInt32* romPtr,
+					const std::string& inMachineName,
+					const TROMPatchDatabase::STable* inTable = NULL);
+
+	///
+	/// Find a call from the name of the ROM routine.
+	///
+	/// \param inName	name of the routine, like memmove.
+	/// \return the call or kNbCalls if there is none.
+	///
+	static KUInt32 GetCallByName(const char* inName);
+
+private:
+	///
+	/// Write the invocation of a call.
+	///
+	/// \param inROMPtr		ROM words.
+	/// \param inAddress	address of the invocation.
+	/// \param inCall		call.
+	///
+	static void PatchCall(KUInt32* inROMPtr, KUInt32 inAddress, KUInt32 inCall);
 
 };
 
@@ -31,6 +31,7 @@
 #include "Emulator/Log/TLog.h"
 #include "Emulator/TEmulator.h"
 #include "Emulator/TARMProcessor.h"
+#include "Emulator/TMemory.h"
 #include "Emulator/TInterruptManager.h"
 #include "Emulator/PCMCIA/TPCMCIACard.h"
 
@@ -71,6 +72,10 @@ TPCMCIAController::TPCMCIAController(
 		mReg_3C00( 0 ),
 		mReg_4000( 0 )
 {
+	TMemory::SIOHandler theHandler =
+		{ this, ReadIOWord, WriteIOWord, ReadIOByte, WriteIOByte };
+	(void) mEmulator->GetMemory()->RegisterIOHandler(
+		GetIOBase(), GetIOBase() + kSocketSize, theHandler );
 }
 
 // -------------------------------------------------------------------------- //
@@ -78,6 +83,72 @@ TPCMCIAController::TPCMCIAController(
 // -------------------------------------------------------------------------- //
 TPCMCIAController::~TPCMCIAController( void )
 {
+	mEmulator->GetMemory()->UnregisterIOHandler(
+		GetIOBase(), GetIOBase() + kSocketSize );
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetIOBase( void ) const
+// -------------------------------------------------------------------------- //
+KUInt32
+TPCMCIAController::GetIOBase( void ) const
+{
+	return TMemoryConsts::kPCMCIA0Base + (mSocketIx * kSocketSize);
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadIOWord( void*, KUInt32, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TPCMCIAController::ReadIOWord(
+			void* inObject,
+			KUInt32 inAddress,
+			Boolean& /* outFault */ )
+{
+	return ((TPCMCIAController*) inObject)->Read(
+		inAddress & (kSocketSize - 1) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteIOWord( void*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TPCMCIAController::WriteIOWord(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt32 inWord )
+{
+	((TPCMCIAController*) inObject)->Write(
+		inAddress & (kSocketSize - 1), inWord );
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadIOByte( void*, KUInt32, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TPCMCIAController::ReadIOByte(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt8& outByte )
+{
+	outByte = ((TPCMCIAController*) inObject)->ReadB(
+		inAddress & (kSocketSize - 1) );
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteIOByte( void*, KUInt32, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TPCMCIAController::WriteIOByte(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt8 inByte )
+{
+	((TPCMCIAController*) inObject)->WriteB(
+		inAddress & (kSocketSize - 1), inByte );
+	return false;
 }
 
 // -------------------------------------------------------------------------- //
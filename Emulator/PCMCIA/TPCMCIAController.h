@@ -172,6 +172,7 @@ public:
 	
 	/// \name Constants
 	enum {
+		kSocketSize			= 0x10000000,	///< Address space of a socket.
 		kAttrEndMask		= 0x3FFFFFF,
 		kIOSpace			= 0x4000000,
 		kIOEndMask			= 0x7FFFFFF,
@@ -261,6 +262,22 @@ private:
 	///
 	TPCMCIAController& operator = ( const TPCMCIAController& inCopy );
 
+	///
+	/// Get the physical address of the space of this socket.
+	///
+	KUInt32	GetIOBase( void ) const;
+
+	/// \name Handlers of the socket space (see TMemory::SIOHandler).
+	/// The object is the TPCMCIAController.
+	static KUInt32	ReadIOWord(
+						void* inObject, KUInt32 inAddress, Boolean& outFault );
+	static Boolean	WriteIOWord(
+						void* inObject, KUInt32 inAddress, KUInt32 inWord );
+	static Boolean	ReadIOByte(
+						void* inObject, KUInt32 inAddress, KUInt8& outByte );
+	static Boolean	WriteIOByte(
+						void* inObject, KUInt32 inAddress, KUInt8 inByte );
+
 	/// \name Variables
 	TLog*				mLog;			///< Interface to the log.
 	TInterruptManager*	mIntManager;	///< Interrupt manager
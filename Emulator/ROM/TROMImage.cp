@@ -43,7 +43,6 @@
 
 // K
 #include <K/Misc/TMappedFile.h>
-#include <K/Defines/UByteSex.h>
 
 // Einstein
 #include "TMemoryConsts.h"
@@ -54,6 +53,8 @@
 
 #include "TEmulator.h"
 #include "TScreenManager.h"
+#include "Host/USwapCopy.h"
+#include "TROMPatchDatabase.h"
 
 // -------------------------------------------------------------------------- //
 //  * TROMImage( void )
@@ -61,7 +62,8 @@
 TROMImage::TROMImage( void )
 	:
 		mMappedFile( NULL ),
-		mImage( NULL )
+		mImage( NULL ),
+		mImagePath( NULL )
 {
 	// I'll create the mmap file later, when asked to.
 }
@@ -80,6 +82,11 @@ TROMImage::~TROMImage( void )
 		::free( mImage );
 		mImage = NULL;
 	}
+	if (mImagePath)
+	{
+		::free( mImagePath );
+		mImagePath = NULL;
+	}
 }
 
 // -------------------------------------------------------------------------- //
@@ -121,6 +128,17 @@ TROMImage::IsImageOutdated(
 			break;
 		}
 		
+		// Check the patch database.
+		struct stat thePatchesInfos;
+		std::string thePatchesPath =
+			TROMPatchDatabase::GetPathForImage( inPath );
+		if ((::stat( thePatchesPath.c_str(), &thePatchesInfos ) == 0)
+			&& (thePatchesInfos.st_mtime > theInfos.st_mtime))
+		{
+			// The patches are newer.
+			break;
+		}
+		
 		// Read magic & the version.
 #if TARGET_OS_WIN32
 		int fd = ::open( inPath, O_RDONLY|O_BINARY, 0 );
@@ -193,17 +211,8 @@ TROMImage::CreateImage(
 	// Write this at the start of the image.
 	
 #if TARGET_RT_LITTLE_ENDIAN
-	{
-		// Endian swap it first
-		
-		KUInt32* src = (KUInt32*) inBuffer;
-		KUInt32* dest = (KUInt32*) theImagePtr;
-		KUInt32* end = (KUInt32*) &inBuffer[inBufferSize];
-		do {
-			*dest = UByteSex::Swap( *src );
-			++dest;
-		} while (++src < end);
-	}
+	// Endian swap it first
+	USwapCopy::SwapWords( (KUInt8*) theImagePtr, inBuffer, inBufferSize );
 #else
 	(void) ::memcpy(theImagePtr, inBuffer, inBufferSize);
 #endif
@@ -220,7 +229,40 @@ TROMImage::CreateImage(
 				inMachineString,	// like "717006"
 				6);
 	
-	JITClass::PatchROM((KUInt32*) theImagePtr->fROM, inMachineString);
+	// Look for the patches of this ROM, from the checksums of the base ROM
+	// before it is patched.
+	TROMPatchDatabase theDatabase;
+	const TROMPatchDatabase::STable* theTable = NULL;
+	if (!theDatabase.LoadFile(
+			TROMPatchDatabase::GetPathForImage( inPath ).c_str() ))
+	{
+		KUInt32 theBaseSize;
+		KUInt32 theRexBases[4];
+		KUInt32 theRexSizes[4];
+		KUInt32 theChecksums[2];
+		(void) LookForREXes(
+					theImagePtr->fROM, &theBaseSize, theRexBases, theRexSizes );
+		ComputeSegmentChecksums( theImagePtr->fROM, theBaseSize, theChecksums );
+		theTable = theDatabase.FindTable( inMachineString, theChecksums );
+		if (theTable == NULL)
+		{
+			// What a table for this ROM starts with.
+			fprintf(stderr, "No patches for rom %.6s 0x%.8X 0x%.8X\n",
+				inMachineString,
+				(unsigned int) theChecksums[0],
+				(unsigned int) theChecksums[1] );
+		}
+	}
+	if (theTable
+		&& TROMPatchDatabase::Validate(
+				theTable, (const KUInt32*) theImagePtr->fROM ))
+	{
+		// Probably a table for another version of the ROM.
+		fprintf(stderr, "The patches don't match this ROM, ignoring them\n" );
+		theTable = NULL;
+	}
+	
+	JITClass::PatchROM((KUInt32*) theImagePtr->fROM, inMachineString, theTable);
 	
 	// Compute the checksum.
 	DoComputeChecksums(theImagePtr);
@@ -252,6 +294,12 @@ TROMImage::Init( const char* inPath, Boolean inMonitorMode )
 		mMappedFile = theMappedFile;
 		mImage = theImage;
 	}
+	
+	if (mImagePath)
+	{
+		::free( mImagePath );
+	}
+	mImagePath = ::strdup( inPath );
 }
 
 // -------------------------------------------------------------------------- //
@@ -70,6 +70,16 @@ public:
 	///
 	void	ComputeChecksums( KUInt32 outChecksums[10] ) const;
 
+	///
+	/// Accessor to the path of the (patched) image.
+	///
+	/// \return the path of the image or NULL if it wasn't loaded yet.
+	///
+	const char*	GetImagePath( void ) const
+		{
+			return mImagePath;
+		}
+
 protected:
 	///
 	/// Determine if the mmap is outdated and should be redone.
@@ -178,6 +188,7 @@ private:
 	
 	TMappedFile*	mMappedFile;	///< mapped file with the rom.
 	SImage*			mImage; 		///< image structure.
+	char*			mImagePath;		///< path of the image.
 };
 
 #endif
@@ -0,0 +1,426 @@
+// ==============================
+// File:			TROMPatchDatabase.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "TROMPatchDatabase.h"
+
+// ANSI C & POSIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Einstein
+#include "TMemoryConsts.h"
+#include "Emulator/Log/TLog.h"
+#include "Emulator/NativeCalls/TVirtualizedCallsPatches.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+static const char* const kFileName = "Einstein.patches";
+static const char* const kSeparators = " \t";
+
+// -------------------------------------------------------------------------- //
+//  * ParseWord( const char*, KUInt32*, Boolean* )
+// -------------------------------------------------------------------------- //
+static Boolean
+ParseWord( const char* inToken, KUInt32* outValue, Boolean* outKnown = NULL )
+{
+	if (inToken == NULL)
+	{
+		return true;
+	}
+	if ((outKnown != NULL) && (::strcmp( inToken, "-" ) == 0))
+	{
+		*outKnown = false;
+		*outValue = 0;
+		return false;
+	}
+	char* theEnd;
+	*outValue = (KUInt32) ::strtoul( inToken, &theEnd, 0 );
+	if (outKnown != NULL)
+	{
+		*outKnown = true;
+	}
+	return (theEnd == inToken) || (*theEnd != '\0');
+}
+
+// -------------------------------------------------------------------------- //
+//  * TROMPatchDatabase( void )
+// -------------------------------------------------------------------------- //
+TROMPatchDatabase::TROMPatchDatabase( void )
+	:
+		mTables( NULL ),
+		mTableCount( 0 ),
+		mTableCapacity( 0 )
+{
+}
+
+// -------------------------------------------------------------------------- //
+//  * ~TROMPatchDatabase( void )
+// -------------------------------------------------------------------------- //
+TROMPatchDatabase::~TROMPatchDatabase( void )
+{
+	Clear();
+}
+
+// -------------------------------------------------------------------------- //
+//  * Clear( void )
+// -------------------------------------------------------------------------- //
+void
+TROMPatchDatabase::Clear( void )
+{
+	KUInt32 indexTable;
+	for (indexTable = 0; indexTable < mTableCount; indexTable++)
+	{
+		::free( mTables[indexTable].fEntries );
+	}
+	::free( mTables );
+	mTables = NULL;
+	mTableCount = 0;
+	mTableCapacity = 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * LoadFile( const char* )
+// -------------------------------------------------------------------------- //
+Boolean
+TROMPatchDatabase::LoadFile( const char* inPath )
+{
+	FILE* theFile = ::fopen( inPath, "r" );
+	if (theFile == NULL)
+	{
+		return true;
+	}
+
+	// Read it all.
+	std::string theText;
+	char theBuffer[1024];
+	size_t theCount;
+	while ((theCount = ::fread( theBuffer, 1, sizeof(theBuffer), theFile )) > 0)
+	{
+		theText.append( theBuffer, theCount );
+	}
+	::fclose( theFile );
+
+	Boolean theResult = Parse( theText.c_str() );
+	if (theResult)
+	{
+		(void) ::fprintf( stderr, "Ignoring the patches of '%s'\n", inPath );
+	}
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Parse( const char*, TLog* )
+// -------------------------------------------------------------------------- //
+Boolean
+TROMPatchDatabase::Parse( const char* inText, TLog* inLog )
+{
+	Boolean theResult = false;
+	std::string theLine;
+	KUInt32 theLineNumber = 0;
+	const char* theCursor = inText;
+	while (*theCursor != '\0')
+	{
+		const char* theEnd = theCursor + ::strcspn( theCursor, "\r\n" );
+		theLine.assign( theCursor, theEnd - theCursor );
+		theLineNumber++;
+		if (ParseLine( &theLine[0] ))
+		{
+			if (inLog)
+			{
+				inLog->FLogLine( "Syntax error in patches, line %u",
+					(unsigned int) theLineNumber );
+			} else {
+				(void) ::fprintf( stderr, "Syntax error in patches, line %u\n",
+					(unsigned int) theLineNumber );
+			}
+			theResult = true;
+			break;
+		}
+		theCursor = theEnd;
+		if (*theCursor == '\r')
+		{
+			theCursor++;
+		}
+		if (*theCursor == '\n')
+		{
+			theCursor++;
+		}
+	}
+
+	if (theResult)
+	{
+		// Don't keep half of a file.
+		Clear();
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ParseLine( char* )
+// -------------------------------------------------------------------------- //
+Boolean
+TROMPatchDatabase::ParseLine( char* inLine )
+{
+	// Comments and empty lines.
+	char* theComment = ::strchr( inLine, '#' );
+	if (theComment)
+	{
+		*theComment = '\0';
+	}
+	char* theKeyword = ::strtok( inLine, kSeparators );
+	if (theKeyword == NULL)
+	{
+		return false;
+	}
+
+	if (::strcmp( theKeyword, "rom" ) == 0)
+	{
+		const char* theMachine = ::strtok( NULL, kSeparators );
+		const char* theChecksum0 = ::strtok( NULL, kSeparators );
+		const char* theChecksum1 = ::strtok( NULL, kSeparators );
+		if ((theMachine == NULL) || (::strlen( theMachine ) != 6)
+			|| (theChecksum1 == NULL)
+			|| (::strtok( NULL, kSeparators ) != NULL))
+		{
+			return true;
+		}
+		Boolean knownChecksum0;
+		Boolean knownChecksum1;
+		KUInt32 theChecksums[2];
+		if (ParseWord( theChecksum0, &theChecksums[0], &knownChecksum0 )
+			|| ParseWord( theChecksum1, &theChecksums[1], &knownChecksum1 )
+			|| (knownChecksum0 != knownChecksum1))
+		{
+			return true;
+		}
+
+		if (mTableCount == mTableCapacity)
+		{
+			mTableCapacity += 8;
+			mTables = (STable*) ::realloc(
+								mTables,
+								sizeof(STable) * mTableCapacity );
+		}
+		STable* theTable = &mTables[mTableCount++];
+		(void) ::memset( theTable, 0, sizeof(*theTable) );
+		(void) ::strcpy( theTable->fMachineString, theMachine );
+		theTable->fAnyChecksum = !knownChecksum0;
+		theTable->fChecksums[0] = theChecksums[0];
+		theTable->fChecksums[1] = theChecksums[1];
+		return false;
+	}
+
+	// Entries belong to the last rom.
+	if (mTableCount == 0)
+	{
+		return true;
+	}
+
+	KUInt32 theKind;
+	KUInt32 theAddress;
+	KUInt32 theValue = 0;
+	KUInt32 theOriginal;
+	Boolean knownOriginal;
+	if (::strcmp( theKeyword, "word" ) == 0)
+	{
+		theKind = kWord;
+	} else if (::strcmp( theKeyword, "compiled" ) == 0) {
+		theKind = kCompiled;
+	} else if (::strcmp( theKeyword, "virtualized" ) == 0) {
+		theKind = kVirtualized;
+	} else {
+		return true;
+	}
+	if (ParseWord( ::strtok( NULL, kSeparators ), &theAddress )
+		|| (theAddress & 0x3)
+		|| ((theKind == kWord)
+			&& ParseWord( ::strtok( NULL, kSeparators ), &theValue ))
+		|| ParseWord(
+			::strtok( NULL, kSeparators ), &theOriginal, &knownOriginal ))
+	{
+		return true;
+	}
+
+	// The name is the rest of the line, spaces included.
+	char* theName = ::strtok( NULL, "" );
+	if (theName != NULL)
+	{
+		theName += ::strspn( theName, kSeparators );
+		size_t theLength = ::strlen( theName );
+		while ((theLength > 0)
+			&& ((theName[theLength - 1] == ' ')
+				|| (theName[theLength - 1] == '\t')))
+		{
+			theName[--theLength] = '\0';
+		}
+	}
+	if ((theName == NULL) || (theName[0] == '\0')
+		|| (::strlen( theName ) >= kNameSize))
+	{
+		return true;
+	}
+	if (theKind == kVirtualized)
+	{
+		theValue = TVirtualizedCallsPatches::GetCallByName( theName );
+		if (theValue == TVirtualizedCallsPatches::kNbCalls)
+		{
+			return true;
+		}
+	}
+
+	SEntry* theEntry = AddEntry();
+	theEntry->fKind = theKind;
+	theEntry->fAddress = theAddress;
+	theEntry->fValue = theValue;
+	theEntry->fOriginal = theOriginal;
+	theEntry->fCheckOriginal = knownOriginal;
+	(void) ::strcpy( theEntry->fName, theName );
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * AddEntry( void )
+// -------------------------------------------------------------------------- //
+TROMPatchDatabase::SEntry*
+TROMPatchDatabase::AddEntry( void )
+{
+	STable* theTable = &mTables[mTableCount - 1];
+	if (theTable->fEntryCount == theTable->fEntryCapacity)
+	{
+		theTable->fEntryCapacity += 64;
+		theTable->fEntries = (SEntry*) ::realloc(
+								theTable->fEntries,
+								sizeof(SEntry) * theTable->fEntryCapacity );
+	}
+	return &theTable->fEntries[theTable->fEntryCount++];
+}
+
+// -------------------------------------------------------------------------- //
+//  * FindTable( const char[6], const KUInt32[2] ) const
+// -------------------------------------------------------------------------- //
+const TROMPatchDatabase::STable*
+TROMPatchDatabase::FindTable(
+					const char inMachineString[6],
+					const KUInt32 inChecksums[2] ) const
+{
+	const STable* theResult = NULL;
+	KUInt32 indexTable;
+	for (indexTable = 0; indexTable < mTableCount; indexTable++)
+	{
+		const STable* theTable = &mTables[indexTable];
+		if (::memcmp( theTable->fMachineString, inMachineString, 6 ) != 0)
+		{
+			continue;
+		}
+		if (!theTable->fAnyChecksum)
+		{
+			if ((theTable->fChecksums[0] == inChecksums[0])
+				&& (theTable->fChecksums[1] == inChecksums[1]))
+			{
+				theResult = theTable;
+				break;
+			}
+		} else if (theResult == NULL) {
+			theResult = theTable;
+		}
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Validate( const STable*, const KUInt32*, TLog* )
+// -------------------------------------------------------------------------- //
+KUInt32
+TROMPatchDatabase::Validate(
+					const STable* inTable,
+					const KUInt32* inROM,
+					TLog* inLog )
+{
+	KUInt32 nbMismatches = 0;
+	KUInt32 indexEntry;
+	for (indexEntry = 0; indexEntry < inTable->fEntryCount; indexEntry++)
+	{
+		const SEntry* theEntry = &inTable->fEntries[indexEntry];
+
+		// Virtualized calls overwrite 5 words.
+		KUInt32 theSize = (theEntry->fKind == kVirtualized) ? 5 * 4 : 4;
+		KUInt32 theFound = 0;
+		Boolean theMatch = false;
+		if (theEntry->fAddress + theSize <= TMemoryConsts::kHighROMEnd)
+		{
+			theFound = inROM[theEntry->fAddress / 4];
+			theMatch = !theEntry->fCheckOriginal
+				|| (theFound == theEntry->fOriginal);
+		}
+		if (!theMatch)
+		{
+			nbMismatches++;
+			if (inLog)
+			{
+				inLog->FLogLine( "%.8X (%s): %.8X instead of %.8X",
+					(unsigned int) theEntry->fAddress,
+					theEntry->fName,
+					(unsigned int) theFound,
+					(unsigned int) theEntry->fOriginal );
+			} else {
+				(void) ::fprintf( stderr, "%.8X (%s): %.8X instead of %.8X\n",
+					(unsigned int) theEntry->fAddress,
+					theEntry->fName,
+					(unsigned int) theFound,
+					(unsigned int) theEntry->fOriginal );
+			}
+		}
+	}
+
+	return nbMismatches;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetPathForImage( const char* )
+// -------------------------------------------------------------------------- //
+std::string
+TROMPatchDatabase::GetPathForImage( const char* inImagePath )
+{
+	std::string thePath( inImagePath );
+	std::string::size_type theSlash = thePath.find_last_of( "/\\" );
+	if (theSlash == std::string::npos)
+	{
+		thePath.clear();
+	} else {
+		thePath.erase( theSlash + 1 );
+	}
+	thePath += kFileName;
+
+	return thePath;
+}
+
+// ====================================================================== //
+// Those who do not understand Unix are condemned to reinvent it, poorly. //
+//                 -- Henry Spencer                                       //
+// ====================================================================== //
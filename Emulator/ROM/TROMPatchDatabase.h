@@ -0,0 +1,229 @@
+// ==============================
+// File:			TROMPatchDatabase.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TROMPATCHDATABASE_H
+#define _TROMPATCHDATABASE_H
+
+#include <K/Defines/KDefinitions.h>
+
+// C++
+#include <string>
+
+class TLog;
+
+///
+/// Tables of ROM patches, loaded from a text file. The patches compiled in
+/// Einstein are at the addresses of the 717006 ROM, and are applied there
+/// when the file has no table for the ROM. _Data_/Einstein.patches holds
+/// the table of the 717006 ROM, a starting point for the other ROMs.
+///
+/// A table applies to a ROM identified by its machine string and by the
+/// checksums of the base ROM before it is patched (the checksums are
+/// printed when an image is created with a file that has no table for the
+/// ROM). Every entry gives the address of the patch in this ROM and the
+/// instruction expected there, so that a table written for another version
+/// of the ROM is not applied by mistake:
+///
+/// <pre>
+/// # comment
+/// rom          717006 0x12345678 0x9ABCDEF0
+/// word         0x001412F8 0xEA000009 0x1A000009 Avoid screen calibration
+/// compiled     0x00018688 0xE59F0010 Progress_ROMBoot
+/// virtualized  0x00382440 0xE3520000 memmove
+/// </pre>
+///
+/// - word replaces the instruction with a value.
+/// - compiled moves a patch or an injection compiled in Einstein (a
+///   TJITGenericROMPatch, found by its name) to this address.
+/// - virtualized calls a host implementation of a ROM routine (see
+///   TVirtualizedCallsPatches) from this address.
+///
+/// The original instruction can be replaced with - to skip the check, and
+/// the checksums with - to match any ROM with the machine string.
+///
+/// \test	UROMPatchTests::DatabaseTest
+/// \test	UROMPatchTests::FileTest
+///
+class TROMPatchDatabase
+{
+public:
+	/// Kinds of entries.
+	enum EKind {
+		kWord,
+		kCompiled,
+		kVirtualized
+	};
+
+	/// Maximum length of the name of an entry.
+	enum {
+		kNameSize = 128
+	};
+
+	/// Entry of a table.
+	struct SEntry {
+		KUInt32		fKind;			///< One of EKind.
+		KUInt32		fAddress;		///< Address in the ROM.
+		KUInt32		fValue;			///< Word or virtualized call.
+		KUInt32		fOriginal;		///< Expected instruction.
+		Boolean		fCheckOriginal;	///< Whether fOriginal is known.
+		char		fName[kNameSize];	///< Name of the patch.
+	};
+
+	/// Table for a ROM.
+	struct STable {
+		char		fMachineString[8];	///< Like "717006".
+		Boolean		fAnyChecksum;	///< Whether fChecksums are ignored.
+		KUInt32		fChecksums[2];	///< Checksums of the base ROM.
+		KUInt32		fEntryCount;	///< Number of entries.
+		KUInt32		fEntryCapacity;	///< Size of fEntries.
+		SEntry*		fEntries;		///< Entries.
+	};
+
+	///
+	/// Default constructor, for an empty database.
+	///
+	TROMPatchDatabase( void );
+
+	///
+	/// Destructor.
+	///
+	~TROMPatchDatabase( void );
+
+	///
+	/// Load the tables of a file.
+	///
+	/// \param inPath	path of the file.
+	/// \return true if the file could not be read or parsed.
+	///
+	Boolean		LoadFile( const char* inPath );
+
+	///
+	/// Parse tables and add them to the database.
+	///
+	/// \param inText	text of the tables.
+	/// \param inLog	log for syntax errors (or NULL for stderr).
+	/// \return true if the text could not be parsed (the database is then
+	///			emptied).
+	///
+	Boolean		Parse( const char* inText, TLog* inLog = NULL );
+
+	///
+	/// Accessor on the number of tables.
+	///
+	KUInt32		GetTableCount( void ) const
+		{
+			return mTableCount;
+		}
+
+	///
+	/// Accessor on a table.
+	///
+	/// \param inIndex	index of the table.
+	/// \return the table.
+	///
+	const STable*	GetTable( KUInt32 inIndex ) const
+		{
+			return &mTables[inIndex];
+		}
+
+	///
+	/// Find the table for a ROM. Tables with checksums come first.
+	///
+	/// \param inMachineString	machine string of the ROM.
+	/// \param inChecksums		checksums of the unpatched base ROM.
+	/// \return the table or NULL if there is none.
+	///
+	const STable*	FindTable(
+						const char inMachineString[6],
+						const KUInt32 inChecksums[2] ) const;
+
+	///
+	/// Check the entries of a table against an unpatched ROM.
+	///
+	/// \param inTable	table to check.
+	/// \param inROM	ROM and REX, as 16 MB of host endian words.
+	/// \param inLog	log for mismatches (or NULL for stderr).
+	/// \return the number of entries that don't match.
+	///
+	static KUInt32	Validate(
+						const STable* inTable,
+						const KUInt32* inROM,
+						TLog* inLog = NULL );
+
+	///
+	/// Path of the database used for a ROM image: a file called
+	/// Einstein.patches in the directory of the image.
+	///
+	/// \param inImagePath	path of the image.
+	/// \return the path of the database.
+	///
+	static std::string	GetPathForImage( const char* inImagePath );
+
+private:
+	///
+	/// Copy constructor, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TROMPatchDatabase( const TROMPatchDatabase& inCopy );
+
+	///
+	/// Assignment operator, deliberately unavailable.
+	///
+	/// \param inCopy		object to copy
+	///
+	TROMPatchDatabase& operator = ( const TROMPatchDatabase& inCopy );
+
+	///
+	/// Parse a line.
+	///
+	/// \param inLine	line, without the end of line.
+	/// \return true if the line could not be parsed.
+	///
+	Boolean		ParseLine( char* inLine );
+
+	///
+	/// Add an entry to the last table.
+	///
+	/// \return the new entry.
+	///
+	SEntry*		AddEntry( void );
+
+	///
+	/// Free the tables.
+	///
+	void		Clear( void );
+
+	/// \name Variables
+	STable*		mTables;		///< Tables.
+	KUInt32		mTableCount;	///< Number of tables.
+	KUInt32		mTableCapacity;	///< Size of mTables.
+};
+
+#endif
+		// _TROMPATCHDATABASE_H
+
+// ====================================================================== //
+// The only thing worse than generalizing from one example is            //
+// generalizing from no examples at all.                                  //
+// ====================================================================== //
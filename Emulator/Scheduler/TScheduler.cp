@@ -24,14 +24,18 @@
 #include <K/Defines/KDefinitions.h>
 #include "TScheduler.h"
 
-// -------------------------------------------------------------------------- //
-// Constantes
-// -------------------------------------------------------------------------- //
+// Einstein
+#include "TARMProcessor.h"
 
 // -------------------------------------------------------------------------- //
 //  * TScheduler( void )
 // -------------------------------------------------------------------------- //
 TScheduler::TScheduler( void )
+	:
+		mHoldScheduleLevel( 0 ),
+		mWantSchedule( false ),
+		mReadyMask( 0 ),
+		mCurrentTask( nil )
 {
 }
 
@@ -42,6 +46,239 @@ TScheduler::~TScheduler( void )
 {
 }
 
+// -------------------------------------------------------------------------- //
+//  * AddWhenNotCurrent( TTask* )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::AddWhenNotCurrent( TTask* inTask )
+{
+	if (inTask == mCurrentTask)
+	{
+		if (inTask->mState == TTask::kBlocked)
+		{
+			inTask->mState = TTask::kRunning;
+		}
+	} else {
+		Add( inTask );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * Add( TTask* )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::Add( TTask* inTask )
+{
+	if (inTask->mState == TTask::kBlocked)
+	{
+		Enqueue( inTask, false );
+		if ((mCurrentTask == nil)
+			|| (mCurrentTask->mState != TTask::kRunning)
+			|| (inTask->mPriority > mCurrentTask->mPriority))
+		{
+			mWantSchedule = true;
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * Remove( TTask* )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::Remove( TTask* inTask )
+{
+	if (inTask->mState == TTask::kReady)
+	{
+		KUInt32 thePriority = inTask->mPriority;
+		mReadyQueues[thePriority].Remove( inTask );
+		if (mReadyQueues[thePriority].GetFirstItem() == nil)
+		{
+			mReadyMask &= ~(1U << thePriority);
+		}
+	} else if (inTask->mState == TTask::kRunning) {
+		// The current task blocks.
+		mWantSchedule = true;
+	}
+	inTask->mState = TTask::kBlocked;
+}
+
+// -------------------------------------------------------------------------- //
+//  * RemoveHighestPriority( void )
+// -------------------------------------------------------------------------- //
+TTask*
+TScheduler::RemoveHighestPriority( void )
+{
+	KSInt32 thePriority = GetHighestPriority();
+	if (thePriority < 0)
+	{
+		return nil;
+	}
+	TTask* theTask =
+		(TTask*) mReadyQueues[thePriority].GetFirstItem();
+	Remove( theTask );
+	return theTask;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetPriority( TTask*, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::SetPriority( TTask* inTask, KUInt32 inPriority )
+{
+	if (inPriority > TTask::kMaxPriority)
+	{
+		inPriority = TTask::kMaxPriority;
+	}
+	if (inTask->mState == TTask::kReady)
+	{
+		Remove( inTask );
+		inTask->mPriority = inPriority;
+		Add( inTask );
+	} else {
+		inTask->mPriority = inPriority;
+		if (inTask->mState == TTask::kRunning)
+		{
+			// A ready task may have a higher priority now.
+			mWantSchedule = true;
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * Schedule( Boolean )
+// -------------------------------------------------------------------------- //
+TTask*
+TScheduler::Schedule( Boolean inTimeSliceOver )
+{
+	if (mHoldScheduleLevel)
+	{
+		mWantSchedule = true;
+		return mCurrentTask;
+	}
+	mWantSchedule = false;
+
+	TTask* theCurrentTask = mCurrentTask;
+	if (theCurrentTask && (theCurrentTask->mState == TTask::kRunning))
+	{
+		KSInt32 theHighestPriority = GetHighestPriority();
+		KSInt32 thePriority = (KSInt32) theCurrentTask->mPriority;
+		if ((theHighestPriority < thePriority)
+			|| ((theHighestPriority == thePriority) && !inTimeSliceOver))
+		{
+			return theCurrentTask;
+		}
+
+		// Preempted tasks keep their turn.
+		theCurrentTask->mState = TTask::kBlocked;
+		Enqueue( theCurrentTask, theHighestPriority > thePriority );
+	}
+
+	TTask* theNextTask = RemoveHighestPriority();
+	if (theNextTask)
+	{
+		theNextTask->mState = TTask::kRunning;
+	}
+	mCurrentTask = theNextTask;
+
+	return theNextTask;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwitchTask( TARMProcessor*, Boolean )
+// -------------------------------------------------------------------------- //
+Boolean
+TScheduler::SwitchTask( TARMProcessor* ioCPU, Boolean inTimeSliceOver )
+{
+	TTask* thePreviousTask = mCurrentTask;
+	TTask* theNextTask = Schedule( inTimeSliceOver );
+	if (theNextTask == thePreviousTask)
+	{
+		return true;
+	}
+
+	if (thePreviousTask)
+	{
+		thePreviousTask->SaveContext( ioCPU );
+	}
+	if (theNextTask == nil)
+	{
+		// The kernel waits for a task.
+		return true;
+	}
+	theNextTask->RestoreContext( ioCPU );
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * HoldSchedule( void )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::HoldSchedule( void )
+{
+	mHoldScheduleLevel++;
+}
+
+// -------------------------------------------------------------------------- //
+//  * AllowSchedule( void )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::AllowSchedule( void )
+{
+	if (mHoldScheduleLevel)
+	{
+		mHoldScheduleLevel--;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetCurrentTask( TTask* )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::SetCurrentTask( TTask* inTask )
+{
+	if (mCurrentTask && (mCurrentTask->mState == TTask::kRunning))
+	{
+		mCurrentTask->mState = TTask::kBlocked;
+	}
+	mCurrentTask = inTask;
+	if (inTask)
+	{
+		inTask->mState = TTask::kRunning;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetHighestPriority( void ) const
+// -------------------------------------------------------------------------- //
+KSInt32
+TScheduler::GetHighestPriority( void ) const
+{
+	KSInt32 thePriority = TTask::kMaxPriority;
+	while ((thePriority >= 0) && !(mReadyMask & (1U << thePriority)))
+	{
+		thePriority--;
+	}
+	return thePriority;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Enqueue( TTask*, Boolean )
+// -------------------------------------------------------------------------- //
+void
+TScheduler::Enqueue( TTask* inTask, Boolean inFront )
+{
+	KUInt32 thePriority = inTask->mPriority;
+	if (inFront)
+	{
+		mReadyQueues[thePriority].PushFront( inTask );
+	} else {
+		mReadyQueues[thePriority].PushBack( inTask );
+	}
+	mReadyMask |= (1U << thePriority);
+	inTask->mState = TTask::kReady;
+}
+
 // ============================================================================ //
 // "The bad reputation UNIX has gotten is totally undeserved, laid on by people //
 // who don't understand, who have not gotten in there and tried anything."      //
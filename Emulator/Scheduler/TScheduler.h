@@ -29,19 +29,40 @@
 // K
 #include <K/Misc/TDoubleLinkedList.h>
 
+// Einstein
+#include "TTask.h"
+
+class TARMProcessor;
+
+///
+/// Class for the host mirror of the NewtonOS scheduler.
+///
+/// The ready tasks are in one queue per priority, with a mask of the
+/// queues that are not empty. The current task isn't in a queue. A task of
+/// a higher priority preempts the current task, which goes back at the
+/// front of its queue; at the end of a time slice, the current task goes
+/// at the end of its queue and the next task of the same priority runs.
+///
+/// The scheduler can also switch the processor from the current task to
+/// the next one, with the registers saved in the tasks.
 ///
-/// Class for the Relativity Scheduler.
+/// TNativeKernel keeps one for the kernel when the native scheduler is on.
 ///
 /// \author Paul Guyot <pguyot@kallisys.net>
 /// \version $Revision$
 ///
-/// \test	aucun test dfini.
+/// \test	USchedulerTests::Replay
+/// \test	UNativeKernelTests::TaskSwitch
 ///
 class TScheduler
 {
 public:
+	enum {
+		kNbPriorities	= TTask::kMaxPriority + 1
+	};
+
 	///
-	/// Constructeur par dfaut.
+	/// Constructeur par dfaut.
 	///
 	TScheduler( void );
 
@@ -52,34 +73,61 @@ public:
 
 	///
 	/// Add a task if not current.
+	/// The current task is running again instead.
+	///
+	/// \param inTask	task to add.
 	///
 	void AddWhenNotCurrent( TTask* inTask );
 
 	///
-	/// Add a task.
+	/// Add a task at the end of the queue of its priority.
+	/// Nothing happens if the task is ready or running.
+	///
+	/// \param inTask	task to add.
 	///
 	void Add( TTask* inTask );
 
 	///
-	/// Remove a task.
+	/// Remove a task from its queue, or block the current task.
+	///
+	/// \param inTask	task to remove.
 	///
 	void Remove( TTask* inTask );
 
 	///
-	/// Enter atomic.
+	/// Remove the first task of the highest priority.
 	///
-	void EnterAtomic( void );
+	/// \return the task or \c nil if no task is ready.
+	///
+	TTask* RemoveHighestPriority( void );
 
 	///
-	/// Exit atomic.
+	/// Change the priority of a task.
+	///
+	/// \param inTask		task.
+	/// \param inPriority	new priority (0 to TTask::kMaxPriority).
 	///
-	void ExitAtomic( void );
+	void SetPriority( TTask* inTask, KUInt32 inPriority );
 
 	///
-	/// Say we want schedule.
-	/// NOP.
+	/// Choose the task to run.
+	///
+	/// \param inTimeSliceOver	whether the current task used its time
+	///							slice.
+	/// \return the new current task or \c nil if no task can run.
 	///
-	void WantSchedule( void );
+	TTask* Schedule( Boolean inTimeSliceOver );
+
+	///
+	/// Choose the task to run and switch the processor to it. The processor
+	/// runs the current task, in its mode.
+	///
+	/// \param ioCPU				processor.
+	/// \param inTimeSliceOver	whether the current task used its time
+	///							slice.
+	/// \return true if the processor wasn't switched to another task.
+	///
+	Boolean SwitchTask( TARMProcessor* ioCPU, Boolean inTimeSliceOver );
 
 	///
 	/// Put the scheduler on hold.
@@ -91,29 +139,70 @@ public:
 	///
 	void AllowSchedule( void );
 
+	///
+	/// Whether a task should preempt the current task, or a schedule
+	/// happened on hold.
+	///
+	/// \return true if the scheduler should be called.
+	///
+	Boolean WantSchedule( void ) const
+		{
+			return mWantSchedule;
+		}
+
+	///
+	/// Get the current task.
+	///
+	/// \return the current task or \c nil.
+	///
+	TTask* GetCurrentTask( void ) const
+		{
+			return mCurrentTask;
+		}
+
+	///
+	/// Make a task the current task, without scheduling.
+	///
+	/// \param inTask	task, which must not be ready, or \c nil.
+	///
+	void SetCurrentTask( TTask* inTask );
+
 private:
 	///
 	/// Constructeur par copie volontairement indisponible.
 	///
-	/// \param inCopy		objet  copier
+	/// \param inCopy		objet  copier
 	///
 	TScheduler( const TScheduler& inCopy );
 
 	///
-	/// Oprateur d'assignation volontairement indisponible.
+	/// Oprateur d'assignation volontairement indisponible.
 	///
-	/// \param inCopy		objet  copier
+	/// \param inCopy		objet  copier
 	///
 	TScheduler& operator = ( const TScheduler& inCopy );
 
 	///
-	/// Get the current task.
+	/// Get the highest priority of the ready tasks.
+	///
+	/// \return the priority or -1 if no task is ready.
+	///
+	KSInt32 GetHighestPriority( void ) const;
+
+	///
+	/// Put a task in the queue of its priority.
+	///
+	/// \param inTask	task.
+	/// \param inFront	whether the task goes at the front of the queue.
 	///
-	TTask* GetCurrentTask( void );
+	void Enqueue( TTask* inTask, Boolean inFront );
 
 	/// \name Variables
 	KUInt32				mHoldScheduleLevel;	///< Equivalent to gHoldScheduleLevel.
-	TDoubleLinkedList	mTasks;				///< List of the tasks.
+	Boolean				mWantSchedule;		///< A schedule is wanted.
+	KUInt32				mReadyMask;			///< Queues that are not empty.
+	TTask*				mCurrentTask;		///< Current task.
+	TDoubleLinkedList	mReadyQueues[kNbPriorities];	///< Ready tasks.
 };
 
 #endif
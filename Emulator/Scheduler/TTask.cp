@@ -24,17 +24,27 @@
 #include <K/Defines/KDefinitions.h>
 #include "TTask.h"
 
-// -------------------------------------------------------------------------- //
-// Constantes
-// -------------------------------------------------------------------------- //
+// ANSI C & POSIX
+#include <string.h>
+
+// Einstein
+#include "TARMProcessor.h"
 
 // -------------------------------------------------------------------------- //
-//  * TTask( void )
+//  * TTask( KUInt32, KUInt32 )
 // -------------------------------------------------------------------------- //
-TTask::TTask( void )
+TTask::TTask( KUInt32 inAddress, KUInt32 inPriority )
 	:
-		mThread( this )
+		mAddress( inAddress ),
+		mPriority( inPriority ),
+		mState( kBlocked ),
+		mPSR( TARMProcessor::kUserMode )
 {
+	if (mPriority > kMaxPriority)
+	{
+		mPriority = kMaxPriority;
+	}
+	(void) ::memset( mRegisters, 0, sizeof(mRegisters) );
 }
 
 // -------------------------------------------------------------------------- //
@@ -45,45 +55,31 @@ TTask::~TTask( void )
 }
 
 // -------------------------------------------------------------------------- //
-//  * Run( void )
-// -------------------------------------------------------------------------- //
-void
-TTask::Run( void )
-{
-}
-
-// -------------------------------------------------------------------------- //
-//  * IsCurrentTask( void ) const
-// -------------------------------------------------------------------------- //
-Boolean
-TTask::IsCurrentTask( void ) const
-{
-	return mThread->IsCurrentThread();
-}
-
-// -------------------------------------------------------------------------- //
-//  * SuspendAtomic( void )
+//  * SaveContext( TARMProcessor* )
 // -------------------------------------------------------------------------- //
 void
-TTask::SuspendAtomic( void )
+TTask::SaveContext( TARMProcessor* inCPU )
 {
-	if (!mAtomicSuspended)
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < kNbRegisters; indexReg++)
 	{
-		mAtomicSuspended = true;
-		mThread->Suspend();
+		mRegisters[indexReg] = inCPU->GetRegister( indexReg );
 	}
+	mPSR = inCPU->GetCPSR();
 }
 
 // -------------------------------------------------------------------------- //
-//  * ResumeAtomic( void )
+//  * RestoreContext( TARMProcessor* ) const
 // -------------------------------------------------------------------------- //
 void
-TTask::ResumeAtomic( void )
+TTask::RestoreContext( TARMProcessor* ioCPU ) const
 {
-	if (mAtomicSuspended)
+	// The mode first, for the banked registers.
+	ioCPU->SetCPSR( mPSR );
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < kNbRegisters; indexReg++)
 	{
-		mAtomicSuspended = false;
-		mThread->Resume();
+		ioCPU->SetRegister( indexReg, mRegisters[indexReg] );
 	}
 }
 
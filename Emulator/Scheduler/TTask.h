@@ -29,21 +29,45 @@
 // K
 #include <K/Misc/TDoubleLinkedList.h>
 
+class TARMProcessor;
+
+///
+/// Class for the host mirror of a NewtonOS task.
 ///
-/// Class for a task in Einstein.
+/// The task is known by the address of the kernel TTask. It has a priority,
+/// a state for the scheduler and the registers it had when it was switched
+/// out.
 ///
 /// \author Paul Guyot <pguyot@kallisys.net>
 /// \version $Revision$
 ///
-/// \test	aucun test dfini.
+/// \test	USchedulerTests::Replay
 ///
 class TTask : public TDoubleLinkedElem
 {
 public:
+	friend class TScheduler;
+
+	/// State of the task.
+	enum EState {
+		kBlocked,		///< Neither ready nor running.
+		kReady,			///< In a ready queue.
+		kRunning		///< The current task.
+	};
+
+	/// Priorities.
+	enum {
+		kMaxPriority	= 31,	///< Highest priority.
+		kNbRegisters	= 16	///< r0-r15.
+	};
+
+	///
+	/// Constructor from the task in the kernel and its priority.
 	///
-	/// Default constructor.
+	/// \param inAddress		address of the TTask.
+	/// \param inPriority	priority of the task (0 to kMaxPriority).
 	///
-	TTask( void );
+	TTask( KUInt32 inAddress, KUInt32 inPriority );
 
 	///
 	/// Destructor.
@@ -51,44 +75,114 @@ public:
 	~TTask( void );
 
 	///
-	/// Determine if we're the current task.
+	/// Accessor on the address of the task in the kernel.
+	///
+	/// \return the address of the TTask.
+	///
+	KUInt32 GetAddress( void ) const
+		{
+			return mAddress;
+		}
+
+	///
+	/// Accessor on the priority.
+	///
+	/// \return the priority of the task.
+	///
+	KUInt32 GetPriority( void ) const
+		{
+			return mPriority;
+		}
+
+	///
+	/// Accessor on the state.
+	///
+	/// \return the state of the task for the scheduler.
+	///
+	EState GetState( void ) const
+		{
+			return mState;
+		}
+
+	///
+	/// Accessor on a saved register.
+	///
+	/// \param inIndex	index of the register (0-15).
+	/// \return the value of the register.
 	///
-	Boolean IsCurrentTask( void ) const;
+	KUInt32 GetRegister( KUInt32 inIndex ) const
+		{
+			return mRegisters[inIndex];
+		}
 
 	///
-	/// Suspend for EnterAtomic.
+	/// Selector on a saved register.
 	///
-	void SuspendAtomic( void );
+	/// \param inIndex	index of the register (0-15).
+	/// \param inValue	new value of the register.
+	///
+	void SetRegister( KUInt32 inIndex, KUInt32 inValue )
+		{
+			mRegisters[inIndex] = inValue;
+		}
 
 	///
-	/// Resume for ExitAtomic.
+	/// Accessor on the saved PSR.
+	///
+	/// \return the PSR of the task.
 	///
-	void ExitAtomic( void );
+	KUInt32 GetPSR( void ) const
+		{
+			return mPSR;
+		}
 
 	///
-	/// Thread entry point.
+	/// Selector on the saved PSR.
+	///
+	/// \param inPSR		new PSR of the task.
+	///
+	void SetPSR( KUInt32 inPSR )
+		{
+			mPSR = inPSR;
+		}
+
+	///
+	/// Save the registers of the processor, which runs this task in its
+	/// mode.
+	///
+	/// \param inCPU		processor.
+	///
+	void SaveContext( TARMProcessor* inCPU );
+
+	///
+	/// Load the registers of this task in the processor, and the mode of
+	/// the task.
+	///
+	/// \param ioCPU		processor.
 	///
-	void Run( void );
+	void RestoreContext( TARMProcessor* ioCPU ) const;
 
 private:
 	///
 	/// Constructeur par copie volontairement indisponible.
 	///
-	/// \param inCopy		objet  copier
+	/// \param inCopy		objet  copier
 	///
 	TTask( const TTask& inCopy );
 
 	///
-	/// Oprateur d'assignation volontairement indisponible.
+	/// Oprateur d'assignation volontairement indisponible.
 	///
-	/// \param inCopy		objet  copier
+	/// \param inCopy		objet  copier
 	///
 	TTask& operator = ( const TTask& inCopy );
 
 	/// \name Variables
-	TThread<TTask>	mThread;			///< Thread associated with this task.
-	Boolean			mAtomicSuspended;	///< If the task was suspended with
-										///< SuspendAtomic.
+	KUInt32			mAddress;		///< Address of the TTask.
+	KUInt32			mPriority;		///< Priority.
+	EState			mState;			///< State for the scheduler.
+	KUInt32			mRegisters[kNbRegisters];	///< Saved registers.
+	KUInt32			mPSR;			///< Saved PSR.
 };
 
 #endif
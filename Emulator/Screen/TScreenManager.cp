@@ -94,6 +94,8 @@ TScreenManager::TScreenManager(
 		mBacklight( false ),
 		mKbdIsConnected( true ),
 		mScreenBuffer( NULL ),
+		mBlitRow( NULL ),
+		mBlitRowSize( 0 ),
 		mOverlayIsOn( false )
 {
 	mTabletBuffer = (KUInt32*) ::calloc( 1, sizeof(KUInt32) * kTabletBufferSize );
@@ -161,6 +163,10 @@ TScreenManager::~TScreenManager( void )
 	{
 		::free( mScreenBuffer );
 	}
+	if (mBlitRow)
+	{
+		::free( mBlitRow );
+	}
 }
 
 // -------------------------------------------------------------------------- //
@@ -246,6 +252,25 @@ TScreenManager::Blit(
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * ReadBlitRow( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+const KUInt32*
+TScreenManager::ReadBlitRow( KUInt32 inRowAddy, KUInt32 inWidthInBytes )
+{
+	if (inWidthInBytes > mBlitRowSize)
+	{
+		mBlitRow = (KUInt32*) ::realloc( mBlitRow, inWidthInBytes );
+		mBlitRowSize = inWidthInBytes;
+	}
+	
+	// Words that could not be read (fault) are kept from the previous row,
+	// like the values Read left.
+	(void) mMemory->FastReadBuffer( inRowAddy, inWidthInBytes, (KUInt8*) mBlitRow );
+	
+	return mBlitRow;
+}
+
 // -------------------------------------------------------------------------- //
 //  * Blit_0( KUInt32, SRect*, SRect* )
 // -------------------------------------------------------------------------- //
@@ -324,8 +349,11 @@ TScreenManager::Blit_0(
 		{
 			KUInt32* rowPixels = (KUInt32*) dstPixelsRow;
 			
+			// Read the row in one go.
+			const KUInt32* srcRow = ReadBlitRow( srcRowAddy, srcWidthInBytes );
+			
 			// First column.
-			(void) mMemory->Read( srcRowAddy, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[0] );
 			KUInt32 originalWord = UByteSex_FromBigEndian( *rowPixels );
 			if (inMode == 0)
 			{
@@ -342,7 +370,7 @@ TScreenManager::Blit_0(
 			KUInt32 srcCursor = srcRowAddy + 4;
 			KUInt32 lastPixAddy = srcRowAddy + srcWidthInBytes - 4;
 			while (srcCursor < lastPixAddy) {
-				(void) mMemory->Read( srcCursor, chunk );				
+				chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );				
 				srcCursor += 4;
 				if (inMode == 0)
 				{
@@ -355,7 +383,7 @@ TScreenManager::Blit_0(
 			}
 			
 			// Last column.
-			(void) mMemory->Read( srcCursor, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );
 			originalWord = UByteSex_FromBigEndian( *rowPixels );
 			if (inMode == 0)
 			{
@@ -456,8 +484,11 @@ TScreenManager::Blit_90(
 		{
 			KUInt32* rowPixels = (KUInt32*) dstPixelsRow;
 			
+			// Read the row in one go.
+			const KUInt32* srcRow = ReadBlitRow( srcRowAddy, srcWidthInBytes );
+			
 			// First column.
-			(void) mMemory->Read( srcRowAddy, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[0] );
 			KUInt32 originalWord = UByteSex_FromBigEndian( *rowPixels );
 			if (inMode == 0)
 			{
@@ -474,7 +505,7 @@ TScreenManager::Blit_90(
 			KUInt32 srcCursor = srcRowAddy + 4;
 			KUInt32 lastPixAddy = srcRowAddy + srcWidthInBytes - 4;
 			while (srcCursor < lastPixAddy) {
-				(void) mMemory->Read( srcCursor, chunk );				
+				chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );				
 				srcCursor += 4;
 				if (inMode == 0)
 				{
@@ -487,7 +518,7 @@ TScreenManager::Blit_90(
 			}
 			
 			// Last column.
-			(void) mMemory->Read( srcCursor, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );
 			originalWord = UByteSex_FromBigEndian( *rowPixels );
 			if (inMode == 0)
 			{
@@ -592,8 +623,11 @@ TScreenManager::Blit_180(
 		{
 			KUInt32* rowPixels = (KUInt32*) dstPixelsRow;
 			
+			// Read the row in one go.
+			const KUInt32* srcRow = ReadBlitRow( srcRowAddy, srcWidthInBytes );
+			
 			// First column.
-			(void) mMemory->Read( srcRowAddy, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[0] );
 			// Swap the word.
 			--rowPixels;
 			KUInt32 originalWord = Swap_Pixels_FromBigEndian( *rowPixels );
@@ -613,7 +647,7 @@ TScreenManager::Blit_180(
 			KUInt32 srcCursor = srcRowAddy + 4;
 			KUInt32 lastPixAddy = srcRowAddy + srcWidthInBytes - 4;
 			while (srcCursor < lastPixAddy) {
-				(void) mMemory->Read( srcCursor, chunk );				
+				chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );				
 				srcCursor += 4;
 				if (inMode == 0)
 				{
@@ -626,7 +660,7 @@ TScreenManager::Blit_180(
 			}
 			
 			// Last column.
-			(void) mMemory->Read( srcCursor, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );
 			// Swap.
 			originalWord = Swap_Pixels_FromBigEndian( *rowPixels );
 			if (inMode == 0)
@@ -734,8 +768,11 @@ TScreenManager::Blit_270(
 		{
 			KUInt32* rowPixels = (KUInt32*) dstPixelsRow;
 			
+			// Read the row in one go.
+			const KUInt32* srcRow = ReadBlitRow( srcRowAddy, srcWidthInBytes );
+			
 			// First column.
-			(void) mMemory->Read( srcRowAddy, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[0] );
 			KUInt32 originalWord = UByteSex_FromBigEndian( *rowPixels );
 			if (inMode == 0)
 			{
@@ -752,7 +789,7 @@ TScreenManager::Blit_270(
 			KUInt32 srcCursor = srcRowAddy + 4;
 			KUInt32 lastPixAddy = srcRowAddy + srcWidthInBytes - 4;
 			while (srcCursor < lastPixAddy) {
-				(void) mMemory->Read( srcCursor, chunk );				
+				chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );				
 				srcCursor += 4;
 				if (inMode == 0)
 				{
@@ -765,7 +802,7 @@ TScreenManager::Blit_270(
 			}
 			
 			// Last column.
-			(void) mMemory->Read( srcCursor, chunk );
+			chunk = UByteSex_FromBigEndian( srcRow[(srcCursor - srcRowAddy) / 4] );
 			originalWord = UByteSex_FromBigEndian( *rowPixels );
 			if (inMode == 0)
 			{
@@ -658,6 +658,15 @@ private:
 						SRect* inDstRect,
 						KUInt32 inMode );
 
+	///
+	/// Read a row of the source pixel map with a single bulk access.
+	///
+	/// \param inRowAddy		virtual address of the row.
+	/// \param inWidthInBytes	width of the row (multiple of 4).
+	/// \return the words of the row, in big endian.
+	///
+	const KUInt32*	ReadBlitRow( KUInt32 inRowAddy, KUInt32 inWidthInBytes );
+
 	/// \name Variables
 	TLog*				mLog;				///< Reference to the log.
 	TInterruptManager*	mInterruptManager;	///< Reference to the interrupt mgr.
@@ -684,6 +693,8 @@ private:
 	Boolean				mBacklight;			///< Current screen backlight.
 	Boolean				mKbdIsConnected;	///< If keyboard is connected.
 	KUInt8*				mScreenBuffer;		///< Buffer of the screen.
+	KUInt32*			mBlitRow;			///< Source row being blitted.
+	KUInt32				mBlitRowSize;		///< Size of mBlitRow.
 	
 protected:
 	Boolean				mOverlayIsOn;		///< Show overlay on screen
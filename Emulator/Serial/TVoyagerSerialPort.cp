@@ -37,6 +37,7 @@
 #include "../Log/TLog.h"
 #include "../TInterruptManager.h"
 #include "../TDMAManager.h"
+#include "../TMemory.h"
 
 // -------------------------------------------------------------------------- //
 // Constantes
@@ -58,6 +59,10 @@ TVoyagerSerialPort::TVoyagerSerialPort(
 		mDMAManager( inDMAManager ),
 		mMemory(inMemory)
 {
+	TMemory::SIOHandler theHandler =
+		{ this, ReadIOWord, WriteIOWord, ReadIOByte, WriteIOByte };
+	(void) mMemory->RegisterIOHandler(
+		GetIOBase(), GetIOBase() + TMemory::kIOPageSize, theHandler );
 }
 
 // -------------------------------------------------------------------------- //
@@ -65,6 +70,94 @@ TVoyagerSerialPort::TVoyagerSerialPort(
 // -------------------------------------------------------------------------- //
 TVoyagerSerialPort::~TVoyagerSerialPort( void )
 {
+	mMemory->UnregisterIOHandler(
+		GetIOBase(), GetIOBase() + TMemory::kIOPageSize );
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetIOBase( void ) const
+// -------------------------------------------------------------------------- //
+KUInt32
+TVoyagerSerialPort::GetIOBase( void ) const
+{
+	switch (mLocationID)
+	{
+		case kExternalSerialPort:
+			return TMemoryConsts::kExternalSerialBase;
+		case kInfraredSerialPort:
+			return TMemoryConsts::kInfraredSerialBase;
+		case kBuiltInExtraSerialPort:
+			return TMemoryConsts::kBuiltInSerialBase;
+		default:
+			return TMemoryConsts::kModemSerialBase;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadIOWord( void*, KUInt32, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TVoyagerSerialPort::ReadIOWord(
+			void* inObject,
+			KUInt32 inAddress,
+			Boolean& /* outFault */ )
+{
+	TVoyagerSerialPort* thePort = (TVoyagerSerialPort*) inObject;
+	if (thePort->mLog)
+	{
+		thePort->mLog->FLogLine(
+			"Read word access to serial bank at P0x%.8X",
+			(unsigned int) inAddress );
+	}
+	return 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteIOWord( void*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TVoyagerSerialPort::WriteIOWord(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt32 inWord )
+{
+	TVoyagerSerialPort* thePort = (TVoyagerSerialPort*) inObject;
+	if (thePort->mLog)
+	{
+		thePort->mLog->FLogLine(
+			"Write word access to serial bank at P0x%.8X (%.8X)",
+			(unsigned int) inAddress,
+			(unsigned int) inWord);
+	}
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadIOByte( void*, KUInt32, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TVoyagerSerialPort::ReadIOByte(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt8& outByte )
+{
+	outByte = ((TVoyagerSerialPort*) inObject)->ReadRegister(
+		inAddress & (TMemory::kIOPageSize - 1) );
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteIOByte( void*, KUInt32, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TVoyagerSerialPort::WriteIOByte(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt8 inByte )
+{
+	((TVoyagerSerialPort*) inObject)->WriteRegister(
+		inAddress & (TMemory::kIOPageSize - 1), inByte );
+	return false;
 }
 
 // -------------------------------------------------------------------------- //
@@ -118,6 +118,23 @@ protected:
 	///
 	TVoyagerSerialPort& operator = ( const TVoyagerSerialPort& inCopy );
 
+	///
+	/// Get the physical address of the registers of this port.
+	/// Ports are 64 KB apart.
+	///
+	KUInt32	GetIOBase( void ) const;
+
+	/// \name Handlers of the serial registers (see TMemory::SIOHandler).
+	/// The object is the TVoyagerSerialPort.
+	static KUInt32	ReadIOWord(
+						void* inObject, KUInt32 inAddress, Boolean& outFault );
+	static Boolean	WriteIOWord(
+						void* inObject, KUInt32 inAddress, KUInt32 inWord );
+	static Boolean	ReadIOByte(
+						void* inObject, KUInt32 inAddress, KUInt8& outByte );
+	static Boolean	WriteIOByte(
+						void* inObject, KUInt32 inAddress, KUInt8 inByte );
+
 	/// \name Variables
 	TLog*				mLog;				///< Reference to the log object
 											///< (or NULL)
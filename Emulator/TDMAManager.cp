@@ -32,8 +32,8 @@
 #include "Serial/TVoyagerSerialPort.h"
 #include "Log/TLog.h"
 
-// TDMAManager is invoked by TMemory when physical addresses corresponding
-// to DMA registers are accessed.
+// TDMAManager registers the physical addresses corresponding to DMA
+// registers with TMemory, which invokes it when they are accessed.
 //
 // Currently the only register that is tracked is the Channel Assignment
 // register which resides at physical address 0x0F08FC00 and is read/write.
@@ -56,6 +56,13 @@ TDMAManager::TDMAManager(
 		mMemory( inMemory ),
 		mInterruptManager( inInterruptManager )
 {
+	// Both banks of channels and the global registers.
+	TMemory::SIOHandler theHandler =
+		{ this, ReadRegister, WriteRegister, ReadBRegister, WriteBRegister };
+	(void) mMemory->RegisterIOHandler(
+		TMemoryConsts::kHdWr_DMAChan1Base,
+		TMemoryConsts::kHdWr_DMAChan2Base + TMemory::kIOPageSize,
+		theHandler );
 }
 
 // -------------------------------------------------------------------------- //
@@ -63,6 +70,93 @@ TDMAManager::TDMAManager(
 // -------------------------------------------------------------------------- //
 TDMAManager::~TDMAManager( void )
 {
+	mMemory->UnregisterIOHandler(
+		TMemoryConsts::kHdWr_DMAChan1Base,
+		TMemoryConsts::kHdWr_DMAChan2Base + TMemory::kIOPageSize );
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadRegister( void*, KUInt32, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TDMAManager::ReadRegister(
+			void* inObject,
+			KUInt32 inAddress,
+			Boolean& outFault )
+{
+	TDMAManager* theDMAManager = (TDMAManager*) inObject;
+	if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
+		&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
+		KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
+		KUInt32 reg = (inAddress & 0x1C00) >> 10;
+		return theDMAManager->ReadChannel1Register( channel, reg );
+	} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
+		&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
+		KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
+		KUInt32 reg = (inAddress & 0x0C00) >> 10;
+		return theDMAManager->ReadChannel2Register( channel, reg );
+	} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
+		return theDMAManager->ReadChannelAssignmentRegister();
+	} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
+		return theDMAManager->ReadStatusRegister();
+	} else if (inAddress == TMemoryConsts::kHdWr_DMAWordStat) {
+		return theDMAManager->ReadWordStatusRegister();
+	} else {
+		return TMemory::ReadUnknown(
+			theDMAManager->mMemory, inAddress, outFault );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteRegister( void*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TDMAManager::WriteRegister( void* inObject, KUInt32 inAddress, KUInt32 inWord )
+{
+	TDMAManager* theDMAManager = (TDMAManager*) inObject;
+	if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
+		&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
+		KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
+		KUInt32 reg = (inAddress & 0x1C00) >> 10;
+		theDMAManager->WriteChannel1Register( channel, reg, inWord );
+	} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
+		&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
+		KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
+		KUInt32 reg = (inAddress & 0x0C00) >> 10;
+		theDMAManager->WriteChannel2Register( channel, reg, inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
+		theDMAManager->WriteChannelAssignmentRegister( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
+		theDMAManager->WriteEnableRegister( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_DMADisable) {
+		theDMAManager->WriteDisableRegister( inWord );
+	} else {
+		return TMemory::WriteUnknown(
+			theDMAManager->mMemory, inAddress, inWord );
+	}
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadBRegister( void*, KUInt32, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TDMAManager::ReadBRegister( void* inObject, KUInt32 inAddress, KUInt8& outByte )
+{
+	// DMA registers are only accessed by words.
+	return TMemory::ReadBUnknown(
+		((TDMAManager*) inObject)->mMemory, inAddress, outByte );
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteBRegister( void*, KUInt32, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TDMAManager::WriteBRegister( void* inObject, KUInt32 inAddress, KUInt8 inByte )
+{
+	return TMemory::WriteBUnknown(
+		((TDMAManager*) inObject)->mMemory, inAddress, inByte );
 }
 
 // -------------------------------------------------------------------------- //
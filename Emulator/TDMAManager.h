@@ -179,6 +179,17 @@ private:
 	///
 	TDMAManager& operator = ( const TDMAManager& inCopy );
 
+	/// \name Handlers of the DMA registers (see TMemory::SIOHandler).
+	/// The object is the TDMAManager.
+	static KUInt32	ReadRegister(
+						void* inObject, KUInt32 inAddress, Boolean& outFault );
+	static Boolean	WriteRegister(
+						void* inObject, KUInt32 inAddress, KUInt32 inWord );
+	static Boolean	ReadBRegister(
+						void* inObject, KUInt32 inAddress, KUInt8& outByte );
+	static Boolean	WriteBRegister(
+						void* inObject, KUInt32 inAddress, KUInt8 inByte );
+
 	/// \name Variables
 	TLog*				mLog;				///< Interface for logging.
 	TMemory*			mMemory;			///< Reference on the memory.
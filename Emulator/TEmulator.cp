@@ -59,6 +59,7 @@
 #include "TDMAManager.h"
 #include "Platform/TPlatformManager.h"
 #include "Files/TFileManager.h"
+#include "NativeCalls/TNativeKernel.h"
 
 // -------------------------------------------------------------------------- //
 // Constantes
@@ -92,10 +93,14 @@ TEmulator::TEmulator(
 		mNetworkManager( inNetworkManager ),
 		mSoundManager( inSoundManager ),
 		mScreenManager( inScreenManager ),
+		mNativeKernel( nil ),
 		mLog( inLog ),
 		mMonitor( NULL ),
 		mRunning( false ),
 		mPaused( false ),
+		mIdle( false ),
+		mIdlePC( 0 ),
+		mIdleCount( 0 ),
 		mBPHalted( false )
 {
 	mInterruptManager = new TInterruptManager(inLog, &mProcessor);
@@ -104,6 +109,7 @@ TEmulator::TEmulator(
 	branchLinkDestCount.SetEmulator(this);
 #endif
 	mDMAManager = new TDMAManager(inLog, this, &mMemory, mInterruptManager);
+	mNativeKernel = new TNativeKernel(inLog, &mMemory);
 	mPlatformManager = new TPlatformManager( inLog, inScreenManager );
 #if TARGET_OS_MAC
 	mExternalPort = new TVoyagerManagedSerialPort(
@@ -181,10 +187,14 @@ TEmulator::TEmulator(
 		mNetworkManager( nil ),
 		mSoundManager( nil ),
 		mScreenManager( nil ),
+		mNativeKernel( nil ),
 		mLog( inLog ),
 		mMonitor( NULL ),
 		mRunning( false ),
 		mPaused( false ),
+		mIdle( false ),
+		mIdlePC( 0 ),
+		mIdleCount( 0 ),
 		mBPHalted( false )
 {
 	mInterruptManager = new TInterruptManager(inLog, &mProcessor);
@@ -193,6 +203,7 @@ TEmulator::TEmulator(
 	branchLinkDestCount.SetEmulator(this);
 #endif
 	mDMAManager = new TDMAManager(inLog, this, &mMemory, mInterruptManager);
+	mNativeKernel = new TNativeKernel(inLog, &mMemory);
 	mPlatformManager = new TPlatformManager( inLog, nil );
 	
 	mNewtonID[0] = kMyNewtonIDHigh;
@@ -225,6 +236,8 @@ TEmulator::~TEmulator( void )
 		delete mBuiltInExtraPort;
 	if (mModemPort)
 		delete mModemPort;
+	if (mNativeKernel)
+		delete mNativeKernel;
 }
 
 // -------------------------------------------------------------------------- //
@@ -240,8 +253,25 @@ TEmulator::Run( void )
 
 	while (mRunning)
 	{
-		if (mPaused)
+		if (mIdle)
 		{
+			// Wake up for the interrupts the processor takes, unless it
+			// already took one.
+			KUInt32 theCPSR = mProcessor.GetCPSR();
+			if (mProcessor.GetRegister( 15 ) == mIdlePC)
+			{
+				mIdleCount++;
+				mInterruptManager->WaitUntilInterrupt(
+						(theCPSR & TARMProcessor::kPSR_IBit) != 0,
+						(theCPSR & TARMProcessor::kPSR_FBit) != 0 );
+			}
+			mIdle = false;
+			mPaused = false;
+			if (!mRunning)
+			{
+				break;
+			}
+		} else if (mPaused) {
 			KUInt32 theCPSR = mProcessor.GetCPSR();
 			mInterruptManager->WaitUntilInterrupt(
 					!(theCPSR & TARMProcessor::kPSR_IBit),
@@ -273,6 +303,7 @@ TEmulator::Step( void )
 {
 	mRunning = true;
 	mPaused = false;
+	mIdle = false;
 	mBPHalted = false;
 
 	mInterruptManager->ResumeTimer();
@@ -433,26 +464,16 @@ TEmulator::TapFileCntlUND( KUInt32 inPAddr )
 						result = nbyte - amount;
 					}
 
-					KSInt32 index = 0;
-					while (index < amount) {
-						if (mMemory.WriteB( bufAddress + index, buffer[index] )) {
-							break;
-						}
-						index++;
+					if (amount > 0) {
+						(void) mMemory.FastWriteBuffer( bufAddress, amount, (const KUInt8*) buffer );
 					}
 
 					free(buffer);
 				}
 				else if (command == do_sys_write) {
-					KUInt32 index = 0;
 					KUInt8 buffer[nbyte];
 					
-					while (index < nbyte) {
-						if (mMemory.ReadB( bufAddress + index, buffer[index] )) {
-							break;
-						}
-						index++;
-					}
+					(void) mMemory.FastReadBuffer( bufAddress, nbyte, buffer );
 					
 					KSInt32 amount = mFileManager->do_sys_write(fp, buffer, nbyte);
 					
@@ -589,6 +610,7 @@ TEmulator::Stop( void )
 	mSignal = false;
 	mRunning = false;
 	mPaused = false;
+	mIdle = false;
 	mInterruptManager->WakeEmulatorThread();
 }
 
@@ -43,6 +43,7 @@ class TScreenManager;
 class TMonitor;
 class TStream;
 class TFileManager;
+class TNativeKernel;
 
 ///
 /// Class for the main loop of the emulator.
@@ -237,6 +238,16 @@ public:
 			return mPaused;
 		}
 	
+	///
+	/// Accessor on the number of times the emulator waited in an idle loop.
+	///
+	/// \return the number of waits since the emulator was created.
+	///
+	inline KUInt32	GetIdleCount( void ) const
+		{
+			return mIdleCount;
+		}
+	
 	///
 	/// Determine if we're running.
 	///
@@ -305,6 +316,16 @@ public:
 			return mScreenManager;
 		}
 
+	///
+	/// Accessor on the host implementations of kernel calls.
+	///
+	/// \return a pointer to the native kernel.
+	///
+	TNativeKernel*  GetNativeKernel( void )
+		{
+			return mNativeKernel;
+		}
+
 	///
 	/// Accessor on the file manager interface.
 	///
@@ -394,6 +415,20 @@ public:
 			mPaused = true;
 		}
 	
+	///
+	/// Wait for the next interrupt the processor can take, because it spins
+	/// in a loop that only an interrupt can end (see
+	/// TJITGenericPage::IsIdleLoop). The wait is skipped if the processor
+	/// left the loop in the meantime to take an interrupt.
+	///
+	inline void	IdleSystem( void )
+		{
+			mSignal = false;
+			mPaused = true;
+			mIdle = true;
+			mIdlePC = mProcessor.GetRegister( 15 );
+		}
+	
 	///
 	/// Quit.
 	///
@@ -457,6 +492,7 @@ private:
 	TSoundManager*		mSoundManager;		///< Sound manager.
 	TScreenManager*		mScreenManager;		///< Screen manager.
 	TFileManager*       mFileManager;
+	TNativeKernel*		mNativeKernel;		///< Host implementations of kernel calls.
 	KUInt32				mNewtonID[2];		///< NewtonID (48 bits, 16+32).
 	TLog*				mLog;				///< Interface for logging.
 	TMonitor*			mMonitor;			///< Monitor (or \c nil).
@@ -464,6 +500,9 @@ private:
 	KUInt32				mInterrupted;		///< We got a (processor) interrupt.
 	KUInt32				mRunning;			///< If we're running.
 	KUInt32				mPaused;			///< If we're paused (until next interrupt).
+	KUInt32				mIdle;				///< If the pause is for an idle loop.
+	KUInt32				mIdlePC;			///< PC in the idle loop.
+	KUInt32				mIdleCount;			///< Waits in idle loops.
 	KUInt32				mBPHalted;			///< If we're halted because of a breakpoint.
 	KUInt16				mBPID;				///< ID of the breakpoint.
 };
@@ -37,7 +37,8 @@
 ///
 /// Single key hash-backed cache for virtual adresses.
 /// This isn't a "real" hash-map:
-/// - the hash function is extremely simple;
+/// - the hash function is extremely simple (a multiplicative hash of the
+///   page number, which spreads the pages of all banks over the table);
 /// - collision are not handled here.
 ///
 /// Instead, all entries are allocated here and are stored within a double
@@ -58,12 +59,23 @@ public:
 	///
 	/// Initialization (links the values together)
 	///
-	inline THashMapCache( void );
+	/// \param inCacheSize	number of values in the cache.
+	///
+	inline THashMapCache( KUInt32 inCacheSize = kDefaultCacheSize );
 	
 	///
 	/// Destruction.
 	///
 	inline ~THashMapCache( void );
+
+	///
+	/// Change the number of values in the cache.
+	/// All values are re-created and the map is cleared, so the caller
+	/// must not keep any pointer to the old values.
+	///
+	/// \param inCacheSize	new number of values in the cache.
+	///
+	inline void	Resize( KUInt32 inCacheSize );
 	
 	///
 	/// Insert.
@@ -124,51 +136,56 @@ public:
 			return mLastValue;
 		}
 
+	///
+	/// Accessor on the number of values.
+	///
+	KUInt32		GetCacheSize( void ) const
+		{
+			return mCacheSize;
+		}
+
 	enum {
-		kCacheSize				= 128,
-		kHashFunctionMask		= 0x000FFC00,
-		kHashFunctionShift		= 10,
-		kHashTableSize			= (kHashFunctionMask >> kHashFunctionShift) + 1,
+		kDefaultCacheSize		= 128,
+		kMinCacheSize			= 16,
+		kMaxCacheSize			= 16384,
+		kHashPageShift			= 10,
+		kHashMultiplier			= 0x9E3779B1,	///< 2^32 / golden ratio.
+		kMinHashTableBits		= 10,
 	};
 	
 	///
 	/// Hash function.
 	///
-	static inline KUInt32 HashFunction(const KUInt32 val)
+	inline KUInt32 HashFunction(const KUInt32 val) const
 		{
-			return (val & kHashFunctionMask) >> kHashFunctionShift;
+			// Mask in case KUInt32 is wider than 32 bits.
+			return (((val >> kHashPageShift) * kHashMultiplier) & 0xFFFFFFFF)
+				>> mHashShift;
 		}
 
 private:
+	///
+	/// Allocate the values and the table, and link the values together.
+	///
+	inline void Allocate( KUInt32 inCacheSize );
+
 	/// \name Variables
 	TValue*		mFirstValue;				///< First element.
 	TValue*		mLastValue;					///< Last element.
-	TValue		mValues[kCacheSize];		///< Values.
+	TValue*		mValues;					///< Values.
 	TValue**	mHashTable;					///< Hash table.
+	KUInt32		mCacheSize;					///< Number of values.
+	KUInt32		mHashTableSize;				///< Number of buckets.
+	KUInt32		mHashShift;					///< 32 - log2(mHashTableSize).
 };
 
 // -------------------------------------------------------------------------- //
 //  * THashMapCache( void )
 // -------------------------------------------------------------------------- //
 template<class TValue>
-THashMapCache<TValue>::THashMapCache( void )
+THashMapCache<TValue>::THashMapCache( KUInt32 inCacheSize /* = kDefaultCacheSize */ )
 {
-	// Init the map.
-	mHashTable = (TValue**) ::calloc(kHashTableSize, sizeof(TValue*));
-
-	// Link the values.
-	mFirstValue = &mValues[0];
-	mValues[0].prev = NULL;
-	mValues[0].next = &mValues[1];
-	KUInt32 indexValue;
-	for (indexValue = 1; indexValue < (kCacheSize - 1); indexValue++) {
-		TValue* theValue = &mValues[indexValue];
-		theValue->prev = &mValues[indexValue - 1];
-		theValue->next = &mValues[indexValue + 1];
-	}
-	mValues[kCacheSize - 1].prev = &mValues[kCacheSize - 2];
-	mValues[kCacheSize - 1].next = NULL;
-	mLastValue = &mValues[kCacheSize - 1];
+	Allocate( inCacheSize );
 }
 
 // -------------------------------------------------------------------------- //
@@ -179,6 +196,60 @@ THashMapCache<TValue>::~THashMapCache( void )
 {
 	// Free the map.
 	::free(mHashTable);
+	delete [] mValues;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Resize( KUInt32 )
+// -------------------------------------------------------------------------- //
+template<class TValue>
+void
+THashMapCache<TValue>::Resize( KUInt32 inCacheSize )
+{
+	::free(mHashTable);
+	delete [] mValues;
+	Allocate( inCacheSize );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Allocate( KUInt32 )
+// -------------------------------------------------------------------------- //
+template<class TValue>
+void
+THashMapCache<TValue>::Allocate( KUInt32 inCacheSize )
+{
+	if (inCacheSize < kMinCacheSize)
+	{
+		inCacheSize = kMinCacheSize;
+	} else if (inCacheSize > kMaxCacheSize) {
+		inCacheSize = kMaxCacheSize;
+	}
+	mCacheSize = inCacheSize;
+
+	// Init the map, with about 8 buckets per value to limit collisions.
+	KUInt32 theHashBits = kMinHashTableBits;
+	while ((1U << theHashBits) < (inCacheSize * 8))
+	{
+		theHashBits++;
+	}
+	mHashTableSize = 1 << theHashBits;
+	mHashShift = 32 - theHashBits;
+	mHashTable = (TValue**) ::calloc(mHashTableSize, sizeof(TValue*));
+
+	// Link the values.
+	mValues = new TValue[inCacheSize];
+	mFirstValue = &mValues[0];
+	mValues[0].prev = NULL;
+	mValues[0].next = &mValues[1];
+	KUInt32 indexValue;
+	for (indexValue = 1; indexValue < (inCacheSize - 1); indexValue++) {
+		TValue* theValue = &mValues[indexValue];
+		theValue->prev = &mValues[indexValue - 1];
+		theValue->next = &mValues[indexValue + 1];
+	}
+	mValues[inCacheSize - 1].prev = &mValues[inCacheSize - 2];
+	mValues[inCacheSize - 1].next = NULL;
+	mLastValue = &mValues[inCacheSize - 1];
 }
 
 // -------------------------------------------------------------------------- //
@@ -228,7 +299,7 @@ template<class TValue>
 void
 THashMapCache<TValue>::Clear( void )
 {
-	memset(mHashTable, 0, kHashTableSize * sizeof(TValue*));
+	memset(mHashTable, 0, mHashTableSize * sizeof(TValue*));
 }
 
 // -------------------------------------------------------------------------- //
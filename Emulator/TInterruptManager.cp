@@ -24,6 +24,7 @@
 #include <K/Defines/KDefinitions.h>
 #include "TInterruptManager.h"
 #include "TARMProcessor.h"
+#include "TMemory.h"
 
 // POSIX & ANSI C
 #include <stdio.h>
@@ -121,6 +122,11 @@ TInterruptManager::TInterruptManager(
 // -------------------------------------------------------------------------- //
 TInterruptManager::~TInterruptManager( void )
 {
+	KUInt32 theStart;
+	KUInt32 theEnd;
+	GetIORange( &theStart, &theEnd );
+	mProcessor->GetMemory()->UnregisterIOHandler( theStart, theEnd );
+
 	// Stop the timer thread.
 	mMutex->Lock();
 	
@@ -181,6 +187,143 @@ TInterruptManager::Init( void )
 	
 	// Release the mutex, so the timer thread will get it back.
 	mMutex->Unlock();
+
+	// Register the registers.
+	TMemory::SIOHandler theHandler =
+		{ this, ReadRegister, WriteRegister, ReadBRegister, WriteBRegister };
+	KUInt32 theStart;
+	KUInt32 theEnd;
+	GetIORange( &theStart, &theEnd );
+	(void) mProcessor->GetMemory()->RegisterIOHandler(
+		theStart, theEnd, theHandler );
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetIORange( KUInt32*, KUInt32* )
+// -------------------------------------------------------------------------- //
+void
+TInterruptManager::GetIORange( KUInt32* outStart, KUInt32* outEnd )
+{
+	*outStart = TMemoryConsts::kHdWr_P0F180400 & ~(TMemory::kIOPageSize - 1);
+	*outEnd = (TMemoryConsts::kHdWr_IOPower2 & ~(TMemory::kIOPageSize - 1))
+		+ TMemory::kIOPageSize;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadRegister( void*, KUInt32, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TInterruptManager::ReadRegister(
+			void* inObject,
+			KUInt32 inAddress,
+			Boolean& outFault )
+{
+	TInterruptManager* theIntManager = (TInterruptManager*) inObject;
+	if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
+		return theIntManager->GetRealTimeClock();
+	} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
+		return theIntManager->GetAlarm();
+	} else if (inAddress == TMemoryConsts::kHdWr_Ticks) {
+		return theIntManager->GetTimer();
+	} else if (inAddress == TMemoryConsts::kHdWr_IntPresent) {
+		return theIntManager->GetIntRaised();
+	} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
+		return theIntManager->GetIntCtrlReg();
+	} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
+		return theIntManager->GetFIQMask();
+	} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
+		return theIntManager->GetIntEDReg1();
+	} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
+		return theIntManager->GetIntEDReg2();
+	} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
+		return theIntManager->GetIntEDReg3();
+	} else if (inAddress == TMemoryConsts::kHdWr_GPIO_RReg) {
+		return theIntManager->GetGPIORaised();
+	} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
+		return theIntManager->GetGPIOCtrlReg();
+	} else if (inAddress == TMemoryConsts::kHdWr_P0F18D400) {
+		return 0xffffffff; // PCMCIA Door Locked?
+	} else {
+		return TMemory::ReadUnknown(
+			theIntManager->mProcessor->GetMemory(), inAddress, outFault );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteRegister( void*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TInterruptManager::WriteRegister(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt32 inWord )
+{
+	TInterruptManager* theIntManager = (TInterruptManager*) inObject;
+	if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
+		theIntManager->SetRealTimeClock(inWord);
+	} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
+		theIntManager->SetAlarm(inWord);
+	} else if (inAddress == TMemoryConsts::kHdWr_MatchReg0) {
+		theIntManager->SetTimerMatchRegister( 0, inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_MatchReg1) {
+		theIntManager->SetTimerMatchRegister( 1, inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_MatchReg2) {
+		theIntManager->SetTimerMatchRegister( 2, inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_MatchReg3) {
+		theIntManager->SetTimerMatchRegister( 3, inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
+		theIntManager->SetIntCtrlReg( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_IntClear) {
+		theIntManager->ClearInterrupts( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
+		theIntManager->SetFIQMask( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
+		theIntManager->SetIntEDReg1( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
+		theIntManager->SetIntEDReg2( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
+		theIntManager->SetIntEDReg3( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
+		theIntManager->SetGPIOCtrlReg( inWord );
+	} else if (inAddress == TMemoryConsts::kHdWr_GPIO_CReg) {
+		theIntManager->ClearGPIO( inWord );
+	} else {
+		return TMemory::WriteUnknown(
+			theIntManager->mProcessor->GetMemory(), inAddress, inWord );
+	}
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadBRegister( void*, KUInt32, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TInterruptManager::ReadBRegister(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt8& outByte )
+{
+	// Interrupt registers are only accessed by words.
+	return TMemory::ReadBUnknown(
+		((TInterruptManager*) inObject)->mProcessor->GetMemory(),
+		inAddress,
+		outByte );
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteBRegister( void*, KUInt32, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TInterruptManager::WriteBRegister(
+			void* inObject,
+			KUInt32 inAddress,
+			KUInt8 inByte )
+{
+	return TMemory::WriteBUnknown(
+		((TInterruptManager*) inObject)->mProcessor->GetMemory(),
+		inAddress,
+		inByte );
 }
 
 // -------------------------------------------------------------------------- //
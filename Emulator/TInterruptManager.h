@@ -398,10 +398,30 @@ private:
 	TInterruptManager& operator = ( const TInterruptManager& inCopy );
 
 	///
-	/// Performs initialization (create thread & condition variable).
+	/// Performs initialization (create thread & condition variable, register
+	/// the interrupt registers with the memory).
 	///
 	void	Init( void );
 
+	///
+	/// Get the range of the registers dispatched to the interrupt manager.
+	///
+	/// \param outStart		first address.
+	/// \param outEnd		address after the range.
+	///
+	static void	GetIORange( KUInt32* outStart, KUInt32* outEnd );
+
+	/// \name Handlers of the interrupt registers (see TMemory::SIOHandler).
+	/// The object is the TInterruptManager.
+	static KUInt32	ReadRegister(
+						void* inObject, KUInt32 inAddress, Boolean& outFault );
+	static Boolean	WriteRegister(
+						void* inObject, KUInt32 inAddress, KUInt32 inWord );
+	static Boolean	ReadBRegister(
+						void* inObject, KUInt32 inAddress, KUInt8& outByte );
+	static Boolean	WriteBRegister(
+						void* inObject, KUInt32 inAddress, KUInt8 inByte );
+
 	///
 	/// Fire and find next interrupts.
 	///
@@ -79,10 +79,12 @@ TMMU::TMMU( TMemory* inMemoryIntf )
 		mTTBase( 0 ),
 		mDomainAC( 0xFFFFFFFF )
 {
+	ResetStats();
+
 	// Init the cache entries with unprobable values.
 	SEntry* theEntries = mCache.GetValues();
 	KUInt32 indexEntry;
-	for (indexEntry = 0; indexEntry < THashMapCache<SEntry>::kCacheSize; indexEntry++) {
+	for (indexEntry = 0; indexEntry < mCache.GetCacheSize(); indexEntry++) {
 		SEntry* theEntry = &theEntries[indexEntry];
 		theEntry->key = 1;
 		theEntry->mPhysicalAddress = 1;
@@ -147,6 +149,42 @@ TMMU::SetROMProtection( Boolean inProtection )
 	InvalidatePerms();
 }
 
+// -------------------------------------------------------------------------- //
+//  * TranslatePrivileged( KUInt32, Boolean, KUInt32& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMMU::TranslatePrivileged(
+			KUInt32 inVAddress,
+			Boolean inWrite,
+			KUInt32& outPAddress )
+{
+	KUInt8 savedAPMode = mCurrentAPMode;
+	KUInt8 savedAPRead = mCurrentAPRead;
+	KUInt8 savedAPWrite = mCurrentAPWrite;
+	// A failed translation is not a fault of the guest.
+	KUInt32 savedFaultAddress = mFaultAddress;
+	KUInt32 savedFaultStatus = mFaultStatus;
+	mCurrentAPMode |= kAPMagic_Privileged;
+	mCurrentAPRead = (kAPMagic_Bits_Read >> (4 * mCurrentAPMode)) & 0xF;
+	mCurrentAPWrite = (kAPMagic_Bits_Write >> (4 * mCurrentAPMode)) & 0xF;
+	
+	Boolean theResult;
+	if (inWrite)
+	{
+		theResult = TranslateW( inVAddress, outPAddress );
+	} else {
+		theResult = TranslateR( inVAddress, outPAddress );
+	}
+	
+	mCurrentAPMode = savedAPMode;
+	mCurrentAPRead = savedAPRead;
+	mCurrentAPWrite = savedAPWrite;
+	mFaultAddress = savedFaultAddress;
+	mFaultStatus = savedFaultStatus;
+	
+	return theResult;
+}
+
 // -------------------------------------------------------------------------- //
 //  * TranslateR( KUInt32, KUInt32& )
 // Performanc: this function eats around 9% of the overall performance!
@@ -924,6 +962,26 @@ TMMU::TranslateInstruction(
 	return false;
 }
 
+// -------------------------------------------------------------------------- //
+//  * GetInstructionDomain( KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMMU::GetInstructionDomain( KUInt32 inVAddress )
+{
+	// Same test as TranslateInstruction: unprotected ROM isn't translated.
+	if (mMMUEnabled && ((inVAddress < 0x00002000) || (inVAddress & TMemoryConsts::kROMEndMask)))
+	{
+		SEntry* theEntry =
+			mCache.Lookup(inVAddress & TMemoryConsts::kMMUSmallestPageMask);
+		if (theEntry)
+		{
+			return theEntry->mDomainTimes2 / 2;
+		}
+	}
+	
+	return TMemoryConsts::kMMUNoDomain;
+}
+
 // -------------------------------------------------------------------------- //
 //  * AddToCache( KUInt32, KUInt32, KUInt32, KUInt32 )
 // -------------------------------------------------------------------------- //
@@ -963,8 +1021,10 @@ TMMU::InvalidateTLB( void )
 	gNbInvalidate++;
 #endif
 
+	mStats.mTLBFlushes++;
 	mCache.Clear();
 	mMemoryIntf->GetJITObject()->InvalidateTLB();
+	mMemoryIntf->InvalidateHostTLB();
 }
 
 // -------------------------------------------------------------------------- //
@@ -973,9 +1033,46 @@ TMMU::InvalidateTLB( void )
 void
 TMMU::InvalidatePerms( void )
 {
+	mStats.mPermChanges++;
 	mMemoryIntf->GetJITObject()->InvalidateTLB();
+	mMemoryIntf->InvalidateHostTLB();
 }
 
+// -------------------------------------------------------------------------- //
+//  * InvalidateDomains( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TMMU::InvalidateDomains( KUInt32 inChangedBits )
+{
+	mStats.mPermChanges++;
+
+	// Two bits per domain.
+	KUInt32 theDomains = 0;
+	KUInt32 indexDomain;
+	for (indexDomain = 0; indexDomain < TMemoryConsts::kMMUDomainCount; indexDomain++)
+	{
+		if (inChangedBits & (3 << (indexDomain * 2)))
+		{
+			theDomains |= (1 << indexDomain);
+		}
+	}
+	mMemoryIntf->GetJITObject()->InvalidateDomains( theDomains );
+	
+	// The host TLB is cheap to drop as a whole.
+	mMemoryIntf->InvalidateHostTLB();
+}
+
+// -------------------------------------------------------------------------- //
+//  * ResetStats( void )
+// -------------------------------------------------------------------------- //
+void
+TMMU::ResetStats( void )
+{
+	mStats.mTLBFlushes = 0;
+	mStats.mPermChanges = 0;
+	mStats.mDomainChanges = 0;
+	mStats.mTTBChanges = 0;
+}
 
 // -------------------------------------------------------------------------- //
 //  * TransferState( TStream* )
@@ -41,6 +41,16 @@
 class TStream;
 class TMemory;
 
+///
+/// Counters of the MMU, to measure how often translations are thrown away.
+///
+struct SMMUStats {
+	KUInt32			mTLBFlushes;		///< Invalidations of the whole TLB.
+	KUInt32			mPermChanges;		///< Permission checks invalidated.
+	KUInt32			mDomainChanges;		///< Writes to the domain register.
+	KUInt32			mTTBChanges;		///< Writes to the translation base.
+};
+
 ///
 /// Class to handle MMU operations.
 ///
@@ -77,6 +87,15 @@ public:
 					KUInt32 inVAddress,
 					KUInt32* outPAddress );
 
+	///
+	/// Get the domain an instruction translation depends on.
+	/// Only meaningful right after TranslateInstruction succeeded.
+	///
+	/// \param inVAddress		virtual address of the instruction.
+	/// \return the domain or kMMUNoDomain if no translation was required.
+	///
+	KUInt32		GetInstructionDomain( KUInt32 inVAddress );
+
 	///
 	/// Translate an address using MMU tables for reading.
 	///
@@ -97,6 +116,23 @@ public:
 	///
 	Boolean		TranslateW( KUInt32 inVAddress, KUInt32& outPAddress );
 
+	///
+	/// Translate an address using MMU tables with the privileged
+	/// permissions, whatever the current mode. Unlike SetPrivilege, this
+	/// doesn't invalidate the TLBs: the cache checks the permissions at
+	/// every lookup. A failure doesn't change the fault address and status.
+	///
+	/// \param inVAddress   virtual address.
+	/// \param inWrite		whether the address is translated for writing.
+	/// \param outPAddress  physical address.
+	/// \return true if the MMU tables couldn't be accessed for
+	///			reading or if the target address is not accessible.
+	///
+	Boolean		TranslatePrivileged(
+					KUInt32 inVAddress,
+					Boolean inWrite,
+					KUInt32& outPAddress );
+
 	///
 	/// Enable or disable the MMU.
 	///
@@ -192,8 +228,12 @@ public:
 	///
 	void		SetTranslationTableBase( KUInt32 inNewBase )
 		{
-			InvalidateTLB();
-			mTTBase = inNewBase;
+			mStats.mTTBChanges++;
+			if (inNewBase != mTTBase)
+			{
+				InvalidateTLB();
+				mTTBase = inNewBase;
+			}
 		}
 
 	///
@@ -213,8 +253,15 @@ public:
 	///
 	void		SetDomainAccessControl( KUInt32 inNewDomainAC )
 		{
-			InvalidateTLB();
-			mDomainAC = inNewDomainAC;
+			mStats.mDomainChanges++;
+			KUInt32 theChangedBits = inNewDomainAC ^ mDomainAC;
+			if (theChangedBits)
+			{
+				// Cached translations know their domain: only those of the
+				// domains that changed are checked again.
+				mDomainAC = inNewDomainAC;
+				InvalidateDomains( theChangedBits );
+			}
 		}
 
 	///
@@ -275,6 +322,19 @@ public:
 	///
 	void		InvalidateTLB( void );
 
+	///
+	/// Accessor on the counters.
+	///
+	const SMMUStats&	GetStats( void ) const
+		{
+			return mStats;
+		}
+
+	///
+	/// Reset the counters.
+	///
+	void		ResetStats( void );
+
 	///
 	/// Save or restore the state of the MMU.
 	///
@@ -334,6 +394,13 @@ private:
 	///
 	void		InvalidatePerms( void );
 
+	///
+	/// Invalidate the perms cache of some domains.
+	///
+	/// \param inChangedBits	bits of the domain access control that changed.
+	///
+	void		InvalidateDomains( KUInt32 inChangedBits );
+
 	///
 	/// Add a translation to the cache.
 	///
@@ -355,6 +422,7 @@ private:
 	KUInt32				mFaultAddress;		///< Address of the last fault.
 	KUInt32				mFaultStatus;		///< Status.
 	THashMapCache<SEntry>	mCache;			///< TLB cache.
+	SMMUStats			mStats;				///< Counters.
 };
 
 #endif
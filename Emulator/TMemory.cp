@@ -48,6 +48,7 @@
 #include "TEmulator.h"
 #include "ROM/TROMImage.h"
 #include "Log/TLog.h"
+#include "Host/USwapCopy.h"
 #include "JIT/JIT.h"
 #include "PCMCIA/TATACard.h"
 #include "PCMCIA/TLinearCard.h"
@@ -158,6 +159,19 @@ TMemory::TMemory(
 		mWPCount( 0 )
 {
 	Init();
+	
+	// Reuse the ROM pages translated by a previous run (if enabled).
+	const char* theImagePath = inROMImage->GetImagePath();
+	if (theImagePath)
+	{
+		KUInt32 theChecksums[10];
+		inROMImage->ComputeChecksums( theChecksums );
+		mJIT.OpenPageFile( theImagePath, theChecksums );
+	}
+	
+	// Fill the JIT cache with the first ROM pages, now that they can be
+	// read (and loaded from the page file).
+	(void) mJIT.SetCacheSize( mJIT.GetCacheSize() );
 }
 
 // -------------------------------------------------------------------------- //
@@ -276,7 +290,7 @@ TMemory::GetDirectPointerToROMRAM( VAddr inAddress, const KUInt8** outPTR )
 		theAddress = inAddress;
 	}
 
-	if (!(inAddress & TMemoryConsts::kROMEndMask))
+	if (!(theAddress & TMemoryConsts::kROMEndMask))
 	{
 		*outPTR = ((KUInt8*) (mROMImagePtr + theAddress));
 	} else if(theAddress >= TMemoryConsts::kRAMStart && theAddress < mRAMEnd) {
@@ -291,20 +305,117 @@ TMemory::GetDirectPointerToROMRAM( VAddr inAddress, const KUInt8** outPTR )
 	return false;
 }
 
+// -------------------------------------------------------------------------- //
+//  * GetBlockPointerR( VAddr, KUInt32, const KUInt32** )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::GetBlockPointerR(
+			VAddr inAddress,
+			KUInt32 inAmount,
+			const KUInt32** outPtr )
+{
+	VAddr theFirst = inAddress & ~0x03;
+	if ((inAmount == 0)
+		|| ((theFirst ^ (theFirst + inAmount - 4))
+			& TMemoryConsts::kMMUSmallestPageMask))
+	{
+		// Crosses a page.
+		return true;
+	}
+
+	// Optimization: avoid translation when reading unprotected ROM
+	if (IsMMUEnabled() && IsPageInROM(theFirst))
+	{
+		*outPtr = (const KUInt32*) (mROMImagePtr + theFirst);
+		return false;
+	}
+
+	SHostTLBEntry* theEntry = GetHostTLBEntry( theFirst );
+	if (theEntry->fReadTag != GetHostTLBTag( theFirst ))
+	{
+		// Translate the page once. Watched pages are never in the host TLB.
+		PAddr theAddress;
+		if (IsMMUEnabled())
+		{
+			if (TranslateR( theFirst, theAddress ))
+			{
+				return true;
+			}
+		} else {
+			theAddress = theFirst;
+		}
+		FillHostTLB( theFirst, theAddress, false );
+		if (theEntry->fReadTag != GetHostTLBTag( theFirst ))
+		{
+			// Flash, hardware or watched page.
+			return true;
+		}
+	}
+	
+	*outPtr = (const KUInt32*) (theEntry->fHostOffset + theFirst);
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetBlockPointerW( VAddr, KUInt32, KUInt32** )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::GetBlockPointerW(
+			VAddr inAddress,
+			KUInt32 inAmount,
+			KUInt32** outPtr )
+{
+	VAddr theFirst = inAddress & ~0x03;
+	if ((inAmount == 0)
+		|| ((theFirst ^ (theFirst + inAmount - 4))
+			& TMemoryConsts::kMMUSmallestPageMask))
+	{
+		// Crosses a page.
+		return true;
+	}
+
+	SHostTLBEntry* theEntry = GetHostTLBEntry( theFirst );
+	if (theEntry->fWriteTag != GetHostTLBTag( theFirst ))
+	{
+		// Translate the page once. Watched pages are never in the host TLB.
+		PAddr theAddress;
+		if (IsMMUEnabled())
+		{
+			if (TranslateW( theFirst, theAddress ))
+			{
+				return true;
+			}
+		} else {
+			theAddress = theFirst;
+		}
+		FillHostTLB( theFirst, theAddress, true );
+		if (theEntry->fWriteTag != GetHostTLBTag( theFirst ))
+		{
+			// ROM, flash, hardware or watched page.
+			return true;
+		}
+	}
+	
+	// The block bypasses WriteAligned: the JIT needs to know if the page
+	// was translated (self-modifying code).
+	mJIT.Invalidate( theFirst + theEntry->fPhysicalOffset );
+	*outPtr = (KUInt32*) (theEntry->fHostOffset + theFirst);
+	return false;
+}
+
 // -------------------------------------------------------------------------- //
 //  * FastReadBuffer( VAddr, const KUInt8** )
 // -------------------------------------------------------------------------- //
 Boolean
 TMemory::FastReadBuffer( VAddr inAddress, KUInt32 inAmount, KUInt8* outBuffer )
 {
-	const KUInt8* pointer;
 	KUInt8* dst = outBuffer;
 	KUInt32 len = inAmount;
 	KUInt32 addr = inAddress;
 
 	if (addr & 0x3)
 	{
-		int bytes = min(addr & 0x3, len);
+		int bytes = min(4 - (addr & 0x3), len);
 		// Quickly skip to aligned accesses
 		while (bytes-- > 0)
 		{
@@ -315,54 +426,63 @@ TMemory::FastReadBuffer( VAddr inAddress, KUInt32 inAmount, KUInt8* outBuffer )
 		}
 	}
 	
-	if (GetDirectPointerToROMRAM(addr, &pointer))
+	// Copy page by page. Pages that cannot be accessed directly (flash,
+	// hardware, translation or permission faults) are read word by word,
+	// so that faults are reported as with ReadAligned.
+	KUInt32 alignedLen = len &~ 0x3;
+	while (alignedLen > 0)
 	{
-		// Slower.
-		int words = len / 4;
-		KUInt32* dst32 = (KUInt32*) dst;
-		while (words-- > 0)
+		KUInt32 amount = TMemoryConsts::kMMUSmallestPageSize
+			- (addr & TMemoryConsts::kMMUSmallestPageMaskNeg);
+		if (amount > alignedLen)
 		{
-			KUInt32 word;
-			if (ReadAligned(addr, word)) return true;
-			*dst32++ = UByteSex_FromBigEndian( word );
-			addr += 4;
+			amount = alignedLen;
 		}
-	} else {
-		KUInt32 base = inAddress & TMemoryConsts::kMMUSmallestPageMask;
-		KUInt32 maxCopy = base - addr + TMemoryConsts::kMMUSmallestPageSize;
-		KUInt32 alignedLen = len &~ 0x3;
-
-		do {
-			KUInt32 amount = min(alignedLen, maxCopy);
-#if TARGET_RT_LITTLE_ENDIAN
+		
+		Boolean copied = false;
+		PAddr thePAddr = addr;
+		// Optimization: avoid translation when reading unprotected ROM
+		if (!(IsMMUEnabled() && !IsPageInROM(addr)
+			&& TranslateR( addr, thePAddr )))
+		{
+			const KUInt8* pointer = NULL;
+			if (!(thePAddr & TMemoryConsts::kROMEndMask))
 			{
-				KUInt32 nbWords = amount / 4;
-				KUInt32* dstCrsr = (KUInt32*) dst;
-				KUInt32* srcCrsr = (KUInt32*) pointer;
-				while (nbWords-- > 0)
-				{
-					*dstCrsr++ = UByteSex_ToBigEndian(*srcCrsr++);
-				}
+				pointer = mROMImagePtr + thePAddr;
+			} else if ((thePAddr >= TMemoryConsts::kRAMStart)
+				&& (thePAddr < mRAMEnd)) {
+				pointer = (const KUInt8*) (mRAMOffset + thePAddr);
 			}
+			if (pointer)
+			{
+#if TARGET_RT_LITTLE_ENDIAN
+				USwapCopy::SwapWords( dst, pointer, amount );
 #else
-			(void) ::memcpy(dst, pointer, amount);
+				(void) ::memcpy(dst, pointer, amount);
 #endif
-			alignedLen -= amount;
-			len -= amount;
-			dst += amount;
-			addr += amount;
-			if (alignedLen == 0)
-			{
-				break;
+				copied = true;
 			}
-			// Else, amount == maxCopy
-			maxCopy = TMemoryConsts::kMMUSmallestPageSize;
-			if (GetDirectPointerToROMRAM(addr, &pointer))
+		}
+		
+		if (!copied)
+		{
+			// Slower.
+			KUInt32 words = amount / 4;
+			KUInt32 wordAddr = addr;
+			KUInt32* dst32 = (KUInt32*) dst;
+			while (words-- > 0)
 			{
-				SetHardwareFault(addr);
-				return true;
+				KUInt32 word;
+				if (ReadAligned(wordAddr, word)) return true;
+				*dst32++ = UByteSex_FromBigEndian( word );
+				wordAddr += 4;
 			}
-		} while (true);
+		}
+		
+		alignedLen -= amount;
+		len -= amount;
+		dst += amount;
+		addr += amount;
 	}
 
 	// Copy unaligned bits at the end.
@@ -531,7 +651,6 @@ TMemory::FastReadString( VAddr inAddress, KUInt32* ioAmount, char* outString )
 Boolean
 TMemory::FastWriteBuffer( VAddr inAddress, KUInt32 inAmount, const KUInt8* inBuffer )
 {
-	KUInt8* pointer;
 	const KUInt8* src = inBuffer;
 	KUInt32 len = inAmount;
 	KUInt32 addr = inAddress;
@@ -539,61 +658,66 @@ TMemory::FastWriteBuffer( VAddr inAddress, KUInt32 inAmount, const KUInt8* inBuf
 	if (addr & 0x3)
 	{
 		// Quickly skip to aligned accesses
-		int bytes = min(addr & 0x3, len);
+		int bytes = min(4 - (addr & 0x3), len);
 		while (bytes-- > 0)
 		{
 			KUInt8 byte = *src++;
 			if (WriteB(addr++, byte)) return true;
 			len--;
 		}
-	}	
-	if (GetDirectPointerToRAM(addr, &pointer))
+	}
+	
+	// Copy page by page. Pages that are not RAM or cannot be accessed
+	// (translation or permission faults) are written word by word, so
+	// that faults are reported as with WriteAligned.
+	KUInt32 alignedLen = len &~ 0x3;
+	while (alignedLen > 0)
 	{
-		// Slower.
-		int words = len / 4;
-		KUInt32* src32 = (KUInt32*) src;
-		while (words-- > 0)
+		KUInt32 amount = TMemoryConsts::kMMUSmallestPageSize
+			- (addr & TMemoryConsts::kMMUSmallestPageMaskNeg);
+		if (amount > alignedLen)
 		{
-			KUInt32 word = UByteSex_ToBigEndian(*src32++);
-			if (WriteAligned(addr, word)) return true;
-			addr += 4;
+			amount = alignedLen;
 		}
-	} else {
-		KUInt32 base = inAddress & TMemoryConsts::kMMUSmallestPageMask;
-		KUInt32 maxCopy = base - addr + TMemoryConsts::kMMUSmallestPageSize;
-		KUInt32 alignedLen = len &~ 0x3;
-
-		do {
-			KUInt32 amount = min(alignedLen, maxCopy);
-#if TARGET_RT_LITTLE_ENDIAN
+		
+		Boolean copied = false;
+		PAddr thePAddr = addr;
+		if (!(IsMMUEnabled() && TranslateW( addr, thePAddr )))
+		{
+			if ((thePAddr >= TMemoryConsts::kRAMStart)
+				&& (thePAddr < mRAMEnd))
 			{
-				KUInt32 nbWords = amount / 4;
-				KUInt32* dstCrsr = (KUInt32*) pointer;
-				KUInt32* srcCrsr = (KUInt32*) src;
-				while (nbWords-- > 0)
-				{
-					*dstCrsr++ = UByteSex_ToBigEndian(*srcCrsr++);
-				}
-			}
+				KUInt8* pointer = (KUInt8*) (mRAMOffset + thePAddr);
+				// The direct copy bypasses WriteAligned: the JIT needs to
+				// know if the page was translated (self-modifying code).
+				mJIT.Invalidate( thePAddr );
+#if TARGET_RT_LITTLE_ENDIAN
+				USwapCopy::SwapWords( pointer, src, amount );
 #else
-			(void) ::memcpy(pointer, src, amount);
+				(void) ::memcpy(pointer, src, amount);
 #endif
-			alignedLen -= amount;
-			len -= amount;
-			src += amount;
-			addr += amount;
-			if (alignedLen == 0)
-			{
-				break;
+				copied = true;
 			}
-			// Else, amount == maxCopy
-			maxCopy = TMemoryConsts::kMMUSmallestPageSize;
-			if (GetDirectPointerToRAM(addr, &pointer))
+		}
+		
+		if (!copied)
+		{
+			// Slower.
+			KUInt32 words = amount / 4;
+			KUInt32 wordAddr = addr;
+			const KUInt32* src32 = (const KUInt32*) src;
+			while (words-- > 0)
 			{
-				SetHardwareFault(addr);
-				return true;
+				KUInt32 word = UByteSex_ToBigEndian(*src32++);
+				if (WriteAligned(wordAddr, word)) return true;
+				wordAddr += 4;
 			}
-		} while (true);
+		}
+		
+		alignedLen -= amount;
+		len -= amount;
+		src += amount;
+		addr += amount;
 	}
 
 	// Copy unaligned bits at the end.
@@ -639,6 +763,7 @@ TMemory::FastWriteString( VAddr inAddress, KUInt32* ioAmount, const char* inStri
 
 		do {
 			KUInt32 amount = min(len, maxCopy);
+			mJIT.Invalidate( (PAddr) ((KUIntPtr) pointer - mRAMOffset) );
 			char* last = ::strncpy((char*) pointer, src, amount);
 			if (*last == '\0')
 			{
@@ -701,14 +826,21 @@ TMemory::ReadInstruction( KUInt32 inBankNumber, KUInt32 inOffsetInBank )
 Boolean
 TMemory::Read( VAddr inAddress, KUInt32& outWord )
 {
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
+	// Fast path: aligned access to a page of ROM or RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if ((theEntry->fReadTag == GetHostTLBTag( inAddress ))
+		&& !(inAddress & 0x3))
+	{
+		outWord = *((KUInt32*) (theEntry->fHostOffset + inAddress));
+		return false;
 	}
-	
+
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
+	{
+		CheckWatchpoints( inAddress, kWatchRead );
+	}
+
 	PAddr theAddress;
 
 	// Optimization: avoid translation when reading unprotected ROM
@@ -730,6 +862,12 @@ TMemory::Read( VAddr inAddress, KUInt32& outWord )
 		return true;
 	}
 	
+	// ROM accessed without translation can't be shared with ReadB.
+	if (!IsMMUEnabled() || !IsPageInROM(inAddress))
+	{
+		FillHostTLB( inAddress, theAddress, false );
+	}
+
 	return false;
 }
 
@@ -739,12 +877,18 @@ TMemory::Read( VAddr inAddress, KUInt32& outWord )
 Boolean
 TMemory::ReadAligned( VAddr inAddress, KUInt32& outWord )
 {
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
+	// Fast path: access to a page of ROM or RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if (theEntry->fReadTag == GetHostTLBTag( inAddress ))
+	{
+		outWord = *((KUInt32*) (theEntry->fHostOffset + (inAddress & ~0x03)));
+		return false;
+	}
+
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
+	{
+		CheckWatchpoints( inAddress, kWatchRead );
 	}
 
 	PAddr theAddress;
@@ -768,6 +912,12 @@ TMemory::ReadAligned( VAddr inAddress, KUInt32& outWord )
 		return true;
 	}
 	
+	// ROM accessed without translation can't be shared with ReadB.
+	if (!IsMMUEnabled() || !IsPageInROM(inAddress))
+	{
+		FillHostTLB( inAddress, theAddress, false );
+	}
+
 	return false;
 }
 
@@ -777,12 +927,19 @@ TMemory::ReadAligned( VAddr inAddress, KUInt32& outWord )
 inline Boolean
 TMemory::ReadROMRAM( VAddr inAddress, KUInt32& outWord )
 {
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
+	// Fast path: aligned access to a page of ROM or RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if ((theEntry->fReadTag == GetHostTLBTag( inAddress ))
+		&& !(inAddress & 0x3))
+	{
+		outWord = *((KUInt32*) (theEntry->fHostOffset + inAddress));
+		return false;
+	}
+
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
+	{
+		CheckWatchpoints( inAddress, kWatchRead );
 	}
 
 	PAddr theAddress;
@@ -806,6 +963,12 @@ TMemory::ReadROMRAM( VAddr inAddress, KUInt32& outWord )
 		return true;
 	}
 	
+	// ROM accessed without translation can't be shared with ReadB.
+	if (!IsMMUEnabled() || !IsPageInROM(inAddress))
+	{
+		FillHostTLB( inAddress, theAddress, false );
+	}
+
 	return false;
 }
 
@@ -829,42 +992,8 @@ TMemory::ReadP( PAddr inAddress, Boolean& outFault )
 		} else {
 			return *((KUInt32*) ((KUIntPtr) mROMImagePtr + inAddress));
 		}
-	} else if (inAddress < TMemoryConsts::kRAMStart) {
-		if (inAddress < TMemoryConsts::kFlashBank1) {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word: Bus error at P0x%.8X",
-					(unsigned int) inAddress );
-				// mEmulator->BreakInMonitor();
-			}
-			outFault = true;
-			return false;
-		} else if (inAddress < TMemoryConsts::kFlashBank1End) {
-			KUInt32 theResult = mFlash.Read(
-									inAddress - TMemoryConsts::kFlashBank1,
-									0 );
-#if debugFlash
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read flash (bank#1) at P0x%.8X = %.8X",
-					(unsigned int) inAddress,
-					(unsigned int) theResult );
-			}
-#endif
-			return theResult;
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #1 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
-	} else if (inAddress < mRAMEnd) {
+	} else if ((inAddress >= TMemoryConsts::kRAMStart)
+		&& (inAddress < mRAMEnd)) {
 		// RAM.
 		if (inAddress & 0x3)
 		{
@@ -878,467 +1007,118 @@ TMemory::ReadP( PAddr inAddress, Boolean& outFault )
 		} else {
 			return *((KUInt32*) ((KUIntPtr) mRAMOffset + inAddress));
 		}
-	} else if (inAddress < TMemoryConsts::kHardwareBase) {
-		// Bank #2
-		if (mLog)
+	} else {
+		// Flash, hardware registers or nothing.
+		const SIOHandler& theHandler = GetIOHandler( inAddress );
+		return (*theHandler.fReadWord)(
+			theHandler.fObject, inAddress, outFault );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadPAligned( PAddr, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadPAligned( PAddr inAddress, Boolean& outFault )
+{
+	if (!(inAddress & TMemoryConsts::kROMEndMask))
+	{
+		return *((KUInt32*) ((KUIntPtr) mROMImagePtr + inAddress));
+	} else if ((inAddress >= TMemoryConsts::kRAMStart)
+		&& (inAddress < mRAMEnd)) {
+		// RAM.
+		return *((KUInt32*) ((KUIntPtr) mRAMOffset + inAddress));
+	} else {
+		// Flash, hardware registers or nothing.
+		const SIOHandler& theHandler = GetIOHandler( inAddress );
+		return (*theHandler.fReadWord)(
+			theHandler.fObject, inAddress, outFault );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadROMRAMP( PAddr, Boolean& )
+// -------------------------------------------------------------------------- //
+#if !TARGET_OS_MAC
+//inline
+#endif
+KUInt32
+TMemory::ReadROMRAMP( PAddr inAddress, Boolean& outFault )
+{
+	if (!(inAddress & TMemoryConsts::kROMEndMask))
+	{
+		if (inAddress & 0x3)
 		{
-			mLog->FLogLine(
-				"Read word access to unknown bank #2 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		return 0;
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		// Bank #3
-		if (inAddress == TMemoryConsts::kHdWr_04RAMSize) {
-			KUInt32 thePageCount = (mRAMSize >> 16) & 0xFF;
-			return
-				(thePageCount << 24)
-				| (thePageCount << 16)
-				| thePageCount;
-		} else if (inAddress == TMemoryConsts::kHdWr_08RAMSize) {
-			return 0;
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			return mDMAManager->ReadChannel1Register( channel, reg );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			return mDMAManager->ReadChannel2Register( channel, reg );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			return mDMAManager->ReadChannelAssignmentRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			return mDMAManager->ReadStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAWordStat) {
-			return mDMAManager->ReadWordStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_HighSpeedClck) {
-			return TMemoryConsts::kHighSpeedClockVal;
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			return mInterruptManager->GetRealTimeClock();
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			return mInterruptManager->GetAlarm();
-		} else if (inAddress == TMemoryConsts::kHdWr_Ticks) {
-			return mInterruptManager->GetTimer();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntPresent) {
-			return mInterruptManager->GetIntRaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			return mInterruptManager->GetIntCtrlReg();
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			return mInterruptManager->GetFIQMask();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			return mInterruptManager->GetIntEDReg1();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			return mInterruptManager->GetIntEDReg2();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			return mInterruptManager->GetIntEDReg3();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_RReg) {
-			return mInterruptManager->GetGPIORaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			return mInterruptManager->GetGPIOCtrlReg();
-		} else if (inAddress == TMemoryConsts::kHdWr_P0F18D400) {
-			return 0xffffffff; // PCMCIA Door Locked?
+			// UNALIGNED ACCESS
+			KUInt32 theValue =
+				*((KUInt32*)
+					((KUIntPtr) mROMImagePtr + (inAddress & 0xFFFFFFFC)));
+			KUInt32 rotAmount = (inAddress & 0x3) * 8;
+			return (theValue << rotAmount)
+				| (theValue >> (32 - rotAmount));
 		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #3 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
+			return *((KUInt32*) ((KUIntPtr) mROMImagePtr + inAddress));
 		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
+	} else if (inAddress < TMemoryConsts::kRAMStart) {
 		if (mLog)
 		{
 			mLog->FLogLine(
-				"Read word access to serial bank at P0x%.8X",
+				"ReadROMRAM between ROM & RAM at P0x%.8X",
 				(unsigned int) inAddress );
 		}
-		// mEmulator->BreakInMonitor();
+		mMMU.SetHardwareFault( inAddress );
+		outFault = true;
 		return 0;
-	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		// Bank #4
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt1) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt3) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			return mBankCtrlRegister;
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			KUInt32 bit;
-			if (mSerialNumberIx == 64)
-			{
-				bit = 0;
-			} else if (mSerialNumberIx >= 32) {
-				bit = mSerialNumber[0] >> (mSerialNumberIx - 32);
-			} else {
-				bit = mSerialNumber[1] >> mSerialNumberIx;
-			}
-			mSerialNumberIx = (mSerialNumberIx + 1) % 65;
-			bit = bit & 0x1;
-			return (bit << 1);
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #4 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
-	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
-		KUInt32 theResult = mFlash.Read(
-								inAddress - TMemoryConsts::kFlashBank2,
-								1 );
-#if debugFlash
-		if (mLog)
+	} else if (inAddress < mRAMEnd) {
+		// RAM.
+		if (inAddress & 0x3)
 		{
-			mLog->FLogLine(
-				"Read flash (bank#2) at P0x%.8X = %.8X",
-				(unsigned int) inAddress,
-				(unsigned int) theResult );
+			// UNALIGNED ACCESS
+			KUInt32 theValue =
+				*((KUInt32*)
+					((KUIntPtr) mRAMOffset + (inAddress & 0xFFFFFFFC)));
+			KUInt32 rotAmount = (inAddress & 0x3) * 8;
+			return (theValue << rotAmount)
+				| (theValue >> (32 - rotAmount));
+		} else {
+			return *((KUInt32*) ((KUIntPtr) mRAMOffset + inAddress));
 		}
-#endif
-		return theResult;
-	} else if (inAddress < TMemoryConsts::kPCMCIA0Base) {
+	} else {
 		if (mLog)
 		{
 			mLog->FLogLine(
-				"Read word access to unknown bank #5 at P0x%.8X",
+				"ReadROMRAM after mRAMEnd at P0x%.8X",
 				(unsigned int) inAddress );
 		}
-		return 0;
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		return mPCMCIACtrls[0]->Read( inAddress - TMemoryConsts::kPCMCIA0Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		return mPCMCIACtrls[1]->Read( inAddress - TMemoryConsts::kPCMCIA1Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		return mPCMCIACtrls[2]->Read( inAddress - TMemoryConsts::kPCMCIA2Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		return mPCMCIACtrls[3]->Read( inAddress - TMemoryConsts::kPCMCIA3Base );
-#else
-		return 0;
-#endif
-	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read word: Bus error at P0x%.8X",
-				(unsigned int) inAddress );
-			// mEmulator->BreakInMonitor();
-		}
-		outFault = true;
+		mMMU.SetHardwareFault( inAddress );
+		outFault = true;
 		return 0;
 	}
 }
 
 // -------------------------------------------------------------------------- //
-//  * ReadPAligned( PAddr, Boolean& )
+//  * ReadB( VAddr, KUInt8& )
 // -------------------------------------------------------------------------- //
-KUInt32
-TMemory::ReadPAligned( PAddr inAddress, Boolean& outFault )
+Boolean
+TMemory::ReadB( VAddr inAddress, KUInt8& outByte )
 {
-	if (!(inAddress & TMemoryConsts::kROMEndMask))
+	// Fast path: access to a page of ROM or RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if (theEntry->fReadTag == GetHostTLBTag( inAddress ))
 	{
-		return *((KUInt32*) ((KUIntPtr) mROMImagePtr + inAddress));
-	} else if (inAddress < TMemoryConsts::kRAMStart) {
-		if (inAddress < TMemoryConsts::kFlashBank1) {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word: Bus error at P0x%.8X",
-					(unsigned int) inAddress );
-				// mEmulator->BreakInMonitor();
-			}
-			outFault = true;
-			return false;
-		} else if (inAddress < TMemoryConsts::kFlashBank1End) {
-			KUInt32 theResult = mFlash.Read(
-									inAddress - TMemoryConsts::kFlashBank1,
-									0 );
-#if debugFlash
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read flash (bank#1) at P0x%.8X = %.8X",
-					(unsigned int) inAddress,
-					(unsigned int) theResult );
-			}
-#endif
-			return theResult;
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #1 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
-	} else if (inAddress < mRAMEnd) {
-		// RAM.
-		return *((KUInt32*) ((KUIntPtr) mRAMOffset + inAddress));
-	} else if (inAddress < TMemoryConsts::kHardwareBase) {
-		// Bank #2
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read word access to unknown bank #2 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		return 0;
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		// Bank #3
-		if (inAddress == TMemoryConsts::kHdWr_04RAMSize) {
-			KUInt32 thePageCount = (mRAMSize >> 16) & 0xFF;
-			return
-				(thePageCount << 24)
-				| (thePageCount << 16)
-				| thePageCount;
-		} else if (inAddress == TMemoryConsts::kHdWr_08RAMSize) {
-			return 0;
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			return mDMAManager->ReadChannel1Register( channel, reg );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			return mDMAManager->ReadChannel2Register( channel, reg );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			return mDMAManager->ReadChannelAssignmentRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			return mDMAManager->ReadStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAWordStat) {
-			return mDMAManager->ReadWordStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_HighSpeedClck) {
-			return TMemoryConsts::kHighSpeedClockVal;
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			return mInterruptManager->GetRealTimeClock();
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			return mInterruptManager->GetAlarm();
-		} else if (inAddress == TMemoryConsts::kHdWr_Ticks) {
-			return mInterruptManager->GetTimer();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntPresent) {
-			return mInterruptManager->GetIntRaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			return mInterruptManager->GetIntCtrlReg();
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			return mInterruptManager->GetFIQMask();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			return mInterruptManager->GetIntEDReg1();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			return mInterruptManager->GetIntEDReg2();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			return mInterruptManager->GetIntEDReg3();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_RReg) {
-			return mInterruptManager->GetGPIORaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			return mInterruptManager->GetGPIOCtrlReg();
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #3 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read word access to serial bank at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		return 0;
-	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		// Bank #4
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt1) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt3) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			return mBankCtrlRegister;
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			KUInt32 bit;
-			if (mSerialNumberIx == 64)
-			{
-				bit = 0;
-			} else if (mSerialNumberIx >= 32) {
-				bit = mSerialNumber[0] >> (mSerialNumberIx - 32);
-			} else {
-				bit = mSerialNumber[1] >> mSerialNumberIx;
-			}
-			mSerialNumberIx = (mSerialNumberIx + 1) % 65;
-			bit = bit & 0x1;
-			return (bit << 1);
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #4 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
-	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
-		KUInt32 theResult = mFlash.Read(
-								inAddress - TMemoryConsts::kFlashBank2,
-								1 );
-#if debugFlash
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read flash (bank#2) at P0x%.8X = %.8X",
-				(unsigned int) inAddress,
-				(unsigned int) theResult );
-		}
-#endif
-		return theResult;
-	} else if (inAddress < TMemoryConsts::kPCMCIA0Base) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read word access to unknown bank #5 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		return 0;
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		return mPCMCIACtrls[0]->Read( inAddress - TMemoryConsts::kPCMCIA0Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		return mPCMCIACtrls[1]->Read( inAddress - TMemoryConsts::kPCMCIA1Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		return mPCMCIACtrls[2]->Read( inAddress - TMemoryConsts::kPCMCIA2Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		return mPCMCIACtrls[3]->Read( inAddress - TMemoryConsts::kPCMCIA3Base );
+#if TARGET_RT_LITTLE_ENDIAN
+		// Swap the endianness of the address.
+		outByte = *((KUInt8*) (theEntry->fHostOffset + (inAddress ^ 0x3)));
 #else
-		return 0;
+		outByte = *((KUInt8*) (theEntry->fHostOffset + inAddress));
 #endif
-	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read word: Bus error at P0x%.8X",
-				(unsigned int) inAddress );
-			// mEmulator->BreakInMonitor();
-		}
-		outFault = true;
-		return 0;
+		return false;
 	}
-}
 
-// -------------------------------------------------------------------------- //
-//  * ReadROMRAMP( PAddr, Boolean& )
-// -------------------------------------------------------------------------- //
-#if !TARGET_OS_MAC
-//inline
-#endif
-KUInt32
-TMemory::ReadROMRAMP( PAddr inAddress, Boolean& outFault )
-{
-	if (!(inAddress & TMemoryConsts::kROMEndMask))
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
 	{
-		if (inAddress & 0x3)
-		{
-			// UNALIGNED ACCESS
-			KUInt32 theValue =
-				*((KUInt32*)
-					((KUIntPtr) mROMImagePtr + (inAddress & 0xFFFFFFFC)));
-			KUInt32 rotAmount = (inAddress & 0x3) * 8;
-			return (theValue << rotAmount)
-				| (theValue >> (32 - rotAmount));
-		} else {
-			return *((KUInt32*) ((KUIntPtr) mROMImagePtr + inAddress));
-		}
-	} else if (inAddress < TMemoryConsts::kRAMStart) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"ReadROMRAM between ROM & RAM at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		mMMU.SetHardwareFault( inAddress );
-		outFault = true;
-		return 0;
-	} else if (inAddress < mRAMEnd) {
-		// RAM.
-		if (inAddress & 0x3)
-		{
-			// UNALIGNED ACCESS
-			KUInt32 theValue =
-				*((KUInt32*)
-					((KUIntPtr) mRAMOffset + (inAddress & 0xFFFFFFFC)));
-			KUInt32 rotAmount = (inAddress & 0x3) * 8;
-			return (theValue << rotAmount)
-				| (theValue >> (32 - rotAmount));
-		} else {
-			return *((KUInt32*) ((KUIntPtr) mRAMOffset + inAddress));
-		}
-	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"ReadROMRAM after mRAMEnd at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		mMMU.SetHardwareFault( inAddress );
-		outFault = true;
-		return 0;
-	}
-}
-
-// -------------------------------------------------------------------------- //
-//  * ReadB( VAddr, KUInt8& )
-// -------------------------------------------------------------------------- //
-Boolean
-TMemory::ReadB( VAddr inAddress, KUInt8& outByte )
-{
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
+		CheckWatchpoints( inAddress, kWatchRead );
 	}
 
 	PAddr theAddress;
@@ -1359,6 +1139,8 @@ TMemory::ReadB( VAddr inAddress, KUInt8& outByte )
 		return true;
 	}
 	
+	FillHostTLB( inAddress, theAddress, false );
+
 	return false;
 }
 
@@ -1380,136 +1162,20 @@ TMemory::ReadBP( PAddr inAddress, KUInt8& outByte )
 #else
 		outByte = *((KUInt8*) ((KUIntPtr) mROMImagePtr + inAddress));
 #endif
-	} else if (inAddress < TMemoryConsts::kFlashBank1) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte: Bus error at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		return true;
-	} else if (inAddress < TMemoryConsts::kFlashBank1End) {
-		outByte = mFlash.ReadB( inAddress - TMemoryConsts::kFlashBank1, 0 );
-#if debugFlash
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read flash (bank#1) at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) outByte );
-		}
-#endif
-	} else if (inAddress < TMemoryConsts::kRAMStart) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte access to unknown bank #1 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		outByte = 0;
-	} else if (inAddress < mRAMEnd) {
+	} else if ((inAddress >= TMemoryConsts::kRAMStart)
+		&& (inAddress < mRAMEnd)) {
 		// RAM.
 #if TARGET_RT_LITTLE_ENDIAN
 		// Swap the endianness of the address.
 		outByte = *((KUInt8*) (mRAMOffset + (inAddress ^ 0x3)));
 #else
 		outByte = *((KUInt8*) (mRAMOffset + inAddress));
-#endif
-	} else if (inAddress < TMemoryConsts::kHardwareBase) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte access to unknown bank #2 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		outByte = 0;
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte access to unknown bank #3 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		outByte = 0;
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		if (inAddress < TMemoryConsts::kInfraredSerialBase)
-		{
-			outByte = mExternalPort->ReadRegister(
-				inAddress - TMemoryConsts::kExternalSerialBase );
-		} else if (inAddress < TMemoryConsts::kBuiltInSerialBase) {
-			outByte = mInfraredPort->ReadRegister(
-				inAddress - TMemoryConsts::kInfraredSerialBase );
-		} else if (inAddress < TMemoryConsts::kModemSerialBase) {
-			outByte = mBuiltInExtraPort->ReadRegister(
-				inAddress - TMemoryConsts::kBuiltInSerialBase );
-		} else {
-			outByte = mModemPort->ReadRegister(
-				inAddress - TMemoryConsts::kModemSerialBase );
-		}
-	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte access to unknown bank #4 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		outByte = 0;
-	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
-		outByte = mFlash.ReadB( inAddress - TMemoryConsts::kFlashBank2, 1 );
-#if debugFlash
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read flash (bank#2) at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) outByte );
-		}
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA0Base) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte access to unknown bank #5 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		outByte = 0;
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		outByte = mPCMCIACtrls[0]->ReadB( inAddress - TMemoryConsts::kPCMCIA0Base );
-#else
-		outByte = 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		outByte = mPCMCIACtrls[1]->ReadB( inAddress - TMemoryConsts::kPCMCIA1Base );
-#else
-		outByte = 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		outByte = mPCMCIACtrls[2]->ReadB( inAddress - TMemoryConsts::kPCMCIA2Base );
-#else
-		outByte = 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		outByte = mPCMCIACtrls[3]->ReadB( inAddress - TMemoryConsts::kPCMCIA3Base );
-#else
-		outByte = 0;
 #endif
 	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte: Bus error at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		return true;
+		// Flash, hardware registers or nothing.
+		const SIOHandler& theHandler = GetIOHandler( inAddress );
+		return (*theHandler.fReadByte)(
+			theHandler.fObject, inAddress, outByte );
 	}
 		
 //	if (inAddress == 0x0F1C4400)
@@ -1526,12 +1192,20 @@ TMemory::ReadBP( PAddr inAddress, KUInt8& outByte )
 Boolean
 TMemory::Write( VAddr inAddress, KUInt32 inWord )
 {
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08X written around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
+	// Fast path: aligned access to a page of RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if ((theEntry->fWriteTag == GetHostTLBTag( inAddress ))
+		&& !(inAddress & 0x3))
+	{
+		*((KUInt32*) (theEntry->fHostOffset + inAddress)) = inWord;
+		mJIT.Invalidate( inAddress + theEntry->fPhysicalOffset );
+		return false;
+	}
+
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
+	{
+		CheckWatchpoints( inAddress, kWatchWrite );
 	}
 
 	PAddr theAddress;
@@ -1552,6 +1226,8 @@ TMemory::Write( VAddr inAddress, KUInt32 inWord )
 		return true;
 	}
 	
+	FillHostTLB( inAddress, theAddress, true );
+
 	return false;
 }
 
@@ -1561,14 +1237,21 @@ TMemory::Write( VAddr inAddress, KUInt32 inWord )
 Boolean
 TMemory::WriteAligned( VAddr inAddress, KUInt32 inWord )
 {
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08X written around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
+	// Fast path: access to a page of RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if (theEntry->fWriteTag == GetHostTLBTag( inAddress ))
+	{
+		*((KUInt32*) (theEntry->fHostOffset + (inAddress &~ 0x03))) = inWord;
+		mJIT.Invalidate( inAddress + theEntry->fPhysicalOffset );
+		return false;
 	}
-	
+
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
+	{
+		CheckWatchpoints( inAddress, kWatchWrite );
+	}
+
 	PAddr theAddress;
 
 	if (IsMMUEnabled())
@@ -1587,6 +1270,8 @@ TMemory::WriteAligned( VAddr inAddress, KUInt32 inWord )
 		return true;
 	}
 	
+	FillHostTLB( inAddress, theAddress, true );
+
 	return false;
 }
 
@@ -1596,14 +1281,22 @@ TMemory::WriteAligned( VAddr inAddress, KUInt32 inWord )
 inline Boolean
 TMemory::WriteRAM( VAddr inAddress, KUInt32 inWord )
 {
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08lX written around 0x%08lX\n", (unsigned long)inAddress, (unsigned long)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
+	// Fast path: aligned access to a page of RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if ((theEntry->fWriteTag == GetHostTLBTag( inAddress ))
+		&& !(inAddress & 0x3))
+	{
+		*((KUInt32*) (theEntry->fHostOffset + inAddress)) = inWord;
+		mJIT.Invalidate( inAddress + theEntry->fPhysicalOffset );
+		return false;
 	}
-	
+
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
+	{
+		CheckWatchpoints( inAddress, kWatchWrite );
+	}
+
 	PAddr theAddress;
 
 	if (IsMMUEnabled())
@@ -1622,6 +1315,8 @@ TMemory::WriteRAM( VAddr inAddress, KUInt32 inWord )
 		return true;
 	}
 	
+	FillHostTLB( inAddress, theAddress, true );
+
 	return false;
 }
 
@@ -1631,48 +1326,9 @@ TMemory::WriteRAM( VAddr inAddress, KUInt32 inWord )
 Boolean
 TMemory::WriteP( PAddr inAddress, KUInt32 inWord )
 {
-	if (inAddress < TMemoryConsts::kRAMStart)
+	if ((inAddress >= TMemoryConsts::kRAMStart)
+		&& (inAddress < mRAMEnd))
 	{
-		if (inAddress < TMemoryConsts::kHighROMEnd)
-		{
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Ignored write word access to ROM at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-				//mEmulator->BreakInMonitor();
-			}
-		} else if (inAddress < TMemoryConsts::kFlashBank1) {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word: Bus error at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			return true;
-		} else if (inAddress < TMemoryConsts::kFlashBank1End) {
-#if debugFlash
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word to flash (bank#1) (ignored) at P0x%.8X = %.8X",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-#endif
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #1 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
-	} else if (inAddress < mRAMEnd) {
 //        if (inAddress == 0x04098490)
 //        {
 //                mEmulator->BreakInMonitor();
@@ -1691,608 +1347,696 @@ TMemory::WriteP( PAddr inAddress, KUInt32 inWord )
 		
 		// Invalidate JIT.
 		mJIT.Invalidate( inAddress );
-	} else if (inAddress < TMemoryConsts::kHardwareBase) {
+	} else {
+		// ROM, flash, hardware registers or nothing.
+		const SIOHandler& theHandler = GetIOHandler( inAddress );
+		return (*theHandler.fWriteWord)(
+			theHandler.fObject, inAddress, inWord );
+	}
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WritePAligned( PAddr, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WritePAligned( PAddr inAddress, KUInt32 inWord )
+{
+	if ((inAddress >= TMemoryConsts::kRAMStart)
+		&& (inAddress < mRAMEnd))
+	{
+//        if (inAddress == 0x04098490)
+//        {
+//                mEmulator->BreakInMonitor();
+//        }
+		// RAM.
+		*((KUInt32*) (mRAMOffset + inAddress)) = inWord;
+		
+		// Invalidate JIT.
+		mJIT.Invalidate( inAddress );
+	} else {
+		// ROM, flash, hardware registers or nothing.
+		const SIOHandler& theHandler = GetIOHandler( inAddress );
+		return (*theHandler.fWriteWord)(
+			theHandler.fObject, inAddress, inWord );
+	}
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteRAMP( PAddr, KUInt32 )
+// -------------------------------------------------------------------------- //
+inline Boolean
+TMemory::WriteRAMP( PAddr inAddress, KUInt32 inWord )
+{
+	if (inAddress < TMemoryConsts::kRAMStart)
+	{
 		if (mLog)
 		{
 			mLog->FLogLine(
-				"Write word access to unknown bank #2 at P0x%.8X (%.8X)",
+				"WriteRAM before TMemoryConsts::kRAMStart at P0x%.8X (%.8X)",
 				(unsigned int) inAddress,
 				(unsigned int) inWord );
 		}
-//		if (inWord == 0x00000411)
-//			mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			mDMAManager->WriteChannel1Register( channel, reg, inWord );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			mDMAManager->WriteChannel2Register( channel, reg, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			mDMAManager->WriteChannelAssignmentRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			mDMAManager->WriteEnableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMADisable) {
-			mDMAManager->WriteDisableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			mInterruptManager->SetRealTimeClock(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			mInterruptManager->SetAlarm(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg0) {
-			mInterruptManager->SetTimerMatchRegister( 0, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg1) {
-			mInterruptManager->SetTimerMatchRegister( 1, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg2) {
-			mInterruptManager->SetTimerMatchRegister( 2, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg3) {
-			mInterruptManager->SetTimerMatchRegister( 3, inWord );
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Set scheduler timer to %.8X (now = %.8X)",
-//					(unsigned int) inWord,
-//					(unsigned int) mInterruptManager->GetTimer() );
-//			}
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			mInterruptManager->SetIntCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntClear) {
-			mInterruptManager->ClearInterrupts( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			mInterruptManager->SetFIQMask( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			mInterruptManager->SetIntEDReg1( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			mInterruptManager->SetIntEDReg2( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			mInterruptManager->SetIntEDReg3( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			mInterruptManager->SetGPIOCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_CReg) {
-			mInterruptManager->ClearGPIO( inWord );
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #3 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
-		if (mLog)
+		return true;
+	} else if (inAddress < mRAMEnd) {
+		// RAM.
+		if (inAddress & 0x3)
 		{
-			mLog->FLogLine(
-				"Write word access to serial bank at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord);
-		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt2) {
-			// Ignore it.
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			mBankCtrlRegister = inWord;
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Changed bank control register to %.8X",
-//					(unsigned int) inWord );
-//				mEmulator->BreakInMonitor();
-//			}
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			// Ignore it.
+			// UNALIGNED ACCESS
+			KUInt32 rotAmount = (inAddress & 0x3) * 8;
+			KUInt32 theValue = (inWord >> rotAmount)
+				| (inWord << (32 - rotAmount));
+			*((KUInt32*) (mRAMOffset + inAddress)) = theValue;
 		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #4 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
+			*((KUInt32*) (mRAMOffset + inAddress)) = inWord;
 		}
-	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
-#if debugFlash
+		
+		// Invalidate JIT.
+		mJIT.Invalidate( inAddress );
+		return false;
+	} else {
 		if (mLog)
 		{
 			mLog->FLogLine(
-				"Write word to flash (bank#2) (ignored) at P0x%.8X = %.8X",
+				"WriteRAM after mRAMEnd at P0x%.8X (%.8X)",
 				(unsigned int) inAddress,
 				(unsigned int) inWord );
 		}
+		return true;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteB( VAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteB( VAddr inAddress, KUInt8 inByte )
+{
+	// Fast path: access to a page of RAM we know.
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inAddress );
+	if (theEntry->fWriteTag == GetHostTLBTag( inAddress ))
+	{
+#if TARGET_RT_LITTLE_ENDIAN
+		// Swap the endianness of the address.
+		*((KUInt8*) (theEntry->fHostOffset + (inAddress ^ 0x3))) = inByte;
+#else
+		*((KUInt8*) (theEntry->fHostOffset + inAddress)) = inByte;
 #endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA0Base) {
-		if (mLog)
+		mJIT.Invalidate( inAddress + theEntry->fPhysicalOffset );
+		return false;
+	}
+
+	// Watched pages are never in the host TLB.
+	if (IsWatchedPage( inAddress ))
+	{
+		CheckWatchpoints( inAddress, kWatchWrite );
+	}
+
+	PAddr theAddress;
+	if (IsMMUEnabled())
+	{
+		if (TranslateW( inAddress, theAddress ))
 		{
-			mLog->FLogLine(
-				"Write word access to unknown bank #5 at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
+			return true;
 		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		mPCMCIACtrls[0]->Write( inAddress - TMemoryConsts::kPCMCIA0Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		mPCMCIACtrls[1]->Write( inAddress - TMemoryConsts::kPCMCIA1Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		mPCMCIACtrls[2]->Write( inAddress - TMemoryConsts::kPCMCIA2Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		mPCMCIACtrls[3]->Write( inAddress - TMemoryConsts::kPCMCIA3Base, inWord );
-#endif
 	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write word: Bus error at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
-		}
+		theAddress = inAddress;
+	}
+	
+	if (WriteBP( theAddress, inByte ))
+	{
+		mMMU.SetHardwareFault( inAddress );
 		return true;
 	}
 	
+	FillHostTLB( inAddress, theAddress, true );
+
+//	if (inAddress == 0x0C105548)
+//	{
+//		mEmulator->BreakInMonitor();
+//	}
+
 	return false;
 }
 
 // -------------------------------------------------------------------------- //
-//  * WritePAligned( PAddr, KUInt32 )
+//  * WriteBP( PAddr, KUInt8 )
 // -------------------------------------------------------------------------- //
 Boolean
-TMemory::WritePAligned( PAddr inAddress, KUInt32 inWord )
+TMemory::WriteBP( PAddr inAddress, KUInt8 inByte )
 {
-	if (inAddress < TMemoryConsts::kRAMStart)
+	if ((inAddress >= TMemoryConsts::kRAMStart)
+		&& (inAddress < mRAMEnd))
 	{
-		if (inAddress < TMemoryConsts::kHighROMEnd)
-		{
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Ignored write word access to ROM at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-				//mEmulator->BreakInMonitor();
-			}
-		} else if (inAddress < TMemoryConsts::kFlashBank1) {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word: Bus error at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			return true;
-		} else if (inAddress < TMemoryConsts::kFlashBank1End) {
-#if debugFlash
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word to flash (bank#1) (ignored) at P0x%.8X = %.8X",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-#endif
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #1 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
-	} else if (inAddress < mRAMEnd) {
 //        if (inAddress == 0x04098490)
 //        {
 //                mEmulator->BreakInMonitor();
 //        }
+
 		// RAM.
-		*((KUInt32*) (mRAMOffset + inAddress)) = inWord;
-		
+#if TARGET_RT_LITTLE_ENDIAN
+		// Swap the endianness of the address.
+		*((KUInt8*) (mRAMOffset + (inAddress ^ 0x3))) = inByte;
+#else
+		*((KUInt8*) (mRAMOffset + inAddress)) = inByte;
+#endif		
+
 		// Invalidate JIT.
 		mJIT.Invalidate( inAddress );
-	} else if (inAddress < TMemoryConsts::kHardwareBase) {
-		if (mLog)
+	} else {
+		// ROM, flash, hardware registers or nothing.
+		const SIOHandler& theHandler = GetIOHandler( inAddress );
+		return (*theHandler.fWriteByte)(
+			theHandler.fObject, inAddress, inByte );
+	}
+	
+//	if ((inAddress == 0x0F240000) || (inAddress == 0x0F240800))
+//	{
+//		mEmulator->BreakInMonitor();
+//	}
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * RegisterIOHandler( PAddr, PAddr, const SIOHandler& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::RegisterIOHandler(
+				PAddr inStart,
+				PAddr inEnd,
+				const SIOHandler& inHandler )
+{
+	if ((inStart & (kIOPageSize - 1))
+		|| (inEnd & (kIOPageSize - 1))
+		|| (inEnd <= inStart))
+	{
+		return true;
+	}
+	
+	// Share the entry of identical handlers.
+	KUInt32 theIndex;
+	for (theIndex = 0; theIndex < mIOHandlerCount; theIndex++)
+	{
+		const SIOHandler& theHandler = mIOHandlers[theIndex];
+		if ((theHandler.fObject == inHandler.fObject)
+			&& (theHandler.fReadWord == inHandler.fReadWord)
+			&& (theHandler.fWriteWord == inHandler.fWriteWord)
+			&& (theHandler.fReadByte == inHandler.fReadByte)
+			&& (theHandler.fWriteByte == inHandler.fWriteByte))
 		{
-			mLog->FLogLine(
-				"Write word access to unknown bank #2 at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
-		}
-//		if (inWord == 0x00000411)
-//			mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			mDMAManager->WriteChannel1Register( channel, reg, inWord );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			mDMAManager->WriteChannel2Register( channel, reg, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			mDMAManager->WriteChannelAssignmentRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			mDMAManager->WriteEnableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMADisable) {
-			mDMAManager->WriteDisableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			mInterruptManager->SetRealTimeClock(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			mInterruptManager->SetAlarm(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg0) {
-			mInterruptManager->SetTimerMatchRegister( 0, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg1) {
-			mInterruptManager->SetTimerMatchRegister( 1, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg2) {
-			mInterruptManager->SetTimerMatchRegister( 2, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg3) {
-			mInterruptManager->SetTimerMatchRegister( 3, inWord );
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Set scheduler timer to %.8X (now = %.8X)",
-//					(unsigned int) inWord,
-//					(unsigned int) mInterruptManager->GetTimer() );
-//			}
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			mInterruptManager->SetIntCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntClear) {
-			mInterruptManager->ClearInterrupts( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			mInterruptManager->SetFIQMask( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			mInterruptManager->SetIntEDReg1( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			mInterruptManager->SetIntEDReg2( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			mInterruptManager->SetIntEDReg3( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			mInterruptManager->SetGPIOCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_CReg) {
-			mInterruptManager->ClearGPIO( inWord );
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #3 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
+			break;
 		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
-		if (mLog)
+	}
+	
+	if (theIndex == mIOHandlerCount)
+	{
+		if (mIOHandlerCount == kMaxIOHandlers)
 		{
-			mLog->FLogLine(
-				"Write word access to serial bank at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord);
+			return true;
 		}
-		// mEmulator->BreakInMonitor();
+		mIOHandlers[mIOHandlerCount++] = inHandler;
+	}
+	
+	PAddr thePage;
+	for (thePage = inStart; thePage < inEnd; thePage += kIOPageSize)
+	{
+		mIOPages[(thePage >> kIOPageShift) & (kIOPageCount - 1)] =
+			(KUInt8) theIndex;
+	}
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * UnregisterIOHandler( PAddr, PAddr )
+// -------------------------------------------------------------------------- //
+void
+TMemory::UnregisterIOHandler( PAddr inStart, PAddr inEnd )
+{
+	SIOHandler theUnknown =
+		{ this, ReadUnknown, WriteUnknown, ReadBUnknown, WriteBUnknown };
+	(void) RegisterIOHandler( inStart, inEnd, theUnknown );
+}
+
+// -------------------------------------------------------------------------- //
+//  * InitIOHandlers( void )
+// -------------------------------------------------------------------------- //
+void
+TMemory::InitIOHandlers( void )
+{
+	// Pages nobody registered are bus errors.
+	SIOHandler theBusError =
+		{ this, ReadBusError, WriteBusError, ReadBBusError, WriteBBusError };
+	mIOHandlers[0] = theBusError;
+	mIOHandlerCount = 1;
+	(void) ::memset( mIOPages, 0, sizeof(mIOPages) );
+
+	SIOHandler theROM =
+		{ this, ReadROM, WriteROM, ReadBROM, WriteBROM };
+	SIOHandler theFlash =
+		{ this, ReadFlash, WriteFlash, ReadBFlash, WriteBFlash };
+	SIOHandler theUnknown =
+		{ this, ReadUnknown, WriteUnknown, ReadBUnknown, WriteBUnknown };
+	SIOHandler theSystem =
+		{ this, ReadSystemRegister, WriteUnknown, ReadBUnknown, WriteBUnknown };
+	SIOHandler theBank4 =
+		{ this, ReadBank4Register, WriteBank4Register,
+			ReadBUnknown, WriteBUnknown };
+
+	// Bank #1 (RAM is not dispatched).
+	(void) RegisterIOHandler(
+		0, TMemoryConsts::kHighROMEnd, theROM );
+	(void) RegisterIOHandler(
+		TMemoryConsts::kFlashBank1, TMemoryConsts::kFlashBank1End, theFlash );
+	(void) RegisterIOHandler(
+		TMemoryConsts::kFlashBank1End, TMemoryConsts::kRAMStart, theUnknown );
+	// Bank #2
+	(void) RegisterIOHandler(
+		TMemoryConsts::kRAMStart, TMemoryConsts::kHardwareBase, theUnknown );
+	// Bank #3 (DMA and interrupt registers are registered by their managers)
+	(void) RegisterIOHandler(
+		TMemoryConsts::kHardwareBase,
+		TMemoryConsts::kExternalSerialBase,
+		theSystem );
+	// Serial bank (registered by the ports)
+	(void) RegisterIOHandler(
+		TMemoryConsts::kExternalSerialBase,
+		TMemoryConsts::kSerialEnd,
+		theUnknown );
+	// Bank #4
+	(void) RegisterIOHandler(
+		TMemoryConsts::kSerialEnd, TMemoryConsts::kFlashBank2, theBank4 );
+	(void) RegisterIOHandler(
+		TMemoryConsts::kFlashBank2, TMemoryConsts::kFlashBank2End, theFlash );
+	// Bank #5 (sockets are registered by the PCMCIA controllers)
+	(void) RegisterIOHandler(
+		TMemoryConsts::kFlashBank2End, TMemoryConsts::kPCMCIA3End, theUnknown );
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetBankNumber( KUInt32 )
+// -------------------------------------------------------------------------- //
+static int
+GetBankNumber( KUInt32 inAddress )
+{
+	if (inAddress < TMemoryConsts::kRAMStart)
+	{
+		return 1;
+	} else if (inAddress < TMemoryConsts::kHardwareBase) {
+		return 2;
+	} else if (inAddress < TMemoryConsts::kSerialEnd) {
+		return 3;
 	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt2) {
-			// Ignore it.
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			mBankCtrlRegister = inWord;
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Changed bank control register to %.8X",
-//					(unsigned int) inWord );
-//				mEmulator->BreakInMonitor();
-//			}
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			// Ignore it.
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #4 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
-	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
-#if debugFlash
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write word to flash (bank#2) (ignored) at P0x%.8X = %.8X",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
-		}
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA0Base) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write word access to unknown bank #5 at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
-		}
+		return 4;
+	} else {
+		return 5;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadBusError( void*, PAddr, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadBusError( void* inObject, PAddr inAddress, Boolean& outFault )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Read word: Bus error at P0x%.8X",
+			(unsigned int) inAddress );
 		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		mPCMCIACtrls[0]->Write( inAddress - TMemoryConsts::kPCMCIA0Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		mPCMCIACtrls[1]->Write( inAddress - TMemoryConsts::kPCMCIA1Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		mPCMCIACtrls[2]->Write( inAddress - TMemoryConsts::kPCMCIA2Base, inWord );
+	}
+	outFault = true;
+	return 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteBusError( void*, PAddr, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteBusError( void* inObject, PAddr inAddress, KUInt32 inWord )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Write word: Bus error at P0x%.8X (%.8X)",
+			(unsigned int) inAddress,
+			(unsigned int) inWord );
+	}
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadBBusError( void*, PAddr, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::ReadBBusError( void* inObject, PAddr inAddress, KUInt8& /* outByte */ )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Read byte: Bus error at P0x%.8X",
+			(unsigned int) inAddress );
+	}
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteBBusError( void*, PAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteBBusError( void* inObject, PAddr inAddress, KUInt8 inByte )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Write byte: Bus error at P0x%.8X (%.2X)",
+			(unsigned int) inAddress,
+			(unsigned int) inByte );
+	}
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadROM( void*, PAddr, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadROM( void* inObject, PAddr inAddress, Boolean& outFault )
+{
+	// ReadP reads ROM without calling the handler.
+	return ((TMemory*) inObject)->ReadP( inAddress, outFault );
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteROM( void*, PAddr, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteROM( void* inObject, PAddr inAddress, KUInt32 inWord )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Ignored write word access to ROM at P0x%.8X (%.8X)",
+			(unsigned int) inAddress,
+			(unsigned int) inWord );
+		//mEmulator->BreakInMonitor();
+	}
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadBROM( void*, PAddr, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::ReadBROM( void* inObject, PAddr inAddress, KUInt8& outByte )
+{
+	// ReadBP reads ROM without calling the handler.
+	return ((TMemory*) inObject)->ReadBP( inAddress, outByte );
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteBROM( void*, PAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteBROM( void* inObject, PAddr inAddress, KUInt8 inByte )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Ignored write byte access to ROM at P0x%.8X (%.2X)",
+			(unsigned int) inAddress,
+			(unsigned int) inByte );
+	}
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadFlash( void*, PAddr, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadFlash( void* inObject, PAddr inAddress, Boolean& /* outFault */ )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	KUInt32 theBank = (inAddress < TMemoryConsts::kFlashBank2) ? 0 : 1;
+	KUInt32 theResult = theMemory->mFlash.Read(
+							inAddress - (theBank
+								? TMemoryConsts::kFlashBank2
+								: TMemoryConsts::kFlashBank1),
+							theBank );
+#if debugFlash
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Read flash (bank#%d) at P0x%.8X = %.8X",
+			(int) theBank + 1,
+			(unsigned int) inAddress,
+			(unsigned int) theResult );
+	}
 #endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		mPCMCIACtrls[3]->Write( inAddress - TMemoryConsts::kPCMCIA3Base, inWord );
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteFlash( void*, PAddr, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteFlash(
+			void* inObject,
+			PAddr inAddress,
+			KUInt32 inWord )
+{
+#if debugFlash
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Write word to flash (bank#%d) (ignored) at P0x%.8X = %.8X",
+			(inAddress < TMemoryConsts::kFlashBank2) ? 1 : 2,
+			(unsigned int) inAddress,
+			(unsigned int) inWord );
+	}
+#else
+	(void) inObject;
+	(void) inAddress;
+	(void) inWord;
 #endif
-	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write word: Bus error at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
-		}
-		return true;
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadBFlash( void*, PAddr, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::ReadBFlash( void* inObject, PAddr inAddress, KUInt8& outByte )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	KUInt32 theBank = (inAddress < TMemoryConsts::kFlashBank2) ? 0 : 1;
+	outByte = theMemory->mFlash.ReadB(
+							inAddress - (theBank
+								? TMemoryConsts::kFlashBank2
+								: TMemoryConsts::kFlashBank1),
+							theBank );
+#if debugFlash
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Read flash (bank#%d) at P0x%.8X = %.2X",
+			(int) theBank + 1,
+			(unsigned int) inAddress,
+			(unsigned int) outByte );
+	}
+#endif
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteBFlash( void*, PAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteBFlash(
+			void* inObject,
+			PAddr inAddress,
+			KUInt8 inByte )
+{
+#if debugFlash
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
+	{
+		theMemory->mLog->FLogLine(
+			"Write byte to flash (bank#%d) (ignored) at P0x%.8X = %.2X",
+			(inAddress < TMemoryConsts::kFlashBank2) ? 1 : 2,
+			(unsigned int) inAddress,
+			(unsigned int) inByte );
 	}
-	
+#else
+	(void) inObject;
+	(void) inAddress;
+	(void) inByte;
+#endif
 	return false;
 }
 
 // -------------------------------------------------------------------------- //
-//  * WriteRAMP( PAddr, KUInt32 )
+//  * ReadUnknown( void*, PAddr, Boolean& )
 // -------------------------------------------------------------------------- //
-inline Boolean
-TMemory::WriteRAMP( PAddr inAddress, KUInt32 inWord )
+KUInt32
+TMemory::ReadUnknown( void* inObject, PAddr inAddress, Boolean& /* outFault */ )
 {
-	if (inAddress < TMemoryConsts::kRAMStart)
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
 	{
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"WriteRAM before TMemoryConsts::kRAMStart at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
-		}
-		return true;
-	} else if (inAddress < mRAMEnd) {
-		// RAM.
-		if (inAddress & 0x3)
-		{
-			// UNALIGNED ACCESS
-			KUInt32 rotAmount = (inAddress & 0x3) * 8;
-			KUInt32 theValue = (inWord >> rotAmount)
-				| (inWord << (32 - rotAmount));
-			*((KUInt32*) (mRAMOffset + inAddress)) = theValue;
-		} else {
-			*((KUInt32*) (mRAMOffset + inAddress)) = inWord;
-		}
-		
-		// Invalidate JIT.
-		mJIT.Invalidate( inAddress );
-		return false;
-	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"WriteRAM after mRAMEnd at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord );
-		}
-		return true;
+		theMemory->mLog->FLogLine(
+			"Read word access to unknown bank #%d at P0x%.8X",
+			GetBankNumber( inAddress ),
+			(unsigned int) inAddress );
 	}
+	// mEmulator->BreakInMonitor();
+	return 0;
 }
 
 // -------------------------------------------------------------------------- //
-//  * WriteB( VAddr, KUInt8 )
+//  * WriteUnknown( void*, PAddr, KUInt32 )
 // -------------------------------------------------------------------------- //
 Boolean
-TMemory::WriteB( VAddr inAddress, KUInt8 inByte )
+TMemory::WriteUnknown( void* inObject, PAddr inAddress, KUInt32 inWord )
 {
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08X written around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
-	
-	PAddr theAddress;
-	if (IsMMUEnabled())
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
 	{
-		if (TranslateW( inAddress, theAddress ))
-		{
-			return true;
-		}
-	} else {
-		theAddress = inAddress;
+		theMemory->mLog->FLogLine(
+			"Write word access to unknown bank #%d at P0x%.8X (%.8X)",
+			GetBankNumber( inAddress ),
+			(unsigned int) inAddress,
+			(unsigned int) inWord );
 	}
-	
-	if (WriteBP( theAddress, inByte ))
+	// mEmulator->BreakInMonitor();
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadBUnknown( void*, PAddr, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::ReadBUnknown( void* inObject, PAddr inAddress, KUInt8& outByte )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
 	{
-		mMMU.SetHardwareFault( inAddress );
-		return true;
+		theMemory->mLog->FLogLine(
+			"Read byte access to unknown bank #%d at P0x%.8X",
+			GetBankNumber( inAddress ),
+			(unsigned int) inAddress );
 	}
-	
-//	if (inAddress == 0x0C105548)
-//	{
-//		mEmulator->BreakInMonitor();
-//	}
-
+	// mEmulator->BreakInMonitor();
+	outByte = 0;
 	return false;
 }
 
 // -------------------------------------------------------------------------- //
-//  * WriteBP( PAddr, KUInt8 )
+//  * WriteBUnknown( void*, PAddr, KUInt8 )
 // -------------------------------------------------------------------------- //
 Boolean
-TMemory::WriteBP( PAddr inAddress, KUInt8 inByte )
+TMemory::WriteBUnknown( void* inObject, PAddr inAddress, KUInt8 inByte )
 {
-	if (inAddress < TMemoryConsts::kHighROMEnd)
+	TMemory* theMemory = (TMemory*) inObject;
+	if (theMemory->mLog)
 	{
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Ignored write byte access to ROM at P0x%.8X (%.2X)",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-	} else if (inAddress < TMemoryConsts::kFlashBank1) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte: Bus error at P0x%.8X (%.2X)",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		return true;
-	} else if (inAddress < TMemoryConsts::kFlashBank1End) {
-#if debugFlash
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte to flash (bank#1) (ignored) at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-#endif
-	} else if (inAddress < TMemoryConsts::kRAMStart) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte access to unknown bank #1 at P0x%.8X (%.2X)",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < mRAMEnd) {
-//        if (inAddress == 0x04098490)
-//        {
-//                mEmulator->BreakInMonitor();
-//        }
+		theMemory->mLog->FLogLine(
+			"Write byte access to unknown bank #%d at P0x%.8X (%.2X)",
+			GetBankNumber( inAddress ),
+			(unsigned int) inAddress,
+			(unsigned int) inByte );
+	}
+	// mEmulator->BreakInMonitor();
+	return false;
+}
 
-		// RAM.
-#if TARGET_RT_LITTLE_ENDIAN
-		// Swap the endianness of the address.
-		*((KUInt8*) (mRAMOffset + (inAddress ^ 0x3))) = inByte;
-#else
-		*((KUInt8*) (mRAMOffset + inAddress)) = inByte;
-#endif		
+// -------------------------------------------------------------------------- //
+//  * ReadSystemRegister( void*, PAddr, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadSystemRegister(
+			void* inObject,
+			PAddr inAddress,
+			Boolean& outFault )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (inAddress == TMemoryConsts::kHdWr_04RAMSize) {
+		KUInt32 thePageCount = (theMemory->mRAMSize >> 16) & 0xFF;
+		return
+			(thePageCount << 24)
+			| (thePageCount << 16)
+			| thePageCount;
+	} else if (inAddress == TMemoryConsts::kHdWr_08RAMSize) {
+		return 0;
+	} else if (inAddress == TMemoryConsts::kHdWr_HighSpeedClck) {
+		return TMemoryConsts::kHighSpeedClockVal;
+	} else {
+		return ReadUnknown( inObject, inAddress, outFault );
+	}
+}
 
-		// Invalidate JIT.
-		mJIT.Invalidate( inAddress );
-	} else if (inAddress < TMemoryConsts::kHardwareBase) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte access to unknown bank #2 at P0x%.8X (%.2X)",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte access to unknown bank #3 at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		if (inAddress < TMemoryConsts::kInfraredSerialBase)
-		{
-			mExternalPort->WriteRegister(
-				inAddress - TMemoryConsts::kExternalSerialBase, inByte );
-		} else if (inAddress < TMemoryConsts::kBuiltInSerialBase) {
-			mInfraredPort->WriteRegister(
-				inAddress - TMemoryConsts::kInfraredSerialBase, inByte );
-		} else if (inAddress < TMemoryConsts::kModemSerialBase) {
-			mBuiltInExtraPort->WriteRegister(
-				inAddress - TMemoryConsts::kBuiltInSerialBase, inByte );
+// -------------------------------------------------------------------------- //
+//  * ReadBank4Register( void*, PAddr, Boolean& )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadBank4Register(
+			void* inObject,
+			PAddr inAddress,
+			Boolean& outFault )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt1) {
+		return 0;
+	} else if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt3) {
+		return 0;
+	} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
+		return theMemory->mBankCtrlRegister;
+	} else if (inAddress == TMemoryConsts::kROMSerialChip) {
+		KUInt32 bit;
+		if (theMemory->mSerialNumberIx == 64)
+		{
+			bit = 0;
+		} else if (theMemory->mSerialNumberIx >= 32) {
+			bit = theMemory->mSerialNumber[0]
+				>> (theMemory->mSerialNumberIx - 32);
 		} else {
-			mModemPort->WriteRegister(
-				inAddress - TMemoryConsts::kModemSerialBase, inByte );
+			bit = theMemory->mSerialNumber[1] >> theMemory->mSerialNumberIx;
 		}
-	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte access to unknown bank #4 at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
-#if debugFlash
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte to flash (bank#2) (ignored) at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA0Base) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte access to unknown bank #5 at P0x%.8X (%.2X)",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		mPCMCIACtrls[0]->WriteB( inAddress - TMemoryConsts::kPCMCIA0Base, inByte );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		mPCMCIACtrls[1]->WriteB( inAddress - TMemoryConsts::kPCMCIA1Base, inByte );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		mPCMCIACtrls[2]->WriteB( inAddress - TMemoryConsts::kPCMCIA2Base, inByte );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		mPCMCIACtrls[3]->WriteB( inAddress - TMemoryConsts::kPCMCIA3Base, inByte );
-#endif
+		theMemory->mSerialNumberIx = (theMemory->mSerialNumberIx + 1) % 65;
+		bit = bit & 0x1;
+		return (bit << 1);
 	} else {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte: Bus error at P0x%.8X (%.2X)",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		return true;
+		return ReadUnknown( inObject, inAddress, outFault );
 	}
-	
-//	if ((inAddress == 0x0F240000) || (inAddress == 0x0F240800))
-//	{
-//		mEmulator->BreakInMonitor();
-//	}
+}
 
+// -------------------------------------------------------------------------- //
+//  * WriteBank4Register( void*, PAddr, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteBank4Register( void* inObject, PAddr inAddress, KUInt32 inWord )
+{
+	if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt2) {
+		// Ignore it.
+	} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
+		((TMemory*) inObject)->mBankCtrlRegister = inWord;
+	} else if (inAddress == TMemoryConsts::kROMSerialChip) {
+		// Ignore it.
+	} else {
+		return WriteUnknown( inObject, inAddress, inWord );
+	}
+	
 	return false;
 }
 
@@ -2895,8 +2639,9 @@ TMemory::TransferState( TStream* inStream )
 	// The flash.
 	mFlash.TransferState( inStream );
 
-	// Invalidate the JIT cache.
+	// Invalidate the JIT cache and the host pointers (RAM may have moved).
 	mJIT.InvalidateTLB();
+	InvalidateHostTLB();
 }
 
 
@@ -2918,6 +2663,79 @@ TMemory::Init( void )
 	mSerialNumber[1] = 0;
 	mWPCount = 0;
 	mWatchpoints = (struct SWatchpoint*)::calloc(kMaxWatchpoints, sizeof(struct SWatchpoint));
+	(void) ::memset( mWatchedPages, 0, sizeof(mWatchedPages) );
+	(void) ::memset( mHostTLB, 0, sizeof(mHostTLB) );
+	mHostTLBGeneration = 1;
+	InitIOHandlers();
+}
+
+// -------------------------------------------------------------------------- //
+//  * FillHostTLB( VAddr, PAddr, Boolean )
+// -------------------------------------------------------------------------- //
+void
+TMemory::FillHostTLB( VAddr inVAddr, PAddr inPAddr, Boolean inWrite )
+{
+	KUInt32 thePPage = inPAddr & TMemoryConsts::kMMUSmallestPageMask;
+	KUIntPtr theHostPage;
+	if (!(thePPage & TMemoryConsts::kROMEndMask))
+	{
+		// Writes to ROM are ignored by WriteP and are logged.
+		if (inWrite)
+		{
+			return;
+		}
+		theHostPage = ((KUIntPtr) mROMImagePtr) + thePPage;
+	} else if ((thePPage >= TMemoryConsts::kRAMStart)
+		&& (thePPage < mRAMEnd)) {
+		theHostPage = mRAMOffset + thePPage;
+	} else {
+		// Flash or hardware.
+		return;
+	}
+
+	// Accesses to watched pages must be checked.
+	if (IsWatchedPage( inVAddr ))
+	{
+		return;
+	}
+
+	KUInt32 theVPage = inVAddr & TMemoryConsts::kMMUSmallestPageMask;
+	KUInt32 theTag = theVPage | mHostTLBGeneration;
+	SHostTLBEntry* theEntry = GetHostTLBEntry( inVAddr );
+
+	// Both permissions share the pointer: drop the other one if it was
+	// for another page.
+	if (inWrite)
+	{
+		if (theEntry->fReadTag != theTag)
+		{
+			theEntry->fReadTag = 0;
+		}
+		theEntry->fWriteTag = theTag;
+	} else {
+		if (theEntry->fWriteTag != theTag)
+		{
+			theEntry->fWriteTag = 0;
+		}
+		theEntry->fReadTag = theTag;
+	}
+	theEntry->fPhysicalOffset = thePPage - theVPage;
+	theEntry->fHostOffset = theHostPage - theVPage;
+}
+
+// -------------------------------------------------------------------------- //
+//  * InvalidateHostTLB( void )
+// -------------------------------------------------------------------------- //
+void
+TMemory::InvalidateHostTLB( void )
+{
+	// Entries of previous generations no longer match.
+	mHostTLBGeneration++;
+	if (mHostTLBGeneration > kHostTLBMaxGeneration)
+	{
+		(void) ::memset( mHostTLB, 0, sizeof(mHostTLB) );
+		mHostTLBGeneration = 1;
+	}
 }
 
 
@@ -2938,6 +2756,7 @@ Boolean TMemory::AddWatchpoint(VAddr inAddr, KUInt8 inMode)
 	mWatchpoints[mWPCount].fAddress = inAddr;
 	mWatchpoints[mWPCount].fMode = inMode;
 	mWPCount++;
+	UpdateWatchedPages();
 	return false;
 }
 
@@ -2951,6 +2770,7 @@ Boolean TMemory::ClearWatchpoint(VAddr inAddr)
 			// move all following wp's one position back
 			memmove(mWatchpoints+i, mWatchpoints+i+1, (kMaxWatchpoints-i-1)*sizeof(SWatchpoint));
 			mWPCount--;
+			UpdateWatchedPages();
 			return false;
 		}
 	}
@@ -2965,6 +2785,41 @@ Boolean TMemory::GetWatchpoint( int inIndex, VAddr &outAddress, KUInt8 &outMode
 	return false;
 }
 
+// -------------------------------------------------------------------------- //
+//  * CheckWatchpoints( VAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+void
+TMemory::CheckWatchpoints( VAddr inAddress, KUInt8 inMode )
+{
+	int i;
+	for (i=0; i<mWPCount; i++) {
+		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&inMode)) {
+			fprintf(stderr, "Watchpoint 0x%08X %s around 0x%08X\n",
+				(unsigned int)inAddress,
+				(inMode == kWatchRead) ? "read" : "written",
+				(unsigned int)mProcessor->mCurrentRegisters[15]);
+			mEmulator->BreakInMonitor();
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * UpdateWatchedPages( void )
+// -------------------------------------------------------------------------- //
+void
+TMemory::UpdateWatchedPages( void )
+{
+	(void) ::memset( mWatchedPages, 0, sizeof(mWatchedPages) );
+	int i;
+	for (i=0; i<mWPCount; i++) {
+		KUInt32 theIndex = GetWatchedPageIndex( mWatchpoints[i].fAddress );
+		mWatchedPages[theIndex / 32] |= (1U << (theIndex % 32));
+	}
+	
+	// Pages that are now watched may be in the host TLB.
+	InvalidateHostTLB();
+}
+
 
 // ========================================================================== //
 // If I have seen farther than others, it is because I was standing on the    //
@@ -177,6 +177,37 @@ public:
 	///
 	Boolean		GetDirectPointerToROMRAM( VAddr inAddress, const KUInt8** outPtr );
 
+	///
+	/// Get a host pointer to the words of a block transfer (LDM), if the
+	/// whole block is in a single page of ROM or RAM that can be read.
+	/// Otherwise, the caller should read word by word to get the faults
+	/// (and the watchpoints) right.
+	///
+	/// \param inAddress	virtual address of the first word.
+	/// \param inAmount		size of the block in bytes (multiple of 4).
+	/// \param outPtr		on output, pointer to the first word.
+	/// \return true if the block cannot be read directly.
+	///
+	Boolean		GetBlockPointerR(
+					VAddr inAddress,
+					KUInt32 inAmount,
+					const KUInt32** outPtr );
+
+	///
+	/// Get a host pointer to the words of a block transfer (STM), if the
+	/// whole block is in a single page of RAM that can be written. The JIT
+	/// translations of the page are invalidated.
+	///
+	/// \param inAddress	virtual address of the first word.
+	/// \param inAmount		size of the block in bytes (multiple of 4).
+	/// \param outPtr		on output, pointer to the first word.
+	/// \return true if the block cannot be written directly.
+	///
+	Boolean		GetBlockPointerW(
+					VAddr inAddress,
+					KUInt32 inAmount,
+					KUInt32** outPtr );
+
 	///
 	/// Get a direct pointer to a page.
 	///
@@ -192,8 +223,14 @@ public:
 
 	///
 	/// Fast read data.
+	/// The range is copied page by page with the host pointers of ROM and
+	/// RAM pages. Other pages are read word by word. On a fault, the
+	/// bytes before the faulting address have been copied and the fault
+	/// registers are set as with Read.
 	///
 	/// \param inAddress		virtual address.
+	/// \param inAmount		number of bytes to read.
+	/// \param outBuffer		host buffer.
 	/// \return true if reading failed.
 	///
 	Boolean		FastReadBuffer(
@@ -224,8 +261,14 @@ public:
 	
 	///
 	/// Fast write data.
+	/// The range is copied page by page with the host pointers of RAM
+	/// pages. Other pages are written word by word. On a fault, the
+	/// bytes before the faulting address have been copied and the fault
+	/// registers are set as with Write.
 	///
 	/// \param inAddress		virtual address.
+	/// \param inAmount		number of bytes to write.
+	/// \param inBuffer		host buffer.
 	/// \return true if writing failed.
 	///
 	Boolean		FastWriteBuffer(
@@ -374,6 +417,76 @@ public:
 	///
 	Boolean		WriteBP( PAddr inAddress, KUInt8 inByte );
 
+	///
+	/// Handlers of a range of memory mapped registers.
+	/// ReadP, WriteP, ReadBP and WriteBP call them with the physical address
+	/// for any access outside ROM and RAM. Functions follow the conventions
+	/// of these methods.
+	///
+	struct SIOHandler {
+		void*		fObject;		///< First parameter of the functions.
+		KUInt32		(*fReadWord)(
+						void* inObject,
+						PAddr inAddress,
+						Boolean& outFault );
+		Boolean		(*fWriteWord)(
+						void* inObject,
+						PAddr inAddress,
+						KUInt32 inWord );
+		Boolean		(*fReadByte)(
+						void* inObject,
+						PAddr inAddress,
+						KUInt8& outByte );
+		Boolean		(*fWriteByte)(
+						void* inObject,
+						PAddr inAddress,
+						KUInt8 inByte );
+	};
+
+	enum {
+		kIOPageShift	= 16,				///< Granularity of the handlers.
+		kIOPageSize		= 1 << kIOPageShift,
+		kIOPageCount	= 1 << (32 - kIOPageShift),
+		kMaxIOHandlers	= 64,				///< Distinct handlers.
+	};
+
+	///
+	/// Register the handlers of a range of physical addresses, replacing
+	/// the handlers previously registered for this range.
+	/// Devices register their registers when they are created.
+	///
+	/// \param inStart		first address, multiple of kIOPageSize.
+	/// \param inEnd		address after the range, multiple of kIOPageSize.
+	/// \param inHandler	handlers for the range.
+	/// \return true if the range is invalid or there are too many handlers.
+	///
+	Boolean		RegisterIOHandler(
+					PAddr inStart,
+					PAddr inEnd,
+					const SIOHandler& inHandler );
+
+	///
+	/// Give a range of physical addresses back to the unknown registers
+	/// handlers, when the device that registered it goes away.
+	///
+	/// \param inStart		first address, multiple of kIOPageSize.
+	/// \param inEnd		address after the range, multiple of kIOPageSize.
+	///
+	void		UnregisterIOHandler(
+					PAddr inStart,
+					PAddr inEnd );
+
+	/// \name Handlers of unknown registers, for devices to fall back on.
+	/// The object is the TMemory.
+	static KUInt32		ReadUnknown(
+							void* inObject, PAddr inAddress, Boolean& outFault );
+	static Boolean		WriteUnknown(
+							void* inObject, PAddr inAddress, KUInt32 inWord );
+	static Boolean		ReadBUnknown(
+							void* inObject, PAddr inAddress, KUInt8& outByte );
+	static Boolean		WriteBUnknown(
+							void* inObject, PAddr inAddress, KUInt8 inByte );
+
 	///
 	/// Translate a flash address and check its validity.
 	///
@@ -461,6 +574,24 @@ public:
 			return mMMU.TranslateW( inVAddress, outPAddress );
 		}
 
+	///
+	/// Translate an address using MMU tables with the privileged
+	/// permissions, without changing the mode.
+	///
+	/// \param inVAddress   virtual address.
+	/// \param inWrite		whether the address is translated for writing.
+	/// \param outPAddress  physical address.
+	/// \return true if the MMU tables couldn't be accessed for
+	///			reading or if the target address is not accessible.
+	///
+	Boolean		TranslatePrivileged(
+					VAddr inVAddress,
+					Boolean inWrite,
+					PAddr& outPAddress )
+		{
+			return mMMU.TranslatePrivileged( inVAddress, inWrite, outPAddress );
+		}
+
 	///
 	/// Enable or disable the MMU.
 	///
@@ -469,6 +600,7 @@ public:
 	void		SetMMUEnabled( Boolean inEnableMMU )
 		{
 			mMMU.SetMMUEnabled( inEnableMMU );
+			InvalidateHostTLB();
 		}
 
 	///
@@ -600,7 +732,7 @@ public:
 	///
 	void		SetFaultStatusRegister( KUInt32 inNewValue )
 		{
-			mMMU.SetDomainAccessControl( inNewValue );
+			mMMU.SetFaultStatusRegister( inNewValue );
 		}
 
 	///
@@ -642,6 +774,22 @@ public:
 			mMMU.InvalidateTLB();
 		}
 
+	///
+	/// Accessor on the counters of the MMU.
+	///
+	const SMMUStats&	GetMMUStats( void ) const
+		{
+			return mMMU.GetStats();
+		}
+
+	///
+	/// Reset the counters of the MMU.
+	///
+	void		ResetMMUStats( void )
+		{
+			mMMU.ResetStats();
+		}
+
 	///
 	/// Set the processor.
 	///
@@ -756,6 +904,23 @@ private:
 		KUInt8	fMode;			///< mode bit: 1 for reading, 2 for writing
 	};
 	
+	struct SHostTLBEntry {
+		KUInt32		fReadTag;		///< Page | generation if readable.
+		KUInt32		fWriteTag;		///< Page | generation if writable.
+		KUInt32		fPhysicalOffset;	///< Physical - virtual address.
+		KUIntPtr	fHostOffset;	///< Host pointer - virtual address.
+	};
+
+	enum {
+		kHostTLBSize			= 256,		///< Entries (1 KB pages).
+		kHostTLBMaxGeneration	= TMemoryConsts::kMMUSmallestPageSize - 1,
+		kWatchedPagesBits		= 256,		///< Bits of the bitmap.
+		kWatchRead				= 1,		///< Mode bit for reading.
+		kWatchWrite				= 2,		///< Mode bit for writing.
+		kPCMCIASocketSize		=			///< Address space of a socket.
+			TMemoryConsts::kPCMCIA1Base - TMemoryConsts::kPCMCIA0Base,
+	};
+
 	struct SDMAChannel {
 		PAddr	fBaseRegister;
 		PAddr	fPointerRegister;
@@ -836,6 +1001,141 @@ private:
 	///
 	void				Init( void );
 
+	///
+	/// Register the handlers of the banks the memory handles itself.
+	/// Other pages of the hardware banks are unknown registers until a
+	/// device registers them.
+	///
+	void				InitIOHandlers( void );
+
+	///
+	/// Get the handlers for a physical address outside ROM and RAM.
+	///
+	/// \param inAddress	physical address.
+	/// \return the handlers of the page.
+	///
+	const SIOHandler&	GetIOHandler( PAddr inAddress ) const
+		{
+			return mIOHandlers[
+				mIOPages[(inAddress >> kIOPageShift) & (kIOPageCount - 1)]];
+		}
+
+	/// \name Handlers of the banks and registers we know.
+	/// The object is the TMemory.
+	static KUInt32		ReadBusError(
+							void* inObject, PAddr inAddress, Boolean& outFault );
+	static Boolean		WriteBusError(
+							void* inObject, PAddr inAddress, KUInt32 inWord );
+	static Boolean		ReadBBusError(
+							void* inObject, PAddr inAddress, KUInt8& outByte );
+	static Boolean		WriteBBusError(
+							void* inObject, PAddr inAddress, KUInt8 inByte );
+	static KUInt32		ReadROM(
+							void* inObject, PAddr inAddress, Boolean& outFault );
+	static Boolean		WriteROM(
+							void* inObject, PAddr inAddress, KUInt32 inWord );
+	static Boolean		ReadBROM(
+							void* inObject, PAddr inAddress, KUInt8& outByte );
+	static Boolean		WriteBROM(
+							void* inObject, PAddr inAddress, KUInt8 inByte );
+	static KUInt32		ReadFlash(
+							void* inObject, PAddr inAddress, Boolean& outFault );
+	static Boolean		WriteFlash(
+							void* inObject, PAddr inAddress, KUInt32 inWord );
+	static Boolean		ReadBFlash(
+							void* inObject, PAddr inAddress, KUInt8& outByte );
+	static Boolean		WriteBFlash(
+							void* inObject, PAddr inAddress, KUInt8 inByte );
+	static KUInt32		ReadSystemRegister(
+							void* inObject, PAddr inAddress, Boolean& outFault );
+	static KUInt32		ReadBank4Register(
+							void* inObject, PAddr inAddress, Boolean& outFault );
+	static Boolean		WriteBank4Register(
+							void* inObject, PAddr inAddress, KUInt32 inWord );
+
+	///
+	/// Get the index of the bit of a virtual address in the bitmap of
+	/// watched pages. Pages sharing a bit are all watched.
+	///
+	/// \param inAddress	virtual address.
+	/// \return the index of the bit.
+	///
+	static KUInt32		GetWatchedPageIndex( VAddr inAddress )
+		{
+			return (inAddress / TMemoryConsts::kMMUSmallestPageSize)
+				& (kWatchedPagesBits - 1);
+		}
+
+	///
+	/// Determine if there might be a watchpoint on the page of an address.
+	///
+	/// \param inAddress	virtual address.
+	/// \return true if a watchpoint might be on this page.
+	///
+	Boolean				IsWatchedPage( VAddr inAddress ) const
+		{
+			KUInt32 theIndex = GetWatchedPageIndex( inAddress );
+			return (mWatchedPages[theIndex / 32] >> (theIndex % 32)) & 1;
+		}
+
+	///
+	/// Check the watchpoints for an access to a watched page, and break in
+	/// the monitor if one matches.
+	///
+	/// \param inAddress	virtual address.
+	/// \param inMode		kWatchRead or kWatchWrite.
+	///
+	void				CheckWatchpoints( VAddr inAddress, KUInt8 inMode );
+
+	///
+	/// Rebuild the bitmap of watched pages after watchpoints changed.
+	///
+	void				UpdateWatchedPages( void );
+
+	///
+	/// Get the host TLB entry for a virtual address.
+	///
+	/// \param inAddress	virtual address.
+	/// \return the entry (which might be for another page).
+	///
+	SHostTLBEntry*		GetHostTLBEntry( VAddr inAddress )
+		{
+			return &mHostTLB[
+				(inAddress / TMemoryConsts::kMMUSmallestPageSize)
+					& (kHostTLBSize - 1)];
+		}
+
+	///
+	/// Get the tag of valid host TLB entries for a virtual address.
+	///
+	/// \param inAddress	virtual address.
+	/// \return the tag.
+	///
+	KUInt32				GetHostTLBTag( VAddr inAddress ) const
+		{
+			return (inAddress & TMemoryConsts::kMMUSmallestPageMask)
+				| mHostTLBGeneration;
+		}
+
+	///
+	/// Remember the host pointer of a page of ROM or RAM after a successful
+	/// translation. Other pages (flash, hardware) are ignored.
+	///
+	/// \param inVAddr		virtual address.
+	/// \param inPAddr		physical address it was translated to.
+	/// \param inWrite		whether the translation was for writing.
+	///
+	void				FillHostTLB(
+							VAddr inVAddr,
+							PAddr inPAddr,
+							Boolean inWrite );
+
+	///
+	/// Forget all host pointers, because translations or permissions
+	/// changed. Called by the MMU.
+	///
+	void				InvalidateHostTLB( void );
+
 	/// \name Variables
 	TARMProcessor*		mProcessor;			///< Reference to the CPU.
 	TLog*				mLog;				///< Interface for logging.
@@ -862,6 +1162,15 @@ private:
 	SBreakpoint*		mBreakpoints;		///< Breakpoints.
 	KUInt32				mWPCount;			///< Number of Watchpoints.
 	SWatchpoint*		mWatchpoints;		///< Watchpoints.
+	KUInt32				mWatchedPages[kWatchedPagesBits / 32];
+											///< Pages with watchpoints.
+	SHostTLBEntry		mHostTLB[kHostTLBSize];	///< Host pointers of pages.
+	KUInt32				mHostTLBGeneration;	///< Tag of valid entries.
+	SIOHandler			mIOHandlers[kMaxIOHandlers];
+											///< Registered handlers.
+	KUInt32				mIOHandlerCount;	///< Number of handlers.
+	KUInt8				mIOPages[kIOPageCount];
+											///< Handler of every page.
 	JITClass			mJIT;				///< JIT.
 };
 
@@ -186,7 +186,11 @@ public:
 		kMMUSmallestPageMask	= kMMUTinyPageMask,
 		kMMUSmallestPageMaskNeg = ~kMMUSmallestPageMask,
 		kMMUSmallestPageSize	= 1024,	///< 1 KB (that's not big).
-		kMMUDirtyCacheMask		= 1
+		kMMUDirtyCacheMask		= 1,
+		kMMUDomainCount			= 16,
+		kMMUNoDomain			= kMMUDomainCount	///< Translation that
+												///< doesn't depend on
+												///< domain access.
 	};
 	
 	///
@@ -2732,17 +2732,14 @@ TNativePrimitives::ExecuteNetworkManagerNative( KUInt32 inInstruction )
 		case 0x0a: {
 			// Newton wants to send a raw packet into the world
 			KUInt32 addr = mProcessor->GetRegister(1);
-			KUInt32 size = mProcessor->GetRegister(2), i;
+			KUInt32 size = mProcessor->GetRegister(2);
 			if (mLog)
 			{
 				mLog->FLogLine( "TNetworkManager::SendPacket(0x%08x, %d)", addr, size );
 			}
 			if (mNetworkManager && size) {
-				KUInt8 *data = (KUInt8*)malloc(size), v;
-				for (i=0; i<size; i++) {
-					mMemory->ReadB(addr+i, v);
-					data[i] = v;
-				}
+				KUInt8 *data = (KUInt8*)malloc(size);
+				(void) mMemory->FastReadBuffer(addr, size, data);
 				mNetworkManager->SendPacket(data, size);
 				free(data);
 			}
@@ -2751,7 +2748,7 @@ TNativePrimitives::ExecuteNetworkManagerNative( KUInt32 inInstruction )
 			// NewtonOS wants the hardware MAC address of the card
 			KUInt32 dstBuffer = mProcessor->GetRegister(1);
 			KUInt32 dstBufferSize = mProcessor->GetRegister(2);
-			KUInt32 i, err = 0;
+			KUInt32 err = 0;
 			if (mLog)
 			{
 				mLog->FLogLine( "TNetworkManager::GetDeviceAddress(0x%08x, %d)", dstBuffer, dstBufferSize );
@@ -2759,8 +2756,9 @@ TNativePrimitives::ExecuteNetworkManagerNative( KUInt32 inInstruction )
 			if (mNetworkManager && dstBufferSize) {
 				KUInt8 mac[6] = { 0 };
 				err = (KUInt32)mNetworkManager->GetDeviceAddress(mac, dstBufferSize);
-				for (i=0; i<dstBufferSize; i++)
-					mMemory->WriteB(dstBuffer+i, mac[i]);
+				if (dstBufferSize > sizeof(mac))
+					dstBufferSize = sizeof(mac);
+				(void) mMemory->FastWriteBuffer(dstBuffer, dstBufferSize, mac);
 			}
 			mProcessor->SetRegister(0, err);			
 			break; }
@@ -1225,6 +1225,56 @@ TMonitor::ExecuteCommand( const char* inCommand )
 			::sprintf(theLine, "WP %2d at %.8X, %s", i, (unsigned int)addr, lut[type&3]);
 			PrintLine(theLine, MONITOR_LOG_INFO);
 		}
+	} else if (::strcmp(inCommand, "jit") == 0) {
+		const SJITCacheStats& theStats = mMemory->GetJITObject()->GetCacheStats();
+		(void) ::sprintf(
+			theLine, "JIT cache: %u pages, ROM pages %s (%u pinned)",
+			(unsigned int) mMemory->GetJITObject()->GetCacheSize(),
+			mMemory->GetJITObject()->GetPinROMPages() ? "pinned" : "not pinned",
+			(unsigned int) theStats.mPinnedPages );
+		PrintLine(theLine, MONITOR_LOG_INFO);
+		(void) ::sprintf(
+			theLine, "Hits: %u, Misses: %u, Evictions: %u, InvP: %u, InvT: %u",
+			(unsigned int) theStats.mHits,
+			(unsigned int) theStats.mMisses,
+			(unsigned int) theStats.mEvictions,
+			(unsigned int) theStats.mInvalidatedPages,
+			(unsigned int) theStats.mInvalidatedTLBs );
+		PrintLine(theLine, MONITOR_LOG_INFO);
+		const SMMUStats& theMMUStats = mMemory->GetMMUStats();
+		(void) ::sprintf(
+			theLine, "Revalidated: %u, InvD: %u, TLB flushes: %u, Perms: %u, Domain: %u, TTB: %u",
+			(unsigned int) theStats.mRevalidations,
+			(unsigned int) theStats.mInvalidatedDomains,
+			(unsigned int) theMMUStats.mTLBFlushes,
+			(unsigned int) theMMUStats.mPermChanges,
+			(unsigned int) theMMUStats.mDomainChanges,
+			(unsigned int) theMMUStats.mTTBChanges );
+		PrintLine(theLine, MONITOR_LOG_INFO);
+	} else if (::strcmp(inCommand, "jit reset") == 0) {
+		mMemory->GetJITObject()->ResetCacheStats();
+		mMemory->ResetMMUStats();
+	} else if (::sscanf(inCommand, "jit cache %i", &theArgInt) == 1) {
+		if (mHalted)
+		{
+			if (mMemory->GetJITObject()->SetCacheSize( theArgInt ))
+			{
+				(void) ::sprintf(
+					theLine, "Cannot set the JIT cache to %i pages",
+					theArgInt );
+				PrintLine(theLine, MONITOR_LOG_ERROR);
+			}
+		} else {
+			PrintLine("Cannot resize the JIT cache, the emulator is running", MONITOR_LOG_ERROR);
+		}
+	} else if ((::strcmp(inCommand, "jit pin") == 0)
+		|| (::strcmp(inCommand, "jit unpin") == 0)) {
+		if (mHalted)
+		{
+			mMemory->GetJITObject()->SetPinROMPages( inCommand[4] == 'p' );
+		} else {
+			PrintLine("Cannot pin JIT pages, the emulator is running", MONITOR_LOG_ERROR);
+		}
 	} else if (::strcmp(inCommand, "p tasks") == 0) {
 		PrintLine("List of Tasks", MONITOR_LOG_INFO);
 		KUInt32 kernelScheduler; mMemory->Read(0x0C100FD0, kernelScheduler);
@@ -1268,6 +1318,8 @@ TMonitor::ExecuteHelpCommand( const char* inCommand )
 		PrintScriptingHelp();
 	} else if (::strcmp(inCommand, "wp") == 0) {
 		PrintWatchpointHelp();
+	} else if (::strcmp(inCommand, "jit") == 0) {
+		PrintJITHelp();
 	} else {
 		theResult = false;
 	}
@@ -1316,6 +1368,7 @@ TMonitor::PrintHelp( void )
 	PrintLine(" help script        help with scripting", MONITOR_LOG_INFO);
 	PrintLine(" help wp            help with watchpoint commands", MONITOR_LOG_INFO);
 	PrintLine(" help rt            help with retargeting commands", MONITOR_LOG_INFO);
+	PrintLine(" help jit           help with the JIT cache", MONITOR_LOG_INFO);
 #endif
 }
 
@@ -1384,6 +1437,26 @@ TMonitor::PrintWatchpointHelp( void )
 #endif
 }
 
+// -------------------------------------------------------------------------- //
+// PrintJITHelp( void )
+// -------------------------------------------------------------------------- //
+void
+TMonitor::PrintJITHelp( void )
+{
+#if TARGET_OS_WIN32
+	assert(0); // FIXME later
+#else
+	PrintLine("The JIT keeps a fixed number of translated pages.", MONITOR_LOG_INFO);
+	PrintLine("Pinned ROM pages are never evicted (up to half the cache).", MONITOR_LOG_INFO);
+	PrintLine("", MONITOR_LOG_INFO);
+	PrintLine(" jit                display the cache size and counters", MONITOR_LOG_INFO);
+	PrintLine(" jit reset          reset the counters", MONITOR_LOG_INFO);
+	PrintLine("JIT commands available when the machine is halted:", MONITOR_LOG_INFO);
+	PrintLine(" jit pin|unpin      pin or unpin ROM pages", MONITOR_LOG_INFO);
+	PrintLine(" jit cache <n>      keep n pages (16-16384)", MONITOR_LOG_INFO);
+#endif
+}
+
 // -------------------------------------------------------------------------- //
 // PrintRetargetHelp( void )
 // -------------------------------------------------------------------------- //
@@ -1410,6 +1483,9 @@ TMonitor::PrintRetargetHelp( void )
 	PrintLine("                    transcode function to return stub", MONITOR_LOG_INFO);
 	PrintLine(" rt code <addr>-<addr>", MONITOR_LOG_INFO);
 	PrintLine("                    mark range as ARM code", MONITOR_LOG_INFO);
+	PrintLine(" rt paranoid on|off check the PC at every instruction (on)", MONITOR_LOG_INFO);
+	PrintLine("                    or only where it can't be known (off)", MONITOR_LOG_INFO);
+	PrintLine(" rt locals on|off   keep r0-r14 in local variables (off)", MONITOR_LOG_INFO);
 #endif
 }
 
@@ -106,6 +106,11 @@ public:
 	///
 	void		PrintWatchpointHelp( void );
 	
+	///
+	/// Print help for the JIT cache commands.
+	///
+	void		PrintJITHelp( void );
+	
 	///
 	/// Print help for the retargeting commands.
 	///
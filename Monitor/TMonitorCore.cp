@@ -168,6 +168,18 @@ TMonitorCore::ExecuteRetargetCommand( const char* inCommand )
 	} else if (::strcmp(inCommand, "close") == 0) {
 		mRetarget->CloseFiles();
 		PrintLine("Retarget files closed", MONITOR_LOG_INFO);
+	} else if (::strcmp(inCommand, "paranoid on") == 0) {
+		mRetarget->SetParanoid(true);
+		PrintLine("Retargeted code checks the PC at every instruction", MONITOR_LOG_INFO);
+	} else if (::strcmp(inCommand, "paranoid off") == 0) {
+		mRetarget->SetParanoid(false);
+		PrintLine("Retargeted code checks the PC at function entries and returns", MONITOR_LOG_INFO);
+	} else if (::strcmp(inCommand, "locals on") == 0) {
+		mRetarget->SetLocalRegisters(true);
+		PrintLine("Retargeted code keeps registers in local variables", MONITOR_LOG_INFO);
+	} else if (::strcmp(inCommand, "locals off") == 0) {
+		mRetarget->SetLocalRegisters(false);
+		PrintLine("Retargeted code accesses registers in the CPU", MONITOR_LOG_INFO);
 	} else if (::strncmp(inCommand, "code ", 5) == 0) {
 		unsigned long first, last;
 		int n = 0;
@@ -11,6 +11,11 @@
 
 #include "UProcessorTests.h"
 #include "UMemoryTests.h"
+#include "UVirtualizedCallsTests.h"
+#include "UROMPatchTests.h"
+#include "UNativeKernelTests.h"
+#include "USchedulerTests.h"
+#include "URetargetTests.h"
 #include "Emulator/Log/TRAMLog.h"
 
 @interface EinsteinTests : XCTestCase
@@ -79,6 +84,20 @@ typedef void (^LogBlock)(TLog* log);
 		UProcessorTests::RunCode([code cStringUsingEncoding:NSUTF8StringEncoding], log);
 	} withOutputFile:outputFilePath];
 }
+- (void)doTestProcessorRunCodeCompareFlags:(NSString*) code master: (NSString*) suffix {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:[NSString stringWithFormat:@"master-test-run-code-compare-flags_%@", suffix] ofType:@""];
+
+	[self doTest: ^(TLog* log){
+		UProcessorTests::RunCodeCompareFlags([code cStringUsingEncoding:NSUTF8StringEncoding], log);
+	} withOutputFile:outputFilePath];
+}
+- (void)doTestProcessorRunCodeCompareNative:(NSString*) code master: (NSString*) suffix {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:[NSString stringWithFormat:@"master-test-run-code-compare-native_%@", suffix] ofType:@""];
+
+	[self doTest: ^(TLog* log){
+		UProcessorTests::RunCodeCompareNative([code cStringUsingEncoding:NSUTF8StringEncoding], log);
+	} withOutputFile:outputFilePath];
+}
 
 - (void)testProcessorExecuteInstruction_0A000007 {
     [self doTestProcessorExecuteInstruction:@"0A000007"];
@@ -582,6 +601,195 @@ bkpt 0
 	[self doTestProcessorRunCode:@"e3a01003 e3a00c02 e2800057 e1a02130 e1a031a0 e1a04150 e1a051c0 e1200070" master: @"20"];
 }
 
+/*
+ Self-modifying code: the function in RAM is translated, then patched.
+ 
+ mov    r0, #0x04000000
+ ldr    r1, [pc, #40]       r1 = mov r2, #1
+ ldr    r3, [pc, #40]       r3 = mov pc, lr
+ stmia  r0, {r1, r3}
+ mov    lr, pc
+ mov    pc, r0
+ mov    r4, r2              r4 = 1
+ ldr    r1, [pc, #24]       r1 = mov r2, #2
+ str    r1, [r0]
+ mov    lr, pc
+ mov    pc, r0
+ mov    r5, r2              r5 = 2
+ bkpt 0
+ mov    r2, #1
+ mov    pc, lr
+ mov    r2, #2
+*/
+- (void)testProcessorRunCode_21 {
+	[self doTestProcessorRunCode:@"e3a00301 e59f1028 e59f3028 e880000a e1a0e00f e1a0f000 e1a04002 e59f1018 e5801000 e1a0e00f e1a0f000 e1a05002 e1200070 e3a02001 e1a0f00e e3a02002" master: @"21"];
+}
+
+/*
+ mov    r0, #0x04000000
+ ldr    r1, [pc, #20]       r1 = 0x12345678
+ str    r1, [r0]
+ ldrb   r2, [r0]            r2 = 0x12
+ strb   r2, [r0, #3]
+ ldr    r3, [r0]            r3 = 0x12345612
+ ldr    r4, [r0]            same, from the host TLB
+ bkpt 0
+*/
+- (void)testProcessorRunCode_22 {
+	[self doTestProcessorRunCode:@"e3a00301 e59f1014 e5801000 e5d02000 e5c02003 e5903000 e5904000 e1200070 12345678" master: @"22"];
+}
+
+/*
+ mov    r0, #0x04000000
+ add    r0, r0, #0x3F0      r0 = 0x040003F0
+ mov    r1, #1
+ mov    r2, #2
+ mov    r3, #3
+ mov    r4, #4
+ stmia  r0, {r1-r4}         in a single page
+ ldmia  r0, {r5-r8}         r5-r8 = 1-4, in a single page
+ add    r0, r0, #8
+ stmia  r0!, {r1-r4}        crosses 0x04000400, r0 = 0x04000408
+ ldmdb  r0, {r9-r12}        crosses 0x04000400, r9-r12 = 1-4
+ add    sp, pc, #4
+ ldmia  sp, {lr}            from ROM, lr = 0x12345678
+ bkpt 0
+*/
+- (void)testProcessorRunCode_23 {
+	[self doTestProcessorRunCode:@"e3a00301 e2800ffc e3a01001 e3a02002 e3a03003 e3a04004 e880001e e89001e0 e2800008 e8a0001e e9101e00 e28fd004 e89d4000 e1200070 12345678" master: @"23"];
+}
+
+/*
+ Same as 21, with the second function written by stmia.
+*/
+- (void)testProcessorRunCode_24 {
+	[self doTestProcessorRunCode:@"e3a00301 e59f1028 e59f3028 e880000a e1a0e00f e1a0f000 e1a04002 e59f1018 e880000a e1a0e00f e1a0f000 e1a05002 e1200070 e3a02001 e1a0f00e e3a02002" master: @"24"];
+}
+
+/*
+ User registers from FIQ mode, across a page so that LDM2 loads them one
+ by one. R13_usr is not in the list and must not be loaded.
+ 
+ mov    r0, #0x04000000
+ add    r0, r0, #0x3FC      r0 = 0x040003FC
+ mov    r1, #0x11
+ mov    r2, #0x22
+ mov    r3, #0x33
+ stmia  r0, {r1-r3}
+ msr    cpsr_c, #0xD1       FIQ mode
+ ldmia  r0, {r11, r12}^     crosses 0x04000400
+ msr    cpsr_c, #0xDF       System mode: r11 = 0x11, r12 = 0x22, r13 = 0
+ bkpt 0
+*/
+- (void)testProcessorRunCode_25 {
+	[self doTestProcessorRunCode:@"e3a00301 e2800fff e3a01011 e3a02022 e3a03033 e880000e e321f0d1 e8d01800 e321f0df e1200070" master: @"25"];
+}
+
+/*
+ mov    r0, #0x80000000
+ adds   r1, r0, r0          flags are dead (cmp)
+ cmp    r0, #1
+ adds   r2, r0, r0          carry is live (adc)
+ adc    r3, r2, #0          r3 = 1
+ movs   r4, r0, lsl #1      flags are dead (subs)
+ subs   r5, r0, #1
+ orrs   r6, r5, #0          C and V from subs
+ bkpt 0
+*/
+- (void)testProcessorRunCodeCompareFlags_1 {
+	[self doTestProcessorRunCodeCompareFlags:@"e3a00102 e0901000 e3500001 e0902000 e2a23000 e1b04080 e2505001 e3956000 e1200070" master: @"1"];
+}
+
+/*
+ mvn    r1, #0
+ mov    r2, #0x80000000
+ mov    r3, #1
+ adds   r7, r7, #0          clears C
+ ands   r0, r1, r2, lsl r3  C from the register shift
+ movs   r4, r5              doesn't write C
+ adc    r6, r6, #0          r6 = 1
+ bkpt 0
+*/
+- (void)testProcessorRunCodeCompareFlags_2 {
+	[self doTestProcessorRunCodeCompareFlags:@"e3e01000 e3a02102 e3a03001 e2977000 e0110312 e1b04005 e2a66000 e1200070" master: @"2"];
+}
+
+/*
+ mov    r0, #0x12
+ mov    r1, #0xFF000000
+ add    r2, r0, r1
+ sub    r3, r1, r0, lsl #4
+ rsb    r4, r0, #0x100
+ and    r5, r1, r2, lsr #3
+ eor    r6, r2, r3, asr #7
+ orr    r7, r4, r5, ror #12
+ bic    r8, r1, #0x0F000000
+ mvn    r9, r0, lsl #28
+ add    r2, r2, r2
+ adds   r10, r0, r1         sets the flags
+ addne  r11, r0, #1         conditional
+ mov    r12, #3
+loop:
+ add    r0, r0, r1, lsr #24
+ eor    r3, r3, r0
+ subs   r12, r12, #1
+ bne    loop
+ mov    r13, r0, rrx        threaded: rrx
+ mvn    r14, #0
+ bkpt 0
+*/
+- (void)testProcessorRunCodeCompareNative_1 {
+	[self doTestProcessorRunCodeCompareNative:@"e3a00012 e3a014ff e0802001 e0413200 e2604c01 e00151a2 e02263c3 e1847665 e3c1840f e1e09e00 e0822002 e090a001 1280b001 e3a0c003 e0800c21 e0233000 e25cc001 1afffffb e1a0d060 e3e0e000 e1200070" master: @"1"];
+}
+
+/*
+ mov    r0, #0x04000000     RAM
+ mov    r1, #5
+ mov    r2, #0
+loop:
+ str    r1, [r0], #4        post-indexed store
+ add    r2, r2, r1
+ subs   r1, r1, #1
+ bne    loop                threaded: backward branch
+ cmp    r2, #16
+ bgt    skip                condition tested natively
+ mov    r3, #1
+skip:
+ ldr    r4, [r0, #-8]!      pre-indexed load with write back
+ ldrb   r5, [r0, #1]
+ ldr    r6, [r0, r1, lsl #2]
+ adcs   r7, r7, r6          reads and writes the carry
+ sbcs   r8, r8, #1
+ movs   r9, r0, asr #2      C from the shifter
+ moveq  r10, #1
+ movne  r10, #2
+ add    r11, pc, #4         reads R15
+ strgt  r4, [r0]
+ movls  r12, #3
+ movle  r13, #4
+ rscs   r14, r6, r7
+ teq    r7, r8
+ cmn    r3, r4
+ bkpt 0
+*/
+- (void)testProcessorRunCodeCompareNative_2 {
+	[self doTestProcessorRunCodeCompareNative:@"e3a00301 e3a01005 e3a02000 e4801004 e0822001 e2511001 1afffffb e3520010 ca000000 e3a03001 e5304008 e5d05001 e7906101 e0b77006 e2d88001 e1b09140 03a0a001 13a0a002 e28fb004 c5804000 93a0c003 d3a0d004 e0f6e007 e1370008 e1730004 e1200070" master: @"2"];
+}
+
+- (void)testProcessorIdleLoops {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-idle-loops" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UProcessorTests::IdleLoops(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testProcessorSelfModifyingCode {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-self-modifying-code" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UProcessorTests::SelfModifyingCode(log);
+	} withOutputFile:outputFilePath];
+}
+
 // Step tests require a ROM image
 
 - (void)testMemoryReadROM {
@@ -598,5 +806,104 @@ bkpt 0
 	} withOutputFile:outputFilePath];
 }
 
+- (void)testMemoryBuffer {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-memory-buffer" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UMemoryTests::BufferTest(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testMemoryRestore {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-memory-restore" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UMemoryTests::RestoreTest(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testSwapCopy {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-swap-copy" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UMemoryTests::SwapCopyTest(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testVirtualizedMemmove {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-virtualized-memmove" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UVirtualizedCallsTests::MemmoveTest(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testVirtualizedLibc {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-virtualized-libc" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UVirtualizedCallsTests::LibcTest(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testROMPatchDatabase {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-rom-patch-database" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UROMPatchTests::DatabaseTest(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testROMPatchFile {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-rom-patch-file" ofType:@""];
+	NSString *patchesPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"Einstein" ofType:@"patches"];
+	[self doTest: ^(TLog* log){
+		UROMPatchTests::FileTest([patchesPath fileSystemRepresentation], log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testNativeSemaphores {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-native-semaphores" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UNativeKernelTests::Semaphores(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testNativePageFaults {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-native-page-faults" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UNativeKernelTests::PageFaults(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testNativeScheduler {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-native-scheduler" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UNativeKernelTests::Scheduler(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testNativeTaskSwitch {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-native-task-switch" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UNativeKernelTests::TaskSwitch(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testSchedulerReplay {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-scheduler-replay" ofType:@""];
+	[self doTest: ^(TLog* log){
+		USchedulerTests::Replay(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testRetargetRelease {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-retarget-release" ofType:@""];
+	[self doTest: ^(TLog* log){
+		URetargetTests::Release(log);
+	} withOutputFile:outputFilePath];
+}
+
+- (void)testRetargetLocals {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-retarget-locals" ofType:@""];
+	[self doTest: ^(TLog* log){
+		URetargetTests::LocalRegisters(log);
+	} withOutputFile:outputFilePath];
+}
+
 
 @end
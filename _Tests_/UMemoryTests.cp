@@ -16,24 +16,34 @@
 #include "UMemoryTests.h"
 
 // ANSI C & POSIX
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
 #if !TARGET_OS_WIN32
 	#include <unistd.h>
+	#include <sys/time.h>
 #endif
 
 // K
 #include <K/Defines/UByteSex.h>
+#include <K/Streams/TFileStream.h>
 
 // Einstein
 #include "Emulator/Log/TLog.h"
 #include "Emulator/TMemory.h"
+#include "Emulator/Host/USwapCopy.h"
 
 // -------------------------------------------------------------------------- //
 // Constantes
 // -------------------------------------------------------------------------- //
 #if TARGET_OS_WIN32
 	#define kTempFlashPath "c:/EinsteinTests.flash"
+	#define kTempStatePath "c:/EinsteinTests.state"
 #else
 	#define kTempFlashPath "/tmp/EinsteinTests.flash"
+	#define kTempStatePath "/tmp/EinsteinTests.state"
 #endif
 
 // -------------------------------------------------------------------------- //
@@ -260,6 +270,381 @@ UMemoryTests::FlashTest( TLog* inLog )
 	::free( romBuffer );
 }
 
+// -------------------------------------------------------------------------- //
+//  * LogBuffer( TLog*, const KUInt8*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+LogBuffer( TLog* inLog, const KUInt8* inBuffer, KUInt32 inSize )
+{
+	char theLine[128];
+	KUInt32 index;
+	for (index = 0; index < inSize; index++)
+	{
+		(void) ::sprintf( &theLine[2 * index], "%.2X", inBuffer[index] );
+	}
+	inLog->LogLine( theLine );
+}
+
+// -------------------------------------------------------------------------- //
+//  * BufferTest( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UMemoryTests::BufferTest( TLog* inLog )
+{
+	KUInt8* romBuffer = (KUInt8*) malloc(TMemoryConsts::kLowROMEnd);
+	TMemory theMem( inLog, (KUInt8*) romBuffer, kTempFlashPath );
+	KUInt8 theBuffer[32];
+	Boolean fault = false;
+	int index;
+
+	// Unaligned ends, and a page boundary at 0x04000400.
+	for (index = 0; index < 20; index++)
+	{
+		theBuffer[index] = 0x40 + index;
+	}
+	if (theMem.FastWriteBuffer( 0x040003F6, 20, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred writing at 0x040003F6");
+	}
+	for (index = 0; index < 6; index++)
+	{
+		KUInt32 theWord = theMem.ReadP( 0x040003F4 + (4*index), fault );
+		if (fault)
+		{
+			inLog->FLogLine("A fault occurred reading at %i", index);
+		}
+		inLog->FLogLine("%i: %.8X", index, (unsigned int) theWord);
+	}
+	(void) ::memset( theBuffer, 0, sizeof(theBuffer) );
+	if (theMem.FastReadBuffer( 0x040003F7, 18, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred reading at 0x040003F7");
+	}
+	LogBuffer( inLog, theBuffer, 18 );
+
+	// Two sections: 0x10000000 -> 0x04200000 (domain 0, user read/write)
+	// and 0x10100000 -> 0x04300000 (domain 1, privileged only).
+	(void) theMem.WriteP( 0x04004000 + (0x100 * 4), 0x04200C12 );
+	(void) theMem.WriteP( 0x04004000 + (0x101 * 4), 0x04300432 );
+	theMem.SetTranslationTableBase( 0x04004000 );
+	theMem.SetDomainAccessControl( 0x00000005 );
+	theMem.SetPrivilege( false );
+	theMem.SetMMUEnabled( true );
+
+	// User mode: the copy stops at the second section.
+	for (index = 0; index < 16; index++)
+	{
+		theBuffer[index] = 0x60 + index;
+	}
+	if (theMem.FastWriteBuffer( 0x100FFFF8, 16, theBuffer ))
+	{
+		inLog->FLogLine("Write fault: FSR=%.8X FAR=%.8X",
+			(unsigned int) theMem.GetFaultStatusRegister(),
+			(unsigned int) theMem.GetFaultAddressRegister());
+	}
+	for (index = 0; index < 4; index++)
+	{
+		KUInt32 theWord = theMem.ReadP( 0x042FFFF8 + (4*index), fault );
+		if (fault)
+		{
+			inLog->FLogLine("A fault occurred reading at %i", index);
+		}
+		inLog->FLogLine("%i: %.8X", index, (unsigned int) theWord);
+	}
+	(void) ::memset( theBuffer, 0xFF, sizeof(theBuffer) );
+	if (theMem.FastReadBuffer( 0x100FFFF8, 16, theBuffer ))
+	{
+		inLog->FLogLine("Read fault: FSR=%.8X FAR=%.8X",
+			(unsigned int) theMem.GetFaultStatusRegister(),
+			(unsigned int) theMem.GetFaultAddressRegister());
+	}
+	LogBuffer( inLog, theBuffer, 16 );
+
+	// Privileged mode: both sections are accessible.
+	theMem.SetPrivilege( true );
+	for (index = 0; index < 16; index++)
+	{
+		theBuffer[index] = 0x80 + index;
+	}
+	if (theMem.FastWriteBuffer( 0x100FFFF8, 16, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred writing at 0x100FFFF8");
+	}
+	(void) ::memset( theBuffer, 0, sizeof(theBuffer) );
+	if (theMem.FastReadBuffer( 0x100FFFFA, 12, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred reading at 0x100FFFFA");
+	}
+	LogBuffer( inLog, theBuffer, 12 );
+
+	(void) ::unlink( kTempFlashPath );
+	::free( romBuffer );
+}
+
+// -------------------------------------------------------------------------- //
+//  * RestoreTest( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UMemoryTests::RestoreTest( TLog* inLog )
+{
+	// TransferState saves 16 MB of ROM.
+	KUInt8* romBuffer = (KUInt8*) ::calloc( 0x01000000, 1 );
+	KUInt8 theBuffer[16];
+	Boolean fault = false;
+	int index;
+
+	// Save a state with 4 MB of RAM.
+	{
+		TMemory theMem( inLog, romBuffer, kTempFlashPath, 0x00400000 );
+		for (index = 0; index < 4; index++)
+		{
+			(void) theMem.WriteP( 0x04000000 + (4*index), 0x10101010 * index );
+			(void) theMem.WriteP( 0x043FFFF0 + (4*index), 0x01020304 * index );
+		}
+		TFileStream theStream( kTempStatePath, "wb" );
+		theMem.TransferState( &theStream );
+	}
+
+	// Restore it where there was 1 MB of RAM.
+	TMemory theMem( inLog, romBuffer, kTempFlashPath, 0x00100000 );
+	{
+		TFileStream theStream( kTempStatePath, "rb" );
+		theMem.TransferState( &theStream );
+	}
+	for (index = 0; index < 4; index++)
+	{
+		KUInt32 theWord = theMem.ReadP( 0x043FFFF0 + (4*index), fault );
+		if (fault)
+		{
+			inLog->FLogLine("A fault occurred reading at %i", index);
+		}
+		inLog->FLogLine("%i: %.8X", index, (unsigned int) theWord);
+	}
+
+	// Bulk accesses at both ends of the restored RAM.
+	if (theMem.FastReadBuffer( 0x04000000, 16, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred reading at 0x04000000");
+	}
+	LogBuffer( inLog, theBuffer, 16 );
+	for (index = 0; index < 16; index++)
+	{
+		theBuffer[index] = 0xA0 + index;
+	}
+	if (theMem.FastWriteBuffer( 0x043FFFF8, 8, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred writing at 0x043FFFF8");
+	}
+	(void) ::memset( theBuffer, 0, sizeof(theBuffer) );
+	if (theMem.FastReadBuffer( 0x043FFFF0, 16, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred reading at 0x043FFFF0");
+	}
+	LogBuffer( inLog, theBuffer, 16 );
+
+	// Past the end of RAM, and flash (not copied in bulk).
+	if (theMem.FastReadBuffer( 0x04400000, 4, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred reading at 0x04400000");
+	}
+	(void) ::memset( theBuffer, 0, sizeof(theBuffer) );
+	if (theMem.FastReadBuffer( TMemoryConsts::kFlashBank1, 8, theBuffer ))
+	{
+		inLog->LogLine("A fault occurred reading the flash");
+	}
+	LogBuffer( inLog, theBuffer, 8 );
+
+	(void) ::unlink( kTempStatePath );
+	(void) ::unlink( kTempFlashPath );
+	::free( romBuffer );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwapCopyTest( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UMemoryTests::SwapCopyTest( TLog* inLog )
+{
+	// Sizes up to a few AVX2 loops, and every alignment of both buffers.
+	const KUInt32 kMaxSize = 288;
+	const KUInt32 kGuard = 16;
+	KUInt8 theSource[kMaxSize + kGuard];
+	KUInt8 theDest[kMaxSize + 2 * kGuard];
+	KUInt32 copyFailures = 0;
+	KUInt32 inPlaceFailures = 0;
+	KUInt32 guardFailures = 0;
+	KUInt32 index;
+	for (index = 0; index < sizeof(theSource); index++)
+	{
+		theSource[index] = (KUInt8) (index * 7 + 3);
+	}
+
+	// Words of the source as the portable code swaps them.
+	KUInt8 theSample[16];
+	(void) USwapCopy::SetKernel( USwapCopy::kScalar );
+	USwapCopy::SwapWords( theSample, theSource, sizeof(theSample) );
+	LogBuffer( inLog, theSample, sizeof(theSample) );
+
+	USwapCopy::EKernel theKernel;
+	for (theKernel = USwapCopy::kScalar;
+		theKernel < USwapCopy::kKernelCount;
+		theKernel = (USwapCopy::EKernel) (theKernel + 1))
+	{
+		if (USwapCopy::SetKernel( theKernel ))
+		{
+			// Not on this host.
+			continue;
+		}
+		KUInt32 theSize;
+		for (theSize = 0; theSize <= kMaxSize; theSize += 4)
+		{
+			KUInt32 srcOffset;
+			KUInt32 dstOffset;
+			for (srcOffset = 0; srcOffset < kGuard; srcOffset++)
+			{
+				for (dstOffset = 0; dstOffset < kGuard; dstOffset++)
+				{
+					(void) ::memset( theDest, 0xA5, sizeof(theDest) );
+					USwapCopy::SwapWords(
+						&theDest[kGuard + dstOffset],
+						&theSource[srcOffset],
+						theSize );
+					for (index = 0; index < theSize; index++)
+					{
+						if (theDest[kGuard + dstOffset + index]
+							!= theSource[srcOffset + (index ^ 0x3)])
+						{
+							copyFailures++;
+							inLog->FLogLine(
+								"%s: copy of %u bytes from +%u to +%u differs",
+								USwapCopy::GetKernelName( theKernel ),
+								(unsigned int) theSize,
+								(unsigned int) srcOffset,
+								(unsigned int) dstOffset );
+							break;
+						}
+					}
+					for (index = 0; index < sizeof(theDest); index++)
+					{
+						if (((index < kGuard + dstOffset)
+							|| (index >= kGuard + dstOffset + theSize))
+							&& (theDest[index] != 0xA5))
+						{
+							guardFailures++;
+							inLog->FLogLine(
+								"%s: copy of %u bytes to +%u writes at %i",
+								USwapCopy::GetKernelName( theKernel ),
+								(unsigned int) theSize,
+								(unsigned int) dstOffset,
+								(int) index - (int) (kGuard + dstOffset) );
+							break;
+						}
+					}
+				}
+			}
+
+			// In place.
+			for (dstOffset = 0; dstOffset < kGuard; dstOffset++)
+			{
+				(void) ::memcpy( &theDest[dstOffset], theSource, theSize );
+				USwapCopy::SwapWords(
+					&theDest[dstOffset], &theDest[dstOffset], theSize );
+				for (index = 0; index < theSize; index++)
+				{
+					if (theDest[dstOffset + index] != theSource[index ^ 0x3])
+					{
+						inPlaceFailures++;
+						inLog->FLogLine(
+							"%s: swap of %u bytes in place at +%u differs",
+							USwapCopy::GetKernelName( theKernel ),
+							(unsigned int) theSize,
+							(unsigned int) dstOffset );
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	inLog->FLogLine( "Copies: %s", copyFailures ? "FAILED" : "ok" );
+	inLog->FLogLine( "Bounds: %s", guardFailures ? "FAILED" : "ok" );
+	inLog->FLogLine( "In place: %s", inPlaceFailures ? "FAILED" : "ok" );
+
+	// Let SwapWords select the best kernel again.
+	theKernel = USwapCopy::kKernelCount;
+	while (theKernel > USwapCopy::kScalar)
+	{
+		theKernel = (USwapCopy::EKernel) (theKernel - 1);
+		if (!USwapCopy::SetKernel( theKernel ))
+		{
+			break;
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * BenchmarkSwapCopy( const char*, TLog* )
+// -------------------------------------------------------------------------- //
+void
+UMemoryTests::BenchmarkSwapCopy( const char* inSize, TLog* inLog )
+{
+	KUInt32 theSize;
+	if (inSize == nil)
+	{
+		(void) ::printf( "This test requires a buffer size in decimal.\n" );
+	} else if ((::sscanf( inSize, "%u", (unsigned int*) &theSize ) != 1)
+		|| (theSize < 4)) {
+		(void) ::printf( "Can't parse buffer size (%s).\n", inSize );
+	} else {
+		// Copy about 1 GB with every kernel.
+		theSize &= ~0x3;
+		KUInt32 theLoops = (1024 * 1024 * 1024) / theSize;
+		if (theLoops == 0)
+		{
+			theLoops = 1;
+		}
+		KUInt8* theSource = (KUInt8*) ::calloc( theSize, 1 );
+		KUInt8* theDest = (KUInt8*) ::calloc( theSize, 1 );
+		USwapCopy::EKernel theBest = USwapCopy::GetKernel();
+		USwapCopy::EKernel theKernel;
+		for (theKernel = USwapCopy::kScalar;
+			theKernel < USwapCopy::kKernelCount;
+			theKernel = (USwapCopy::EKernel) (theKernel + 1))
+		{
+			if (USwapCopy::SetKernel( theKernel ))
+			{
+				continue;
+			}
+			struct timeval theStart;
+			struct timeval theEnd;
+			(void) ::gettimeofday( &theStart, NULL );
+			KUInt32 indexLoop;
+			for (indexLoop = 0; indexLoop < theLoops; indexLoop++)
+			{
+				USwapCopy::SwapWords( theDest, theSource, theSize );
+			}
+			(void) ::gettimeofday( &theEnd, NULL );
+			double theElapsed =
+				(theEnd.tv_sec - theStart.tv_sec)
+				+ (theEnd.tv_usec - theStart.tv_usec) / 1000000.0;
+			double theBytes = ((double) theSize) * theLoops;
+			if (inLog) {
+				inLog->FLogLine(
+					"%s%s: %u x %u bytes, %.3f s, %.0f MB/s",
+					USwapCopy::GetKernelName( theKernel ),
+					(theKernel == theBest) ? " (default)" : "",
+					(unsigned int) theLoops,
+					(unsigned int) theSize,
+					theElapsed,
+					theElapsed > 0 ? theBytes / (1024 * 1024) / theElapsed : 0.0 );
+			}
+		}
+		(void) USwapCopy::SetKernel( theBest );
+		::free( theSource );
+		::free( theDest );
+	}
+}
+
 // ========================================================= //
 // You are in a maze of little twisting passages, all alike. //
 // ========================================================= //
@@ -46,6 +46,30 @@ public:
 	/// Perform flash accesses.
 	///
 	static void FlashTest( TLog* inLog );
+
+	///
+	/// Perform bulk accesses that cross page and permission boundaries.
+	///
+	static void BufferTest( TLog* inLog );
+
+	///
+	/// Restore a state with more RAM than the memory had, and access the
+	/// restored RAM in bulk.
+	///
+	static void RestoreTest( TLog* inLog );
+
+	///
+	/// Compare the byte swapping copy kernels with the portable code, for
+	/// all lengths up to a few vectors and all alignments.
+	///
+	static void SwapCopyTest( TLog* inLog );
+
+	///
+	/// Measure the throughput of the byte swapping copy kernels.
+	///
+	/// \param inSize	size of the buffer in bytes, in decimal.
+	///
+	static void BenchmarkSwapCopy( const char* inSize, TLog* inLog );
 };
 
 #endif
@@ -0,0 +1,839 @@
+// ==============================
+// File:			UNativeKernelTests.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "UNativeKernelTests.h"
+
+// ANSI C & POSIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !TARGET_OS_WIN32
+	#include <unistd.h>
+#endif
+
+// Einstein
+#include "Emulator/Log/TLog.h"
+#include "Emulator/TMemory.h"
+#include "Emulator/TEmulator.h"
+#include "Emulator/TARMProcessor.h"
+#include "Emulator/JIT/Generic/TJITGenericROMPatch.h"
+#include "Emulator/NativeCalls/TNativeKernel.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+#if TARGET_OS_WIN32
+	#define kTempFlashPath "c:/EinsteinTests.flash"
+#else
+	#define kTempFlashPath "/tmp/EinsteinTests.flash"
+#endif
+
+// A user task calls SemaphoreOpGlue with the lists of a table, and the
+// SWI handler calls TSemaphoreGroup::SemOp with the objects.
+static const KUInt32 kTaskCode[] = {
+	0xEA00000E,		// 00: b      40
+	0x00000000,		// 04
+	0xEA00002C,		// 08: b      C0                SWI
+	0x00000000,		// 0C
+	0x00000000,		// 10
+	0x00000000,		// 14
+	0x00000000,		// 18
+	0x00000000,		// 1C
+	0x00000000,		// 20
+	0x00000000,		// 24
+	0x00000000,		// 28
+	0x00000000,		// 2C
+	0x00000000,		// 30
+	0x00000000,		// 34
+	0x00000000,		// 38
+	0x00000000,		// 3C
+	0xE3A0D301,		// 40: mov    sp, #0x04000000
+	0xE28DDA01,		// 44: add    sp, sp, #0x1000   SVC stack
+	0xE3A000D0,		// 48: mov    r0, #0xD0
+	0xE121F000,		// 4C: msr    cpsr_c, r0        user mode
+	0xE3A04301,		// 50: mov    r4, #0x04000000   the objects
+	0xE3A06000,		// 54: mov    r6, #0
+	0xE5940000,		// 58: ldr    r0, [r4]          group id
+	0xE2841080,		// 5C: add    r1, r4, #0x80
+	0xE7911106,		// 60: ldr    r1, [r1, r6, lsl #2]
+	0xE3A02000,		// 64: mov    r2, #0            don't block
+	0xEB0EB863,		// 68: bl     003AE1FC          SemaphoreOpGlue
+	0xE2841C01,		// 6C: add    r1, r4, #0x100
+	0xE7810106,		// 70: str    r0, [r1, r6, lsl #2]
+	0xE2866001,		// 74: add    r6, r6, #1
+	0xE3560005,		// 78: cmp    r6, #5
+	0x1AFFFFF5,		// 7C: bne    58
+	0xE1200070,		// 80: bkpt   0
+	0x00000000,		// 84
+	0x00000000,		// 88
+	0x00000000,		// 8C
+	0x00000000,		// 90
+	0x00000000,		// 94
+	0x00000000,		// 98
+	0x00000000,		// 9C
+	0x00000000,		// A0
+	0x00000000,		// A4
+	0x00000000,		// A8
+	0x00000000,		// AC
+	0x00000000,		// B0
+	0x00000000,		// B4
+	0x00000000,		// B8
+	0x00000000,		// BC
+	0xE92D4010,		// C0: stmdb  sp!, {r4, lr}
+	0xE3A04301,		// C4: mov    r4, #0x04000000
+	0xE5940200,		// C8: ldr    r0, [r4, #512]    count the calls
+	0xE2800001,		// CC: add    r0, r0, #1
+	0xE5840200,		// D0: str    r0, [r4, #512]
+	0xE1A00004,		// D4: mov    r0, r4            the group
+	0xE5942020,		// D8: ldr    r2, [r4, #32]
+	0xE1520001,		// DC: cmp    r2, r1
+	0x02841020,		// E0: addeq  r1, r4, #0x20     the first list
+	0x12841040,		// E4: addne  r1, r4, #0x40     or the second one
+	0xEB075392,		// E8: bl     001D4F38          SemOp
+	0xE8BD4010,		// EC: ldmia  sp!, {r4, lr}
+	0xE1B0F00E,		// F0: movs   pc, lr
+};
+
+// TSemaphoreGroup::SemOp, for a list of one operation that doesn't block.
+static const KUInt32 kSemOpCode[] = {
+	0xE5912014,		// 00: ldr    r2, [r1, #20]     fOpList
+	0xE5922000,		// 04: ldr    r2, [r2]
+	0xE1A03802,		// 08: mov    r3, r2, lsl #16
+	0xE1A03843,		// 0C: mov    r3, r3, asr #16   op
+	0xE1A02822,		// 10: mov    r2, r2, lsr #16   num
+	0xE590C014,		// 14: ldr    r12, [r0, #20]    fGroup
+	0xE0822102,		// 18: add    r2, r2, r2, lsl #2
+	0xE08CC102,		// 1C: add    r12, r12, r2, lsl #2
+	0xE59C2000,		// 20: ldr    r2, [r12]         fVal
+	0xE0922003,		// 24: adds   r2, r2, r3
+	0x43E00000,		// 28: mvnmi  r0, #0            would block
+	0x558C2000,		// 2C: strpl  r2, [r12]
+	0x53A00000,		// 30: movpl  r0, #0
+	0xE1A0F00E,		// 34: mov    pc, lr
+};
+
+// _SemaphoreOpGlue.
+static const KUInt32 kSemaphoreOpGlueCode[] = {
+	0xEF00000B,		// 00: swi    0x0000000B
+	0xE1A0F00E,		// 04: mov    pc, lr
+};
+
+const KUInt32 kSemOp = 0x001D4F38;
+const KUInt32 kSemaphoreOpGlue = 0x003AE1FC;
+const KUInt32 kObjects = 0x04000000;		///< The group, at +00.
+const KUInt32 kFirstList = kObjects + 0x20;	///< Decrement.
+const KUInt32 kSecondList = kObjects + 0x40;	///< Increment.
+const KUInt32 kSemaphores = kObjects + 0x60;
+const KUInt32 kOps = kObjects + 0x78;
+const KUInt32 kCalls = kObjects + 0x80;		///< Lists of the calls.
+const KUInt32 kResults = kObjects + 0x100;	///< Results of the calls.
+const KUInt32 kKernelCalls = kObjects + 0x200;
+const KUInt32 kNbCalls = 5;
+
+// -------------------------------------------------------------------------- //
+//  * Semaphores( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UNativeKernelTests::Semaphores( TLog* inLog )
+{
+	int indexRun;
+	for (indexRun = 0; indexRun < 2; indexRun++)
+	{
+		TNativeKernel::SetFastPaths( indexRun == 1 );
+		KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+		(void) ::memcpy( rom, kTaskCode, sizeof(kTaskCode) );
+		(void) ::memcpy( rom + kSemOp, kSemOpCode, sizeof(kSemOpCode) );
+		(void) ::memcpy(
+			rom + kSemaphoreOpGlue,
+			kSemaphoreOpGlueCode,
+			sizeof(kSemaphoreOpGlueCode) );
+		TJITGenericROMPatch::FindByName( "SemaphoreOpGlue" )->applyAt(
+			(KUInt32*) rom, kSemaphoreOpGlue >> 2 );
+		TJITGenericROMPatch::FindByName(
+			"SemOp__15TSemaphoreGroupFP16TSemaphoreOpList8SemFlagsP5TTask" )
+				->applyAt( (KUInt32*) rom, kSemOp >> 2 );
+
+		TEmulator theEmulator(inLog, rom, kTempFlashPath);
+		TMemory* theMemory = theEmulator.GetMemory();
+
+		// A group of one semaphore, at 2, and two lists.
+		(void) theMemory->Write( kObjects, 0x00010045 );
+		(void) theMemory->Write( kObjects + 0x10, 1 );
+		(void) theMemory->Write( kObjects + 0x14, kSemaphores );
+		(void) theMemory->Write( kFirstList, 0x00010064 );
+		(void) theMemory->Write( kFirstList + 0x10, 1 );
+		(void) theMemory->Write( kFirstList + 0x14, kOps );
+		(void) theMemory->Write( kSecondList, 0x00010074 );
+		(void) theMemory->Write( kSecondList + 0x10, 1 );
+		(void) theMemory->Write( kSecondList + 0x14, kOps + 4 );
+		(void) theMemory->Write( kSemaphores, 2 );
+		(void) theMemory->Write( kOps, 0x0000FFFF );		// 0, -1
+		(void) theMemory->Write( kOps + 4, 0x00000001 );	// 0, +1
+
+		// Take it twice, fail, give it back and take it again.
+		const KUInt32 theCalls[kNbCalls] = {
+			0x00010064, 0x00010064, 0x00010064, 0x00010074, 0x00010064 };
+		KUInt32 indexCall;
+		for (indexCall = 0; indexCall < kNbCalls; indexCall++)
+		{
+			(void) theMemory->Write( kCalls + (4 * indexCall), theCalls[indexCall] );
+		}
+
+		theEmulator.Run();
+
+		KUInt32 theResults[kNbCalls];
+		for (indexCall = 0; indexCall < kNbCalls; indexCall++)
+		{
+			(void) theMemory->Read( kResults + (4 * indexCall), theResults[indexCall] );
+		}
+		KUInt32 theValue;
+		(void) theMemory->Read( kSemaphores, theValue );
+		KUInt32 theKernelCalls;
+		(void) theMemory->Read( kKernelCalls, theKernelCalls );
+		TNativeKernel* theKernel = theEmulator.GetNativeKernel();
+		if (inLog) {
+			inLog->FLogLine(
+				"%s fast paths: results %.8X %.8X %.8X %.8X %.8X, value %u",
+				indexRun ? "With" : "Without",
+				(unsigned int) theResults[0],
+				(unsigned int) theResults[1],
+				(unsigned int) theResults[2],
+				(unsigned int) theResults[3],
+				(unsigned int) theResults[4],
+				(unsigned int) theValue );
+			inLog->FLogLine(
+				"%u SWIs, %u calls through the kernel, %u on the host",
+				(unsigned int) theKernelCalls,
+				(unsigned int) theKernel->GetKernelCallCount(),
+				(unsigned int) theKernel->GetFastPathCount() );
+		}
+		(void) ::unlink( kTempFlashPath );
+		::free( rom );
+	}
+	TNativeKernel::SetFastPaths( false );
+}
+
+// A task touches four pages three times, and ForgetMapping unmaps them
+// after each round. The abort handler maps the pages from a table.
+static const KUInt32 kPageFaultCode[] = {
+	0xEA00000E,		// 00: b      40
+	0x00000000,		// 04
+	0x00000000,		// 08
+	0x00000000,		// 0C
+	0xEA00002A,		// 10: b      C0                Data abort
+	0x00000000,		// 14
+	0x00000000,		// 18
+	0x00000000,		// 1C
+	0x00000000,		// 20
+	0x00000000,		// 24
+	0x00000000,		// 28
+	0x00000000,		// 2C
+	0x00000000,		// 30
+	0x00000000,		// 34
+	0x00000000,		// 38
+	0x00000000,		// 3C
+	0xE3A000D7,		// 40: mov    r0, #0xD7
+	0xE121F000,		// 44: msr    cpsr_c, r0        abort mode
+	0xE3A0D301,		// 48: mov    sp, #0x04000000
+	0xE28DDA02,		// 4C: add    sp, sp, #0x2000   abort stack
+	0xE3A000D3,		// 50: mov    r0, #0xD3
+	0xE121F000,		// 54: msr    cpsr_c, r0        supervisor mode
+	0xE3A0D301,		// 58: mov    sp, #0x04000000
+	0xE28DDA01,		// 5C: add    sp, sp, #0x1000   SVC stack
+	0xE3A04201,		// 60: mov    r4, #0x10000000   the pages
+	0xE3A05000,		// 64: mov    r5, #0
+	0xE3A06000,		// 68: mov    r6, #0
+	0xE7940606,		// 6C: ldr    r0, [r4, r6, lsl #12]
+	0xE2800001,		// 70: add    r0, r0, #1
+	0xE7840606,		// 74: str    r0, [r4, r6, lsl #12]
+	0xE2866001,		// 78: add    r6, r6, #1
+	0xE3560004,		// 7C: cmp    r6, #4
+	0x1AFFFFF9,		// 80: bne    6C
+	0xE3A06000,		// 84: mov    r6, #0
+	0xE0840606,		// 88: add    r0, r4, r6, lsl #12
+	0xEB0471FB,		// 8C: bl     0011C880          ForgetMapping
+	0xE2866001,		// 90: add    r6, r6, #1
+	0xE3560004,		// 94: cmp    r6, #4
+	0x1AFFFFFA,		// 98: bne    88
+	0xE2855001,		// 9C: add    r5, r5, #1
+	0xE3550003,		// A0: cmp    r5, #3
+	0x1AFFFFEF,		// A4: bne    68
+	0xE1200070,		// A8: bkpt   0
+	0x00000000,		// AC
+	0x00000000,		// B0
+	0x00000000,		// B4
+	0x00000000,		// B8
+	0x00000000,		// BC
+	0xE92D000F,		// C0: stmdb  sp!, {r0-r3}
+	0xE3A03301,		// C4: mov    r3, #0x04000000
+	0xE5930200,		// C8: ldr    r0, [r3, #512]    count the aborts
+	0xE2800001,		// CC: add    r0, r0, #1
+	0xE5830200,		// D0: str    r0, [r3, #512]
+	0xEE160F10,		// D4: mrc    p15, 0, r0, c6, c0, 0
+	0xE1A01620,		// D8: mov    r1, r0, lsr #12
+	0xE20110FF,		// DC: and    r1, r1, #0xFF
+	0xE2832601,		// E0: add    r2, r3, #0x100000
+	0xE0822601,		// E4: add    r2, r2, r1, lsl #12
+	0xE3822EFF,		// E8: orr    r2, r2, #0xFF0    read/write
+	0xE3822002,		// EC: orr    r2, r2, #0x2      small page
+	0xE2830801,		// F0: add    r0, r3, #0x10000  second level table
+	0xE7802101,		// F4: str    r2, [r0, r1, lsl #2]
+	0xE8BD000F,		// F8: ldmia  sp!, {r0-r3}
+	0xE25EF008,		// FC: subs   pc, lr, #8
+};
+
+// ForgetMapping, for the virtual address of a page.
+static const KUInt32 kForgetMappingCode[] = {
+	0xE1A01620,		// 00: mov    r1, r0, lsr #12
+	0xE20110FF,		// 04: and    r1, r1, #0xFF
+	0xE3A02301,		// 08: mov    r2, #0x04000000
+	0xE2822801,		// 0C: add    r2, r2, #0x10000
+	0xE3A03000,		// 10: mov    r3, #0
+	0xE7823101,		// 14: str    r3, [r2, r1, lsl #2]
+	0xEE080F17,		// 18: mcr    p15, 0, r0, c8, c7, 0
+	0xE1A0F00E,		// 1C: mov    pc, lr
+};
+
+const KUInt32 kDataAbortVector = 0x00000010;
+const KUInt32 kForgetMapping = 0x0011C880;
+const KUInt32 kTranslationTable = 0x04004000;
+const KUInt32 kPageTable = 0x04010000;		///< For 0x10000000.
+const KUInt32 kPhysicalPages = 0x04100000;
+const KUInt32 kAborts = 0x04000200;
+const KUInt32 kNbPages = 4;
+
+// -------------------------------------------------------------------------- //
+//  * PageFaults( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UNativeKernelTests::PageFaults( TLog* inLog )
+{
+	int indexRun;
+	for (indexRun = 0; indexRun < 2; indexRun++)
+	{
+		TNativeKernel::SetPageFaults( indexRun == 1 );
+		KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+		(void) ::memcpy( rom, kPageFaultCode, sizeof(kPageFaultCode) );
+		(void) ::memcpy(
+			rom + kForgetMapping,
+			kForgetMappingCode,
+			sizeof(kForgetMappingCode) );
+		TJITGenericROMPatch::FindByName( "_AbortData" )->applyAt(
+			(KUInt32*) rom, kDataAbortVector >> 2 );
+		TJITGenericROMPatch::FindByName( "ForgetMapping__FUlN21" )->applyAt(
+			(KUInt32*) rom, kForgetMapping >> 2 );
+
+		TEmulator theEmulator(inLog, rom, kTempFlashPath);
+		TMemory* theMemory = theEmulator.GetMemory();
+
+		// The ROM and the RAM in sections, and a coarse table for
+		// 0x10000000 with no page.
+		(void) theMemory->WriteP( kTranslationTable + (0x000 * 4), 0x00000C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x040 * 4), 0x04000C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x100 * 4), kPageTable | 0x1 );
+		theMemory->SetTranslationTableBase( kTranslationTable );
+		theMemory->SetDomainAccessControl( 0x00000001 );
+		theMemory->SetPrivilege( true );
+		theMemory->SetMMUEnabled( true );
+
+		theEmulator.Run();
+
+		KUInt32 theValues[kNbPages];
+		KUInt32 indexPage;
+		for (indexPage = 0; indexPage < kNbPages; indexPage++)
+		{
+			Boolean theFault = false;
+			theValues[indexPage] = theMemory->ReadP(
+				kPhysicalPages + (indexPage * 0x1000), theFault );
+		}
+		Boolean theFault = false;
+		KUInt32 theAborts = theMemory->ReadP( kAborts, theFault );
+		TNativeKernel* theKernel = theEmulator.GetNativeKernel();
+		if (inLog) {
+			inLog->FLogLine(
+				"%s fast paths: pages %u %u %u %u",
+				indexRun ? "With" : "Without",
+				(unsigned int) theValues[0],
+				(unsigned int) theValues[1],
+				(unsigned int) theValues[2],
+				(unsigned int) theValues[3] );
+			inLog->FLogLine(
+				"%u aborts, %u faults through the kernel, %u on the host",
+				(unsigned int) theAborts,
+				(unsigned int) theKernel->GetKernelCallCount(),
+				(unsigned int) theKernel->GetFastPathCount() );
+		}
+		(void) ::unlink( kTempFlashPath );
+		::free( rom );
+	}
+	TNativeKernel::SetPageFaults( false );
+}
+
+// A task makes a call that may block and yields with DoSchedulerSWI, for
+// priority masks of a table. The SWI handler calls Scheduler at its exit.
+static const KUInt32 kSchedulerTaskCode[] = {
+	0xEA00000E,		// 00: b      40
+	0x00000000,		// 04
+	0xEA00002C,		// 08: b      C0                SWI
+	0x00000000,		// 0C
+	0x00000000,		// 10
+	0x00000000,		// 14
+	0x00000000,		// 18
+	0x00000000,		// 1C
+	0x00000000,		// 20
+	0x00000000,		// 24
+	0x00000000,		// 28
+	0x00000000,		// 2C
+	0x00000000,		// 30
+	0x00000000,		// 34
+	0x00000000,		// 38
+	0x00000000,		// 3C
+	0xE3A0D301,		// 40: mov    sp, #0x04000000
+	0xE28DDA01,		// 44: add    sp, sp, #0x1000   SVC stack
+	0xE3A000D0,		// 48: mov    r0, #0xD0
+	0xE121F000,		// 4C: msr    cpsr_c, r0        user mode
+	0xE3A04301,		// 50: mov    r4, #0x04000000   the scheduler
+	0xE3A06000,		// 54: mov    r6, #0
+	0xE2841C02,		// 58: add    r1, r4, #0x200
+	0xE7911106,		// 5C: ldr    r1, [r1, r6, lsl #2]
+	0xE5841010,		// 60: str    r1, [r4, #0x10]   fPriorityMask
+	0xE2840D0A,		// 64: add    r0, r4, #0x280
+	0xE7900106,		// 68: ldr    r0, [r0, r6, lsl #2]
+	0xEF000001,		// 6C: swi    0x00000001        a call that may block
+	0xE3A00000,		// 70: mov    r0, #0
+	0xEB0EB577,		// 74: bl     003AD658          DoSchedulerSWI
+	0xE2866001,		// 78: add    r6, r6, #1
+	0xE3560006,		// 7C: cmp    r6, #6
+	0x1AFFFFF4,		// 80: bne    58
+	0xE1200070,		// 84: bkpt   0
+	0x00000000,		// 88
+	0x00000000,		// 8C
+	0x00000000,		// 90
+	0x00000000,		// 94
+	0x00000000,		// 98
+	0x00000000,		// 9C
+	0x00000000,		// A0
+	0x00000000,		// A4
+	0x00000000,		// A8
+	0x00000000,		// AC
+	0x00000000,		// B0
+	0x00000000,		// B4
+	0x00000000,		// B8
+	0x00000000,		// BC
+	0xE92D4010,		// C0: stmdb  sp!, {r4, lr}
+	0xE3A04301,		// C4: mov    r4, #0x04000000
+	0xE5942300,		// C8: ldr    r2, [r4, #0x300]  count the SWIs
+	0xE2822001,		// CC: add    r2, r2, #1
+	0xE5842300,		// D0: str    r2, [r4, #0x300]
+	0xE3500000,		// D4: cmp    r0, #0            block the task?
+	0x11A00004,		// D8: movne  r0, r4
+	0x12841C01,		// DC: addne  r1, r4, #0x100    the current task
+	0x1B073144,		// E0: blne   001CC5F8          TScheduler::Remove
+	0xEB073040,		// E4: bl     001CC1EC          Scheduler, at the exit
+	0xE3A00000,		// E8: mov    r0, #0
+	0xE8BD4010,		// EC: ldmia  sp!, {r4, lr}
+	0xE1B0F00E,		// F0: movs   pc, lr
+};
+
+// Scheduler, that counts a switch when a task of the same or a higher
+// priority is ready or when the current task is blocked.
+static const KUInt32 kSchedulerCode[] = {
+	0xE92D4000,		// 00: stmdb  sp!, {lr}
+	0xE3A0C301,		// 04: mov    r12, #0x04000000
+	0xE59C0308,		// 08: ldr    r0, [r12, #0x308] count the runs
+	0xE2800001,		// 0C: add    r0, r0, #1
+	0xE58C0308,		// 10: str    r0, [r12, #0x308]
+	0xE28C1C01,		// 14: add    r1, r12, #0x100   the current task
+	0xE591200C,		// 18: ldr    r2, [r1, #0x0C]   blocked
+	0xE59C0010,		// 1C: ldr    r0, [r12, #0x10]  fPriorityMask
+	0xE5913074,		// 20: ldr    r3, [r1, #0x74]   fPriority
+	0xE1920330,		// 24: orrs   r0, r2, r0, lsr r3
+	0x159C0304,		// 28: ldrne  r0, [r12, #0x304] count the switches
+	0x12800001,		// 2C: addne  r0, r0, #1
+	0x158C0304,		// 30: strne  r0, [r12, #0x304]
+	0xE3520000,		// 34: cmp    r2, #0
+	0x1B0000CE,		// 38: blne   001CC564          TScheduler::Add, the task is ready again
+	0xE8BD8000,		// 3C: ldmia  sp!, {pc}
+};
+
+// TScheduler::Add and TScheduler::Remove, for the current task.
+static const KUInt32 kAddCode[] = {
+	0xE3A02000,		// 00: mov    r2, #0
+	0xE581200C,		// 04: str    r2, [r1, #0x0C]
+	0xE1A0F00E,		// 08: mov    pc, lr
+};
+
+static const KUInt32 kRemoveCode[] = {
+	0xE3A02001,		// 00: mov    r2, #1
+	0xE581200C,		// 04: str    r2, [r1, #0x0C]
+	0xE1A0F00E,		// 08: mov    pc, lr
+};
+
+// _DoSchedulerSWI.
+static const KUInt32 kDoSchedulerSWICode[] = {
+	0xEF000000,		// 00: swi    0x00000000
+	0xE1A0F00E,		// 04: mov    pc, lr
+};
+
+const KUInt32 kScheduler = 0x001CC1EC;
+const KUInt32 kAdd = 0x001CC564;
+const KUInt32 kRemove = 0x001CC5F8;
+const KUInt32 kDoSchedulerSWI = 0x003AD658;
+const KUInt32 kKernelScheduler = 0x04000000;
+const KUInt32 kCurrentTask = kKernelScheduler + 0x100;
+const KUInt32 kMasks = kKernelScheduler + 0x200;
+const KUInt32 kBlocks = kKernelScheduler + 0x280;
+const KUInt32 kSWIs = kKernelScheduler + 0x300;
+const KUInt32 kSwitches = kKernelScheduler + 0x304;
+const KUInt32 kSchedulerRuns = kKernelScheduler + 0x308;
+const KUInt32 kKernelGlobals = 0x04100000;	///< For 0x0C100000.
+const KUInt32 kNbYields = 6;
+
+// -------------------------------------------------------------------------- //
+//  * Scheduler( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UNativeKernelTests::Scheduler( TLog* inLog )
+{
+	int indexRun;
+	for (indexRun = 0; indexRun < 2; indexRun++)
+	{
+		TNativeKernel::SetFastPaths( indexRun == 1 );
+		KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+		(void) ::memcpy( rom, kSchedulerTaskCode, sizeof(kSchedulerTaskCode) );
+		(void) ::memcpy( rom + kScheduler, kSchedulerCode, sizeof(kSchedulerCode) );
+		(void) ::memcpy( rom + kAdd, kAddCode, sizeof(kAddCode) );
+		(void) ::memcpy( rom + kRemove, kRemoveCode, sizeof(kRemoveCode) );
+		(void) ::memcpy(
+			rom + kDoSchedulerSWI,
+			kDoSchedulerSWICode,
+			sizeof(kDoSchedulerSWICode) );
+		TJITGenericROMPatch::FindByName( "Scheduler" )->applyAt(
+			(KUInt32*) rom, kScheduler >> 2 );
+		TJITGenericROMPatch::FindByName( "Add__10TSchedulerFP5TTask" )->applyAt(
+			(KUInt32*) rom, kAdd >> 2 );
+		TJITGenericROMPatch::FindByName( "Remove__10TSchedulerFP5TTask" )->applyAt(
+			(KUInt32*) rom, kRemove >> 2 );
+		TJITGenericROMPatch::FindByName( "DoSchedulerSWI" )->applyAt(
+			(KUInt32*) rom, kDoSchedulerSWI >> 2 );
+
+		TEmulator theEmulator(inLog, rom, kTempFlashPath);
+		TMemory* theMemory = theEmulator.GetMemory();
+
+		// The ROM, the RAM and the kernel globals in sections.
+		(void) theMemory->WriteP( kTranslationTable + (0x000 * 4), 0x00000C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x001 * 4), 0x00100C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x003 * 4), 0x00300C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x040 * 4), 0x04000C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x0C1 * 4), kKernelGlobals | 0xC12 );
+		theMemory->SetTranslationTableBase( kTranslationTable );
+		theMemory->SetDomainAccessControl( 0x00000001 );
+		theMemory->SetPrivilege( true );
+		theMemory->SetMMUEnabled( true );
+
+		// The scheduler and the current task, of priority 20.
+		(void) theMemory->WriteP(
+			kKernelGlobals + (TNativeKernel::kKernelSchedulerGlobal & 0xFFFFF),
+			kKernelScheduler );
+		(void) theMemory->WriteP(
+			kKernelGlobals + (TNativeKernel::kHoldScheduleLevelGlobal & 0xFFFFF),
+			0 );
+		(void) theMemory->WriteP(
+			kKernelGlobals + (TNativeKernel::kCurrentTaskGlobal & 0xFFFFF),
+			kCurrentTask );
+		(void) theMemory->WriteP(
+			kCurrentTask + TNativeKernel::kTaskPriorityOffset, 20 );
+
+		// Nothing ready, lower, the same and a higher priority ready, the
+		// task blocked and nothing ready again.
+		const KUInt32 theMasks[kNbYields] = {
+			0, 1 << 10, 1 << 20, 1 << 25, 0, 0 };
+		const KUInt32 theBlocks[kNbYields] = { 0, 0, 0, 0, 1, 0 };
+		KUInt32 indexYield;
+		for (indexYield = 0; indexYield < kNbYields; indexYield++)
+		{
+			(void) theMemory->WriteP( kMasks + (4 * indexYield), theMasks[indexYield] );
+			(void) theMemory->WriteP( kBlocks + (4 * indexYield), theBlocks[indexYield] );
+		}
+
+		theEmulator.Run();
+
+		Boolean theFault = false;
+		KUInt32 theSWIs = theMemory->ReadP( kSWIs, theFault );
+		KUInt32 theSwitches = theMemory->ReadP( kSwitches, theFault );
+		KUInt32 theRuns = theMemory->ReadP( kSchedulerRuns, theFault );
+		TNativeKernel* theKernel = theEmulator.GetNativeKernel();
+		if (inLog) {
+			inLog->FLogLine(
+				"%s fast paths: %u switches",
+				indexRun ? "With" : "Without",
+				(unsigned int) theSwitches );
+			inLog->FLogLine(
+				"%u SWIs, %u scheduler runs, %u calls through the kernel, %u on the host",
+				(unsigned int) theSWIs,
+				(unsigned int) theRuns,
+				(unsigned int) theKernel->GetKernelCallCount(),
+				(unsigned int) theKernel->GetFastPathCount() );
+		}
+		(void) ::unlink( kTempFlashPath );
+		::free( rom );
+	}
+	TNativeKernel::SetFastPaths( false );
+}
+
+// Task A makes task B ready and both yield with DoSchedulerSWI, until task
+// A blocks with a SWI. The SWI handler saves the registers of the current
+// task in its TTask, calls Scheduler and loads those of the new current
+// task.
+static const KUInt32 kTaskSwitchCode[] = {
+	0xEA00000E,		// 00: b      40
+	0x00000000,		// 04
+	0xEA00003C,		// 08: b      100               SWI
+	0x00000000,		// 0C
+	0x00000000,		// 10
+	0x00000000,		// 14
+	0x00000000,		// 18
+	0x00000000,		// 1C
+	0x00000000,		// 20
+	0x00000000,		// 24
+	0x00000000,		// 28
+	0x00000000,		// 2C
+	0x00000000,		// 30
+	0x00000000,		// 34
+	0x00000000,		// 38
+	0x00000000,		// 3C
+	0xE3A0D301,		// 40: mov    sp, #0x04000000
+	0xE28DDA01,		// 44: add    sp, sp, #0x1000   SVC stack
+	0xE3A000D0,		// 48: mov    r0, #0xD0
+	0xE121F000,		// 4C: msr    cpsr_c, r0        user mode, task A
+	0xE3A00301,		// 50: mov    r0, #0x04000000
+	0xE2801C02,		// 54: add    r1, r0, #0x200
+	0xEB073141,		// 58: bl     001CC564          TScheduler::Add, task B
+	0xE3A05000,		// 5C: mov    r5, #0
+	0xE28500A0,		// 60: add    r0, r5, #0xA0
+	0xEB00001D,		// 64: bl     E0                Trace
+	0xE3A00000,		// 68: mov    r0, #0
+	0xEB0EB579,		// 6C: bl     003AD658          DoSchedulerSWI
+	0xE2855001,		// 70: add    r5, r5, #1
+	0xE3550003,		// 74: cmp    r5, #3
+	0x1AFFFFF8,		// 78: bne    60
+	0xE3A00001,		// 7C: mov    r0, #1
+	0xEF000001,		// 80: swi    0x00000001        block task A
+	0xE1200070,		// 84: bkpt   0
+	0xE28500B0,		// 88: add    r0, r5, #0xB0     task B
+	0xEB000013,		// 8C: bl     E0                Trace
+	0xE2855001,		// 90: add    r5, r5, #1
+	0xE3550004,		// 94: cmp    r5, #4
+	0x0A000002,		// 98: beq    A8
+	0xE3A00000,		// 9C: mov    r0, #0
+	0xEB0EB56C,		// A0: bl     003AD658          DoSchedulerSWI
+	0xEAFFFFF7,		// A4: b      88
+	0xE1200070,		// A8: bkpt   0
+	0x00000000,		// AC
+	0x00000000,		// B0
+	0x00000000,		// B4
+	0x00000000,		// B8
+	0x00000000,		// BC
+	0x00000000,		// C0
+	0x00000000,		// C4
+	0x00000000,		// C8
+	0x00000000,		// CC
+	0x00000000,		// D0
+	0x00000000,		// D4
+	0x00000000,		// D8
+	0x00000000,		// DC
+	0xE3A03301,		// E0: mov    r3, #0x04000000   Trace
+	0xE5932300,		// E4: ldr    r2, [r3, #0x300]
+	0xE4820004,		// E8: str    r0, [r2], #4
+	0xE5832300,		// EC: str    r2, [r3, #0x300]
+	0xE1A0F00E,		// F0: mov    pc, lr
+	0x00000000,		// F4
+	0x00000000,		// F8
+	0x00000000,		// FC
+	0xE92D0001,		// 100: stmdb  sp!, {r0}
+	0xE3A00303,		// 104: mov    r0, #0x0C000000
+	0xE3800601,		// 108: orr    r0, r0, #0x100000
+	0xE3800C0F,		// 10C: orr    r0, r0, #0xF00
+	0xE38000F8,		// 110: orr    r0, r0, #0xF8     gCurrentTask
+	0xE5900000,		// 114: ldr    r0, [r0]
+	0xE2800010,		// 118: add    r0, r0, #0x10     fRegister
+	0xE8C07FFF,		// 11C: stmia  r0, {r0-r14}^
+	0xE8BD0020,		// 120: ldmia  sp!, {r5}
+	0xE5805000,		// 124: str    r5, [r0]
+	0xE580E03C,		// 128: str    lr, [r0, #0x3C]
+	0xE14F1000,		// 12C: mrs    r1, spsr
+	0xE5801040,		// 130: str    r1, [r0, #0x40]   fPSR
+	0xE3A04301,		// 134: mov    r4, #0x04000000
+	0xE5942400,		// 138: ldr    r2, [r4, #0x400]  count the SWIs
+	0xE2822001,		// 13C: add    r2, r2, #1
+	0xE5842400,		// 140: str    r2, [r4, #0x400]
+	0xE3550000,		// 144: cmp    r5, #0            block the task?
+	0x12401010,		// 148: subne  r1, r0, #0x10
+	0x1B073129,		// 14C: blne   001CC5F8          TScheduler::Remove
+	0xEB073025,		// 150: bl     001CC1EC          Scheduler, at the exit
+	0xE3A00303,		// 154: mov    r0, #0x0C000000
+	0xE3800601,		// 158: orr    r0, r0, #0x100000
+	0xE3800C0F,		// 15C: orr    r0, r0, #0xF00
+	0xE38000F8,		// 160: orr    r0, r0, #0xF8
+	0xE5900000,		// 164: ldr    r0, [r0]
+	0xE280D010,		// 168: add    sp, r0, #0x10
+	0xE59D1040,		// 16C: ldr    r1, [sp, #0x40]
+	0xE16FF001,		// 170: msr    spsr_cxsf, r1
+	0xE59DE03C,		// 174: ldr    lr, [sp, #0x3C]
+	0xE8DD7FFF,		// 178: ldmia  sp, {r0-r14}^
+	0xE1A00000,		// 17C: nop
+	0xE3A0D301,		// 180: mov    sp, #0x04000000
+	0xE28DDA01,		// 184: add    sp, sp, #0x1000
+	0xE1B0F00E,		// 188: movs   pc, lr
+};
+
+// Scheduler, that makes the other task current unless it blocked.
+static const KUInt32 kRoundRobinCode[] = {
+	0xE3A00303,		// 00: mov    r0, #0x0C000000
+	0xE3800601,		// 04: orr    r0, r0, #0x100000
+	0xE3800C0F,		// 08: orr    r0, r0, #0xF00
+	0xE38000F8,		// 0C: orr    r0, r0, #0xF8     gCurrentTask
+	0xE5901000,		// 10: ldr    r1, [r0]
+	0xE3A02301,		// 14: mov    r2, #0x04000000
+	0xE2823C01,		// 18: add    r3, r2, #0x100    task A
+	0xE1510003,		// 1C: cmp    r1, r3
+	0x02823C02,		// 20: addeq  r3, r2, #0x200    or task B
+	0xE593200C,		// 24: ldr    r2, [r3, #0x0C]
+	0xE3520000,		// 28: cmp    r2, #0            the other one, unless it blocked
+	0x05803000,		// 2C: streq  r3, [r0]
+	0xE1A0F00E,		// 30: mov    pc, lr
+};
+
+const KUInt32 kTaskA = 0x04000100;
+const KUInt32 kTaskB = 0x04000200;
+const KUInt32 kTaskBEntry = 0x00000088;
+const KUInt32 kTrace = 0x04000300;			///< Pointer, then the trace.
+const KUInt32 kTaskSwitchSWIs = 0x04000400;
+const KUInt32 kTaskPriority = 20;
+const KUInt32 kMaxTrace = 8;
+
+// -------------------------------------------------------------------------- //
+//  * TaskSwitch( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UNativeKernelTests::TaskSwitch( TLog* inLog )
+{
+	int indexRun;
+	for (indexRun = 0; indexRun < 2; indexRun++)
+	{
+		TNativeKernel::SetNativeScheduler( indexRun == 1 );
+		KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+		(void) ::memcpy( rom, kTaskSwitchCode, sizeof(kTaskSwitchCode) );
+		(void) ::memcpy( rom + kScheduler, kRoundRobinCode, sizeof(kRoundRobinCode) );
+		(void) ::memcpy( rom + kAdd, kAddCode, sizeof(kAddCode) );
+		(void) ::memcpy( rom + kRemove, kRemoveCode, sizeof(kRemoveCode) );
+		(void) ::memcpy(
+			rom + kDoSchedulerSWI,
+			kDoSchedulerSWICode,
+			sizeof(kDoSchedulerSWICode) );
+		TJITGenericROMPatch::FindByName( "Scheduler" )->applyAt(
+			(KUInt32*) rom, kScheduler >> 2 );
+		TJITGenericROMPatch::FindByName( "Add__10TSchedulerFP5TTask" )->applyAt(
+			(KUInt32*) rom, kAdd >> 2 );
+		TJITGenericROMPatch::FindByName( "Remove__10TSchedulerFP5TTask" )->applyAt(
+			(KUInt32*) rom, kRemove >> 2 );
+		TJITGenericROMPatch::FindByName( "DoSchedulerSWI" )->applyAt(
+			(KUInt32*) rom, kDoSchedulerSWI >> 2 );
+
+		TEmulator theEmulator(inLog, rom, kTempFlashPath);
+		TMemory* theMemory = theEmulator.GetMemory();
+
+		// The ROM, the RAM and the kernel globals in sections.
+		(void) theMemory->WriteP( kTranslationTable + (0x000 * 4), 0x00000C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x001 * 4), 0x00100C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x003 * 4), 0x00300C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x040 * 4), 0x04000C12 );
+		(void) theMemory->WriteP( kTranslationTable + (0x0C1 * 4), kKernelGlobals | 0xC12 );
+		theMemory->SetTranslationTableBase( kTranslationTable );
+		theMemory->SetDomainAccessControl( 0x00000001 );
+		theMemory->SetPrivilege( true );
+		theMemory->SetMMUEnabled( true );
+
+		// Task A runs, task B starts at its entry in user mode.
+		(void) theMemory->WriteP(
+			kKernelGlobals + (TNativeKernel::kHoldScheduleLevelGlobal & 0xFFFFF),
+			0 );
+		(void) theMemory->WriteP(
+			kKernelGlobals + (TNativeKernel::kCurrentTaskGlobal & 0xFFFFF),
+			kTaskA );
+		(void) theMemory->WriteP(
+			kTaskA + TNativeKernel::kTaskPriorityOffset, kTaskPriority );
+		(void) theMemory->WriteP(
+			kTaskB + TNativeKernel::kTaskPriorityOffset, kTaskPriority );
+		(void) theMemory->WriteP(
+			kTaskB + TNativeKernel::kTaskRegistersOffset + (4 * 15),
+			kTaskBEntry );
+		(void) theMemory->WriteP(
+			kTaskB + TNativeKernel::kTaskPSROffset,
+			TARMProcessor::kUserMode );
+		(void) theMemory->WriteP( kTrace, kTrace + 4 );
+
+		theEmulator.Run();
+
+		Boolean theFault = false;
+		KUInt32 theEnd = theMemory->ReadP( kTrace, theFault );
+		KUInt32 theSWIs = theMemory->ReadP( kTaskSwitchSWIs, theFault );
+		char theTrace[(kMaxTrace * 3) + 1];
+		theTrace[0] = 0;
+		KUInt32 indexTrace;
+		for (indexTrace = 0; indexTrace < kMaxTrace; indexTrace++)
+		{
+			KUInt32 theAddress = kTrace + 4 + (4 * indexTrace);
+			if (theAddress >= theEnd)
+			{
+				break;
+			}
+			(void) ::sprintf(
+				&theTrace[3 * indexTrace],
+				" %.2X",
+				(unsigned int) theMemory->ReadP( theAddress, theFault ) );
+		}
+		TNativeKernel* theKernel = theEmulator.GetNativeKernel();
+		if (inLog) {
+			inLog->FLogLine(
+				"%s native scheduler:%s",
+				indexRun ? "With" : "Without",
+				theTrace );
+			inLog->FLogLine(
+				"%u SWIs, %u calls through the kernel, %u on the host",
+				(unsigned int) theSWIs,
+				(unsigned int) theKernel->GetKernelCallCount(),
+				(unsigned int) theKernel->GetFastPathCount() );
+		}
+		(void) ::unlink( kTempFlashPath );
+		::free( rom );
+	}
+	TNativeKernel::SetNativeScheduler( false );
+}
+
+// ========================================================================== //
+// The price of reliability is the pursuit of the utmost simplicity.          //
+//                 -- C.A.R. Hoare                                            //
+// ========================================================================== //
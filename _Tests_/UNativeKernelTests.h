@@ -0,0 +1,71 @@
+// ==============================
+// File:			UNativeKernelTests.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _UNATIVEKERNELTESTS_H
+#define _UNATIVEKERNELTESTS_H
+
+#include <K/Defines/KDefinitions.h>
+
+#include "Emulator/Log/TLog.h"
+
+///
+/// Class to test the host implementations of kernel calls.
+///
+/// A small kernel in the test ROM does what the NewtonOS kernel does, and
+/// the same calls are made with and without the fast paths.
+///
+class UNativeKernelTests
+{
+public:
+	///
+	/// Make semaphore operations through SemaphoreOpGlue, with and without
+	/// the fast paths, and compare the results.
+	///
+	static void Semaphores( TLog* inLog );
+
+	///
+	/// Fault on pages the kernel maps and forgets, with and without the
+	/// fast paths, and compare the results.
+	///
+	static void PageFaults( TLog* inLog );
+
+	///
+	/// Yield and block with priority masks of a table, with and without
+	/// the fast paths, and compare the task switches.
+	///
+	static void Scheduler( TLog* inLog );
+
+	///
+	/// Switch between two tasks with and without the native scheduler, and
+	/// compare what they did.
+	///
+	static void TaskSwitch( TLog* inLog );
+};
+
+#endif
+		// _UNATIVEKERNELTESTS_H
+
+// ====================================================================== //
+// If it ain't broke, don't fix it.                                       //
+//                 -- Bert Lance                                          //
+// ====================================================================== //
@@ -17,9 +17,11 @@
 
 // ANSI C & POSIX
 #include <stdlib.h>
+#include <string.h>
 
 #if !TARGET_OS_WIN32
 	#include <unistd.h>
+	#include <sys/time.h>
 #endif
 
 // K
@@ -34,6 +36,7 @@
 #include "Emulator/TARMProcessor.h"
 #include "Emulator/JIT/JIT.h"
 #include "Emulator/JIT/TJITPage.h"
+#include "Emulator/JIT/Generic/TJITGenericPage.h"
 #include "Emulator/Sound/TNullSoundManager.h"
 #include "Emulator/Network/TUsermodeNetwork.h"
 #include "Emulator/Screen/TNullScreenManager.h"
@@ -176,6 +179,21 @@ UProcessorTests::ExecuteTwoInstructions( const char* inHexWords, TLog* inLog )
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * ParseCode( const char*, KUInt8* )
+// -------------------------------------------------------------------------- //
+static int
+ParseCode( const char* inHexWords, KUInt8* outROM )
+{
+	KUInt32* theCodePtr = (KUInt32*) outROM;
+	int nbBytes;
+	while (::sscanf(inHexWords, "%X %n", theCodePtr, &nbBytes) == 1) {
+		inHexWords += nbBytes;
+		theCodePtr++;
+	}
+	return (int) (theCodePtr - (KUInt32*) outROM);
+}
+
 // -------------------------------------------------------------------------- //
 //  * RunCode( const char* )
 // -------------------------------------------------------------------------- //
@@ -186,14 +204,9 @@ UProcessorTests::RunCode( const char* inHexWords, TLog* inLog ) {
 		(void) ::printf( "This test requires code in hexa\n" );
 	} else {
 		KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
-		KUInt32* theCodePtr = (KUInt32*) rom;
-		int nbBytes;
-		while (::sscanf(inHexWords, "%X %n", theCodePtr, &nbBytes) == 1) {
-			inHexWords += nbBytes;
-			theCodePtr++;
-		}
+		int nbInstructions = ParseCode( inHexWords, rom );
 		if (inLog) {
-			inLog->FLogLine("Parsed %d instruction(s).", (int) ((theCodePtr - (KUInt32*)rom)));
+			inLog->FLogLine("Parsed %d instruction(s).", nbInstructions);
 		}
 
 		TEmulator theEmulator(inLog, rom, kTempFlashPath);
@@ -204,6 +217,126 @@ UProcessorTests::RunCode( const char* inHexWords, TLog* inLog ) {
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * RunCodeState( const char*, TLog*, Boolean, KUInt32[17] )
+// -------------------------------------------------------------------------- //
+static void
+RunCodeState(
+			const char* inHexWords,
+			TLog* inLog,
+			Boolean inLogCount,
+			KUInt32 outState[17] )
+{
+	KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+	int nbInstructions = ParseCode( inHexWords, rom );
+	if (inLog && inLogCount) {
+		inLog->FLogLine("Parsed %d instruction(s).", nbInstructions);
+	}
+
+	TEmulator theEmulator(inLog, rom, kTempFlashPath);
+	theEmulator.Run();
+	TARMProcessor* theProcessor = theEmulator.GetProcessor();
+	for (int indexRegisters = 0; indexRegisters < 16; indexRegisters++) {
+		outState[indexRegisters] = theProcessor->GetRegister( indexRegisters );
+	}
+	outState[16] = theProcessor->GetCPSR();
+	(void) ::unlink( kTempFlashPath );
+	::free( rom );
+}
+
+// -------------------------------------------------------------------------- //
+//  * LogStateDifferences( TLog*, KUInt32[2][17], const char* )
+// -------------------------------------------------------------------------- //
+static void
+LogStateDifferences(
+			TLog* inLog,
+			KUInt32 inStates[2][17],
+			const char* inReference )
+{
+	int nbDifferences = 0;
+	for (int indexRegisters = 0; indexRegisters < 17; indexRegisters++) {
+		char theName[8];
+		if (indexRegisters < 16) {
+			(void) ::sprintf( theName, "R%i", indexRegisters );
+		} else {
+			(void) ::strcpy( theName, "CPSR" );
+		}
+		if (inStates[0][indexRegisters] == inStates[1][indexRegisters]) {
+			inLog->FLogLine("%s = %.8X",
+				theName,
+				(unsigned int) inStates[1][indexRegisters] );
+		} else {
+			inLog->FLogLine("%s = %.8X (%.8X %s)",
+				theName,
+				(unsigned int) inStates[1][indexRegisters],
+				(unsigned int) inStates[0][indexRegisters],
+				inReference );
+			nbDifferences++;
+		}
+	}
+	inLog->FLogLine("%d difference(s).", nbDifferences);
+}
+
+// -------------------------------------------------------------------------- //
+//  * RunCodeCompareFlags( const char* )
+// -------------------------------------------------------------------------- //
+void
+UProcessorTests::RunCodeCompareFlags( const char* inHexWords, TLog* inLog ) {
+	if (inHexWords == nil)
+	{
+		(void) ::printf( "This test requires code in hexa\n" );
+	} else {
+		KUInt32 theStates[2][17];
+		int indexRun;
+		for (indexRun = 0; indexRun < 2; indexRun++)
+		{
+			// First with all flags, then with dead flags eliminated.
+			TJITGenericPage::SetEliminateDeadFlags( indexRun == 1 );
+			RunCodeState( inHexWords, inLog, indexRun == 0, theStates[indexRun] );
+		}
+		TJITGenericPage::SetEliminateDeadFlags( true );
+
+		if (inLog) {
+			LogStateDifferences( inLog, theStates, "with all flags" );
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * RunCodeCompareNative( const char* )
+// -------------------------------------------------------------------------- //
+void
+UProcessorTests::RunCodeCompareNative( const char* inHexWords, TLog* inLog ) {
+	if (inHexWords == nil)
+	{
+		(void) ::printf( "This test requires code in hexa\n" );
+	} else {
+		KUInt32 theStates[2][17];
+		int indexRun;
+#ifdef JITTARGET_X86_64
+		KUInt32 theNativeCount = TJITX86_64Code::GetTotalNativeCount();
+#endif
+		for (indexRun = 0; indexRun < 2; indexRun++)
+		{
+			// First with the threaded code only, then with native code.
+#ifdef JITTARGET_X86_64
+			TJITX86_64Code::SetEnabled( indexRun == 1 );
+#endif
+			RunCodeState( inHexWords, inLog, indexRun == 0, theStates[indexRun] );
+		}
+
+		if (inLog) {
+			LogStateDifferences( inLog, theStates, "with threaded code" );
+#ifdef JITTARGET_X86_64
+			// The output doesn't depend on the host, unless it's wrong.
+			if (TJITX86_64Code::IsAvailable()
+				&& (TJITX86_64Code::GetTotalNativeCount() == theNativeCount)) {
+				inLog->LogLine("No instruction was compiled to native code.");
+			}
+#endif
+		}
+	}
+}
 
 // -------------------------------------------------------------------------- //
 //  * Step( const char* )
@@ -232,6 +365,293 @@ UProcessorTests::Step( const char* inCount, TLog* inLog )
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * BenchmarkBranchCache( const char* )
+// -------------------------------------------------------------------------- //
+void
+UProcessorTests::BenchmarkBranchCache( const char* inLoops, TLog* inLog )
+{
+	KUInt32 loops;
+	if (inLoops == nil)
+	{
+		(void) ::printf( "This test requires a number of loops in decimal.\n" );
+	} else if (::sscanf( inLoops, "%d", (unsigned int*) &loops ) != 1) {
+		(void) ::printf( "Can't parse number of loops (%s).\n", inLoops );
+	} else {
+		// Every loop calls a leaf function (mov pc, lr) and a function that
+		// saves lr on the stack (ldmfd sp!, {pc}).
+		const KUInt32 theCode[] = {
+			0xE59F002C,		// 00: ldr    r0, [pc, #44]     r0 = loops
+			0xE3A0D641,		// 04: mov    sp, #0x04100000
+			0xEB000004,		// 08: bl     20
+			0xEB000005,		// 0C: bl     28
+			0xE2500001,		// 10: subs   r0, r0, #1
+			0x1AFFFFFB,		// 14: bne    08
+			0xE1200070,		// 18: bkpt   0
+			0xE1A00000,		// 1C: nop
+			0xE2811001,		// 20: add    r1, r1, #1
+			0xE1A0F00E,		// 24: mov    pc, lr
+			0xE92D4000,		// 28: stmfd  sp!, {lr}
+			0xE2822001,		// 2C: add    r2, r2, #1
+			0xE8BD8000,		// 30: ldmfd  sp!, {pc}
+		};
+		const KUInt32 theCodeCount = sizeof(theCode) / sizeof(theCode[0]);
+		int indexRun;
+		for (indexRun = 0; indexRun < 2; indexRun++)
+		{
+			// First without the branch cache, then with it.
+			TJITGeneric::SetBranchCacheEnabled( indexRun == 1 );
+			KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+			(void) ::memcpy( rom, theCode, sizeof(theCode) );
+			((KUInt32*) rom)[theCodeCount] = loops;
+
+			TEmulator theEmulator(inLog, rom, kTempFlashPath);
+			theEmulator.GetMemory()->GetJITObject()->ResetBranchCacheMisses();
+			struct timeval theStart;
+			struct timeval theEnd;
+			(void) ::gettimeofday( &theStart, NULL );
+			theEmulator.Run();
+			(void) ::gettimeofday( &theEnd, NULL );
+			KUInt32 theMisses =
+				theEmulator.GetMemory()->GetJITObject()->GetBranchCacheMisses();
+			KUInt32 theBranches = 2 * loops;
+			double theElapsed =
+				(theEnd.tv_sec - theStart.tv_sec)
+				+ (theEnd.tv_usec - theStart.tv_usec) / 1000000.0;
+			if (inLog) {
+				inLog->FLogLine(
+					"%s branch cache: %u indirect branches, %u misses, "
+					"%.2f%% hit rate, %.3f s",
+					indexRun ? "With" : "Without",
+					(unsigned int) theBranches,
+					(unsigned int) theMisses,
+					theBranches ?
+						(100.0 * (theBranches - theMisses)) / theBranches : 0.0,
+					theElapsed );
+			}
+			(void) ::unlink( kTempFlashPath );
+			::free( rom );
+		}
+		TJITGeneric::SetBranchCacheEnabled( true );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * IdleLoops( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UProcessorTests::IdleLoops( TLog* inLog )
+{
+	// Loops, the backward branch last.
+	static const struct {
+		const char*	fName;
+		KUInt32		fLength;
+		KUInt32		fLoop[4];
+	} kLoops[] = {
+		{ "poll a word", 3,
+			{ 0xE5971000,		// ldr    r1, [r7]
+			  0xE3510000,		// cmp    r1, #0
+			  0x0AFFFFFC } },	// beq    loop
+		{ "poll through a literal", 4,
+			{ 0xE59F0010,		// ldr    r0, [pc, #16]
+			  0xE5901004,		// ldr    r1, [r0, #4]
+			  0xE3110001,		// tst    r1, #1
+			  0x0AFFFFFB } },	// beq    loop
+		{ "poll, base overwritten", 4,
+			{ 0xE59F0010,		// ldr    r0, [pc, #16]
+			  0xE5900000,		// ldr    r0, [r0]
+			  0xE3500000,		// cmp    r0, #0
+			  0x0AFFFFFB } },	// beq    loop
+		{ "spin forever", 1,
+			{ 0xEAFFFFFE } },	// b      loop
+		{ "compare registers", 2,
+			{ 0xE1500001,		// cmp    r0, r1
+			  0x1AFFFFFD } },	// bne    loop
+		{ "count down", 2,
+			{ 0xE2500001,		// subs   r0, r0, #1
+			  0x1AFFFFFD } },	// bne    loop
+		{ "add with carry", 3,
+			{ 0xE5971000,		// ldr    r1, [r7]
+			  0xE0922001,		// adds   r2, r2, r1
+			  0x3AFFFFFC } },	// bcc    loop
+		{ "walk a list", 3,
+			{ 0xE5977000,		// ldr    r7, [r7]
+			  0xE3570000,		// cmp    r7, #0
+			  0x1AFFFFFC } },	// bne    loop
+		{ "post-indexed load", 3,
+			{ 0xE4971004,		// ldr    r1, [r7], #4
+			  0xE3510000,		// cmp    r1, #0
+			  0x0AFFFFFC } },	// beq    loop
+		{ "register offset", 3,
+			{ 0xE7971002,		// ldr    r1, [r7, r2]
+			  0xE3510000,		// cmp    r1, #0
+			  0x0AFFFFFC } },	// beq    loop
+		{ "store", 3,
+			{ 0xE5971000,		// ldr    r1, [r7]
+			  0xE5881000,		// str    r1, [r8]
+			  0xEAFFFFFC } },	// b      loop
+		{ "conditional move", 3,
+			{ 0xE5971000,		// ldr    r1, [r7]
+			  0x03A02001,		// moveq  r2, #1
+			  0xEAFFFFFC } },	// b      loop
+	};
+	const KUInt32 theLoopCount = sizeof(kLoops) / sizeof(kLoops[0]);
+	KUInt32 indexLoop;
+	for (indexLoop = 0; indexLoop < theLoopCount; indexLoop++)
+	{
+		KUInt32 theLoads[TJITGenericPage::kMaxIdleLoopLoads];
+		Boolean isIdle = TJITGenericPage::IsIdleLoop(
+							kLoops[indexLoop].fLoop,
+							kLoops[indexLoop].fLength,
+							theLoads );
+		if (inLog)
+		{
+			if (isIdle)
+			{
+				KUInt32 theLoadCount = 0;
+				while ((theLoadCount < TJITGenericPage::kMaxIdleLoopLoads)
+					&& theLoads[theLoadCount])
+				{
+					theLoadCount++;
+				}
+				inLog->FLogLine( "%s: idle, %u load(s) to check",
+					kLoops[indexLoop].fName,
+					(unsigned int) theLoadCount );
+			} else {
+				inLog->FLogLine( "%s: not idle", kLoops[indexLoop].fName );
+			}
+		}
+	}
+	
+	// The IRQ handler sets the word after about 17 ms.
+	const KUInt32 theCode[] = {
+		0xEA00000E,		// 00: b      40
+		0x00000000,		// 04
+		0x00000000,		// 08
+		0x00000000,		// 0C
+		0x00000000,		// 10
+		0x00000000,		// 14
+		0xEA000028,		// 18: b      C0                IRQ
+		0x00000000,		// 1C
+		0x00000000,		// 20
+		0x00000000,		// 24
+		0x00000000,		// 28
+		0x00000000,		// 2C
+		0x00000000,		// 30
+		0x00000000,		// 34
+		0x00000000,		// 38
+		0x00000000,		// 3C
+		0xE3A07301,		// 40: mov    r7, #0x04000000   the word, in RAM
+		0xE3A00000,		// 44: mov    r0, #0
+		0xE5870000,		// 48: str    r0, [r7]
+		0xE59F604C,		// 4C: ldr    r6, [pc, #76]     interrupt control
+		0xE5860800,		// 50: str    r0, [r6, #2048]   no FIQ
+		0xE59F4048,		// 54: ldr    r4, [pc, #72]     ticks
+		0xE59F5048,		// 58: ldr    r5, [pc, #72]     match register 2
+		0xE5940000,		// 5C: ldr    r0, [r4]
+		0xE2800801,		// 60: add    r0, r0, #0x10000
+		0xE5850000,		// 64: str    r0, [r5]
+		0xE3A00020,		// 68: mov    r0, #0x20
+		0xE5860400,		// 6C: str    r0, [r6, #1024]   clear timer 2
+		0xE5860000,		// 70: str    r0, [r6]          timer 2 only
+		0xE10F0000,		// 74: mrs    r0, cpsr
+		0xE3C00080,		// 78: bic    r0, r0, #0x80
+		0xE121F000,		// 7C: msr    cpsr_c, r0        IRQ on
+		0xE5971000,		// 80: ldr    r1, [r7]
+		0xE3510000,		// 84: cmp    r1, #0
+		0x0AFFFFFC,		// 88: beq    80
+		0xE1200070,		// 8C: bkpt   0
+		0x00000000,		// 90
+		0x00000000,		// 94
+		0x00000000,		// 98
+		0x00000000,		// 9C
+		0x0F183400,		// A0
+		0x0F181800,		// A4
+		0x0F182800,		// A8
+		0x00000000,		// AC
+		0x00000000,		// B0
+		0x00000000,		// B4
+		0x00000000,		// B8
+		0x00000000,		// BC
+		0xE3A02001,		// C0: mov    r2, #1
+		0xE5872000,		// C4: str    r2, [r7]
+		0xE3A02020,		// C8: mov    r2, #0x20
+		0xE5862400,		// CC: str    r2, [r6, #1024]   clear timer 2
+		0xE25EF004,		// D0: subs   pc, lr, #4
+	};
+	int indexRun;
+	for (indexRun = 0; indexRun < 2; indexRun++)
+	{
+		// First spinning, then waiting.
+		TJITGenericPage::SetDetectIdleLoops( indexRun == 1 );
+		KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+		(void) ::memcpy( rom, theCode, sizeof(theCode) );
+
+		TEmulator theEmulator(inLog, rom, kTempFlashPath);
+		theEmulator.Run();
+		TARMProcessor* theProcessor = theEmulator.GetProcessor();
+		if (inLog) {
+			inLog->FLogLine(
+				"%s idle loops: r1 = %.8X, pc = %.8X, %s",
+				indexRun ? "With" : "Without",
+				(unsigned int) theProcessor->GetRegister( 1 ),
+				(unsigned int) theProcessor->GetRegister( 15 ),
+				theEmulator.GetIdleCount() ? "waited" : "spun" );
+		}
+		(void) ::unlink( kTempFlashPath );
+		::free( rom );
+	}
+	TJITGenericPage::SetDetectIdleLoops( true );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SelfModifyingCode( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UProcessorTests::SelfModifyingCode( TLog* inLog )
+{
+	// A function in RAM, in the byte order of the guest.
+	static const KUInt8 kFunction[] = {
+		0xE3, 0xA0, 0x00, 0x01,		// 00: mov    r0, #1
+		0xE1, 0x20, 0x00, 0x70		// 04: bkpt   0
+	};
+	static const KUInt8 kMoveTwo[] = {
+		0xE3, 0xA0, 0x00, 0x02		// mov    r0, #2
+	};
+	const KUInt32 kFunctionAddr = 0x04000000;
+
+	KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+	TEmulator theEmulator(inLog, rom, kTempFlashPath);
+	TMemory* theMemory = theEmulator.GetMemory();
+	TARMProcessor* theProcessor = theEmulator.GetProcessor();
+	(void) theMemory->FastWriteBuffer(
+				kFunctionAddr, sizeof(kFunction), kFunction );
+	
+	// Translated by the first run. The host copies of FastWriteBuffer and
+	// the stores of the guest must both drop the translation.
+	int indexRun;
+	for (indexRun = 0; indexRun < 3; indexRun++)
+	{
+		if (indexRun == 1)
+		{
+			(void) theMemory->FastWriteBuffer(
+						kFunctionAddr, sizeof(kMoveTwo), kMoveTwo );
+		} else if (indexRun == 2) {
+			(void) theMemory->Write( kFunctionAddr, 0xE3A00003 );	// mov r0, #3
+		}
+		theProcessor->SetRegister( 0, 0 );
+		theProcessor->SetRegister( 15, kFunctionAddr + 4 );	// Prefetch.
+		theEmulator.Run();
+		if (inLog) {
+			inLog->FLogLine( "Run %i: r0 = %.8X",
+				indexRun + 1,
+				(unsigned int) theProcessor->GetRegister( 0 ) );
+		}
+	}
+	(void) ::unlink( kTempFlashPath );
+	::free( rom );
+}
+
 // ========================================================================== //
 // APL is a mistake, carried through to perfection.  It is the language of    //
 // the future for the programming techniques of the past: it creates a new    //
@@ -68,6 +68,44 @@ public:
 	///
 	static void RunCode( const char* inHexWords, TLog* inLog );
 
+	///
+	/// Run code twice, with and without the elimination of dead flags,
+	/// and print the registers with the differences.
+	///
+	/// \param inHexWord	instructions (as hexa) to execute.
+	///
+	static void RunCodeCompareFlags( const char* inHexWords, TLog* inLog );
+
+	///
+	/// Run code twice, with the threaded code of the generic JIT and with
+	/// native code where the host has it, and print the registers with the
+	/// differences.
+	///
+	/// \param inHexWord	instructions (as hexa) to execute.
+	///
+	static void RunCodeCompareNative( const char* inHexWords, TLog* inLog );
+
+	///
+	/// Run a loop of calls and returns, with and without the branch cache,
+	/// and print the time and the hit rate of each run.
+	///
+	/// \param inLoops	number of loops in decimal.
+	///
+	static void BenchmarkBranchCache( const char* inLoops, TLog* inLog );
+
+	///
+	/// Classify loops as idle or not, then run a loop that polls a word
+	/// set by a timer interrupt, with and without the detection of idle
+	/// loops.
+	///
+	static void IdleLoops( TLog* inLog );
+
+	///
+	/// Run a function in RAM, then change it with FastWriteBuffer and with a
+	/// store, and run it again after each change.
+	///
+	static void SelfModifyingCode( TLog* inLog );
+
 	///
 	/// Step into the ROM (found at ../../_Data_/717006)
 	///
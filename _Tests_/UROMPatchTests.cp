@@ -0,0 +1,270 @@
+// ==============================
+// File:			UROMPatchTests.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "UROMPatchTests.h"
+
+// ANSI C & POSIX
+#include <stdlib.h>
+#include <string.h>
+
+// Einstein
+#include "Emulator/Log/TLog.h"
+#include "Emulator/ROM/TROMPatchDatabase.h"
+#include "Emulator/JIT/Generic/TJITGenericROMPatch.h"
+#include "Emulator/NativeCalls/TVirtualizedCallsPatches.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+
+// Two versions of the same machine, and one more machine.
+static const char* const kTables =
+	"# Test tables.\n"
+	"rom\t737041\t0x00001234\t0x00005678\n"
+	"word\t0x00001000\t0xEA000009\t0x1A000009\tAvoid screen calibration\n"
+	"compiled 0x00002000 0xE59F0010   Avoid screen calibration  \r\n"
+	"virtualized\t0x00003000\t0xE3520000\tmemmove\t# comment\n"
+	"virtualized\t0x00003100\t-\tstrlen\n"
+	"\n"
+	"rom\t737041\t-\t-\n"
+	"word\t0x00001000\t0xEA000009\t0x12345678\tWrong version\n"
+	"rom\t747129\t0x00000001\t0x00000002\n";
+
+// A compiled patch at another address.
+static const char* const kMovedPatch =
+	"rom\t717006\t-\t-\n"
+	"compiled\t0x00002000\t-\tProgress_ROMBoot\n";
+
+// Lines the database refuses.
+static const char* const kSyntaxErrors[] = {
+	"word\t0x00001000\t0x00000000\t-\tNo rom\n",
+	"rom\t7170\t-\t-\n",
+	"rom\t717006\t-\t0x00000001\n",
+	"rom\t717006\t-\t-\nvirtualized\t0x00001000\t-\tmemcpy\n",
+	"rom\t717006\t-\t-\nword\t0x00001002\t0x00000000\t-\tUnaligned\n",
+	"rom\t717006\t-\t-\n\nword\t0x00001000\t0x00000000\t-\n",
+	"rom\t717006\t-\t-\nbranch\t0x00001000\t-\tUnknown\n",
+	NULL
+};
+
+// -------------------------------------------------------------------------- //
+//  * LogTable( TLog*, const char*, const TROMPatchDatabase::STable* )
+// -------------------------------------------------------------------------- //
+static void
+LogTable(
+		TLog* inLog,
+		const char* inWhat,
+		const TROMPatchDatabase::STable* inTable )
+{
+	if (inTable == NULL)
+	{
+		inLog->FLogLine( "%s: none", inWhat );
+	} else {
+		inLog->FLogLine( "%s: %s %.8X %.8X%s, %u entries",
+			inWhat,
+			inTable->fMachineString,
+			(unsigned int) inTable->fChecksums[0],
+			(unsigned int) inTable->fChecksums[1],
+			inTable->fAnyChecksum ? " (any)" : "",
+			(unsigned int) inTable->fEntryCount );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * DatabaseTest( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UROMPatchTests::DatabaseTest( TLog* inLog )
+{
+	TROMPatchDatabase theDatabase;
+	if (theDatabase.Parse( kTables, inLog ))
+	{
+		inLog->LogLine( "Parse failed" );
+		return;
+	}
+	
+	// Every table.
+	KUInt32 indexTable;
+	for (indexTable = 0; indexTable < theDatabase.GetTableCount(); indexTable++)
+	{
+		const TROMPatchDatabase::STable* theTable =
+			theDatabase.GetTable( indexTable );
+		LogTable( inLog, "Table", theTable );
+		KUInt32 indexEntry;
+		for (indexEntry = 0; indexEntry < theTable->fEntryCount; indexEntry++)
+		{
+			const TROMPatchDatabase::SEntry* theEntry =
+				&theTable->fEntries[indexEntry];
+			inLog->FLogLine( "  %u %.8X %.8X %.8X%s >%s<",
+				(unsigned int) theEntry->fKind,
+				(unsigned int) theEntry->fAddress,
+				(unsigned int) theEntry->fValue,
+				(unsigned int) theEntry->fOriginal,
+				theEntry->fCheckOriginal ? "" : " (any)",
+				theEntry->fName );
+		}
+	}
+	
+	// Lookup.
+	KUInt32 theChecksums[2] = { 0x00001234, 0x00005678 };
+	LogTable( inLog, "737041 1234 5678",
+		theDatabase.FindTable( "737041", theChecksums ) );
+	KUInt32 theOtherChecksums[2] = { 0x00001234, 0x00000000 };
+	LogTable( inLog, "737041 1234 0000",
+		theDatabase.FindTable( "737041", theOtherChecksums ) );
+	LogTable( inLog, "747129 1234 5678",
+		theDatabase.FindTable( "747129", theChecksums ) );
+	LogTable( inLog, "717006 1234 5678",
+		theDatabase.FindTable( "717006", theChecksums ) );
+
+	// Validation against a ROM with the instructions of the first version.
+	KUInt32* theROM = (KUInt32*) ::calloc( 0x01000000, 1 );
+	theROM[0x00001000 / 4] = 0x1A000009;
+	theROM[0x00002000 / 4] = 0xE59F0010;
+	theROM[0x00003000 / 4] = 0xE3520000;
+	theROM[0x00003100 / 4] = 0xE1A03000;
+	for (indexTable = 0; indexTable < theDatabase.GetTableCount(); indexTable++)
+	{
+		const TROMPatchDatabase::STable* theTable =
+			theDatabase.GetTable( indexTable );
+		inLog->FLogLine( "Table %u: %u mismatches",
+			(unsigned int) indexTable,
+			(unsigned int) TROMPatchDatabase::Validate(
+				theTable, theROM, inLog ) );
+	}
+
+	// Patch with the first table.
+	const TROMPatchDatabase::STable* theTable = theDatabase.GetTable( 0 );
+	TJITGenericROMPatch::DoPatchROM( theROM, "737041", theTable );
+	TVirtualizedCallsPatches::DoPatchROM( theROM, "737041", theTable );
+	static const KUInt32 kPatched[] = {
+		0x00001000, 0x00002000,
+		0x00003000, 0x00003004, 0x00003008, 0x0000300C, 0x00003010,
+		0x00003100, 0x00003110, 0x00003114
+	};
+	KUInt32 index;
+	for (index = 0; index < sizeof(kPatched) / sizeof(kPatched[0]); index++)
+	{
+		inLog->FLogLine( "%.8X: %.8X",
+			(unsigned int) kPatched[index],
+			(unsigned int) theROM[kPatched[index] / 4] );
+	}
+	::free( theROM );
+
+	// Syntax errors.
+	for (index = 0; kSyntaxErrors[index] != NULL; index++)
+	{
+		TROMPatchDatabase theOtherDatabase;
+		Boolean theResult = theOtherDatabase.Parse( kSyntaxErrors[index], inLog );
+		inLog->FLogLine( "%s, %u tables",
+			theResult ? "error" : "no error",
+			(unsigned int) theOtherDatabase.GetTableCount() );
+	}
+
+	// Path.
+	inLog->FLogLine( "%s",
+		TROMPatchDatabase::GetPathForImage( "/data/717006.img" ).c_str() );
+	inLog->FLogLine( "%s",
+		TROMPatchDatabase::GetPathForImage( "717006.img" ).c_str() );
+}
+
+// -------------------------------------------------------------------------- //
+//  * FileTest( const char*, TLog* )
+// -------------------------------------------------------------------------- //
+void
+UROMPatchTests::FileTest( const char* inPath, TLog* inLog )
+{
+	TROMPatchDatabase theDatabase;
+	if (theDatabase.LoadFile( inPath ))
+	{
+		inLog->LogLine( "Load failed" );
+		return;
+	}
+	
+	KUInt32 indexTable;
+	for (indexTable = 0; indexTable < theDatabase.GetTableCount(); indexTable++)
+	{
+		LogTable( inLog, "Table", theDatabase.GetTable( indexTable ) );
+	}
+	
+	KUInt32 theChecksums[2] = { 0x00000000, 0x00000000 };
+	const TROMPatchDatabase::STable* theTable =
+		theDatabase.FindTable( "717006", theChecksums );
+	LogTable( inLog, "717006", theTable );
+	if (theTable == NULL)
+	{
+		return;
+	}
+
+	// Applying a patch at another address doesn't move it.
+	TROMPatchDatabase theOtherDatabase;
+	(void) theOtherDatabase.Parse( kMovedPatch, inLog );
+	KUInt32* theTableROM = (KUInt32*) ::calloc( 0x01000000, 1 );
+	TJITGenericROMPatch::DoPatchROM(
+		theTableROM, "717006", theOtherDatabase.GetTable( 0 ) );
+	(void) ::memset( theTableROM, 0, 0x01000000 );
+
+	// The compiled patches at their addresses. The injections that only
+	// the tables apply are the differences.
+	KUInt32* theCompiledROM = (KUInt32*) ::calloc( 0x01000000, 1 );
+	TJITGenericROMPatch* thePatch;
+	for (thePatch = TJITGenericROMPatch::first();
+		thePatch != NULL;
+		thePatch = thePatch->next())
+	{
+		thePatch->apply( theCompiledROM );
+	}
+	TVirtualizedCallsPatches::DoPatchROM( theCompiledROM, "717006" );
+	
+	// The patches of the table.
+	TJITGenericROMPatch::DoPatchROM( theTableROM, "717006", theTable );
+	TVirtualizedCallsPatches::DoPatchROM( theTableROM, "717006", theTable );
+
+	KUInt32 theDifferences = 0;
+	KUInt32 index;
+	for (index = 0; index < 0x01000000 / 4; index++)
+	{
+		if (theCompiledROM[index] == 0 && theTableROM[index] != 0)
+		{
+			// The value depends on the order of the patches.
+			inLog->FLogLine( "%.8X: only patched by the table",
+				(unsigned int) (index * 4) );
+			theDifferences++;
+		} else if (theTableROM[index] != theCompiledROM[index]) {
+			inLog->FLogLine( "%.8X: %.8X instead of %.8X",
+				(unsigned int) (index * 4),
+				(unsigned int) theTableROM[index],
+				(unsigned int) theCompiledROM[index] );
+			theDifferences++;
+		}
+	}
+	inLog->FLogLine( "%u differences", (unsigned int) theDifferences );
+	::free( theTableROM );
+	::free( theCompiledROM );
+}
+
+// ====================================================================== //
+// Real programmers don't comment their code.  It was hard to write, it  //
+// should be hard to understand.                                          //
+// ====================================================================== //
@@ -0,0 +1,59 @@
+// ==============================
+// File:			UROMPatchTests.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _UROMPATCHTESTS_H
+#define _UROMPATCHTESTS_H
+
+#include <K/Defines/KDefinitions.h>
+
+#include "Emulator/Log/TLog.h"
+
+///
+/// Class to test the ROM patch database.
+///
+class UROMPatchTests
+{
+public:
+	///
+	/// Load tables, check them against a ROM and apply them.
+	///
+	static void DatabaseTest( TLog* inLog );
+
+	///
+	/// Load the database shipped in _Data_ and check that its table for the
+	/// 717006 ROM patches it like the compiled patches do.
+	///
+	/// \param inPath	path of the database.
+	/// \param inLog	log for the results.
+	///
+	static void FileTest( const char* inPath, TLog* inLog );
+};
+
+#endif
+		// _UROMPATCHTESTS_H
+
+// ====================================================================== //
+// A program should be light and agile, its subroutines connected like a //
+// string of pearls.                                                      //
+//                 -- The Tao of Programming                              //
+// ====================================================================== //
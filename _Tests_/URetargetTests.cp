@@ -0,0 +1,885 @@
+// ==============================
+// File:			URetargetTests.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "URetargetTests.h"
+
+// ANSI C & POSIX
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !TARGET_OS_WIN32
+	#include <unistd.h>
+	#include <sys/time.h>
+#endif
+
+// Einstein
+#include "Emulator/Log/TLog.h"
+#include "Emulator/TMemory.h"
+#include "Emulator/TEmulator.h"
+#include "Emulator/TARMProcessor.h"
+#include "Emulator/JIT/JIT.h"
+
+#ifdef JITTARGET_GENERIC
+#include "Emulator/JIT/Generic/TJITGenericRetarget.h"
+#include "Emulator/JIT/Generic/TJITGenericRetargetMap.h"
+#include "Emulator/JIT/Generic/TJITGenericPage.h"
+#include "Emulator/JIT/Generic/TJITGeneric_Macros.h"
+#include "Emulator/JIT/Generic/UJITGenericRetargetSupport.h"
+#include "Monitor/TSymbolList.h"
+#include "Monitor/UDisasm.h"
+#endif
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+#if TARGET_OS_WIN32
+	#define kTempFlashPath "c:/EinsteinTests.flash"
+	#define kTempSymbolsPath "c:/EinsteinTests.symbols"
+	#define kTempRetargetPath "c:/EinsteinTests-retarget"
+#else
+	#define kTempFlashPath "/tmp/EinsteinTests.flash"
+	#define kTempSymbolsPath "/tmp/EinsteinTests.symbols"
+	#define kTempRetargetPath "/tmp/EinsteinTests-retarget"
+#endif
+
+// The reset code calls SumWords with five words in RAM and the stack
+// after them, and stops.
+static const KUInt32 kResetCode[] = {
+	0xE3A00301,		// 00: mov    r0, #0x04000000
+	0xE280DA01,		// 04: add    sp, r0, #0x1000
+	0xE3A01005,		// 08: mov    r1, #5
+	0xEB0003FB,		// 0C: bl     1000              SumWords
+	0xE1200070,		// 10: bkpt   0
+};
+
+// Add r1 words from r0, the odd ones twice, store the sum after them and
+// return it. The odd words are doubled by a conditional call to AddOdd.
+static const KUInt32 kSumWordsCode[] = {
+	0xE92D4000,		// 00: stmdb  sp!, {lr}
+	0xE3A02000,		// 04: mov    r2, #0
+	0xE3510000,		// 08: cmp    r1, #0
+	0x0A000005,		// 0C: beq    28
+	0xE4903004,		// 10: ldr    r3, [r0], #4
+	0xE3130001,		// 14: tst    r3, #1
+	0x1B000008,		// 18: blne   40                AddOdd
+	0xE0822003,		// 1C: add    r2, r2, r3
+	0xE2511001,		// 20: subs   r1, r1, #1
+	0x1AFFFFF9,		// 24: bne    10
+	0xE5802000,		// 28: str    r2, [r0]
+	0xE1A00002,		// 2C: mov    r0, r2
+	0xE8BD8000,		// 30: ldmia  sp!, {pc}
+};
+
+// Double r3.
+static const KUInt32 kAddOddCode[] = {
+	0xE0833003,		// 00: add    r3, r3, r3
+	0xE1A0F00E,		// 04: mov    pc, lr
+};
+
+const KUInt32 kSumWords = 0x00001000;
+const KUInt32 kSumWordsReturn = 0x00000010;
+const KUInt32 kAddOdd = 0x00001040;
+const KUInt32 kWords = 0x04000000;
+const KUInt32 kStack = 0x04001000;
+const KUInt32 kNbWords = 5;
+const KUInt32 kWordValues[kNbWords] = { 3, 4, 7, 10, 13 };
+const KUInt32 kBenchmarkNbWords = 1024;
+
+/// What the retargeted function does with the CPU.
+struct SRetargetCounts {
+	KUInt32		fChecks;		///< Paranoid PC checks.
+	KUInt32		fAccesses;		///< Accesses to r0-r14 in the CPU by instructions.
+	KUInt32		fLoads;			///< Registers loaded in locals at the entry.
+	KUInt32		fWriteBacks;	///< Lines that write the locals back to the CPU.
+	KUInt32		fReloads;		///< Lines that read the locals again after calls.
+};
+
+enum {
+	kStateCPSR	= TARMProcessor::kR15,	///< r0 to r14, then the CPSR.
+	kStateSum,
+	kStateSize
+};
+
+// SumWords and AddOdd as retargeted by Release (rt paranoid off, rt cjit)
+// and by LocalRegisters (rt paranoid off, rt locals on, rt cjit).
+// The checks stop in the debugger with an x86 instruction.
+#if defined(JITTARGET_GENERIC) && (defined(__i386__) || defined(__x86_64__))
+	#define kRunRetargetedCode 1
+	// As in Newt/SimulatorGlue.h, which needs the whole simulated ROM.
+	#define RT_PANIC_UNEXPECTED_RETURN_ADDRESS \
+		UJITGenericRetargetSupport::UnexpectedPC(ioCPU);
+
+namespace Release {
+
+void Func_0x00001040(TARMProcessor* ioCPU, KUInt32 ret);
+
+void Func_0x00001000(TARMProcessor* ioCPU, KUInt32 ret)
+{
+// L00001000: 0xE92D4000  stmfd	r13!, {lr}
+	if (ioCPU->mCurrentRegisters[15]!=0x00001000+4) __asm__("int $3\n" : : ); // be paranoid about a correct PC
+	ioCPU->mCurrentRegisters[15] += 4; // update the PC
+	{
+		KUInt32 baseAddress = ioCPU->mCurrentRegisters[13];
+		KUInt32 wbAddress = baseAddress - (1 * 4);
+		baseAddress -= (1 * 4);
+		UJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, ioCPU->mCurrentRegisters[14]);
+		baseAddress += 4;
+		ioCPU->mCurrentRegisters[13] = wbAddress;
+	}
+// L00001004: 0xE3A02000  mov	r2, #0x00000000
+	ioCPU->mCurrentRegisters[15] = 0x00001004+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000000;
+		const KUInt32 theResult = Opnd2;
+		ioCPU->mCurrentRegisters[2] = theResult;
+	}
+// L00001008: 0xE3510000  cmp	r1, #0x00000000
+	ioCPU->mCurrentRegisters[15] = 0x00001008+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000000;
+		KUInt32 Opnd1 = ioCPU->mCurrentRegisters[1];
+		const KUInt32 theResult = Opnd1 - Opnd2;
+		ioCPU->mCPSR_Z = (theResult==0);
+		ioCPU->mCPSR_N = ((theResult&0x80000000)!=0);
+		ioCPU->mCPSR_C = ( ((Opnd1&~Opnd2)|(Opnd1&~theResult)|(~Opnd2&~theResult)) >> 31);
+		ioCPU->mCPSR_V = ( ((Opnd1&~Opnd2&~theResult)|(~Opnd1&Opnd2&theResult)) >> 31);
+	}
+// L0000100C: 0x0A000005  beq	00001028  =SumWords+28
+	ioCPU->mCurrentRegisters[15] = 0x0000100C+8; // update the PC
+	if (ioCPU->TestEQ()) {
+		SETPC(0x00001028+4);
+		goto L00001028;
+	}
+L00001010: // 0xE4903004  ldr	r3, [r0], #0x004
+	ioCPU->mCurrentRegisters[15] = 0x00001010+8; // update the PC
+	{
+		KUInt32 offset = 0x00000004;
+		KUInt32 theAddress = ioCPU->mCurrentRegisters[0];
+		KUInt32 theData = UJITGenericRetargetSupport::ManagedMemoryRead(ioCPU, theAddress);
+		ioCPU->mCurrentRegisters[3] = theData;
+		ioCPU->mCurrentRegisters[0] = theAddress + offset;
+	}
+// L00001014: 0xE3130001  tst	r3, #0x00000001
+	ioCPU->mCurrentRegisters[15] = 0x00001014+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000001;
+		KUInt32 Opnd1 = ioCPU->mCurrentRegisters[3];
+		const KUInt32 theResult = Opnd1 & Opnd2;
+		ioCPU->mCPSR_Z = (theResult==0);
+		ioCPU->mCPSR_N = ((theResult&0x80000000)!=0);
+	}
+// L00001018: 0x1B000008  blne	AddOdd
+	ioCPU->mCurrentRegisters[15] = 0x00001018+8; // update the PC
+	if (ioCPU->TestNE()) {
+		ioCPU->mCurrentRegisters[14] = 0x00001018 + 4;
+		// rt cjitr AddOdd
+		SETPC(0x00001040+4);
+		Func_0x00001040(ioCPU, 0x00001020);
+		if (ioCPU->mCurrentRegisters[15]!=0x00001020) {
+			RT_PANIC_UNEXPECTED_RETURN_ADDRESS
+		}
+	}
+// L0000101C: 0xE0822003  add	r2, r2, r3
+	ioCPU->mCurrentRegisters[15] = 0x0000101C+8; // update the PC
+	{
+		KUInt32 Opnd2 = ioCPU->mCurrentRegisters[3];
+		KUInt32 Opnd1 = ioCPU->mCurrentRegisters[2];
+		const KUInt32 theResult = Opnd1 + Opnd2;
+		ioCPU->mCurrentRegisters[2] = theResult;
+	}
+// L00001020: 0xE2511001  subs	r1, r1, #0x00000001
+	ioCPU->mCurrentRegisters[15] = 0x00001020+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000001;
+		KUInt32 Opnd1 = ioCPU->mCurrentRegisters[1];
+		const KUInt32 theResult = Opnd1 - Opnd2;
+		ioCPU->mCurrentRegisters[1] = theResult;
+		ioCPU->mCPSR_Z = (theResult==0);
+		ioCPU->mCPSR_N = ((theResult&0x80000000)!=0);
+		ioCPU->mCPSR_C = ( ((Opnd1&~Opnd2)|(Opnd1&~theResult)|(~Opnd2&~theResult)) >> 31);
+		ioCPU->mCPSR_V = ( ( (Opnd1&~Opnd2&~theResult)|(~Opnd1&Opnd2&theResult) ) >> 31);
+	}
+// L00001024: 0x1AFFFFF9  bne	00001010  =SumWords+10
+	ioCPU->mCurrentRegisters[15] = 0x00001024+8; // update the PC
+	if (ioCPU->TestNE()) {
+		SETPC(0x00001010+4);
+		goto L00001010;
+	}
+L00001028: // 0xE5802000  str	r2, [r0]
+	ioCPU->mCurrentRegisters[15] = 0x00001028+8; // update the PC
+	{
+		KUInt32 offset = 0x00000000;
+		KUInt32 theAddress = ioCPU->mCurrentRegisters[0] + offset;
+		KUInt32 theValue = ioCPU->mCurrentRegisters[2];
+		UJITGenericRetargetSupport::ManagedMemoryWrite(ioCPU, theAddress, theValue);
+	}
+// L0000102C: 0xE1A00002  mov	r0, r2
+	ioCPU->mCurrentRegisters[15] = 0x0000102C+8; // update the PC
+	{
+		KUInt32 Opnd2 = ioCPU->mCurrentRegisters[2];
+		const KUInt32 theResult = Opnd2;
+		ioCPU->mCurrentRegisters[0] = theResult;
+	}
+// L00001030: 0xE8BD8000  ldmea	r13!, {pc}
+	ioCPU->mCurrentRegisters[15] = 0x00001030+8; // update the PC
+	{
+		KUInt32 baseAddress = ioCPU->mCurrentRegisters[13];
+		KUInt32 wbAddress = baseAddress + (1 * 4);
+		SETPC( UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress)) + 4;
+		ioCPU->mCurrentRegisters[13] = wbAddress;
+		return; //MMUCALLNEXT_AFTERSETPC;
+	}
+	__asm__("int $3\n" : : ); // There was no return instruction found
+}
+
+void Func_0x00001040(TARMProcessor* ioCPU, KUInt32 ret)
+{
+// L00001040: 0xE0833003  add	r3, r3, r3
+	if (ioCPU->mCurrentRegisters[15]!=0x00001040+4) __asm__("int $3\n" : : ); // be paranoid about a correct PC
+	ioCPU->mCurrentRegisters[15] += 4; // update the PC
+	{
+		KUInt32 Opnd2 = ioCPU->mCurrentRegisters[3];
+		KUInt32 Opnd1 = ioCPU->mCurrentRegisters[3];
+		const KUInt32 theResult = Opnd1 + Opnd2;
+		ioCPU->mCurrentRegisters[3] = theResult;
+	}
+// L00001044: 0xE1A0F00E  mov	pc, lr
+	ioCPU->mCurrentRegisters[15] = 0x00001044+8; // update the PC
+	{
+		KUInt32 Opnd2 = ioCPU->mCurrentRegisters[14];
+		const KUInt32 theResult = Opnd2;
+		SETPC(theResult + 4);
+		if (ret==0xFFFFFFFF)
+			return; // Return to emulator
+		if (ioCPU->mCurrentRegisters[15]!=ret)
+			__asm__("int $3\n" : : ); // Unexpected return address
+		return;
+	}
+	__asm__("int $3\n" : : ); // There was no return instruction found
+}
+}
+
+namespace LocalRegisters {
+
+void Func_0x00001040(TARMProcessor* ioCPU, KUInt32 ret);
+
+void Func_0x00001000(TARMProcessor* ioCPU, KUInt32 ret)
+{
+	KUInt32 r0 = ioCPU->mCurrentRegisters[0];
+	KUInt32 r1 = ioCPU->mCurrentRegisters[1];
+	KUInt32 r2 = ioCPU->mCurrentRegisters[2];
+	KUInt32 r3 = ioCPU->mCurrentRegisters[3];
+	KUInt32 r13 = ioCPU->mCurrentRegisters[13];
+	KUInt32 r14 = ioCPU->mCurrentRegisters[14];
+// L00001000: 0xE92D4000  stmfd	r13!, {lr}
+	if (ioCPU->mCurrentRegisters[15]!=0x00001000+4) __asm__("int $3\n" : : ); // be paranoid about a correct PC
+	ioCPU->mCurrentRegisters[15] += 4; // update the PC
+	{
+		ioCPU->mCurrentRegisters[0] = r0; ioCPU->mCurrentRegisters[1] = r1; ioCPU->mCurrentRegisters[2] = r2; ioCPU->mCurrentRegisters[3] = r3; ioCPU->mCurrentRegisters[13] = r13; ioCPU->mCurrentRegisters[14] = r14;
+		KUInt32 baseAddress = r13;
+		KUInt32 wbAddress = baseAddress - (1 * 4);
+		baseAddress -= (1 * 4);
+		UJITGenericRetargetSupport::ManagedMemoryWriteAligned(ioCPU, baseAddress, r14);
+		baseAddress += 4;
+		r13 = wbAddress;
+	}
+// L00001004: 0xE3A02000  mov	r2, #0x00000000
+	ioCPU->mCurrentRegisters[15] = 0x00001004+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000000;
+		const KUInt32 theResult = Opnd2;
+		r2 = theResult;
+	}
+// L00001008: 0xE3510000  cmp	r1, #0x00000000
+	ioCPU->mCurrentRegisters[15] = 0x00001008+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000000;
+		KUInt32 Opnd1 = r1;
+		const KUInt32 theResult = Opnd1 - Opnd2;
+		ioCPU->mCPSR_Z = (theResult==0);
+		ioCPU->mCPSR_N = ((theResult&0x80000000)!=0);
+		ioCPU->mCPSR_C = ( ((Opnd1&~Opnd2)|(Opnd1&~theResult)|(~Opnd2&~theResult)) >> 31);
+		ioCPU->mCPSR_V = ( ((Opnd1&~Opnd2&~theResult)|(~Opnd1&Opnd2&theResult)) >> 31);
+	}
+// L0000100C: 0x0A000005  beq	00001028  =SumWords+28
+	ioCPU->mCurrentRegisters[15] = 0x0000100C+8; // update the PC
+	if (ioCPU->TestEQ()) {
+		SETPC(0x00001028+4);
+		goto L00001028;
+	}
+L00001010: // 0xE4903004  ldr	r3, [r0], #0x004
+	ioCPU->mCurrentRegisters[15] = 0x00001010+8; // update the PC
+	{
+		ioCPU->mCurrentRegisters[0] = r0; ioCPU->mCurrentRegisters[1] = r1; ioCPU->mCurrentRegisters[2] = r2; ioCPU->mCurrentRegisters[3] = r3; ioCPU->mCurrentRegisters[13] = r13; ioCPU->mCurrentRegisters[14] = r14;
+		KUInt32 offset = 0x00000004;
+		KUInt32 theAddress = r0;
+		KUInt32 theData = UJITGenericRetargetSupport::ManagedMemoryRead(ioCPU, theAddress);
+		r3 = theData;
+		r0 = theAddress + offset;
+	}
+// L00001014: 0xE3130001  tst	r3, #0x00000001
+	ioCPU->mCurrentRegisters[15] = 0x00001014+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000001;
+		KUInt32 Opnd1 = r3;
+		const KUInt32 theResult = Opnd1 & Opnd2;
+		ioCPU->mCPSR_Z = (theResult==0);
+		ioCPU->mCPSR_N = ((theResult&0x80000000)!=0);
+	}
+// L00001018: 0x1B000008  blne	AddOdd
+	ioCPU->mCurrentRegisters[15] = 0x00001018+8; // update the PC
+	if (ioCPU->TestNE()) {
+		ioCPU->mCurrentRegisters[0] = r0; ioCPU->mCurrentRegisters[1] = r1; ioCPU->mCurrentRegisters[2] = r2; ioCPU->mCurrentRegisters[3] = r3; ioCPU->mCurrentRegisters[13] = r13; ioCPU->mCurrentRegisters[14] = r14;
+		r14 = 0x00001018 + 4;
+		// rt cjitr AddOdd
+		ioCPU->mCurrentRegisters[14] = r14;
+		SETPC(0x00001040+4);
+		Func_0x00001040(ioCPU, 0x00001020);
+		r0 = ioCPU->mCurrentRegisters[0]; r1 = ioCPU->mCurrentRegisters[1]; r2 = ioCPU->mCurrentRegisters[2]; r3 = ioCPU->mCurrentRegisters[3]; r13 = ioCPU->mCurrentRegisters[13]; r14 = ioCPU->mCurrentRegisters[14];
+		if (ioCPU->mCurrentRegisters[15]!=0x00001020) {
+			RT_PANIC_UNEXPECTED_RETURN_ADDRESS
+		}
+	}
+// L0000101C: 0xE0822003  add	r2, r2, r3
+	ioCPU->mCurrentRegisters[15] = 0x0000101C+8; // update the PC
+	{
+		KUInt32 Opnd2 = r3;
+		KUInt32 Opnd1 = r2;
+		const KUInt32 theResult = Opnd1 + Opnd2;
+		r2 = theResult;
+	}
+// L00001020: 0xE2511001  subs	r1, r1, #0x00000001
+	ioCPU->mCurrentRegisters[15] = 0x00001020+8; // update the PC
+	{
+		KUInt32 Opnd2 = 0x00000001;
+		KUInt32 Opnd1 = r1;
+		const KUInt32 theResult = Opnd1 - Opnd2;
+		r1 = theResult;
+		ioCPU->mCPSR_Z = (theResult==0);
+		ioCPU->mCPSR_N = ((theResult&0x80000000)!=0);
+		ioCPU->mCPSR_C = ( ((Opnd1&~Opnd2)|(Opnd1&~theResult)|(~Opnd2&~theResult)) >> 31);
+		ioCPU->mCPSR_V = ( ( (Opnd1&~Opnd2&~theResult)|(~Opnd1&Opnd2&theResult) ) >> 31);
+	}
+// L00001024: 0x1AFFFFF9  bne	00001010  =SumWords+10
+	ioCPU->mCurrentRegisters[15] = 0x00001024+8; // update the PC
+	if (ioCPU->TestNE()) {
+		SETPC(0x00001010+4);
+		goto L00001010;
+	}
+L00001028: // 0xE5802000  str	r2, [r0]
+	ioCPU->mCurrentRegisters[15] = 0x00001028+8; // update the PC
+	{
+		ioCPU->mCurrentRegisters[0] = r0; ioCPU->mCurrentRegisters[1] = r1; ioCPU->mCurrentRegisters[2] = r2; ioCPU->mCurrentRegisters[3] = r3; ioCPU->mCurrentRegisters[13] = r13; ioCPU->mCurrentRegisters[14] = r14;
+		KUInt32 offset = 0x00000000;
+		KUInt32 theAddress = r0 + offset;
+		KUInt32 theValue = r2;
+		UJITGenericRetargetSupport::ManagedMemoryWrite(ioCPU, theAddress, theValue);
+	}
+// L0000102C: 0xE1A00002  mov	r0, r2
+	ioCPU->mCurrentRegisters[15] = 0x0000102C+8; // update the PC
+	{
+		KUInt32 Opnd2 = r2;
+		const KUInt32 theResult = Opnd2;
+		r0 = theResult;
+	}
+// L00001030: 0xE8BD8000  ldmea	r13!, {pc}
+	ioCPU->mCurrentRegisters[15] = 0x00001030+8; // update the PC
+	{
+		ioCPU->mCurrentRegisters[0] = r0; ioCPU->mCurrentRegisters[1] = r1; ioCPU->mCurrentRegisters[2] = r2; ioCPU->mCurrentRegisters[3] = r3; ioCPU->mCurrentRegisters[13] = r13; ioCPU->mCurrentRegisters[14] = r14;
+		KUInt32 baseAddress = r13;
+		KUInt32 wbAddress = baseAddress + (1 * 4);
+		SETPC( UJITGenericRetargetSupport::ManagedMemoryReadAligned(ioCPU, baseAddress)) + 4;
+		r13 = wbAddress;
+		ioCPU->mCurrentRegisters[13] = r13;
+		return; //MMUCALLNEXT_AFTERSETPC;
+	}
+	ioCPU->mCurrentRegisters[0] = r0; ioCPU->mCurrentRegisters[1] = r1; ioCPU->mCurrentRegisters[2] = r2; ioCPU->mCurrentRegisters[3] = r3; ioCPU->mCurrentRegisters[13] = r13; ioCPU->mCurrentRegisters[14] = r14;
+	__asm__("int $3\n" : : ); // There was no return instruction found
+}
+
+void Func_0x00001040(TARMProcessor* ioCPU, KUInt32 ret)
+{
+	KUInt32 r3 = ioCPU->mCurrentRegisters[3];
+	KUInt32 r14 = ioCPU->mCurrentRegisters[14];
+// L00001040: 0xE0833003  add	r3, r3, r3
+	if (ioCPU->mCurrentRegisters[15]!=0x00001040+4) __asm__("int $3\n" : : ); // be paranoid about a correct PC
+	ioCPU->mCurrentRegisters[15] += 4; // update the PC
+	{
+		KUInt32 Opnd2 = r3;
+		KUInt32 Opnd1 = r3;
+		const KUInt32 theResult = Opnd1 + Opnd2;
+		r3 = theResult;
+	}
+// L00001044: 0xE1A0F00E  mov	pc, lr
+	ioCPU->mCurrentRegisters[15] = 0x00001044+8; // update the PC
+	{
+		ioCPU->mCurrentRegisters[3] = r3;
+		KUInt32 Opnd2 = r14;
+		const KUInt32 theResult = Opnd2;
+		SETPC(theResult + 4);
+		if (ret==0xFFFFFFFF)
+			return; // Return to emulator
+		if (ioCPU->mCurrentRegisters[15]!=ret)
+			__asm__("int $3\n" : : ); // Unexpected return address
+		return;
+	}
+	ioCPU->mCurrentRegisters[3] = r3;
+	__asm__("int $3\n" : : ); // There was no return instruction found
+}
+}
+#endif
+
+// -------------------------------------------------------------------------- //
+//  * CreateROM( void )
+// -------------------------------------------------------------------------- //
+static KUInt8*
+CreateROM( void )
+{
+	KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+	(void) ::memcpy( rom, kResetCode, sizeof(kResetCode) );
+	(void) ::memcpy( rom + kSumWords, kSumWordsCode, sizeof(kSumWordsCode) );
+	(void) ::memcpy( rom + kAddOdd, kAddOddCode, sizeof(kAddOddCode) );
+	return rom;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteWords( TMemory*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+WriteWords( TMemory* inMemory, KUInt32 inNbWords )
+{
+	KUInt32 indexWord;
+	for (indexWord = 0; indexWord < inNbWords; indexWord++)
+	{
+		(void) inMemory->Write(
+			kWords + (4 * indexWord),
+			kWordValues[indexWord % kNbWords] );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetState( TARMProcessor*, TMemory*, KUInt32[] )
+// -------------------------------------------------------------------------- //
+static void
+GetState(
+			TARMProcessor* inProcessor,
+			TMemory* inMemory,
+			KUInt32 outState[kStateSize] )
+{
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < TARMProcessor::kR15; indexReg++)
+	{
+		outState[indexReg] = inProcessor->GetRegister( indexReg );
+	}
+	outState[kStateCPSR] = inProcessor->GetCPSR();
+	outState[kStateSum] = 0;
+	(void) inMemory->Read( kWords + (4 * kNbWords), outState[kStateSum] );
+}
+
+// -------------------------------------------------------------------------- //
+//  * LogState( TLog*, const char*, const KUInt32[] )
+// -------------------------------------------------------------------------- //
+static void
+LogState(
+			TLog* inLog,
+			const char* inLabel,
+			const KUInt32 inState[kStateSize] )
+{
+	inLog->FLogLine(
+		"%s: r0=%.8X r1=%.8X r2=%.8X r3=%.8X lr=%.8X cpsr=%.8X sum=%.8X",
+		inLabel,
+		(unsigned int) inState[0],
+		(unsigned int) inState[1],
+		(unsigned int) inState[2],
+		(unsigned int) inState[3],
+		(unsigned int) inState[14],
+		(unsigned int) inState[kStateCPSR],
+		(unsigned int) inState[kStateSum] );
+}
+
+#ifdef JITTARGET_GENERIC
+// -------------------------------------------------------------------------- //
+//  * CreateSymbolList( void )
+// -------------------------------------------------------------------------- //
+static TSymbolList*
+CreateSymbolList( void )
+{
+	FILE* theSymbols = ::fopen( kTempSymbolsPath, "w" );
+	if (theSymbols)
+	{
+		(void) ::fprintf( theSymbols, "%.8X\tSumWords\n", (unsigned int) kSumWords );
+		(void) ::fprintf( theSymbols, "%.8X\tAddOdd\n", (unsigned int) kAddOdd );
+		(void) ::fclose( theSymbols );
+	}
+	return new TSymbolList( kTempSymbolsPath );
+}
+
+// -------------------------------------------------------------------------- //
+//  * DeleteSymbolList( TSymbolList* )
+// -------------------------------------------------------------------------- //
+static void
+DeleteSymbolList( TSymbolList* inSymbolList )
+{
+	delete inSymbolList;
+	UDisasm::setSymbolList( NULL );
+	(void) ::unlink( kTempSymbolsPath );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Emulate( TLog*, TEmulator*, KUInt32[] )
+// -------------------------------------------------------------------------- //
+static void
+Emulate(
+			TLog* inLog,
+			TEmulator* inEmulator,
+			KUInt32 outState[kStateSize] )
+{
+	WriteWords( inEmulator->GetMemory(), kNbWords );
+	inEmulator->Run();
+	GetState( inEmulator->GetProcessor(), inEmulator->GetMemory(), outState );
+	if (inLog)
+	{
+		LogState( inLog, "Emulated", outState );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * Retarget( TMemory*, TSymbolList*, bool, bool, TLog*, SRetargetCounts& )
+// -------------------------------------------------------------------------- //
+static void
+Retarget(
+			TMemory* inMemory,
+			TSymbolList* inSymbolList,
+			bool inParanoid,
+			bool inLocalRegisters,
+			TLog* inListingLog,
+			SRetargetCounts& outCounts )
+{
+	static const char* kRegister = "ioCPU->mCurrentRegisters[";
+	(void) ::memset( &outCounts, 0, sizeof(outCounts) );
+	TJITGenericRetarget theRetarget( inMemory, inSymbolList );
+	theRetarget.SetParanoid( inParanoid );
+	theRetarget.SetLocalRegisters( inLocalRegisters );
+	theRetarget.SetRetargetMap( kSumWords, kSumWords + sizeof(kSumWordsCode), 1 );
+	theRetarget.SetRetargetMap( kAddOdd, kAddOdd + sizeof(kAddOddCode), 1 );
+	if (!theRetarget.OpenFiles( kTempRetargetPath ))
+	{
+		theRetarget.TranslateFunction(
+			kSumWords, kSumWords + sizeof(kSumWordsCode), "SumWords", false, true );
+		theRetarget.TranslateFunction(
+			kAddOdd, kAddOdd + sizeof(kAddOddCode), "AddOdd", false, true );
+		theRetarget.CloseFiles();
+	}
+	theRetarget.SetRetargetMap( kSumWords, kSumWords + sizeof(kSumWordsCode), 0 );
+	theRetarget.SetRetargetMap( kAddOdd, kAddOdd + sizeof(kAddOddCode), 0 );
+
+	// Count the checks and the accesses to r0-r14, and list the function.
+	// The locals are loaded with "KUInt32 rN = ...", written back with
+	// "... = rN;" and read again with "rN = ...".
+	FILE* theFile = ::fopen( kTempRetargetPath ".cp", "r" );
+	if (theFile)
+	{
+		Boolean inFunction = false;
+		char theLine[1024];
+		while (::fgets( theLine, sizeof(theLine), theFile ))
+		{
+			if (::strncmp( theLine, "void Func_", 10 ) == 0)
+			{
+				inFunction = true;
+			}
+			if (!inFunction)
+			{
+				continue;
+			}
+			if (::strstr( theLine, "be paranoid about a correct PC" ))
+			{
+				outCounts.fChecks++;
+			}
+			Boolean isWriteBack = false;
+			Boolean isReload = false;
+			const char* theText = theLine + ::strspn( theLine, "\t " );
+			const char* theAccess = theLine;
+			while ((theAccess = ::strstr( theAccess, kRegister )) != NULL)
+			{
+				theAccess += ::strlen( kRegister );
+				const char* theEnd = ::strchr( theAccess, ']' );
+				if (::strncmp( theAccess, "15]", 3 ) == 0) {
+					// The PC always stays in the CPU.
+				} else if (::strncmp( theLine, "\tKUInt32 r", 10 ) == 0) {
+					outCounts.fLoads++;
+				} else if (theEnd && (::strncmp( theEnd, "] = r", 5 ) == 0)
+					&& ::isdigit( theEnd[5] )) {
+					isWriteBack = true;
+				} else if ((theText[0] == 'r') && ::isdigit( theText[1] )) {
+					isReload = true;
+				} else {
+					outCounts.fAccesses++;
+				}
+			}
+			if (isWriteBack)
+			{
+				outCounts.fWriteBacks++;
+			}
+			if (isReload)
+			{
+				outCounts.fReloads++;
+			}
+			if (inListingLog)
+			{
+				theLine[::strcspn( theLine, "\n" )] = 0;
+				inListingLog->LogLine( theLine );
+			}
+			if (::strcmp( theLine, "}" ) == 0)
+			{
+				inFunction = false;
+			}
+		}
+		(void) ::fclose( theFile );
+	}
+	(void) ::unlink( kTempRetargetPath ".cp" );
+	(void) ::unlink( kTempRetargetPath ".h" );
+}
+#endif
+
+#if kRunRetargetedCode
+// -------------------------------------------------------------------------- //
+//  * CallSumWords( TLog*, TARMProcessor*, JITSimPtr, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+CallSumWords(
+			TLog* inLog,
+			TARMProcessor* ioCPU,
+			JITSimPtr inFunction,
+			KUInt32 inNbWords )
+{
+	// As the reset code does.
+	ioCPU->SetRegister( 0, kWords );
+	ioCPU->SetRegister( 1, inNbWords );
+	ioCPU->SetRegister( 13, kStack );
+	ioCPU->SetRegister( 14, kSumWordsReturn );
+	ioCPU->SetRegister( 15, kSumWords + 4 );
+	try {
+		inFunction( ioCPU, 0xFFFFFFFF );
+	} catch (const char* theException) {
+		if (inLog)
+		{
+			inLog->FLogLine( "Retargeted code threw %s", theException );
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * CompareWithEmulator( TLog*, JITSimPtr, KUInt8*, const KUInt32[] )
+// -------------------------------------------------------------------------- //
+static void
+CompareWithEmulator(
+			TLog* inLog,
+			JITSimPtr inFunction,
+			KUInt8* inROM,
+			const KUInt32 inEmulatedState[kStateSize] )
+{
+	{
+		TEmulator theEmulator( inLog, inROM, kTempFlashPath );
+		TMemory* theMemory = theEmulator.GetMemory();
+		TARMProcessor* theProcessor = theEmulator.GetProcessor();
+		WriteWords( theMemory, kNbWords );
+		theProcessor->SetCPSR( inEmulatedState[kStateCPSR]
+			& ~(KUInt32) (TARMProcessor::kPSR_NBit | TARMProcessor::kPSR_ZBit
+				| TARMProcessor::kPSR_CBit | TARMProcessor::kPSR_VBit) );
+		CallSumWords( inLog, theProcessor, inFunction, kNbWords );
+		KUInt32 theRetargetedState[kStateSize];
+		GetState( theProcessor, theMemory, theRetargetedState );
+		KUInt32 theDifferences = 0;
+		KUInt32 indexState;
+		for (indexState = 0; indexState < kStateSize; indexState++)
+		{
+			if (theRetargetedState[indexState] != inEmulatedState[indexState])
+			{
+				theDifferences++;
+			}
+		}
+		if (inLog)
+		{
+			LogState( inLog, "Retargeted", theRetargetedState );
+			inLog->FLogLine( "Returned to %.8X, %u differences with the emulator",
+				(unsigned int) theProcessor->GetRegister( 15 ) - 4,
+				(unsigned int) theDifferences );
+		}
+	}
+	(void) ::unlink( kTempFlashPath );
+}
+#endif
+
+// -------------------------------------------------------------------------- //
+//  * Release( TLog* )
+// -------------------------------------------------------------------------- //
+void
+URetargetTests::Release( TLog* inLog )
+{
+#ifdef JITTARGET_GENERIC
+	TSymbolList* theSymbolList = CreateSymbolList();
+	KUInt8* rom = CreateROM();
+	KUInt32 theEmulatedState[kStateSize];
+	{
+		TEmulator theEmulator( inLog, rom, kTempFlashPath );
+		Emulate( inLog, &theEmulator, theEmulatedState );
+
+		// Retarget the function from the memory of the emulator.
+		SRetargetCounts theParanoidCounts;
+		SRetargetCounts theReleaseCounts;
+		Retarget( theEmulator.GetMemory(), theSymbolList, true, false, NULL,
+			theParanoidCounts );
+		Retarget( theEmulator.GetMemory(), theSymbolList, false, false, inLog,
+			theReleaseCounts );
+		if (inLog)
+		{
+			inLog->FLogLine( "%u PC checks in paranoid code, %u in release code",
+				(unsigned int) theParanoidCounts.fChecks,
+				(unsigned int) theReleaseCounts.fChecks );
+		}
+	}
+	(void) ::unlink( kTempFlashPath );
+
+#if kRunRetargetedCode
+	CompareWithEmulator( inLog, Release::Func_0x00001000, rom, theEmulatedState );
+#endif
+	::free( rom );
+	DeleteSymbolList( theSymbolList );
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+//  * LocalRegisters( TLog* )
+// -------------------------------------------------------------------------- //
+void
+URetargetTests::LocalRegisters( TLog* inLog )
+{
+#ifdef JITTARGET_GENERIC
+	TSymbolList* theSymbolList = CreateSymbolList();
+	KUInt8* rom = CreateROM();
+	KUInt32 theEmulatedState[kStateSize];
+	{
+		TEmulator theEmulator( inLog, rom, kTempFlashPath );
+		Emulate( inLog, &theEmulator, theEmulatedState );
+
+		// Retarget the function from the memory of the emulator.
+		SRetargetCounts theCPUCounts;
+		SRetargetCounts theLocalCounts;
+		Retarget( theEmulator.GetMemory(), theSymbolList, false, false, NULL,
+			theCPUCounts );
+		Retarget( theEmulator.GetMemory(), theSymbolList, false, true, inLog,
+			theLocalCounts );
+		if (inLog)
+		{
+			inLog->FLogLine(
+				"%u accesses to r0-r14 in the CPU by instructions, %u with local registers",
+				(unsigned int) theCPUCounts.fAccesses,
+				(unsigned int) theLocalCounts.fAccesses );
+			inLog->FLogLine(
+				"%u registers loaded at the entry, written back on %u lines, read again on %u",
+				(unsigned int) theLocalCounts.fLoads,
+				(unsigned int) theLocalCounts.fWriteBacks,
+				(unsigned int) theLocalCounts.fReloads );
+		}
+	}
+	(void) ::unlink( kTempFlashPath );
+
+#if kRunRetargetedCode
+	CompareWithEmulator( inLog, LocalRegisters::Func_0x00001000, rom, theEmulatedState );
+#endif
+	::free( rom );
+	DeleteSymbolList( theSymbolList );
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+//  * BenchmarkLocalRegisters( const char*, TLog* )
+// -------------------------------------------------------------------------- //
+void
+URetargetTests::BenchmarkLocalRegisters( const char* inLoops, TLog* inLog )
+{
+	KUInt32 loops;
+	if (inLoops == nil)
+	{
+		(void) ::printf( "This test requires a number of loops in decimal.\n" );
+	} else if (::sscanf( inLoops, "%d", (unsigned int*) &loops ) != 1) {
+		(void) ::printf( "Can't parse number of loops (%s).\n", inLoops );
+	} else {
+#if kRunRetargetedCode
+		static const struct {
+			const char*	fName;
+			JITSimPtr	fFunction;
+		} kVersions[] = {
+			{ "Registers in the CPU", Release::Func_0x00001000 },
+			{ "Registers in locals", LocalRegisters::Func_0x00001000 }
+		};
+		KUInt8* rom = CreateROM();
+		KUInt32 indexVersion;
+		for (indexVersion = 0; indexVersion < 2; indexVersion++)
+		{
+			TEmulator theEmulator( inLog, rom, kTempFlashPath );
+			TARMProcessor* theProcessor = theEmulator.GetProcessor();
+			WriteWords( theEmulator.GetMemory(), kBenchmarkNbWords );
+			struct timeval theStart;
+			struct timeval theEnd;
+			(void) ::gettimeofday( &theStart, NULL );
+			KUInt32 indexLoop;
+			for (indexLoop = 0; indexLoop < loops; indexLoop++)
+			{
+				CallSumWords(
+					inLog,
+					theProcessor,
+					kVersions[indexVersion].fFunction,
+					kBenchmarkNbWords );
+			}
+			(void) ::gettimeofday( &theEnd, NULL );
+			double theElapsed =
+				(theEnd.tv_sec - theStart.tv_sec)
+				+ (theEnd.tv_usec - theStart.tv_usec) / 1000000.0;
+			if (inLog) {
+				inLog->FLogLine(
+					"%s: %u calls over %u words, sum %.8X, %.3f s",
+					kVersions[indexVersion].fName,
+					(unsigned int) loops,
+					(unsigned int) kBenchmarkNbWords,
+					(unsigned int) theProcessor->GetRegister( 0 ),
+					theElapsed );
+			}
+			(void) ::unlink( kTempFlashPath );
+		}
+		::free( rom );
+#else
+		(void) ::printf( "The retargeted code only runs on x86 hosts.\n" );
+#endif
+	}
+}
+
+// ========================================================================== //
+// Everyone knows that debugging is twice as hard as writing a program in the //
+// first place. So if you're as clever as you can be when you write it, how   //
+// will you ever debug it?                                                    //
+//                 -- Brian Kernighan                                         //
+// ========================================================================== //
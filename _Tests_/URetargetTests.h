@@ -0,0 +1,68 @@
+// ==============================
+// File:			URetargetTests.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _URETARGETTESTS_H
+#define _URETARGETTESTS_H
+
+#include <K/Defines/KDefinitions.h>
+
+#include "Emulator/Log/TLog.h"
+
+///
+/// Class to test the code of the retargeting tool.
+///
+class URetargetTests
+{
+public:
+	///
+	/// Retarget a function without the paranoid PC checks, and compare
+	/// the state of the emulator after running the retargeted code with
+	/// the state after running the function in the emulator.
+	///
+	static void Release( TLog* inLog );
+
+	///
+	/// Retarget a function with r0-r14 in local variables, count the
+	/// accesses to the registers of the CPU left, and compare the state
+	/// after running the retargeted code with the emulator. The function
+	/// has conditional branches and a conditional call.
+	///
+	static void LocalRegisters( TLog* inLog );
+
+	///
+	/// Time the retargeted function with the registers in the CPU and
+	/// with the registers in local variables.
+	///
+	/// \param inLoops	number of calls, in decimal.
+	///
+	static void BenchmarkLocalRegisters( const char* inLoops, TLog* inLog );
+};
+
+#endif
+		// _URETARGETTESTS_H
+
+// ========================================================================== //
+// If builders built buildings the way programmers wrote programs, then the   //
+// first woodpecker that came along would destroy civilization.               //
+//                 -- Gerald Weinberg                                         //
+// ========================================================================== //
@@ -0,0 +1,272 @@
+// ==============================
+// File:			USchedulerTests.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "USchedulerTests.h"
+
+// ANSI C & POSIX
+#include <stdlib.h>
+#include <string.h>
+
+#if !TARGET_OS_WIN32
+	#include <unistd.h>
+#endif
+
+// Einstein
+#include "Emulator/Log/TLog.h"
+#include "Emulator/TEmulator.h"
+#include "Emulator/TARMProcessor.h"
+#include "Emulator/Scheduler/TScheduler.h"
+#include "Emulator/Scheduler/TTask.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+#if TARGET_OS_WIN32
+	#define kTempFlashPath "c:/EinsteinTests.flash"
+#else
+	#define kTempFlashPath "/tmp/EinsteinTests.flash"
+#endif
+
+enum EEvent {
+	kAdd,
+	kAddWhenNotCurrent,
+	kRemove,
+	kSetPriority,
+	kHold,
+	kAllow,
+	kSchedule,			///< Schedule, the current task keeps its time slice.
+	kTimeSliceOver		///< Schedule at the end of the time slice.
+};
+
+struct SEvent {
+	EEvent		fEvent;
+	char		fTask;		///< Task of the event.
+	KUInt32		fPriority;	///< New priority for kSetPriority.
+	char		fExpected;	///< Task the kernel chose, or '-' for none.
+};
+
+// The tasks: the idle task, two tasks at 20 and two at 25 and 30.
+static const char kTaskNames[] = "IABCD";
+static const KUInt32 kTaskPriorities[] = { 0, 20, 20, 25, 30 };
+const KUInt32 kNbTasks = 5;
+
+// A sequence of scheduling decisions.
+static const SEvent kEvents[] = {
+	{ kAdd,					'I', 0, 0 },
+	{ kAdd,					'A', 0, 0 },
+	{ kSchedule,			0, 0, 'A' },
+	{ kAdd,					'B', 0, 0 },
+	{ kSchedule,			0, 0, 'A' },	// Same priority.
+	{ kTimeSliceOver,		0, 0, 'B' },
+	{ kTimeSliceOver,		0, 0, 'A' },
+	{ kAdd,					'C', 0, 0 },
+	{ kSchedule,			0, 0, 'C' },	// A keeps its turn.
+	{ kHold,				0, 0, 0 },
+	{ kAdd,					'D', 0, 0 },
+	{ kSchedule,			0, 0, 'C' },	// On hold.
+	{ kAllow,				0, 0, 0 },
+	{ kSchedule,			0, 0, 'D' },
+	{ kRemove,				'D', 0, 0 },	// D blocks.
+	{ kSchedule,			0, 0, 'C' },
+	{ kRemove,				'C', 0, 0 },
+	{ kSchedule,			0, 0, 'A' },
+	{ kSetPriority,			'B', 26, 0 },
+	{ kSchedule,			0, 0, 'B' },
+	{ kRemove,				'B', 0, 0 },	// B is woken up before it
+	{ kAddWhenNotCurrent,	'B', 0, 0 },	// blocks.
+	{ kSchedule,			0, 0, 'B' },
+	{ kRemove,				'B', 0, 0 },
+	{ kRemove,				'A', 0, 0 },
+	{ kSchedule,			0, 0, 'I' },
+	{ kRemove,				'I', 0, 0 },
+	{ kSchedule,			0, 0, '-' },
+	{ kAdd,					'C', 0, 0 },
+	{ kSchedule,			0, 0, 'C' },
+	{ kTimeSliceOver,		0, 0, 'C' },	// Alone at 25.
+};
+
+// -------------------------------------------------------------------------- //
+//  * TaskName( TTask* const[], TTask* )
+// -------------------------------------------------------------------------- //
+static char
+TaskName( TTask* const inTasks[], TTask* inTask )
+{
+	KUInt32 indexTask;
+	for (indexTask = 0; indexTask < kNbTasks; indexTask++)
+	{
+		if (inTasks[indexTask] == inTask)
+		{
+			return kTaskNames[indexTask];
+		}
+	}
+	return '-';
+}
+
+// -------------------------------------------------------------------------- //
+//  * LogRegisters( TLog*, const char*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+static void
+LogRegisters( TLog* inLog, const char* inLabel, TARMProcessor* inCPU )
+{
+	inLog->FLogLine(
+		"%s: r0=%.8X sp=%.8X lr=%.8X pc=%.8X cpsr=%.8X",
+		inLabel,
+		(unsigned int) inCPU->GetRegister( 0 ),
+		(unsigned int) inCPU->GetRegister( 13 ),
+		(unsigned int) inCPU->GetRegister( 14 ),
+		(unsigned int) inCPU->GetRegister( 15 ),
+		(unsigned int) inCPU->GetCPSR() );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Replay( TLog* )
+// -------------------------------------------------------------------------- //
+void
+USchedulerTests::Replay( TLog* inLog )
+{
+	TScheduler theScheduler;
+	TTask* theTasks[kNbTasks];
+	KUInt32 indexTask;
+	for (indexTask = 0; indexTask < kNbTasks; indexTask++)
+	{
+		theTasks[indexTask] = new TTask(
+			0x0C101000 + (indexTask * 0x100),
+			kTaskPriorities[indexTask] );
+	}
+
+	KUInt32 nbDecisions = 0;
+	KUInt32 nbMismatches = 0;
+	KUInt32 indexEvent;
+	for (indexEvent = 0; indexEvent < sizeof(kEvents) / sizeof(kEvents[0]); indexEvent++)
+	{
+		const SEvent* theEvent = &kEvents[indexEvent];
+		TTask* theTask = nil;
+		if (theEvent->fTask)
+		{
+			theTask = theTasks[::strchr( kTaskNames, theEvent->fTask ) - kTaskNames];
+		}
+		switch (theEvent->fEvent)
+		{
+			case kAdd:
+				theScheduler.Add( theTask );
+				break;
+
+			case kAddWhenNotCurrent:
+				theScheduler.AddWhenNotCurrent( theTask );
+				break;
+
+			case kRemove:
+				theScheduler.Remove( theTask );
+				break;
+
+			case kSetPriority:
+				theScheduler.SetPriority( theTask, theEvent->fPriority );
+				break;
+
+			case kHold:
+				theScheduler.HoldSchedule();
+				break;
+
+			case kAllow:
+				theScheduler.AllowSchedule();
+				break;
+
+			case kSchedule:
+			case kTimeSliceOver:
+				{
+					char theChoice = TaskName(
+						theTasks,
+						theScheduler.Schedule( theEvent->fEvent == kTimeSliceOver ) );
+					nbDecisions++;
+					if (theChoice != theEvent->fExpected)
+					{
+						nbMismatches++;
+					}
+					if (inLog)
+					{
+						inLog->FLogLine( "%2u: %s -> %c%s",
+							(unsigned int) indexEvent,
+							theEvent->fEvent == kSchedule ? "schedule" : "time slice",
+							theChoice,
+							theChoice == theEvent->fExpected ? "" : " MISMATCH" );
+					}
+				}
+				break;
+		}
+	}
+	if (inLog)
+	{
+		inLog->FLogLine( "%u decisions, %u mismatches",
+			(unsigned int) nbDecisions,
+			(unsigned int) nbMismatches );
+	}
+
+	for (indexTask = 0; indexTask < kNbTasks; indexTask++)
+	{
+		delete theTasks[indexTask];
+	}
+
+	// Switch the processor between two tasks of the same priority.
+	KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+	{
+		TEmulator theEmulator( inLog, rom, kTempFlashPath );
+		TARMProcessor* theProcessor = theEmulator.GetProcessor();
+		TScheduler theSwitchScheduler;
+		TTask theFirstTask( 0x0C101000, 20 );
+		TTask theSecondTask( 0x0C101100, 20 );
+		KUInt32 indexReg;
+		theProcessor->SetCPSR( TARMProcessor::kUserMode );
+		for (indexReg = 0; indexReg < TTask::kNbRegisters; indexReg++)
+		{
+			theProcessor->SetRegister( indexReg, 0xA0000000 + indexReg );
+			theSecondTask.SetRegister( indexReg, 0xB0000000 + indexReg );
+		}
+		theSecondTask.SetPSR( TARMProcessor::kUserMode | TARMProcessor::kPSR_ZBit );
+		theSwitchScheduler.SetCurrentTask( &theFirstTask );
+		theSwitchScheduler.Add( &theSecondTask );
+
+		Boolean theResult = theSwitchScheduler.SwitchTask( theProcessor, false );
+		if (inLog)
+		{
+			inLog->FLogLine( "Preemption only: %s",
+				theResult ? "no switch" : "switched" );
+		}
+		theResult = theSwitchScheduler.SwitchTask( theProcessor, true );
+		if (inLog)
+		{
+			LogRegisters( inLog, theResult ? "No switch" : "Second task", theProcessor );
+		}
+		theResult = theSwitchScheduler.SwitchTask( theProcessor, true );
+		if (inLog)
+		{
+			LogRegisters( inLog, theResult ? "No switch" : "First task", theProcessor );
+		}
+	}
+	(void) ::unlink( kTempFlashPath );
+	::free( rom );
+}
+
+// ========================================================================== //
+// One person's error is another person's data.                               //
+// ========================================================================== //
@@ -0,0 +1,50 @@
+// ==============================
+// File:			USchedulerTests.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _USCHEDULERTESTS_H
+#define _USCHEDULERTESTS_H
+
+#include <K/Defines/KDefinitions.h>
+
+#include "Emulator/Log/TLog.h"
+
+///
+/// Class to test the host mirror of the scheduler.
+///
+class USchedulerTests
+{
+public:
+	///
+	/// Replay a recorded sequence of scheduling decisions, and switch the
+	/// processor between two tasks.
+	///
+	static void Replay( TLog* inLog );
+};
+
+#endif
+		// _USCHEDULERTESTS_H
+
+// ====================================================================== //
+// Any sufficiently advanced bug is indistinguishable from a feature.     //
+//                 -- Rich Kulawiec                                       //
+// ====================================================================== //
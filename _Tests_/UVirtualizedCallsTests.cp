@@ -0,0 +1,536 @@
+// ==============================
+// File:			UVirtualizedCallsTests.cp
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "UVirtualizedCallsTests.h"
+
+// ANSI C & POSIX
+#include <stdlib.h>
+#include <string.h>
+
+#if !TARGET_OS_WIN32
+	#include <unistd.h>
+#endif
+
+// Einstein
+#include "Emulator/Log/TLog.h"
+#include "Emulator/TMemory.h"
+#include "Emulator/TEmulator.h"
+#include "Emulator/TARMProcessor.h"
+#include "Emulator/NativeCalls/TVirtualizedCalls.h"
+#include "Emulator/NativeCalls/TVirtualizedCallsPatches.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+#if TARGET_OS_WIN32
+	#define kTempFlashPath "c:/EinsteinTests.flash"
+#else
+	#define kTempFlashPath "/tmp/EinsteinTests.flash"
+#endif
+
+// Reference memmove, at kGuestMemmove.
+static const KUInt32 kGuestMemmoveCode[] = {
+	0xE1A03000,		// 00: mov    r3, r0
+	0xE3520000,		// 04: cmp    r2, #0
+	0x0A00000C,		// 08: beq    40
+	0xE1500001,		// 0C: cmp    r0, r1
+	0x8A000004,		// 10: bhi    28
+	0xE4D1C001,		// 14: ldrb   r12, [r1], #1
+	0xE4C0C001,		// 18: strb   r12, [r0], #1
+	0xE2522001,		// 1C: subs   r2, r2, #1
+	0x1AFFFFFB,		// 20: bne    14
+	0xEA000005,		// 24: b      40
+	0xE0811002,		// 28: add    r1, r1, r2
+	0xE0800002,		// 2C: add    r0, r0, r2
+	0xE571C001,		// 30: ldrb   r12, [r1, #-1]!
+	0xE560C001,		// 34: strb   r12, [r0, #-1]!
+	0xE2522001,		// 38: subs   r2, r2, #1
+	0x1AFFFFFB,		// 3C: bne    30
+	0xE1A00003,		// 40: mov    r0, r3
+	0xE1200070,		// 44: bkpt   0
+};
+
+// Reference memset, at kGuestMemset.
+static const KUInt32 kGuestMemsetCode[] = {
+	0xE1A03000,		// 00: mov    r3, r0
+	0xE3520000,		// 04: cmp    r2, #0
+	0x0A000002,		// 08: beq    18
+	0xE4C31001,		// 0C: strb   r1, [r3], #1
+	0xE2522001,		// 10: subs   r2, r2, #1
+	0x1AFFFFFC,		// 14: bne    0C
+	0xE1200070,		// 18: bkpt   0
+};
+
+// Reference memcmp, at kGuestMemcmp.
+static const KUInt32 kGuestMemcmpCode[] = {
+	0xE1A03000,		// 00: mov    r3, r0
+	0xE3A00000,		// 04: mov    r0, #0
+	0xE3520000,		// 08: cmp    r2, #0
+	0x0A000005,		// 0C: beq    28
+	0xE4D3C001,		// 10: ldrb   r12, [r3], #1
+	0xE4D10001,		// 14: ldrb   r0, [r1], #1
+	0xE05C0000,		// 18: subs   r0, r12, r0
+	0x1A000001,		// 1C: bne    28
+	0xE2522001,		// 20: subs   r2, r2, #1
+	0x1AFFFFF9,		// 24: bne    10
+	0xE1200070,		// 28: bkpt   0
+};
+
+// Reference strlen, at kGuestStrlen.
+static const KUInt32 kGuestStrlenCode[] = {
+	0xE1A03000,		// 00: mov    r3, r0
+	0xE4D3C001,		// 04: ldrb   r12, [r3], #1
+	0xE35C0000,		// 08: cmp    r12, #0
+	0x1AFFFFFC,		// 0C: bne    04
+	0xE0430000,		// 10: sub    r0, r3, r0
+	0xE2400001,		// 14: sub    r0, r0, #1
+	0xE1200070,		// 18: bkpt   0
+};
+
+const KUInt32 kGuestMemmove = 0x00000000;	///< Reference routines.
+const KUInt32 kGuestMemset = 0x00000100;
+const KUInt32 kGuestMemcmp = 0x00000200;
+const KUInt32 kGuestStrlen = 0x00000300;
+const KUInt32 kROMData = 0x00002000;		///< Pattern in ROM.
+const KUInt32 kWindowSize = 0x1000;			///< Size of the windows.
+const KUInt32 kTranslationTable = 0x04004000;
+
+// -------------------------------------------------------------------------- //
+//  * Random( KUInt32& )
+// -------------------------------------------------------------------------- //
+static KUInt32
+Random( KUInt32& ioSeed )
+{
+	ioSeed = (ioSeed * 1103515245) + 12345;
+	return (ioSeed >> 8) & 0xFFFFFF;
+}
+
+// -------------------------------------------------------------------------- //
+//  * FillWindow( TMemory*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+FillWindow( TMemory* inMemory, KUInt32 inBase, KUInt32 inSeed )
+{
+	KUInt32 index;
+	for (index = 0; index < kWindowSize; index++)
+	{
+		(void) inMemory->WriteB( inBase + index, (KUInt8) Random( inSeed ) );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadWindow( TMemory*, KUInt32, KUInt8* )
+// -------------------------------------------------------------------------- //
+static void
+ReadWindow( TMemory* inMemory, KUInt32 inBase, KUInt8* outBytes )
+{
+	KUInt32 index;
+	for (index = 0; index < kWindowSize; index++)
+	{
+		(void) inMemory->ReadB( inBase + index, outBytes[index] );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * CreateROM( void )
+// -------------------------------------------------------------------------- //
+static KUInt8*
+CreateROM( void )
+{
+	KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+	(void) ::memcpy(
+		rom + kGuestMemmove, kGuestMemmoveCode, sizeof(kGuestMemmoveCode) );
+	(void) ::memcpy(
+		rom + kGuestMemset, kGuestMemsetCode, sizeof(kGuestMemsetCode) );
+	(void) ::memcpy(
+		rom + kGuestMemcmp, kGuestMemcmpCode, sizeof(kGuestMemcmpCode) );
+	(void) ::memcpy(
+		rom + kGuestStrlen, kGuestStrlenCode, sizeof(kGuestStrlenCode) );
+	KUInt32 index;
+	for (index = 0; index < kWindowSize; index += 4)
+	{
+		((KUInt32*) (rom + kROMData))[index / 4] = index * 0x9E3779B1;
+	}
+	
+	return rom;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EnableMMU( TMemory* )
+// -------------------------------------------------------------------------- //
+static void
+EnableMMU( TMemory* inMemory )
+{
+	// Two sections that are not contiguous in RAM:
+	// 0x00000000 -> 0x00000000 (ROM), 0x10000000 -> 0x04100000 and
+	// 0x10100000 -> 0x04300000. 0x20000000 is not mapped.
+	(void) inMemory->WriteP( kTranslationTable + (0x000 * 4), 0x00000C12 );
+	(void) inMemory->WriteP( kTranslationTable + (0x100 * 4), 0x04100C12 );
+	(void) inMemory->WriteP( kTranslationTable + (0x101 * 4), 0x04300C12 );
+	inMemory->SetTranslationTableBase( kTranslationTable );
+	inMemory->SetDomainAccessControl( 0x00000001 );
+	// The access permissions are computed when the mode changes.
+	inMemory->SetPrivilege( true );
+	inMemory->SetMMUEnabled( true );
+}
+
+// -------------------------------------------------------------------------- //
+//  * RunGuest( TEmulator*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+RunGuest( TEmulator* inEmulator, KUInt32 inAddress )
+{
+	// Until the bkpt.
+	inEmulator->GetProcessor()->SetRegister( 15, inAddress + 4 );	// Prefetch.
+	inEmulator->Run();
+}
+
+// -------------------------------------------------------------------------- //
+//  * CompareMemmove( TLog*, TEmulator*, TVirtualizedCalls*, KUInt32, ... )
+// -------------------------------------------------------------------------- //
+static KUInt32
+CompareMemmove(
+			TLog* inLog,
+			TEmulator* inEmulator,
+			TVirtualizedCalls* inCalls,
+			KUInt32 inWindow,
+			KUInt32 inNbCases,
+			KUInt32 inSeed )
+{
+	TMemory* theMemory = inEmulator->GetMemory();
+	TARMProcessor* theProcessor = inEmulator->GetProcessor();
+	KUInt8 theExpected[kWindowSize];
+	KUInt8 theResult[kWindowSize];
+	KUInt32 theSeed = inSeed;
+	KUInt32 nbFailures = 0;
+	KUInt32 indexCase;
+	for (indexCase = 0; indexCase < inNbCases; indexCase++)
+	{
+		// Mostly short copies, some longer than the host buffer.
+		KUInt32 theLen = Random( theSeed ) % ((indexCase % 8) ? 600 : 3000);
+		KUInt32 theSrcOffset = Random( theSeed ) % (kWindowSize - theLen + 1);
+		KUInt32 theDstOffset;
+		if (indexCase & 1)
+		{
+			// Overlapping, in both directions.
+			KSInt32 theDelta = (KSInt32) (Random( theSeed ) % 64) - 32;
+			KSInt32 theOffset = (KSInt32) theSrcOffset + theDelta;
+			if (theOffset < 0)
+			{
+				theOffset = 0;
+			} else if (theOffset > (KSInt32) (kWindowSize - theLen)) {
+				theOffset = kWindowSize - theLen;
+			}
+			theDstOffset = (KUInt32) theOffset;
+		} else {
+			theDstOffset = Random( theSeed ) % (kWindowSize - theLen + 1);
+		}
+		KUInt32 theSrc = ((indexCase % 4) == 2) ? kROMData : inWindow;
+		theSrc += theSrcOffset;
+		KUInt32 theDst = inWindow + theDstOffset;
+		KUInt32 theFill = Random( theSeed );
+
+		// Emulated.
+		FillWindow( theMemory, inWindow, theFill );
+		theProcessor->SetRegister( 0, theDst );
+		theProcessor->SetRegister( 1, theSrc );
+		theProcessor->SetRegister( 2, theLen );
+		RunGuest( inEmulator, kGuestMemmove );
+		ReadWindow( theMemory, inWindow, theExpected );
+
+		// Virtualized.
+		FillWindow( theMemory, inWindow, theFill );
+		theProcessor->SetRegister( 0, theDst );
+		theProcessor->SetRegister( 1, theSrc );
+		theProcessor->SetRegister( 2, theLen );
+		inCalls->Execute( TVirtualizedCallsPatches::kmemmove );
+		ReadWindow( theMemory, inWindow, theResult );
+
+		if ((::memcmp( theExpected, theResult, kWindowSize ) != 0)
+			|| (theProcessor->GetRegister( 0 ) != theDst))
+		{
+			nbFailures++;
+			inLog->FLogLine(
+				"memmove( %.8X, %.8X, %u ) differs",
+				(unsigned int) theDst,
+				(unsigned int) theSrc,
+				(unsigned int) theLen );
+		}
+	}
+	
+	return nbFailures;
+}
+
+// -------------------------------------------------------------------------- //
+//  * MemmoveTest( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UVirtualizedCallsTests::MemmoveTest( TLog* inLog )
+{
+	KUInt8* rom = CreateROM();
+	TEmulator theEmulator( inLog, rom, kTempFlashPath );
+	TMemory* theMemory = theEmulator.GetMemory();
+	TARMProcessor* theProcessor = theEmulator.GetProcessor();
+	TVirtualizedCalls theCalls( &theEmulator, theMemory, theProcessor );
+
+	// Without the MMU, across 4 pages of RAM.
+	KUInt32 nbFailures =
+		CompareMemmove( inLog, &theEmulator, &theCalls, 0x04010000, 200, 1 );
+	inLog->FLogLine( "MMU off: %s", nbFailures ? "FAILED" : "ok" );
+
+	// With the MMU, across two sections.
+	EnableMMU( theMemory );
+	nbFailures =
+		CompareMemmove( inLog, &theEmulator, &theCalls, 0x100FF800, 200, 2 );
+	inLog->FLogLine( "MMU on: %s", nbFailures ? "FAILED" : "ok" );
+
+	// A destination that ends in a missing section: nothing is copied and
+	// a data abort is raised, so that the call can be executed again.
+	KUInt8 theBefore[kWindowSize];
+	KUInt8 theAfter[kWindowSize];
+	ReadWindow( theMemory, 0x100FF800, theBefore );
+	theProcessor->SetRegister( 0, 0x101FFF00 );
+	theProcessor->SetRegister( 1, 0x100FF800 );
+	theProcessor->SetRegister( 2, 0x200 );
+	theCalls.Execute( TVirtualizedCallsPatches::kmemmove );
+	ReadWindow( theMemory, 0x100FF800, theAfter );
+	inLog->FLogLine( "Fault: FSR=%.8X FAR=%.8X PC=%.8X mode=%.2X, %s",
+		(unsigned int) theMemory->GetFaultStatusRegister(),
+		(unsigned int) theMemory->GetFaultAddressRegister(),
+		(unsigned int) theProcessor->GetRegister( 15 ),
+		(unsigned int) (theProcessor->GetCPSR() & 0x1F),
+		::memcmp( theBefore, theAfter, kWindowSize ) ? "modified" : "unmodified" );
+
+	(void) ::unlink( kTempFlashPath );
+	::free( rom );
+}
+
+// -------------------------------------------------------------------------- //
+//  * CompareLibc( TLog*, TEmulator*, TVirtualizedCalls*, KUInt32, ... )
+// -------------------------------------------------------------------------- //
+static KUInt32
+CompareLibc(
+			TLog* inLog,
+			TEmulator* inEmulator,
+			TVirtualizedCalls* inCalls,
+			KUInt32 inWindow,
+			KUInt32 inNbCases,
+			KUInt32 inSeed )
+{
+	TMemory* theMemory = inEmulator->GetMemory();
+	TARMProcessor* theProcessor = inEmulator->GetProcessor();
+	KUInt8 theExpected[kWindowSize];
+	KUInt8 theResult[kWindowSize];
+	KUInt32 theSeed = inSeed;
+	KUInt32 nbFailures = 0;
+	KUInt32 indexCase;
+	for (indexCase = 0; indexCase < inNbCases; indexCase++)
+	{
+		KUInt32 theLen = Random( theSeed ) % ((indexCase % 8) ? 600 : 3000);
+		KUInt32 theOffset1 = Random( theSeed ) % (kWindowSize - theLen + 1);
+		KUInt32 theOffset2 = Random( theSeed ) % (kWindowSize - theLen + 1);
+		KUInt32 theFill = Random( theSeed );
+		KUInt32 theValue = Random( theSeed );
+		Boolean fromROM = ((indexCase % 4) == 2);
+
+		// memset.
+		KUInt32 theDst = inWindow + theOffset1;
+		FillWindow( theMemory, inWindow, theFill );
+		theProcessor->SetRegister( 0, theDst );
+		theProcessor->SetRegister( 1, theValue );
+		theProcessor->SetRegister( 2, theLen );
+		RunGuest( inEmulator, kGuestMemset );
+		ReadWindow( theMemory, inWindow, theExpected );
+
+		FillWindow( theMemory, inWindow, theFill );
+		theProcessor->SetRegister( 0, theDst );
+		theProcessor->SetRegister( 1, theValue );
+		theProcessor->SetRegister( 2, theLen );
+		inCalls->Execute( TVirtualizedCallsPatches::kmemset );
+		ReadWindow( theMemory, inWindow, theResult );
+
+		if ((::memcmp( theExpected, theResult, kWindowSize ) != 0)
+			|| (theProcessor->GetRegister( 0 ) != theDst))
+		{
+			nbFailures++;
+			inLog->FLogLine(
+				"memset( %.8X, %.2X, %u ) differs",
+				(unsigned int) theDst,
+				(unsigned int) (theValue & 0xFF),
+				(unsigned int) theLen );
+		}
+
+		// memcmp: the second buffer starts with a copy of the first one.
+		KUInt32 theS1 = (fromROM ? kROMData : inWindow) + theOffset1;
+		KUInt32 theS2 = inWindow + theOffset2;
+		KUInt32 theSame = (indexCase % 3) ? theLen : theValue % (theLen + 1);
+		KUInt32 index;
+		FillWindow( theMemory, inWindow, theFill );
+		for (index = 0; index < theSame; index++)
+		{
+			KUInt8 theByte;
+			(void) theMemory->ReadB( theS1 + index, theByte );
+			(void) theMemory->WriteB( theS2 + index, theByte );
+		}
+		theProcessor->SetRegister( 0, theS1 );
+		theProcessor->SetRegister( 1, theS2 );
+		theProcessor->SetRegister( 2, theLen );
+		RunGuest( inEmulator, kGuestMemcmp );
+		KUInt32 theExpectedResult = theProcessor->GetRegister( 0 );
+
+		theProcessor->SetRegister( 0, theS1 );
+		theProcessor->SetRegister( 1, theS2 );
+		theProcessor->SetRegister( 2, theLen );
+		inCalls->Execute( TVirtualizedCallsPatches::kmemcmp );
+
+		if (theProcessor->GetRegister( 0 ) != theExpectedResult)
+		{
+			nbFailures++;
+			inLog->FLogLine(
+				"memcmp( %.8X, %.8X, %u ) differs",
+				(unsigned int) theS1,
+				(unsigned int) theS2,
+				(unsigned int) theLen );
+		}
+
+		// strlen: the window ends with a null byte, the ROM pattern with
+		// zeroes.
+		KUInt32 theString = (fromROM ? kROMData : inWindow) + theOffset2;
+		FillWindow( theMemory, inWindow, theFill );
+		(void) theMemory->WriteB( inWindow + kWindowSize - 1, 0 );
+		if (indexCase & 1)
+		{
+			(void) theMemory->WriteB(
+				inWindow + theOffset2 + (theValue % (kWindowSize - theOffset2)),
+				0 );
+		}
+		theProcessor->SetRegister( 0, theString );
+		RunGuest( inEmulator, kGuestStrlen );
+		theExpectedResult = theProcessor->GetRegister( 0 );
+
+		theProcessor->SetRegister( 0, theString );
+		inCalls->Execute( TVirtualizedCallsPatches::kstrlen );
+
+		if (theProcessor->GetRegister( 0 ) != theExpectedResult)
+		{
+			nbFailures++;
+			inLog->FLogLine(
+				"strlen( %.8X ) differs",
+				(unsigned int) theString );
+		}
+	}
+	
+	return nbFailures;
+}
+
+// -------------------------------------------------------------------------- //
+//  * LogFault( TLog*, TEmulator*, const char* )
+// -------------------------------------------------------------------------- //
+static void
+LogFault( TLog* inLog, TEmulator* inEmulator, const char* inName )
+{
+	TMemory* theMemory = inEmulator->GetMemory();
+	TARMProcessor* theProcessor = inEmulator->GetProcessor();
+	inLog->FLogLine( "%s fault: FSR=%.8X FAR=%.8X PC=%.8X mode=%.2X",
+		inName,
+		(unsigned int) theMemory->GetFaultStatusRegister(),
+		(unsigned int) theMemory->GetFaultAddressRegister(),
+		(unsigned int) theProcessor->GetRegister( 15 ),
+		(unsigned int) (theProcessor->GetCPSR() & 0x1F) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * LibcTest( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UVirtualizedCallsTests::LibcTest( TLog* inLog )
+{
+	KUInt8* rom = CreateROM();
+	TEmulator theEmulator( inLog, rom, kTempFlashPath );
+	TMemory* theMemory = theEmulator.GetMemory();
+	TARMProcessor* theProcessor = theEmulator.GetProcessor();
+	TVirtualizedCalls theCalls( &theEmulator, theMemory, theProcessor );
+
+	KUInt32 nbFailures =
+		CompareLibc( inLog, &theEmulator, &theCalls, 0x04010000, 200, 3 );
+	inLog->FLogLine( "MMU off: %s", nbFailures ? "FAILED" : "ok" );
+
+	EnableMMU( theMemory );
+	nbFailures =
+		CompareLibc( inLog, &theEmulator, &theCalls, 0x100FF800, 200, 4 );
+	inLog->FLogLine( "MMU on: %s", nbFailures ? "FAILED" : "ok" );
+
+	// memset ending in the missing section: nothing is written.
+	KUInt8 theBefore[kWindowSize];
+	KUInt8 theAfter[kWindowSize];
+	ReadWindow( theMemory, 0x101FF000, theBefore );
+	theProcessor->SetRegister( 0, 0x101FFF00 );
+	theProcessor->SetRegister( 1, 0xA5 );
+	theProcessor->SetRegister( 2, 0x200 );
+	theCalls.Execute( TVirtualizedCallsPatches::kmemset );
+	ReadWindow( theMemory, 0x101FF000, theAfter );
+	LogFault( inLog, &theEmulator, "memset" );
+	inLog->FLogLine( "memset: %s",
+		::memcmp( theBefore, theAfter, kWindowSize ) ? "modified" : "unmodified" );
+
+	// memcmp of equal buffers that end in the missing section.
+	theProcessor->SetRegister( 0, 0x101FFFF0 );
+	theProcessor->SetRegister( 1, 0x101FFFF0 );
+	theProcessor->SetRegister( 2, 0x20 );
+	theCalls.Execute( TVirtualizedCallsPatches::kmemcmp );
+	LogFault( inLog, &theEmulator, "memcmp" );
+
+	// memcmp of different buffers only reads up to the difference.
+	(void) theMemory->WriteB( 0x101FFFF8, 0x01 );
+	(void) theMemory->WriteB( 0x100FFFF8, 0x02 );
+	(void) theMemory->Write( 0x101FFFF0, 0x00000000 );
+	(void) theMemory->Write( 0x101FFFF4, 0x00000000 );
+	(void) theMemory->Write( 0x100FFFF0, 0x00000000 );
+	(void) theMemory->Write( 0x100FFFF4, 0x00000000 );
+	theProcessor->SetRegister( 0, 0x101FFFF0 );
+	theProcessor->SetRegister( 1, 0x100FFFF0 );
+	theProcessor->SetRegister( 2, 0x20 );
+	theCalls.Execute( TVirtualizedCallsPatches::kmemcmp );
+	inLog->FLogLine( "memcmp: %.8X",
+		(unsigned int) theProcessor->GetRegister( 0 ) );
+
+	// strlen of a string that continues in the missing section.
+	KUInt32 index;
+	for (index = 0; index < 0x10; index++)
+	{
+		(void) theMemory->WriteB( 0x101FFFF0 + index, 'a' );
+	}
+	theProcessor->SetRegister( 0, 0x101FFFF0 );
+	theCalls.Execute( TVirtualizedCallsPatches::kstrlen );
+	LogFault( inLog, &theEmulator, "strlen" );
+
+	(void) ::unlink( kTempFlashPath );
+	::free( rom );
+}
+
+// ====================================================================== //
+// If it happens once, it's a bug.                                        //
+// If it happens twice, it's a feature.                                   //
+// If it happens more than twice, it's a design philosophy.               //
+// ====================================================================== //
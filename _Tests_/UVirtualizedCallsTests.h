@@ -0,0 +1,59 @@
+// ==============================
+// File:			UVirtualizedCallsTests.h
+// Project:			Einstein
+//
+// Copyright 2026 by the Einstein developers.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _UVIRTUALIZEDCALLSTESTS_H
+#define _UVIRTUALIZEDCALLSTESTS_H
+
+#include <K/Defines/KDefinitions.h>
+
+#include "Emulator/Log/TLog.h"
+
+///
+/// Class to test the host implementations of ROM routines.
+///
+/// Every virtualized call is compared with an equivalent routine run by the
+/// emulator, on the same pseudo-random inputs.
+///
+class UVirtualizedCallsTests
+{
+public:
+	///
+	/// Compare memmove with a byte by byte guest memmove, with and
+	/// without the MMU, and check it faults before modifying memory.
+	///
+	static void MemmoveTest( TLog* inLog );
+
+	///
+	/// Compare memset, memcmp and strlen with byte by byte guest routines,
+	/// with and without the MMU, and check how they fault.
+	///
+	static void LibcTest( TLog* inLog );
+};
+
+#endif
+		// _UVIRTUALIZEDCALLSTESTS_H
+
+// ====================================================================== //
+// Testing can show the presence of bugs, but not their absence.          //
+//                 -- Edsger W. Dijkstra                                  //
+// ====================================================================== //
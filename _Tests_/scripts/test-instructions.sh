@@ -172,3 +172,7 @@ perl tests.pl "$TESTSPATH" execute-instruction EE010F11
 
 # 00000000 mla      r0, r4, r0, r5
 perl tests.pl "$TESTSPATH" execute-instruction-state1 E0205094
+
+# idle loops, with a timer interrupt
+perl tests.pl "$TESTSPATH" idle-loops
+perl tests.pl "$TESTSPATH" self-modifying-code
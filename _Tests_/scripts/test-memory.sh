@@ -2,3 +2,17 @@
 . common.sh $*
 perl tests.pl "$TESTSPATH" memory-read-rom
 perl tests.pl "$TESTSPATH" memory-read-write-ram
+perl tests.pl "$TESTSPATH" memory-buffer
+perl tests.pl "$TESTSPATH" memory-restore
+perl tests.pl "$TESTSPATH" swap-copy
+perl tests.pl "$TESTSPATH" virtualized-memmove
+perl tests.pl "$TESTSPATH" virtualized-libc
+perl tests.pl "$TESTSPATH" rom-patch-database
+perl tests.pl "$TESTSPATH" rom-patch-file
+perl tests.pl "$TESTSPATH" native-semaphores
+perl tests.pl "$TESTSPATH" native-page-faults
+perl tests.pl "$TESTSPATH" native-scheduler
+perl tests.pl "$TESTSPATH" native-task-switch
+perl tests.pl "$TESTSPATH" scheduler-replay
+perl tests.pl "$TESTSPATH" retarget-release
+perl tests.pl "$TESTSPATH" retarget-locals
@@ -25,6 +25,11 @@
 #include "UScreenTests.h"
 #include "UMemoryTests.h"
 #include "UHostInfoTests.h"
+#include "UVirtualizedCallsTests.h"
+#include "UROMPatchTests.h"
+#include "UNativeKernelTests.h"
+#include "USchedulerTests.h"
+#include "URetargetTests.h"
 
 // ------------------------------------------------------------------------- //
 //  * main
@@ -76,6 +81,19 @@ test( const char* inTestName, const char* inArgument )
 	} else if (::strcmp(inTestName, "run-code") == 0) {
 		// inArgument: code to execute.
 		UProcessorTests::RunCode( inArgument, &theLog );
+	} else if (::strcmp(inTestName, "run-code-compare-flags") == 0) {
+		// inArgument: code to execute.
+		UProcessorTests::RunCodeCompareFlags( inArgument, &theLog );
+	} else if (::strcmp(inTestName, "run-code-compare-native") == 0) {
+		// inArgument: code to execute.
+		UProcessorTests::RunCodeCompareNative( inArgument, &theLog );
+	} else if (::strcmp(inTestName, "benchmark-branch-cache") == 0) {
+		// inArgument: number of loops.
+		UProcessorTests::BenchmarkBranchCache( inArgument, &theLog );
+	} else if (::strcmp(inTestName, "idle-loops") == 0) {
+		UProcessorTests::IdleLoops( &theLog );
+	} else if (::strcmp(inTestName, "self-modifying-code") == 0) {
+		UProcessorTests::SelfModifyingCode( &theLog );
 #ifndef TARGET_OS_MAC
 	} else if (::strcmp(inTestName, "screen-x11") == 0) {
 		UScreenTests::TestX11();
@@ -84,10 +102,45 @@ test( const char* inTestName, const char* inArgument )
 		UMemoryTests::ReadROMTest(&theLog);
 	} else if (::strcmp(inTestName, "memory-read-write-ram") == 0) {
 		UMemoryTests::ReadWriteRAMTest(&theLog);
+	} else if (::strcmp(inTestName, "memory-buffer") == 0) {
+		UMemoryTests::BufferTest(&theLog);
+	} else if (::strcmp(inTestName, "memory-restore") == 0) {
+		UMemoryTests::RestoreTest(&theLog);
+	} else if (::strcmp(inTestName, "swap-copy") == 0) {
+		UMemoryTests::SwapCopyTest(&theLog);
+	} else if (::strcmp(inTestName, "benchmark-swap-copy") == 0) {
+		// inArgument: size of the buffer in bytes.
+		UMemoryTests::BenchmarkSwapCopy( inArgument, &theLog );
 	} else if (::strcmp(inTestName, "flash") == 0) {
 		UMemoryTests::FlashTest(&theLog);
 	} else if (::strcmp(inTestName, "host-info") == 0) {
 		UHostInfoTests::HostInfoTest(&theLog);
+	} else if (::strcmp(inTestName, "virtualized-memmove") == 0) {
+		UVirtualizedCallsTests::MemmoveTest(&theLog);
+	} else if (::strcmp(inTestName, "virtualized-libc") == 0) {
+		UVirtualizedCallsTests::LibcTest(&theLog);
+	} else if (::strcmp(inTestName, "rom-patch-database") == 0) {
+		UROMPatchTests::DatabaseTest(&theLog);
+	} else if (::strcmp(inTestName, "rom-patch-file") == 0) {
+		// The scripts run in _Tests_/scripts.
+		UROMPatchTests::FileTest("../../_Data_/Einstein.patches", &theLog);
+	} else if (::strcmp(inTestName, "native-semaphores") == 0) {
+		UNativeKernelTests::Semaphores(&theLog);
+	} else if (::strcmp(inTestName, "native-page-faults") == 0) {
+		UNativeKernelTests::PageFaults(&theLog);
+	} else if (::strcmp(inTestName, "native-scheduler") == 0) {
+		UNativeKernelTests::Scheduler(&theLog);
+	} else if (::strcmp(inTestName, "native-task-switch") == 0) {
+		UNativeKernelTests::TaskSwitch(&theLog);
+	} else if (::strcmp(inTestName, "scheduler-replay") == 0) {
+		USchedulerTests::Replay(&theLog);
+	} else if (::strcmp(inTestName, "retarget-release") == 0) {
+		URetargetTests::Release(&theLog);
+	} else if (::strcmp(inTestName, "retarget-locals") == 0) {
+		URetargetTests::LocalRegisters(&theLog);
+	} else if (::strcmp(inTestName, "benchmark-retarget-locals") == 0) {
+		// inArgument: number of loops.
+		URetargetTests::BenchmarkLocalRegisters( inArgument, &theLog );
 	} else {
 		(void) ::printf( "%s is an unknown test.\n", inTestName );
 	}
@@ -56,6 +56,7 @@
 #include "Emulator/Log/TLog.h"
 #include "Emulator/Log/TFileLog.h"
 #include "Emulator/Log/TBufferLog.h"
+#include "Emulator/NativeCalls/TNativeKernel.h"
 #include "Monitor/TMonitor.h"
 #include "Monitor/TSymbolList.h"
 
@@ -137,6 +138,8 @@ TCLIApp::Run( int argc, char* argv[] )
 	int portraitWidth = TScreenManager::kDefaultPortraitWidth;
 	int portraitHeight = TScreenManager::kDefaultPortraitHeight;
 	int ramSize = 0x40;
+	int jitCacheSize = 0;			// Default is to keep the JIT default.
+	Boolean jitPinROM = false;		// Default is to evict ROM pages.
 	Boolean fullscreen = false;		// Default is not full screen.
 	Boolean useAIFROMFile = false;	// Default is to use flat rom format.
 	Boolean faceless = false;		// Default is to have an interface.
@@ -266,6 +269,18 @@ TCLIApp::Run( int argc, char* argv[] )
 					"first bank is handled)\nI'll boot with 4 MB (64).\n");
 				ramSize = 0x40;
 			}
+		} else if (::sscanf(argv[indexArgs], "--jit-cache=%i", &jitCacheSize) == 1) {
+			// Checked once the emulator is created.
+		} else if (::strcmp(argv[indexArgs], "--jit-pin-rom") == 0) {
+			jitPinROM = true;
+		} else if (::strcmp(argv[indexArgs], "--jit-page-file") == 0) {
+			TJITGeneric::SetUsePageFile( true );
+		} else if (::strcmp(argv[indexArgs], "--native-kernel") == 0) {
+			TNativeKernel::SetFastPaths( true );
+		} else if (::strcmp(argv[indexArgs], "--native-page-faults") == 0) {
+			TNativeKernel::SetPageFaults( true );
+		} else if (::strcmp(argv[indexArgs], "--native-scheduler") == 0) {
+			TNativeKernel::SetNativeScheduler( true );
 		} else if (::strcmp(argv[indexArgs], "--aif") == 0) {
 			useAIFROMFile = true;
 		} else if (::strcmp(argv[indexArgs], "--faceless") == 0) {
@@ -344,6 +359,19 @@ TCLIApp::Run( int argc, char* argv[] )
 				mSoundManager, mScreenManager, mNetworkManager, ramSize << 16 );
 	mPlatformManager = mEmulator->GetPlatformManager();
 	
+	if (jitCacheSize != 0)
+	{
+		if (mEmulator->GetMemory()->GetJITObject()->SetCacheSize( jitCacheSize ))
+		{
+			(void) ::fprintf(
+				stderr,
+				"JIT cache size must be between 16 and 16384 pages\n"
+				"I'll boot with the default size (%i).\n",
+				(int) mEmulator->GetMemory()->GetJITObject()->GetCacheSize() );
+		}
+	}
+	mEmulator->GetMemory()->GetJITObject()->SetPinROMPages( jitPinROM );
+	
 	if (useMonitor)
 	{
 		char theSymbolListPath[512];
@@ -697,6 +725,18 @@ TCLIApp::Help( void )
 				"  --monitor                       monitor mode\n" );
 	(void) ::printf(
 				"  --ram=size                      ram size in 64 KB (1-255) (default: 64, i.e. 4 MB)\n" );
+	(void) ::printf(
+				"  --jit-cache=pages               JIT cache size in 1 KB pages (16-16384) (default: 128)\n" );
+	(void) ::printf(
+				"  --jit-pin-rom                   never evict translated ROM pages\n" );
+	(void) ::printf(
+				"  --jit-page-file                 keep translated ROM pages next to the ROM image\n" );
+	(void) ::printf(
+				"  --native-kernel                 do semaphore operations on the host (experimental)\n" );
+	(void) ::printf(
+				"  --native-page-faults            map pages again on the host (experimental)\n" );
+	(void) ::printf(
+				"  --native-scheduler              switch tasks on the host (experimental)\n" );
 	(void) ::printf(
 				"  --aif                           read aif files\n" );
 	::exit(1);